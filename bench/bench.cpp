@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "bufmgr.h"
+#include "db.h"
+#include "logmgr.h"
+
+static const char* dbName = "BENCH.DB";
+static const char* logName = "BENCH.LOG";
+
+const char* benchReplacers[] = { "Clock" };
+const int numOfBenchReplacers = sizeof(benchReplacers) / sizeof(benchReplacers[0]);
+
+static std::atomic<long> numOfAllocations(0);
+
+
+long GetNumOfAllocations()
+{
+	return numOfAllocations.load();
+}
+
+
+void* operator new(size_t size)
+{
+	numOfAllocations.fetch_add(1, std::memory_order_relaxed);
+	void *p = malloc(size ? size : 1);
+	if (p == NULL)
+		throw std::bad_alloc();
+	return p;
+}
+
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+
+
+void operator delete[](void* p) noexcept
+{
+	free(p);
+}
+
+
+//------------------------------------------------------------------
+// Constructor of Bench
+//
+// Input    : name - the operation timed,
+//            params - what it was run with.
+// Output   : None.
+// Purpose  : Sets up an empty measurement.
+//------------------------------------------------------------------
+
+Bench::Bench(const std::string& name, const std::string& params)
+	: name(name), params(params), seconds(0)
+{
+}
+
+
+//------------------------------------------------------------------
+// Bench::Start
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Starts a stretch of calls.
+// Return   : None.
+//------------------------------------------------------------------
+
+void Bench::Start()
+{
+	runStart = Clock::now();
+}
+
+
+//------------------------------------------------------------------
+// Bench::Stop
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Ends the stretch of calls begun by Start.
+// Return   : None.
+//------------------------------------------------------------------
+
+void Bench::Stop()
+{
+	seconds += std::chrono::duration<double>(Clock::now() - runStart).count();
+}
+
+
+void Bench::Merge(const Bench& other)
+{
+	latencies.insert(latencies.end(), other.latencies.begin(), other.latencies.end());
+}
+
+
+//------------------------------------------------------------------
+// Bench::GetOpsPerSec
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Computes the throughput of the run.
+// Return   : Calls timed per second of the run, 0 if it took no time.
+//------------------------------------------------------------------
+
+double Bench::GetOpsPerSec() const
+{
+	if (seconds <= 0)
+		return 0;
+	return latencies.size() / seconds;
+}
+
+
+//------------------------------------------------------------------
+// Bench::GetPercentile
+//
+// Input    : p - a fraction between 0 and 1.
+// Output   : None.
+// Purpose  : Finds the nearest-rank percentile of the latencies.
+//            They are sorted once, on the first call.
+// Return   : The latency in nanoseconds, 0 if no call was timed.
+//------------------------------------------------------------------
+
+long Bench::GetPercentile(double p) const
+{
+	if (latencies.empty())
+		return 0;
+
+	if (sorted.size() != latencies.size())
+	{
+		sorted = latencies;
+		std::sort(sorted.begin(), sorted.end());
+	}
+
+	size_t rank = (size_t)std::ceil(p * sorted.size());
+	if (rank == 0)
+		rank = 1;
+	return sorted[rank - 1];
+}
+
+
+//------------------------------------------------------------------
+// Bench::GetHistogram
+//
+// Input    : None.
+// Output   : buckets - (upper bound, number of calls) of each bucket
+//            that is not empty, in increasing order.
+// Purpose  : Counts the latencies in power-of-two buckets.
+// Return   : None.
+//------------------------------------------------------------------
+
+void Bench::GetHistogram(std::vector<std::pair<long, long> >& buckets) const
+{
+	std::vector<long> counts;
+
+	for (size_t i = 0; i < latencies.size(); i++)
+	{
+		size_t bucket = 0;
+		while ((1L << bucket) < latencies[i])
+			bucket++;
+		if (counts.size() <= bucket)
+			counts.resize(bucket + 1, 0);
+		counts[bucket]++;
+	}
+
+	buckets.clear();
+	for (size_t i = 0; i < counts.size(); i++)
+		if (counts[i] != 0)
+			buckets.push_back(std::make_pair(1L << i, counts[i]));
+}
+
+
+//------------------------------------------------------------------
+// BenchReport::Add
+//
+// Input    : bench - a finished measurement.
+// Output   : None.
+// Purpose  : Keeps the figures of a measurement for the report.
+// Return   : None.
+//------------------------------------------------------------------
+
+void BenchReport::Add(const Bench& bench)
+{
+	Row row;
+	row.name = bench.GetName();
+	row.params = bench.GetParams();
+	row.numOfOps = bench.GetNumOfOps();
+	row.seconds = bench.GetSeconds();
+	row.opsPerSec = bench.GetOpsPerSec();
+	row.p50 = bench.GetPercentile(0.50);
+	row.p99 = bench.GetPercentile(0.99);
+	bench.GetHistogram(row.histogram);
+	rows.push_back(row);
+}
+
+
+//------------------------------------------------------------------
+// BenchReport::Write
+//
+// Input    : out - where to write the report,
+//            format - JSON or CSV.
+// Output   : None.
+// Purpose  : Writes one entry per measurement.  Names and parameters
+//            never hold quotes or commas, so they are written as is.
+//            Only JSON has room for the latency histograms.
+// Return   : None.
+//------------------------------------------------------------------
+
+void BenchReport::Write(std::ostream& out, Format format) const
+{
+	if (format == CSV)
+	{
+		out << "name,params,ops,seconds,ops_per_sec,p50_ns,p99_ns\n";
+		for (size_t i = 0; i < rows.size(); i++)
+		{
+			const Row& r = rows[i];
+			out << r.name << "," << r.params << "," << r.numOfOps << ","
+			    << r.seconds << "," << (long)r.opsPerSec << ","
+			    << r.p50 << "," << r.p99 << "\n";
+		}
+		return;
+	}
+
+	out << "{\n  \"benchmarks\": [";
+	for (size_t i = 0; i < rows.size(); i++)
+	{
+		const Row& r = rows[i];
+		out << (i ? ",\n" : "\n")
+		    << "    {\"name\": \"" << r.name << "\""
+		    << ", \"params\": \"" << r.params << "\""
+		    << ", \"ops\": " << r.numOfOps
+		    << ", \"seconds\": " << r.seconds
+		    << ", \"ops_per_sec\": " << (long)r.opsPerSec
+		    << ", \"p50_ns\": " << r.p50
+		    << ", \"p99_ns\": " << r.p99
+		    << ", \"histogram\": [";
+		for (size_t j = 0; j < r.histogram.size(); j++)
+			out << (j ? ", " : "") << "[" << r.histogram[j].first
+			    << ", " << r.histogram[j].second << "]";
+		out << "]}";
+	}
+	out << "\n  ]\n}\n";
+}
+
+
+//------------------------------------------------------------------
+// CreateBenchDB
+//
+// Input    : dbPages - size of the database, in pages,
+//            bufPages - size of the buffer pool, in frames,
+//            replacer - replacement policy of the pool.
+// Output   : None.
+// Purpose  : Creates a new database and log, replacing any left by
+//            an earlier benchmark.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status CreateBenchDB(unsigned dbPages, unsigned bufPages, const char* replacer)
+{
+	Status status;
+
+	RemoveBenchDB();
+	minibase_globals = new SystemDefs(status, dbName, logName, dbPages,
+	                                  4 * dbPages, bufPages, replacer);
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// CloseBenchDB
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Writes back every page and closes the database.  No
+//            page may be pinned.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status CloseBenchDB()
+{
+	Status status = MINIBASE_BM->FlushAllPages();
+	if (status == OK)
+		status = MINIBASE_LOG->Commit();
+	if (status == OK)
+		status = MINIBASE_LOG->Checkpoint();
+
+	delete minibase_globals;
+	minibase_globals = 0;
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// ReopenBenchDB
+//
+// Input    : bufPages - size of the new buffer pool, in frames,
+//            replacer - its replacement policy.
+// Output   : None.
+// Purpose  : Closes the database, asks the kernel to drop it from
+//            the page cache, and opens it again with an empty pool,
+//            so that every page must come from the file.  The list of
+//            pages the pool held is removed first, or the reopen
+//            would bring them back (see BufMgr::Prewarm).
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status ReopenBenchDB(unsigned bufPages, const char* replacer)
+{
+	Status status = CloseBenchDB();
+	if (status != OK)
+		return status;
+
+	unlink((std::string(dbName) + ".prewarm").c_str());
+
+	int fd = open(dbName, O_RDONLY);
+	if (fd >= 0)
+	{
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	}
+
+	minibase_globals = new SystemDefs(status, dbName, logName, 0, 0,
+	                                  bufPages, replacer);
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// RemoveBenchDB
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Removes the files of the benchmark database.
+// Return   : None.
+//------------------------------------------------------------------
+
+void RemoveBenchDB()
+{
+	unlink(dbName);
+	unlink(logName);
+	unlink((std::string(dbName) + ".prewarm").c_str());
+}
@@ -0,0 +1,119 @@
+#ifndef _BENCH_H
+#define _BENCH_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "minirel.h"
+
+//
+// One measurement: a named operation, timed one call at a time.  Each call
+// is bracketed by Begin and End, and the stretches of calls by Start and
+// Stop; throughput is taken over the time between Start and Stop, so that
+// work done between stretches is left out, and latency percentiles over
+// the calls.
+//
+class Bench
+{
+public:
+
+	typedef std::chrono::steady_clock Clock;
+
+	Bench(const std::string& name, const std::string& params);
+
+	void Start();
+	void Stop();
+
+	// Makes room for the latencies of this many calls up front.
+	void Reserve(long numOfOps) { latencies.reserve(numOfOps); }
+
+	void Begin() { opStart = Clock::now(); }
+	void End()
+	{
+		latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			Clock::now() - opStart).count());
+	}
+
+	// Counts a call timed some other way, such as from its start to its
+	// callback, that took the given nanoseconds.
+	void Add(long nanoseconds) { latencies.push_back(nanoseconds); }
+
+	// Counts the calls another bench timed, in a thread of its own, as
+	// calls of this one; the time is still this one's, from Start to Stop.
+	void Merge(const Bench& other);
+
+	const std::string& GetName() const { return name; }
+	const std::string& GetParams() const { return params; }
+	void SetParams(const std::string& p) { params = p; }
+	long GetNumOfOps() const { return (long)latencies.size(); }
+	double GetSeconds() const { return seconds; }
+	double GetOpsPerSec() const;
+
+	// Latency in nanoseconds that the fraction p of calls did not exceed.
+	long GetPercentile(double p) const;
+
+	// Counts the calls by latency, in buckets whose upper bounds (in
+	// nanoseconds) are successive powers of two.  Empty buckets are left
+	// out.
+	void GetHistogram(std::vector<std::pair<long, long> >& buckets) const;
+
+private:
+
+	std::string name;            // what was timed, e.g. "file.scan".
+	std::string params;          // "key=value" pairs separated by spaces.
+	Clock::time_point runStart;  // of the current stretch.
+	Clock::time_point opStart;
+	double seconds;              // time between Start and Stop.
+	std::vector<long> latencies; // of each call, in nanoseconds.
+	mutable std::vector<long> sorted;
+};
+
+//
+// The measurements of one benchmark run, written out as JSON or CSV.
+//
+class BenchReport
+{
+public:
+
+	enum Format { JSON, CSV };
+
+	void Add(const Bench& bench);
+	void Write(std::ostream& out, Format format) const;
+
+private:
+
+	struct Row
+	{
+		std::string name;
+		std::string params;
+		long   numOfOps;
+		double seconds;
+		double opsPerSec;
+		long   p50;
+		long   p99;
+		std::vector<std::pair<long, long> > histogram;
+	};
+
+	std::vector<Row> rows;
+};
+
+//
+// Every benchmark runs against a database of its own, created afresh.
+//
+Status CreateBenchDB(unsigned dbPages, unsigned bufPages, const char* replacer);
+Status CloseBenchDB();
+Status ReopenBenchDB(unsigned bufPages, const char* replacer);
+void RemoveBenchDB();
+
+// Every replacement policy the buffer manager offers.
+extern const char* benchReplacers[];
+extern const int numOfBenchReplacers;
+
+// Calls to operator new, in any thread, since the benchmarks started: the
+// benchmark binary replaces the global operator new to count them, so that
+// a benchmark can check what a path allocates.
+long GetNumOfAllocations();
+
+#endif
@@ -0,0 +1,878 @@
+/////////////////////////////////////////////////////////////////
+//
+// filename : main.cpp
+//
+// Micro-benchmarks of the storage layer: heap page operations, heap
+// file insert and scan, inserts from several threads, the buffer
+// pool pin paths, asynchronous reads at several queue depths, sealed
+// pages against heap pages, and page reads with checksums checked and
+// not.  With -w, the YCSB workloads named instead (see ycsb.h).
+// Results go to standard output (or the file given with -o) as JSON or
+// CSV.
+//
+//   usage: heapbench [-f json|csv] [-o file] [-m] [-q] [-w workloads]
+//
+// -m writes the metrics registry (see metrics.h) to standard error at
+// the end; -q runs smaller files and fewer operations, for a quick check.
+//
+/////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <unistd.h>
+
+#include "minirel.h"
+#include "bufmgr.h"
+#include "db.h"
+#include "logmgr.h"
+#include "heapfile.h"
+#include "heappage.h"
+#include "sealedpage.h"
+#include "scan.h"
+#include "metrics.h"
+#include "bench.h"
+#include "ycsb.h"
+#include "ioservice.h"
+
+using namespace std;
+
+int MINIBASE_RESTART_FLAG = 0;
+
+struct Rec
+{
+	int  key;
+	char payload[36];
+};
+
+static const int recLen = sizeof(Rec);
+
+
+//------------------------------------------------------------------
+// BenchPage
+//
+// Input    : numOfRounds - times to fill and empty the page.
+// Output   : report - receives page.insert, page.get, page.delete.
+// Purpose  : Times record operations on a heap page in memory, with
+//            no buffer manager or log involved.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+static Status BenchPage(BenchReport& report, int numOfRounds)
+{
+	ostringstream params;
+	params << "reclen=" << recLen;
+
+	Bench insert("page.insert", params.str());
+	Bench get("page.get", params.str());
+	Bench remove("page.delete", params.str());
+
+	HeapPage heapPage;
+	HeapPage *page = &heapPage;
+	vector<RecordID> rids;
+	Rec rec;
+	int len;
+
+	memset(&rec, 'x', sizeof(rec));
+
+	for (int round = 0; round < numOfRounds; round++)
+	{
+		page->Init(1);
+		rids.clear();
+
+		insert.Start();
+		for (;;)
+		{
+			RecordID rid;
+			rec.key = (int)rids.size();
+			insert.Begin();
+			if (page->InsertRecord((char *)&rec, recLen, rid) != OK)
+				break;
+			insert.End();
+			rids.push_back(rid);
+		}
+		insert.Stop();
+
+		get.Start();
+		for (size_t i = 0; i < rids.size(); i++)
+		{
+			get.Begin();
+			Status status = page->GetRecord(rids[i], (char *)&rec, len);
+			get.End();
+			if (status != OK)
+				return FAIL;
+		}
+		get.Stop();
+
+		remove.Start();
+		for (size_t i = 0; i < rids.size(); i++)
+		{
+			remove.Begin();
+			Status status = page->DeleteRecord(rids[i]);
+			remove.End();
+			if (status != OK)
+				return FAIL;
+		}
+		remove.Stop();
+	}
+
+	report.Add(insert);
+	report.Add(get);
+	report.Add(remove);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BenchSeal
+//
+// Input    : numOfPages - heap pages to fill and seal,
+//            numOfOps - point lookups to time on each kind of page.
+// Output   : report - receives page.seal, and page.scan and
+//            page.lookup with sealed=off and sealed=on.
+// Purpose  : Fills heap pages in memory with records whose keys
+//            rise and whose payloads repeat, as a cold file's would,
+//            seals each with frame-of-reference on the key and a
+//            dictionary on the payload, and times reading every
+//            record in page order, and records picked across the
+//            pages, from the heap pages and from their sealed images.
+//            page.seal gives the bytes the pages use, the bytes their
+//            images use, and the ratio of the two.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+static Status BenchSeal(BenchReport& report, int numOfPages, int numOfOps)
+{
+	const ColumnDesc cols[] = {
+		{ offsetof(Rec, key), sizeof(int), attrInteger },
+		{ offsetof(Rec, payload), sizeof(((Rec *)0)->payload), attrString },
+	};
+
+	vector<Page> pages(numOfPages);
+	vector<SealedPage> sealed(numOfPages);
+	vector<RecordID> rids;
+	Rec rec;
+	int len;
+	long heapBytes = 0, sealedBytes = 0;
+
+	memset(&rec, 0, sizeof(rec));
+
+	for (int p = 0; p < numOfPages; p++)
+	{
+		HeapPage *page = (HeapPage *)&pages[p];
+		page->Init(p + 1);
+		for (;;)
+		{
+			RecordID rid;
+			rec.key = (int)rids.size();
+			sprintf(rec.payload, "region %d", rec.key % 8);
+			if (page->InsertRecord((char *)&rec, recLen, rid) != OK)
+				break;
+			rids.push_back(rid);
+		}
+		heapBytes += MAX_SPACE - page->AvailableSpace();
+	}
+
+	ostringstream params;
+	params << "pages=" << numOfPages << " reclen=" << recLen;
+
+	Bench seal("page.seal", params.str());
+	seal.Start();
+	for (int p = 0; p < numOfPages; p++)
+	{
+		seal.Begin();
+		Status status = sealed[p].Seal((HeapPage *)&pages[p], cols, 2);
+		seal.End();
+		if (status != OK)
+			return FAIL;
+		sealedBytes += sealed[p].SealedSize();
+	}
+	seal.Stop();
+
+	ostringstream sealParams;
+	sealParams.precision(3);
+	sealParams << params.str() << " heapbytes=" << heapBytes
+	           << " sealedbytes=" << sealedBytes
+	           << " ratio=" << (double)heapBytes / sealedBytes;
+	seal.SetParams(sealParams.str());
+	report.Add(seal);
+
+	// The same records are read from both kinds of page, through the
+	// same calls, so that the difference is the cost of decoding.
+
+	for (int s = 0; s < 2; s++)
+	{
+		string which = params.str() + (s == 0 ? " sealed=off" : " sealed=on");
+		Bench scan("page.scan", which);
+		Bench lookup("page.lookup", which);
+
+		scan.Reserve(rids.size());
+		scan.Start();
+		for (int p = 0; p < numOfPages; p++)
+		{
+			HeapPage *page = (HeapPage *)&pages[p];
+			RecordID rid;
+			Status status = (s == 0) ? page->FirstRecord(rid) : sealed[p].FirstRecord(rid);
+			while (status == OK)
+			{
+				scan.Begin();
+				status = (s == 0) ? page->GetRecord(rid, (char *)&rec, len)
+				                  : sealed[p].GetRecord(rid, (char *)&rec, len);
+				if (status == OK)
+					status = (s == 0) ? page->NextRecord(rid, rid)
+					                  : sealed[p].NextRecord(rid, rid);
+				scan.End();
+			}
+			if (status != DONE)
+				return FAIL;
+		}
+		scan.Stop();
+
+		// Records are picked with a stride prime to their number, so
+		// that every page is visited in no particular order.
+
+		lookup.Reserve(numOfOps);
+		lookup.Start();
+		for (int i = 0; i < numOfOps; i++)
+		{
+			const RecordID& rid = rids[(long)i * 7919 % rids.size()];
+			int p = rid.pageNo - 1;
+			lookup.Begin();
+			Status status = (s == 0) ? ((HeapPage *)&pages[p])->GetRecord(rid, (char *)&rec, len)
+			                         : sealed[p].GetRecord(rid, (char *)&rec, len);
+			lookup.End();
+			if (status != OK)
+				return FAIL;
+		}
+		lookup.Stop();
+
+		if (scan.GetNumOfOps() != (long)rids.size())
+		{
+			cerr << "The scan of the " << (s == 0 ? "heap" : "sealed") << " pages read "
+			     << scan.GetNumOfOps() << " of " << rids.size() << " records\n";
+			return FAIL;
+		}
+
+		report.Add(scan);
+		report.Add(lookup);
+	}
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// TimeScan
+//
+// Input    : file - the file to scan.
+// Output   : bench - receives the time of each call to GetNext.
+// Purpose  : Scans the whole file once.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+static Status TimeScan(HeapFile& file, Bench& bench)
+{
+	Status status;
+	Scan *scan = file.OpenScan(status);
+	if (status != OK)
+		return status;
+
+	RecordID rid;
+	Rec rec;
+	int len;
+
+	bench.Start();
+	for (;;)
+	{
+		bench.Begin();
+		status = scan->GetNext(rid, (char *)&rec, len);
+		if (status != OK)
+			break;
+		bench.End();
+	}
+	bench.Stop();
+
+	delete scan;
+	return (status == DONE) ? OK : status;
+}
+
+
+//------------------------------------------------------------------
+// BenchFile
+//
+// Input    : numOfRecords - size of the file to build.
+// Output   : report - receives file.insert, file.scan.warm and
+//            file.scan.cold.
+// Purpose  : Builds a heap file one record at a time, then scans it
+//            with every page in the pool, and again after reopening
+//            the database with an empty pool and page cache.  The
+//            pool holds the whole file.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+static Status BenchFile(BenchReport& report, int numOfRecords)
+{
+	unsigned dbPages = numOfRecords / 16 + 1000;
+	unsigned bufPages = dbPages;
+
+	ostringstream params;
+	params << "records=" << numOfRecords << " reclen=" << recLen
+	       << " frames=" << bufPages;
+
+	Bench insert("file.insert", params.str());
+	Bench warm("file.scan.warm", params.str());
+	Bench cold("file.scan.cold", params.str());
+
+	Status status = CreateBenchDB(dbPages, bufPages, "Clock");
+	if (status != OK)
+		return status;
+
+	{
+		HeapFile file("bench", status);
+		if (status != OK)
+			return status;
+
+		Rec rec;
+		RecordID rid;
+		memset(&rec, 'x', sizeof(rec));
+
+		insert.Start();
+		for (int i = 0; i < numOfRecords && status == OK; i++)
+		{
+			rec.key = i;
+			insert.Begin();
+			status = file.InsertRecord((char *)&rec, recLen, rid);
+			insert.End();
+		}
+		insert.Stop();
+
+		if (status == OK)
+			status = MINIBASE_LOG->Commit();
+		if (status == OK)
+			status = TimeScan(file, warm);
+		if (status == OK && warm.GetNumOfOps() != numOfRecords)
+		{
+			cerr << "The scan returned " << warm.GetNumOfOps() << " of "
+			     << numOfRecords << " records\n";
+			status = FAIL;
+		}
+	}
+
+	if (status == OK)
+		status = ReopenBenchDB(bufPages, "Clock");
+
+	if (status == OK)
+	{
+		HeapFile file("bench", status);
+		if (status == OK)
+			status = TimeScan(file, cold);
+	}
+
+	if (status == OK)
+		status = CloseBenchDB();
+	if (status != OK)
+		return status;
+
+	report.Add(insert);
+	report.Add(warm);
+	report.Add(cold);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BenchInsertThreads
+//
+// Input    : numOfThreads - threads inserting at once,
+//            numOfRecords - records they insert between them.
+// Output   : report - receives file.insert.threads.
+// Purpose  : Times inserts into one heap file from several threads,
+//            each timing its own calls; throughput is over the time
+//            from the first thread starting to the last finishing.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+static Status BenchInsertThreads(BenchReport& report, int numOfThreads, int numOfRecords)
+{
+	unsigned dbPages = numOfRecords / 16 + 1000;
+	unsigned bufPages = dbPages;
+
+	ostringstream params;
+	params << "threads=" << numOfThreads << " records=" << numOfRecords
+	       << " reclen=" << recLen << " frames=" << bufPages;
+
+	Bench insert("file.insert.threads", params.str());
+	vector<Bench> threadBenches(numOfThreads, insert);
+	vector<Status> results(numOfThreads, OK);
+
+	Status status = CreateBenchDB(dbPages, bufPages, "Clock");
+	if (status != OK)
+		return status;
+
+	{
+		HeapFile file("bench", status);
+		if (status != OK)
+			return status;
+
+		vector<thread> threads;
+		insert.Start();
+		for (int t = 0; t < numOfThreads; t++)
+			threads.push_back(thread([t, numOfThreads, numOfRecords, &file,
+			                          &threadBenches, &results]() {
+				Rec rec;
+				RecordID rid;
+				memset(&rec, 'x', sizeof(rec));
+				for (int i = t; i < numOfRecords && results[t] == OK; i += numOfThreads)
+				{
+					rec.key = i;
+					threadBenches[t].Begin();
+					results[t] = file.InsertRecord((char *)&rec, recLen, rid);
+					threadBenches[t].End();
+				}
+			}));
+		for (int t = 0; t < numOfThreads; t++)
+		{
+			threads[t].join();
+			insert.Merge(threadBenches[t]);
+			if (results[t] != OK)
+				status = results[t];
+		}
+		insert.Stop();
+
+		if (status == OK && file.GetNumOfRecords() != numOfRecords)
+		{
+			cerr << "The file has " << file.GetNumOfRecords() << " of "
+			     << numOfRecords << " records\n";
+			status = FAIL;
+		}
+	}
+
+	if (status == OK)
+		status = CloseBenchDB();
+	if (status != OK)
+		return status;
+
+	report.Add(insert);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BenchPin
+//
+// Input    : replacer - replacement policy of the pool,
+//            numOfOps - pins to time on each path.
+// Output   : report - receives bufmgr.pin.hit and bufmgr.pin.miss.
+// Purpose  : Times PinPage when the page is in the pool, cycling
+//            over half as many pages as there are frames, and when
+//            it is not, cycling in order over sixteen times as many
+//            pages as there are frames.  The allocations the pins and
+//            unpins make, which should be none, are reported with
+//            each.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+static Status BenchPin(BenchReport& report, const char* replacer, int numOfOps)
+{
+	const unsigned numOfFrames = 256;
+	const unsigned numOfPages = 16 * numOfFrames;
+	const unsigned numOfHot = numOfFrames / 2;
+
+	ostringstream hitParams, missParams;
+	hitParams << "replacer=" << replacer << " frames=" << numOfFrames
+	          << " pages=" << numOfHot;
+	missParams << "replacer=" << replacer << " frames=" << numOfFrames
+	           << " pages=" << numOfPages - numOfHot;
+
+	Bench hit("bufmgr.pin.hit", hitParams.str());
+	Bench miss("bufmgr.pin.miss", missParams.str());
+
+	Status status = CreateBenchDB(numOfPages + 100, numOfFrames, replacer);
+	if (status != OK)
+		return status;
+
+	vector<PageID> pids(numOfPages);
+	Page *page;
+
+	for (unsigned i = 0; i < numOfPages && status == OK; i++)
+	{
+		status = MINIBASE_BM->NewPage(pids[i], page);
+		if (status == OK)
+			status = MINIBASE_BM->UnpinPage(pids[i], DIRTY);
+	}
+
+	// Start both paths from an empty pool, then bring the pages the hit
+	// path cycles over in before timing it.
+
+	if (status == OK)
+		status = ReopenBenchDB(numOfFrames, replacer);
+
+	for (unsigned i = 0; i < numOfHot && status == OK; i++)
+	{
+		status = MINIBASE_BM->PinPage(pids[i], page);
+		if (status == OK)
+			status = MINIBASE_BM->UnpinPage(pids[i], CLEAN);
+	}
+
+	// Room for every latency is made first, so that the benches do not
+	// allocate while the allocations are counted.  The first time round
+	// the miss path's pages the pool grows its per-page statistics, so
+	// only the rounds after are counted.
+
+	hit.Reserve(numOfOps);
+	miss.Reserve(numOfOps);
+	long allocs = GetNumOfAllocations();
+
+	hit.Start();
+	for (int i = 0; i < numOfOps && status == OK; i++)
+	{
+		PageID pid = pids[i % numOfHot];
+		hit.Begin();
+		status = MINIBASE_BM->PinPage(pid, page);
+		hit.End();
+		if (status == OK)
+			status = MINIBASE_BM->UnpinPage(pid, CLEAN);
+	}
+	hit.Stop();
+
+	long hitAllocs = GetNumOfAllocations() - allocs;
+	allocs = GetNumOfAllocations();
+
+	miss.Start();
+	for (int i = 0; i < numOfOps && status == OK; i++)
+	{
+		if (i == (int)(numOfPages - numOfHot))
+			allocs = GetNumOfAllocations();
+		PageID pid = pids[numOfHot + i % (numOfPages - numOfHot)];
+		miss.Begin();
+		status = MINIBASE_BM->PinPage(pid, page);
+		miss.End();
+		if (status == OK)
+			status = MINIBASE_BM->UnpinPage(pid, CLEAN);
+	}
+	miss.Stop();
+
+	long missAllocs = GetNumOfAllocations() - allocs;
+
+	hitParams << " allocs=" << hitAllocs;
+	missParams << " allocs=" << missAllocs;
+	hit.SetParams(hitParams.str());
+	miss.SetParams(missParams.str());
+
+	if (status == OK)
+		status = CloseBenchDB();
+	if (status != OK)
+		return status;
+
+	report.Add(hit);
+	report.Add(miss);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BenchAsyncGet
+//
+// Input    : numOfRecords - size of the file to build,
+//            depth - reads the I/O service keeps under way at once.
+// Output   : report - receives file.get.async.
+// Purpose  : Builds a heap file, reopens the database with an empty
+//            pool and page cache, and reads one record of each data
+//            page with GetRecordAsync, all handed over at once and in
+//            no particular order, so that every read is a miss.  Each
+//            read is timed from the call to its callback; throughput
+//            is over the time until the last callback.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+static Status BenchAsyncGet(BenchReport& report, int numOfRecords, int depth)
+{
+	unsigned dbPages = numOfRecords / 16 + 1000;
+	unsigned bufPages = dbPages;
+
+	Status status = CreateBenchDB(dbPages, bufPages, "Clock");
+	if (status != OK)
+		return status;
+
+	vector<RecordID> rids;
+	{
+		HeapFile file("bench", status);
+		if (status != OK)
+			return status;
+
+		Rec rec;
+		RecordID rid;
+		memset(&rec, 'x', sizeof(rec));
+		for (int i = 0; i < numOfRecords && status == OK; i++)
+		{
+			rec.key = i;
+			status = file.InsertRecord((char *)&rec, recLen, rid);
+			if (status == OK && (rids.empty() || rids.back().pageNo != rid.pageNo))
+				rids.push_back(rid);
+		}
+	}
+
+	if (status == OK)
+		status = ReopenBenchDB(bufPages, "Clock");
+	if (status != OK)
+		return status;
+
+	MINIBASE_IO->SetQueueDepth(depth);
+
+	ostringstream params;
+	params << "records=" << numOfRecords << " pages=" << rids.size()
+	       << " depth=" << MINIBASE_IO->GetQueueDepth()
+	       << " ring=" << (MINIBASE_IO->HasKernelQueue() ? "on" : "off");
+	Bench get("file.get.async", params.str());
+
+	size_t numOfReads = rids.size();
+	vector<Rec> recs(numOfReads);
+	vector<Status> results(numOfReads, FAIL);
+	vector<Bench::Clock::time_point> starts(numOfReads);
+	vector<long> latencies(numOfReads, 0);
+	{
+		HeapFile file("bench", status);
+		if (status != OK)
+			return status;
+
+		get.Start();
+		for (size_t n = 0; n < numOfReads; n++)
+		{
+			size_t i = n * 7919 % numOfReads;
+			starts[i] = Bench::Clock::now();
+			file.GetRecordAsync(rids[i], (char *)&recs[i],
+			                    [i, &starts, &latencies, &results](Status s, int) {
+				latencies[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+					Bench::Clock::now() - starts[i]).count();
+				results[i] = s;
+			});
+		}
+		MINIBASE_IO->Drain();
+		get.Stop();
+	}
+
+	for (size_t i = 0; i < numOfReads && status == OK; i++)
+	{
+		if (results[i] != OK)
+			status = results[i];
+		get.Add(latencies[i]);
+	}
+
+	if (status == OK)
+		status = CloseBenchDB();
+	if (status != OK)
+		return status;
+
+	report.Add(get);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BenchRead
+//
+// Input    : numOfOps - page reads to time with checking on and off.
+// Output   : report - receives db.read with verify=on and verify=off.
+// Purpose  : Times DB::ReadPage over pages the kernel has cached,
+//            with checksums checked and not, so that the difference
+//            is the cost of the check.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+static Status BenchRead(BenchReport& report, int numOfOps)
+{
+	const unsigned numOfPages = 256;
+
+	ostringstream params;
+	params << "pages=" << numOfPages;
+	Bench verified("db.read", params.str() + " verify=on");
+	Bench unverified("db.read", params.str() + " verify=off");
+
+	Status status = CreateBenchDB(numOfPages + 100, 64, "Clock");
+	if (status != OK)
+		return status;
+
+	vector<PageID> pids(numOfPages);
+	Page *page;
+
+	for (unsigned i = 0; i < numOfPages && status == OK; i++)
+	{
+		status = MINIBASE_BM->NewPage(pids[i], page);
+		if (status == OK)
+		{
+			memset((char *)page, 'a' + i % 26, MINIBASE_PAGESIZE);
+			status = MINIBASE_BM->UnpinPage(pids[i], DIRTY);
+		}
+	}
+	if (status == OK)
+		status = MINIBASE_BM->FlushAllPages();
+
+	Page copy;
+	Bench *benches[] = { &verified, &unverified };
+	for (int b = 0; b < 2 && status == OK; b++)
+	{
+		MINIBASE_DB->SetVerifyChecksums(b == 0);
+		benches[b]->Reserve(numOfOps);
+		benches[b]->Start();
+		for (int i = 0; i < numOfOps && status == OK; i++)
+		{
+			benches[b]->Begin();
+			status = MINIBASE_DB->ReadPage(pids[i % numOfPages], &copy);
+			benches[b]->End();
+		}
+		benches[b]->Stop();
+	}
+	MINIBASE_DB->SetVerifyChecksums(true);
+
+	if (status == OK)
+		status = CloseBenchDB();
+	if (status != OK)
+		return status;
+
+	report.Add(verified);
+	report.Add(unverified);
+	return OK;
+}
+
+
+int main(int argc, char **argv)
+{
+	BenchReport::Format format = BenchReport::JSON;
+	const char* outName = NULL;
+	const char* workloads = NULL;
+	bool quick = false;
+	bool metrics = false;
+	int c;
+
+	while ((c = getopt(argc, argv, "f:mo:qw:")) != -1)
+	{
+		switch (c)
+		{
+		case 'f':
+			if (strcmp(optarg, "csv") == 0)
+				format = BenchReport::CSV;
+			else if (strcmp(optarg, "json") != 0)
+			{
+				cerr << "Unknown format " << optarg << endl;
+				return 2;
+			}
+			break;
+		case 'm':
+			metrics = true;
+			break;
+		case 'o':
+			outName = optarg;
+			break;
+		case 'q':
+			quick = true;
+			break;
+		case 'w':
+			workloads = optarg;
+			break;
+		default:
+			cerr << "usage: " << argv[0]
+			     << " [-f json|csv] [-o file] [-m] [-q] [-w workloads]\n";
+			return 2;
+		}
+	}
+
+	int fileSizes[] = { 1000, 10000, 100000 };
+	int numOfSizes = quick ? 2 : 3;
+	int numOfPins = quick ? 100000 : 1000000;
+	int numOfRounds = quick ? 10000 : 100000;
+
+	BenchReport report;
+	Status status = OK;
+
+	if (workloads != NULL)
+	{
+		long numOfRecords = quick ? 10000 : 100000;
+		long numOfOps = quick ? 20000 : 200000;
+		numOfSizes = 0;
+
+		for (int i = 0; i < numOfBenchReplacers && status == OK; i++)
+		{
+			YcsbDriver driver(report, benchReplacers[i], numOfRecords,
+			                  numOfOps, 1000);
+			status = driver.RunWorkloads(workloads);
+		}
+	}
+	else
+	{
+		cerr << "Heap page operations\n";
+		status = BenchPage(report, numOfRounds);
+	}
+
+	for (int i = 0; i < numOfSizes && status == OK; i++)
+	{
+		cerr << "Heap file of " << fileSizes[i] << " records\n";
+		status = BenchFile(report, fileSizes[i]);
+	}
+
+	int threadCounts[] = { 1, 2, 4, 8, 16 };
+	for (int i = 0; i < 5 && status == OK && workloads == NULL; i++)
+	{
+		cerr << "Heap file inserts from " << threadCounts[i] << " threads\n";
+		status = BenchInsertThreads(report, threadCounts[i], fileSizes[numOfSizes - 1]);
+	}
+
+	for (int i = 0; i < numOfBenchReplacers && status == OK && workloads == NULL; i++)
+	{
+		cerr << "Buffer pool pins, " << benchReplacers[i] << " replacer\n";
+		status = BenchPin(report, benchReplacers[i], numOfPins);
+	}
+
+	int depths[] = { 1, 4, 16, 64 };
+	for (int i = 0; i < 4 && status == OK && workloads == NULL; i++)
+	{
+		cerr << "Asynchronous reads, " << depths[i] << " under way at once\n";
+		status = BenchAsyncGet(report, fileSizes[numOfSizes - 1], depths[i]);
+	}
+
+	if (status == OK && workloads == NULL)
+	{
+		cerr << "Sealed and heap pages\n";
+		status = BenchSeal(report, quick ? 64 : 1024, numOfPins);
+	}
+
+	if (status == OK && workloads == NULL)
+	{
+		cerr << "Page reads with and without checksums\n";
+		status = BenchRead(report, numOfPins);
+	}
+
+	RemoveBenchDB();
+
+	if (metrics)
+	{
+		MetricsSnapshot snapshot;
+		minibase_metrics.Snapshot(snapshot);
+		snapshot.WriteText(cerr);
+	}
+
+	if (status != OK)
+	{
+		cerr << "Error running the benchmarks\n";
+		minibase_errors.show_errors();
+		return 1;
+	}
+
+	if (outName == NULL)
+	{
+		report.Write(cout, format);
+		return 0;
+	}
+
+	ofstream out(outName);
+	report.Write(out, format);
+	if (!out)
+	{
+		cerr << "Error writing " << outName << endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,357 @@
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+#include "ycsb.h"
+#include "bufmgr.h"
+#include "logmgr.h"
+#include "heapfile.h"
+#include "scan.h"
+
+// A YCSB record: the key, and the fields that reads and updates touch.
+struct YcsbRec
+{
+	long key;
+	char fields[92];
+};
+
+static const int ycsbRecLen = sizeof(YcsbRec);
+
+// Longest scan of workload E.
+static const int maxScanLength = 100;
+
+
+//------------------------------------------------------------------
+// Scramble
+//
+// Input    : key - a key chosen by rank,
+//            numOfKeys - number of keys.
+// Output   : None.
+// Purpose  : Spreads the popular keys of a zipfian choice over the
+//            whole key space, as YCSB does, with an FNV-1a hash.
+// Return   : The key to use.
+//------------------------------------------------------------------
+
+static long Scramble(long key, long numOfKeys)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for (int i = 0; i < 8; i++)
+	{
+		hash ^= (key >> (8 * i)) & 0xff;
+		hash *= 1099511628211ULL;
+	}
+	return (long)(hash % numOfKeys);
+}
+
+
+//------------------------------------------------------------------
+// Constructor of YcsbDriver
+//
+// Input    : report - receives the measurements,
+//            replacer - replacement policy of the buffer pool,
+//            numOfRecords - records loaded before each workload,
+//            numOfOps - operations run by each workload,
+//            numOfFrames - size of the buffer pool.
+// Output   : None.
+// Purpose  : Sets up the driver; nothing runs until RunWorkloads.
+//------------------------------------------------------------------
+
+YcsbDriver::YcsbDriver(BenchReport& report, const char* replacer,
+                       long numOfRecords, long numOfOps, unsigned numOfFrames)
+	: report(report), replacer(replacer), numOfRecords(numOfRecords),
+	  numOfOps(numOfOps), numOfFrames(numOfFrames), random(42),
+	  theta(0.99), zetan(0), zetaKeys(0)
+{
+	zeta2 = 1 + 1 / pow(2, theta);
+}
+
+
+//------------------------------------------------------------------
+// YcsbDriver::RunWorkloads
+//
+// Input    : workloads - letters of the workloads to run, in order.
+// Output   : None.
+// Purpose  : Runs each workload named.  Unknown letters are skipped.
+// Return   : OK if every workload ran, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status YcsbDriver::RunWorkloads(const char* workloads)
+{
+	Status status = OK;
+
+	for (const char* w = workloads; *w != '\0' && status == OK; w++)
+	{
+		Distribution keys = islower(*w) ? UNIFORM : ZIPFIAN;
+		Mix mix = { 0, 0, 0, 0, 0, keys };
+
+		switch (toupper(*w))
+		{
+		case 'A' :
+			mix.read = 0.5;
+			mix.update = 0.5;
+			break;
+		case 'B' :
+			mix.read = 0.95;
+			mix.update = 0.05;
+			break;
+		case 'C' :
+			mix.read = 1;
+			break;
+		case 'D' :
+			mix.read = 0.95;
+			mix.insert = 0.05;
+			if (keys == ZIPFIAN)
+				mix.distribution = LATEST;
+			break;
+		case 'E' :
+			mix.scan = 0.95;
+			mix.insert = 0.05;
+			break;
+		case 'F' :
+			mix.read = 0.5;
+			mix.readModifyWrite = 0.5;
+			break;
+		default :
+			continue;
+		}
+
+		cerr << "YCSB workload " << *w << ", " << replacer << " replacer\n";
+		status = Run(*w, mix);
+	}
+
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// YcsbDriver::Load
+//
+// Input    : file - an empty heap file.
+// Output   : None.
+// Purpose  : Inserts keys 0 to numOfRecords - 1, in order, and
+//            commits them.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status YcsbDriver::Load(HeapFile& file)
+{
+	YcsbRec rec;
+	memset(&rec, 'f', sizeof(rec));
+
+	rids.resize(numOfRecords);
+	for (long key = 0; key < numOfRecords; key++)
+	{
+		rec.key = key;
+		Status status = file.InsertRecord((char *)&rec, ycsbRecLen, rids[key]);
+		if (status != OK)
+			return status;
+	}
+
+	return MINIBASE_LOG->Commit();
+}
+
+
+//------------------------------------------------------------------
+// YcsbDriver::NextKey
+//
+// Input    : distribution - how to choose the key.
+// Output   : None.
+// Purpose  : Chooses the key of the next operation among the keys
+//            loaded or inserted so far.  LATEST favours the newest
+//            keys, ZIPFIAN a few keys scattered over the key space.
+// Return   : The key.
+//------------------------------------------------------------------
+
+long YcsbDriver::NextKey(Distribution distribution)
+{
+	long n = (long)rids.size();
+	std::uniform_real_distribution<double> uniform(0, 1);
+
+	if (distribution == UNIFORM)
+		return std::uniform_int_distribution<long>(0, n - 1)(random);
+
+	while (zetaKeys < n)
+	{
+		zetaKeys++;
+		zetan += 1 / pow((double)zetaKeys, theta);
+	}
+
+	double alpha = 1 / (1 - theta);
+	double eta = (1 - pow(2.0 / n, 1 - theta)) / (1 - zeta2 / zetan);
+	double u = uniform(random);
+	double uz = u * zetan;
+
+	long rank;
+	if (uz < 1)
+		rank = 0;
+	else if (uz < 1 + pow(0.5, theta))
+		rank = 1;
+	else
+		rank = (long)(n * pow(eta * u - eta + 1, alpha));
+	if (rank >= n)
+		rank = n - 1;
+
+	if (distribution == LATEST)
+		return n - 1 - rank;
+	return Scramble(rank, n);
+}
+
+
+//------------------------------------------------------------------
+// YcsbDriver::Run
+//
+// Input    : name - letter of the workload,
+//            mix - its operations.
+// Output   : None.
+// Purpose  : Loads a new database and runs the operations of the
+//            workload on it, timing each one.  Reads check that they
+//            found the record of the key they asked for.  Updates and
+//            inserts are committed once, at the end of the run.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status YcsbDriver::Run(char name, const Mix& mix)
+{
+	long maxRecords = numOfRecords + (long)(mix.insert * numOfOps) + 1;
+	unsigned dbPages = maxRecords / 4 + 1000;
+
+	ostringstream params;
+	params << "records=" << numOfRecords << " ops=" << numOfOps
+	       << " keys=" << (mix.distribution == UNIFORM ? "uniform" :
+	                       mix.distribution == LATEST ? "latest" : "zipfian")
+	       << " replacer=" << replacer << " frames=" << numOfFrames;
+
+	string prefix = string("ycsb.") + (char)toupper(name) + ".";
+	Bench read(prefix + "read", params.str());
+	Bench update(prefix + "update", params.str());
+	Bench insert(prefix + "insert", params.str());
+	Bench scan(prefix + "scan", params.str());
+	Bench readModifyWrite(prefix + "rmw", params.str());
+	Bench all(prefix + "all", params.str());
+
+	Status status = CreateBenchDB(dbPages, numOfFrames, replacer);
+	if (status != OK)
+		return status;
+
+	long pinsBefore, missesBefore, pins, misses;
+
+	{
+		HeapFile file("ycsb", status);
+		if (status == OK)
+			status = Load(file);
+		if (status != OK)
+			return status;
+
+		std::uniform_real_distribution<double> uniform(0, 1);
+		std::uniform_int_distribution<int> scanLength(1, maxScanLength);
+		YcsbRec rec;
+		int len;
+
+		MINIBASE_BM->GetStat(pinsBefore, missesBefore);
+		read.Start();
+		update.Start();
+		insert.Start();
+		scan.Start();
+		readModifyWrite.Start();
+		all.Start();
+
+		for (long op = 0; op < numOfOps && status == OK; op++)
+		{
+			double which = uniform(random);
+
+			all.Begin();
+			if ((which -= mix.read) < 0)
+			{
+				long key = NextKey(mix.distribution);
+				read.Begin();
+				status = file.GetRecord(rids[key], (char *)&rec, len);
+				read.End();
+				if (status == OK && rec.key != key)
+				{
+					cerr << "Key " << key << " read record of key " << rec.key << endl;
+					status = FAIL;
+				}
+			}
+			else if ((which -= mix.update) < 0)
+			{
+				long key = NextKey(mix.distribution);
+				memset(&rec, 'u', sizeof(rec));
+				rec.key = key;
+				update.Begin();
+				status = file.UpdateRecord(rids[key], (char *)&rec, ycsbRecLen);
+				update.End();
+			}
+			else if ((which -= mix.insert) < 0)
+			{
+				RecordID rid;
+				memset(&rec, 'i', sizeof(rec));
+				rec.key = (long)rids.size();
+				insert.Begin();
+				status = file.InsertRecord((char *)&rec, ycsbRecLen, rid);
+				insert.End();
+				rids.push_back(rid);
+			}
+			else if ((which -= mix.scan) < 0)
+			{
+				long key = NextKey(mix.distribution);
+				int length = scanLength(random);
+				RecordID rid;
+				scan.Begin();
+				Scan *s = file.OpenScan(status);
+				if (status == OK)
+					status = s->MoveTo(rids[key]);
+				for (int i = 0; i < length && status == OK; i++)
+					status = s->GetNext(rid, (char *)&rec, len);
+				delete s;
+				scan.End();
+				if (status == DONE)
+					status = OK;
+			}
+			else
+			{
+				long key = NextKey(mix.distribution);
+				readModifyWrite.Begin();
+				status = file.GetRecord(rids[key], (char *)&rec, len);
+				if (status == OK)
+				{
+					rec.fields[op % sizeof(rec.fields)]++;
+					status = file.UpdateRecord(rids[key], (char *)&rec, ycsbRecLen);
+				}
+				readModifyWrite.End();
+			}
+			all.End();
+		}
+
+		all.Stop();
+		read.Stop();
+		update.Stop();
+		insert.Stop();
+		scan.Stop();
+		readModifyWrite.Stop();
+		MINIBASE_BM->GetStat(pins, misses);
+
+		if (status == OK)
+			status = MINIBASE_LOG->Commit();
+	}
+
+	if (status == OK)
+		status = CloseBenchDB();
+	rids.clear();
+	zetan = 0;
+	zetaKeys = 0;
+	if (status != OK)
+		return status;
+
+	pins -= pinsBefore;
+	misses -= missesBefore;
+	params << " hit_rate=" << (pins ? (double)(pins - misses) / pins : 0);
+	all.SetParams(params.str());
+
+	Bench* benches[] = { &read, &update, &insert, &scan, &readModifyWrite, &all };
+	for (int i = 0; i < 6; i++)
+		if (benches[i]->GetNumOfOps() > 0)
+			report.Add(*benches[i]);
+
+	return OK;
+}
@@ -0,0 +1,85 @@
+#ifndef _YCSB_H
+#define _YCSB_H
+
+#include <vector>
+#include <random>
+
+#include "minirel.h"
+#include "bench.h"
+
+class HeapFile;
+
+//
+// Runs the YCSB core workloads against a heap file.  Each workload loads
+// numOfRecords records into a new database, then runs numOfOps operations
+// of its mix, one at a time, and reports to the BenchReport:
+//
+//   ycsb.<W>.<op>  for each kind of operation in the mix, and
+//   ycsb.<W>.all   for all of them, with the buffer pool hit rate of the
+//                  run among its parameters.
+//
+// Keys are dense integers.  The driver keeps the RecordID of every key in
+// memory; a scan starts at the record of its first key and goes on in file
+// order, which is key order since records are inserted in key order.
+//
+//   A  50% read, 50% update                    zipfian
+//   B  95% read,  5% update                    zipfian
+//   C  100% read                               zipfian
+//   D  95% read,  5% insert                    latest
+//   E  95% scan,  5% insert                    zipfian, 1 to 100 records
+//   F  50% read, 50% read-modify-write         zipfian
+//
+// Like TestDriver, workloads are picked by a string of their letters.
+//
+class YcsbDriver
+{
+public:
+
+	enum Distribution { UNIFORM, ZIPFIAN, LATEST };
+
+	YcsbDriver(BenchReport& report, const char* replacer, long numOfRecords,
+	           long numOfOps, unsigned numOfFrames);
+
+	// Runs the workloads named in workloads, e.g. "ABCDEF".  A lower
+	// case letter runs the workload with uniform key choice instead.
+	Status RunWorkloads(const char* workloads);
+
+protected:
+
+	// Fractions of each kind of operation; they add up to 1.
+	struct Mix
+	{
+		double read;
+		double update;
+		double insert;
+		double scan;
+		double readModifyWrite;
+		Distribution distribution;
+	};
+
+	Status Run(char name, const Mix& mix);
+
+private:
+
+	Status Load(HeapFile& file);
+	long NextKey(Distribution distribution);
+
+	BenchReport& report;
+	const char* replacer;
+	long numOfRecords;
+	long numOfOps;
+	unsigned numOfFrames;
+
+	std::vector<RecordID> rids;   // RecordID of each key.
+	std::mt19937_64 random;
+
+	// Zipfian key choice, after Gray et al., "Quickly Generating
+	// Billion-Record Synthetic Databases".  zetan grows with the number
+	// of keys as records are inserted.
+	double theta;
+	double zeta2;
+	double zetan;
+	long   zetaKeys;             // number of keys zetan is summed over.
+};
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef _AGGREGATE_H
+#define _AGGREGATE_H
+
+#include <functional>
+#include <vector>
+
+#include "minirel.h"
+#include "page.h"
+#include "spill.h"
+
+class HeapFile;
+
+// Percentage of the slots of a group table that may be taken before the
+// records of new groups are spilled.
+#define AGG_TABLE_FILL 75
+
+enum AggFunction { aggCount, aggSum, aggMin, aggMax, aggAvg };
+
+//
+// One aggregate: func of the numeric attribute of length bytes at offset
+// in each record, read as type: an int, or a float or a double as for
+// Index.  aggCount counts records and ignores the attribute.
+//
+struct AggSpec
+{
+	AggFunction func;
+	int         offset;
+	AttrType    type;
+	int         length;
+};
+
+//
+// Called once per group with its key, NULL if there is no grouping, and
+// the value of each aggregate in order.  MIN, MAX and AVG of no records
+// are NaN.  Any status but OK stops the aggregation, which returns it.
+//
+typedef std::function<Status (const char* key, const double* values)> AggCallback;
+
+//
+// Computes aggregates over the records of a heap file, for every group of
+// records with equal keys (GROUP BY) or for the file as a whole.  The key
+// is described as for Index.
+//
+// The work is done in batches: a page of records at a time from
+// Scan::GetNextBatch, the keys hashed in one loop, their groups found in
+// another, and each aggregate gathered into an array and folded in loops
+// of its own.  Groups are kept in an open-addressing table, linear probing
+// on slots holding the hash, key and accumulators side by side, in frames
+// taken from the buffer pool for as long as the aggregation runs.  Once
+// the table is AGG_TABLE_FILL percent full, records of groups not in it
+// are spilled (see SpillRun) to partitions by hash, each aggregated the
+// same way after the groups of the table are given out.
+//
+class Aggregate
+{
+public:
+
+	// Groups by the groupLength bytes at groupOffset, read as groupType,
+	// or not at all if groupLength is 0.  numOfFrames is the memory of the
+	// aggregation, at least 3 frames.
+	Aggregate(int groupOffset, AttrType groupType, int groupLength,
+	          const std::vector<AggSpec>& aggs, int numOfFrames);
+
+	// Aggregates in, giving each group to emit, or appending it to result
+	// as its key followed by a double for each aggregate.  Without
+	// grouping there is always one group, even if in is empty.
+	Status Run(HeapFile& in, const AggCallback& emit);
+	Status Run(HeapFile& in, HeapFile& result);
+
+	// Of the last Run: groups given out, records spilled over every level
+	// and the deepest level of spilling.
+	int GetNumOfGroups()  { return numOfGroups; }
+	int GetNumOfSpilled() { return numOfSpilled; }
+	int GetDepth()        { return depth; }
+
+private:
+
+	struct AggAcc
+	{
+		double    value;
+		long long count;
+	};
+
+	// Arrays of the batch being aggregated, reused from batch to batch.
+	struct Batch
+	{
+		std::vector<char*>    recPtrs;
+		std::vector<int>      recLens;
+		std::vector<unsigned> hashes;
+		std::vector<int>      slots;
+		std::vector<double>   values;
+	};
+
+	int      groupOffset;
+	AttrType groupType;
+	int      groupLength;
+	std::vector<AggSpec> aggs;
+	int      numOfFrames;
+
+	int numOfGroups;
+	int numOfSpilled;
+	int depth;
+
+	// The table: slotLen bytes a slot, slotsPerFrame slots in each of the
+	// first numOfTableFrames frames.  The next numOfParts frames write the
+	// partitions, and the last reads one back.
+	int recLen;             // bytes a record needs to hold every attribute.
+	int keyPad;
+	int slotLen;
+	int slotsPerFrame;
+	int numOfTableFrames;
+	int numOfSlots;
+	int maxGroups;
+	int numOfParts;
+	int groups;
+
+	std::vector<Page*> frames;
+	SpillSpace         space;
+
+	Status Pass(HeapFile* file, SpillRun* run, int level, const AggCallback& emit);
+	Status Consume(Batch& batch, int level, std::vector<SpillWriter>& writers,
+	               std::vector<SpillRun>& parts);
+	int    FindSlot(unsigned hash, const char* key);
+	char  *Slot(int slot);
+	AggAcc *Acc(int slot, int agg);
+	Status EmitGroups(const AggCallback& emit);
+};
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef _BTREE_H
+#define _BTREE_H
+
+#include <vector>
+
+#include "index.h"
+#include "page.h"
+
+class HeapPage;
+
+// Percentage of a page a bulk load fills, leaving room for later inserts.
+#define BTREE_BULK_FILL 90
+
+//
+// A node of a B+-tree.  Leaf entries are a key and a record ID, kept in
+// order of key and then record ID, so that every entry is unique even when
+// keys are not.  Index entries are such a key and record ID followed by the
+// child holding the entries from there up to the next index entry; the
+// entries below the first index entry are in the leftmost child.
+//
+class BTreePage
+{
+private :
+
+	short  type;            // BTREE_LEAF or BTREE_INDEX.
+	short  numOfEntries;
+	PageID prev;            // neighbours of a leaf in key order.
+	PageID next;
+	PageID leftmost;        // leftmost child of an index node.
+
+	#define BTREE_PAGE_SIZE (MAX_SPACE - 2*sizeof(short) - 3*sizeof(PageID))
+
+	char data[BTREE_PAGE_SIZE];
+
+public :
+
+	enum { BTREE_LEAF = 1, BTREE_INDEX = 2 };
+
+	void   Init(short pageType);
+	bool   IsLeaf()          { return type == BTREE_LEAF; }
+	int    GetNumOfEntries() { return numOfEntries; }
+	bool   IsFull(int entryLen) { return (numOfEntries + 1) * entryLen > (int)BTREE_PAGE_SIZE; }
+	char  *GetEntry(int entry, int entryLen) { return data + entry * entryLen; }
+	PageID GetChild(int entry, int entryLen);
+	void   InsertEntry(int entry, const char* entryPtr, int entryLen);
+	void   RemoveEntry(int entry, int entryLen);
+	void   SetEntries(const char* entries, int n, int entryLen);
+
+	PageID GetPrevPage()     { return prev; }
+	PageID GetNextPage()     { return next; }
+	PageID GetLeftmost()     { return leftmost; }
+	void   SetPrevPage(PageID pid) { prev = pid; }
+	void   SetNextPage(PageID pid) { next = pid; }
+	void   SetLeftmost(PageID pid) { leftmost = pid; }
+};
+
+class BTreeScan;
+
+//
+// A disk-resident B+-tree index, kept in the database as a file of its own
+// whose first page records the key and the root.  Inserts split full nodes
+// on the way back up; deletes leave underfull and even empty leaves in
+// place, which scans step over.
+//
+// A tree can be loaded in bulk from entries in ascending order, filling
+// pages BTREE_BULK_FILL percent, which is how Build indexes a heap file.
+//
+class BTreeIndex : public Index
+{
+	friend class BTreeScan;
+
+public:
+
+	// Opens the index of the given name, or creates it empty if the
+	// database has no such file.  An existing index must have been created
+	// with the same key.
+	BTreeIndex(const char* name, int keyOffset, AttrType keyType, int keyLength,
+	           Status& status);
+	~BTreeIndex();
+
+	Status Insert(const char* key, const RecordID& rid);
+	Status Delete(const char* key, const RecordID& rid);
+	Status Lookup(const char* key, std::vector<RecordID>& rids);
+
+	// Sorts the entries of the records of the file and loads them in bulk
+	// if the tree is empty; inserts them one at a time otherwise.
+	Status Build(HeapFile& file);
+
+	// Loads an empty tree from entries given in ascending order of key and
+	// record ID, between BeginBulkLoad and EndBulkLoad.
+	Status BeginBulkLoad();
+	Status BulkAppend(const char* key, const RecordID& rid);
+	Status EndBulkLoad();
+
+	// Opens a scan of the entries whose key k satisfies k op key, or
+	// key <= k <= key2 for opRANGE, in order of key.  aopNE is not
+	// supported.
+	BTreeScan* OpenScan(AttrOperator op, const char* key, const char* key2,
+	                    Status& status);
+
+	int GetNumOfEntries() { return numOfEntries; }
+	int GetHeight()       { return height; }
+
+	// Frees every page of the index and removes it from the database.
+	Status DeleteFile();
+
+private:
+
+	string filename;
+	PageID headerPid;
+	PageID rootPid;
+	int    height;          // levels of nodes; a lone leaf is 1.
+	int    numOfEntries;
+	int    keyPad;          // bytes of the key in an entry.
+	int    leafLen;         // bytes of a leaf entry: key and record ID.
+	int    indexLen;        // bytes of an index entry: and a child.
+
+	// Bulk load state: the leaf being filled, the last entry appended,
+	// and an index entry for each leaf after the first.
+	bool              bulkLoading;
+	PageID            bulkLeaf;
+	std::vector<char> bulkLast;
+	std::vector<char> bulkSeps;
+
+	Status Create(const char* name);
+	Status Open();
+	Status Clear();
+	void   MakeEntry(char* entry, const char* key, const RecordID& rid);
+	int    Compare(const char* entry, const char* key, const RecordID* rid) const;
+	int    LeafPosition(BTreePage* page, const char* key, const RecordID* rid);
+	PageID ChildOf(BTreePage* page, const char* key, const RecordID* rid);
+	Status FindLeaf(const char* key, const RecordID* rid, PageID& leaf);
+	Status InsertInto(PageID pid, const char* entry, char* upEntry, bool& split);
+	Status SplitLeaf(PageID pid, BTreePage* page, int pos, const char* entry,
+	                 char* upEntry);
+	Status SplitIndex(PageID pid, BTreePage* page, int pos, const char* entry,
+	                  char* upEntry);
+	Status FreeSubtree(PageID pid);
+	Status WriteHeader();
+};
+
+//
+// A scan of the entries of a B+-tree in a range of keys.  It keeps the leaf
+// it is on pinned.
+//
+class BTreeScan
+{
+	friend class BTreeIndex;
+
+public:
+
+	~BTreeScan();
+
+	// Gives the record ID of the next entry, and its key if key is not
+	// NULL.  DONE after the last entry in the range.
+	Status GetNext(RecordID& rid, char* key = NULL);
+
+private:
+
+	BTreeScan(BTreeIndex* tree);
+	Status Start(AttrOperator op, const char* key, const char* key2);
+
+	BTreeIndex *tree;
+	PageID     currPid;
+	BTreePage  *page;
+	int        currEntry;
+
+	std::vector<char> low;         // empty if there is no lower bound.
+	std::vector<char> high;        // empty if there is no upper bound.
+	bool       lowInclusive;
+	bool       highInclusive;
+};
+
+//
+// Fetches from their heap file the records of the entries a B+-tree scan
+// finds, sorted by record ID first, so that each data page is pinned once
+// however the keys are spread over the file.  Records come in page order,
+// not key order.
+//
+class IndexScan
+{
+public:
+
+	// Reads every entry of scan, then deletes it.
+	IndexScan(BTreeScan* scan, Status& status);
+	~IndexScan();
+
+	Status GetNext(RecordID& rid, char* recPtr, int& recLen);
+
+private:
+
+	std::vector<RecordID> rids;
+	size_t   currRid;
+	PageID   currPid;             // data page pinned, INVALID_PAGE if none.
+	HeapPage *page;
+};
+
+#endif
@@ -1,52 +1,229 @@
-
-#ifndef _BUF_H
-#define _BUF_H
-
-#include "db.h"
-#include "page.h"
-#include "frame.h"
-#include "replacer.h"
-#include "hash.h"
-
-class BufMgr 
-{
-	private:
-
-		/*
-		 * hashTable to give hash access to frames
-		 */
-		HashTable *hashTable;
-		Frame **frames; 			// pool of frames
-		
-		/*
-		 * Component responsible of implementing the buffer replacement policy 
-		 */
-		Replacer *replacer;
-		unsigned int numOfFrames;			// number of frames
-
-		int FindFrame( PageID pid );
-		long totalCall;				// number of times upper layers try to pin a page
-		long totalHit;		     	// number of times upper layers try to pin a page and the page is already in the buffer
-		long numDirtyPageWrites;	// number of times a page has been modified and written back to disk
-
-	public:
-
-		BufMgr( int bufsize );
-		~BufMgr();      
-		Status PinPage( PageID pid, Page*& page, bool emptyPage = false );
-		Status UnpinPage( PageID pid, bool dirty = false );
-		Status NewPage( PageID& pid, Page*& firstpage, int howmany = 1 ); 
-		Status FreePage( PageID pid ); 
-		Status FlushPage( PageID pid );
-		Status FlushAllPages();
-		Status GetStat(long& pinNo, long& missNo) { pinNo = totalCall; missNo = totalCall-totalHit; return OK; }
-
-		unsigned int GetNumOfFrames();
-		unsigned int GetNumOfUnpinnedFrames();
-
-		void PrintStat();
-		void ResetStat() { totalHit = 0; totalCall = 0; numDirtyPageWrites = 0; }
-};
-
-
-#endif // _BUF_H
+
+#ifndef _BUF_H
+#define _BUF_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "db.h"
+#include "page.h"
+#include "frame.h"
+#include "replacer.h"
+#include "hash.h"
+
+//
+// A dirty page and the LSN of the first change made to it since it was last
+// written; the checkpoint records these.
+//
+struct DirtyPageEntry
+{
+	PageID pid;
+	LSN    recLSN;
+};
+
+//
+// Pins of one page since the statistics were last reset, and how many of
+// them found the page already in the pool.
+//
+struct PageAccess
+{
+	PageID pid;
+	long   pins;
+	long   hits;
+};
+
+//
+// How a heap file uses the buffer pool: its data and directory pages, the
+// frames they hold now, their pins and hits, and the pages pinned most.
+//
+struct FileResidency
+{
+	int  numOfPages;
+	int  numOfFrames;
+	long pins;
+	long hits;
+	std::vector<PageAccess> hottest;    // most pinned first
+};
+
+//
+// A page in the list of those in the pool, which FlushAllPages keeps for
+// Prewarm; referenced is the frame's reference bit.
+//
+struct PageListEntry
+{
+	PageID pid;
+	int    referenced;
+};
+
+// Pages Prewarm reads in one vectored read at most.
+#define PREWARM_RUN 64
+
+//
+// One of the buffer pools: a share of the frames, with a hash table and a
+// replacer of its own, so that the pages bound to it (see BufMgr::BindPages)
+// only ever evict one another.
+//
+struct BufferPool
+{
+	std::string  name;
+	std::string  policy;        // of its replacer
+	unsigned int numOfFrames;
+	Frame        **frames;      // its frames, as its replacer sees them
+	int          *frameNos;     // the manager's numbers for the same frames
+	HashTable    *hashTable;    // maps its pages to the manager's frame numbers
+	Replacer     *replacer;
+	long         totalCall;
+	long         totalHit;
+};
+
+// The pool pages are bound to unless bound elsewhere, made of the frames
+// the manager is created with.
+#define DEFAULT_POOL 0
+
+//
+// The frames may be split into several named pools, each with its own size
+// and replacement policy, and each may be resized while in use.  A page is
+// bound to one pool, the default one unless BindPages says otherwise, and
+// pinning it looks for it and finds it a frame in that pool only; a heap
+// file opened on a pool binds its pages there.
+//
+// The pool may be used from several threads at once: a mutex guards the
+// frames, the hash table and the replacer.  It is not held while a page
+// is in use, nor while a page is read in; a caller that shares a pinned
+// page with other threads takes the page's latch (see GetPageLatch) to
+// read or change it.
+//
+class BufMgr 
+{
+	private:
+
+		std::recursive_mutex mutex;	// held by the calls below, reentrantly
+		std::mutex resizeMutex;		// held through a Resize, one at a time
+
+		Frame **frames; 			// frames of every pool, by frame number; NULL
+									// where a pool has given a frame up
+		unsigned int numOfSlots;			// length of frames
+		unsigned int numOfFrames;			// number of frames
+		std::vector<int> freeSlots;	// frame numbers given up, for new frames
+
+		std::vector<BufferPool*> pools;	// by pool number, DEFAULT_POOL first
+		std::vector<int> pagePools;	// pool of each page, indexed by PageID
+
+		int PoolOf( PageID pid );
+		Status Pin( PageID pid, Page*& page, bool isEmpty, bool count, bool& hit );
+		int FindFrame( PageID pid );
+		int PickVictim( BufferPool* pool );
+		Status EvictFrame( BufferPool* pool, std::unique_lock<std::recursive_mutex>& lock,
+		                   int& frameNo );
+		Status DropPage( int frameNo );
+		Status WriteBackFrame( int frameNo, std::unique_lock<std::recursive_mutex>& lock );
+		Status SetFrames( BufferPool* pool, std::vector<int>& frameNos );
+		Status AddFrames( BufferPool* pool, int n );
+		Status RemoveFrames( BufferPool* pool, int n );
+		int FreeFrame( BufferPool* pool );
+		void LoadPages( DB* db, std::vector<PageListEntry>& list );
+		long totalCall;				// number of times upper layers try to pin a page
+		long totalHit;		     	// number of times upper layers try to pin a page and the page is already in the buffer
+		long numDirtyPageWrites;	// number of times a page has been modified and written back to disk
+
+		std::vector<long> pagePins;	// pins of each page, indexed by PageID
+		std::vector<long> pageHits;	// those of them that were hits
+		std::string pageListFile;	// where the page list is kept, if anywhere
+
+		void AddPage( PageID pid, FileResidency& residency, bool resident );
+		void DropFailedRead( int frameNo );
+
+	public:
+
+		BufMgr( int bufsize, const char* policy = "Clock" );
+		~BufMgr();      
+		Status PinPage( PageID pid, Page*& page, bool emptyPage = false );
+		Status UnpinPage( PageID pid, bool dirty = false );
+		Status NewPage( PageID& pid, Page*& firstpage, int howmany = 1 ); 
+		Status FreePage( PageID pid ); 
+		Status FlushPage( PageID pid );
+		Status FlushAllPages();
+		Status SetPageLSN( PageID pid, LSN lsn );
+
+		// Puts the page, if it is in the pool, in the dirty page table
+		// from lsn on, ahead of a change logged at lsn or later.
+		void SetRecLSN( PageID pid, LSN lsn );
+
+		// True if the page is in the pool, so that pinning it would not
+		// wait for a read.
+		bool IsResident( PageID pid );
+
+		// Brings the page into the pool without waiting for the read: the
+		// read goes to MINIBASE_IO, and done is called with its outcome on
+		// one of MINIBASE_IO's threads, or at once if the page is in.  The
+		// page is not left pinned.
+		void FetchPage( PageID pid, const std::function<void (Status)>& done );
+
+		// The latch of the frame holding a pinned page; NULL if the page
+		// is not in the pool.  It stays the page's while the page is pinned.
+		Latch *GetPageLatch( PageID pid );
+
+		// Takes n frames out of the pool as memory for an operator such as
+		// a sort: they hold no page and stay pinned until given back.
+		Status GetWorkFrames( int n, std::vector<Page*>& pages );
+		void ReleaseWorkFrames( std::vector<Page*>& pages );
+		void GetDirtyPages( std::vector<DirtyPageEntry>& table );
+
+		// Writes back the unpinned pages first changed before lsn, keeping
+		// them in the pool, so that the log before lsn is no longer needed
+		// to redo them (see LogMgr::Checkpoint).
+		Status WriteOldPages( LSN lsn );
+		Status GetStat(long& pinNo, long& missNo) { pinNo = totalCall; missNo = totalCall-totalHit; return OK; }
+
+		// Adds a pool of numOfFrames new frames, replaced by the named
+		// policy.  FAIL if the name is taken or the policy unknown.
+		Status AddPool( const char* name, int numOfFrames, const char* policy );
+
+		// The number of the named pool, -1 if there is none.
+		int GetPoolNo( const char* name );
+
+		// Binds n pages from first on to a pool.  Those held by another
+		// pool are written back if dirty and dropped from it; FAIL, with
+		// none of the pages moved, if one of them is pinned there.
+		Status BindPages( PageID first, int n, int poolNo );
+
+		// Gives the named pool numOfFrames frames, adding new ones or
+		// evicting pages to give some up.  Pins go on meanwhile.  FAIL,
+		// with the pool as it was, if too many of its frames are pinned.
+		Status Resize( int numOfFrames, const char* poolName = "default" );
+
+		// Names the file the list of pages in the pool is kept in: every
+		// FlushAllPages, and SavePageList, writes it, and Prewarm reads
+		// it back to bring the same pages in after a restart.
+		void SetPageListFile( const char* fileName );
+		Status SavePageList();
+
+		// Reads the page list, then brings its pages into the frames free
+		// for them, on MINIBASE_IO so that the caller need not wait.
+		Status Prewarm();
+
+		// Pins and misses of the named pool; FAIL if there is none.
+		Status GetStat( const char* poolName, long& pinNo, long& missNo );
+
+		// Dirty pages written back to disk since ResetStat.
+		long GetNumOfDirtyPageWrites();
+
+		// Frames of every pool, and of the named one (0 if none).
+		unsigned int GetNumOfFrames();
+		unsigned int GetNumOfFrames( const char* poolName );
+		unsigned int GetNumOfUnpinnedFrames();
+
+		// Reports how the heap file of the given name uses the pool, listing
+		// its numOfHottest most pinned pages.  FAIL if there is no such file.
+		Status GetFileResidency( const char* fileName, FileResidency& residency,
+		                         int numOfHottest = 10 );
+
+		void PrintStat();
+		void PrintFileStat( const char* fileName );
+		void ResetStat();
+};
+
+
+#endif // _BUF_H
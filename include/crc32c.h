@@ -0,0 +1,11 @@
+#ifndef _CRC32C_H
+#define _CRC32C_H
+
+//
+// CRC-32C (Castagnoli) of a block of memory.  Uses the SSE4.2 crc32
+// instruction when the processor has it and a lookup table otherwise; both
+// paths give the same result.
+//
+unsigned int Crc32c(const void* buf, int len);
+
+#endif
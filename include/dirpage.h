@@ -1,80 +1,94 @@
-#ifndef _DIRPAGE_H
-#define _DIRPAGE_H
-
-#include "heappage.h"
-
-struct PageInfo 
-{
-	PageID pid;
-	short  spaceAvailable;
-	short  numOfRecords;
-};
-
-
-class DirPage 
-{
-	friend class DirPageIterator;
-	friend class PageInfoIterator;
-
-private : 
-	unsigned int numOfEntry;
-	unsigned int spaceAvailable;		// not used?
-	PageID curr;
-	PageID next;
-	PageID prev;
-
-	#define DIR_PAGE_SIZE (MAX_SPACE - 2*sizeof(unsigned int) - 3*sizeof(PageID))
-
-	char data[DIR_PAGE_SIZE];
-
-public :
-	Status Init (PageID pid);
-	PageInfo *FindPageInfo (PageID pid);
-	int FindPageInfoEntry (PageID pid);
-	PageInfo *GetPageInfo (unsigned int entry);
-	Status InsertPage (PageID pid, HeapPage *page);
-	Status DeletePage (PageID pid);
-	Status InsertRecordIntoPage (PageID pid, HeapPage *page);
-	Status DeleteRecordFromPage (PageID pid, HeapPage *page);
-	void   SetNextPage (PageID pid) { next = pid; }
-	void   SetPrevPage (PageID pid) { prev = pid; }
-	PageID GetNextPage();
-	bool HasFreeSpace();
-	bool IsEmpty()   { return (numOfEntry == 0); }
-	bool Deletable() { return (prev != INVALID_PAGE) || (next != INVALID_PAGE); }
-	bool IsHead()    { return (prev == INVALID_PAGE); }
-	Status DeleteItSelf();
-};
-
-
-class PageInfoIterator 
-{
-
-private :
-
-	int currEntry;
-	DirPage *page;
-
-public :
-
-	PageInfoIterator(DirPage *page);
-	~PageInfoIterator();
-	PageInfo *operator() ();
-};
-
-
-class DirPageIterator 
-{
-
-private :
-
-	PageID curr;
-
-public :
-
-	DirPageIterator(PageID pid);
-	~DirPageIterator();
-	PageID operator() ();
-};
-
+#ifndef _DIRPAGE_H
+#define _DIRPAGE_H
+
+#include "heappage.h"
+
+struct PageInfo 
+{
+	PageID pid;
+	short  spaceAvailable;
+	short  numOfRecords;
+
+	// Threads changing different data pages change their entries on the
+	// same directory page at once, without latching it (see HeapFile), so
+	// the counts are read and adjusted atomically.  The fields sit in the
+	// page image and cannot be std::atomic, hence the GCC builtins.
+	short GetSpaceAvailable() const { return __atomic_load_n(&spaceAvailable, __ATOMIC_RELAXED); }
+	short GetNumOfRecords() const   { return __atomic_load_n(&numOfRecords, __ATOMIC_RELAXED); }
+
+	void Adjust(int space, int records)
+	{
+		__atomic_fetch_add(&spaceAvailable, (short)space, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&numOfRecords, (short)records, __ATOMIC_RELAXED);
+	}
+};
+
+
+class DirPage 
+{
+	friend class DirPageIterator;
+	friend class PageInfoIterator;
+
+private : 
+	unsigned int numOfEntry;
+	unsigned int spaceAvailable;		// not used?
+	PageID curr;
+	PageID next;
+	PageID prev;
+
+	#define DIR_PAGE_SIZE (MAX_SPACE - 2*sizeof(unsigned int) - 3*sizeof(PageID))
+
+	char data[DIR_PAGE_SIZE];
+
+public :
+	Status Init (PageID pid);
+	PageInfo *FindPageInfo (PageID pid);
+	int FindPageInfoEntry (PageID pid);
+	PageInfo *GetPageInfo (unsigned int entry);
+	Status InsertPage (PageID pid, HeapPage *page);
+	Status DeletePage (PageID pid);
+	Status InsertRecordIntoPage (PageID pid, HeapPage *page);
+	Status DeleteRecordFromPage (PageID pid, HeapPage *page);
+	void   SetNextPage (PageID pid) { next = pid; }
+	void   SetPrevPage (PageID pid) { prev = pid; }
+	PageID GetNextPage();
+	PageID GetPrevPage() { return prev; }
+	bool HasFreeSpace();
+	bool IsEmpty()   { return (numOfEntry == 0); }
+	bool Deletable() { return (prev != INVALID_PAGE) || (next != INVALID_PAGE); }
+	bool IsHead()    { return (prev == INVALID_PAGE); }
+	Status DeleteItSelf();
+};
+
+
+class PageInfoIterator 
+{
+
+private :
+
+	int currEntry;
+	DirPage *page;
+
+public :
+
+	PageInfoIterator(DirPage *page);
+	~PageInfoIterator();
+	PageInfo *operator() ();
+};
+
+
+class DirPageIterator 
+{
+
+private :
+
+	PageID curr;
+
+public :
+
+	DirPageIterator(PageID pid);
+	~DirPageIterator();
+	PageID operator() ();
+};
+
 #endif
\ No newline at end of file
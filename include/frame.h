@@ -1,42 +1,87 @@
-#ifndef FRAME_H
-#define FRAME_H
-
-#include "page.h"
-
-#define INVALID_FRAME -1
-
-class Frame 
-{
-	private :
-	
-		PageID pid;
-		Page   *data;
-		int    pinCount;
-		int    dirty;
-		bool   referenced;
-
-	public :
-		
-		Frame();
-		~Frame();
-		void Pin();
-		void Unpin();
-		void EmptyIt();
-		void DirtyIt();
-		void SetPageID(PageID pid);
-		bool IsDirty();
-		bool IsValid();
-		Status Write();
-		Status Read(PageID pid);
-		Status Free();
-		bool NotPinned();
-		bool HasPageID(PageID pid);
-		PageID GetPageID();
-		Page *GetPage();
-
-		void UnsetReferenced();
-		bool IsReferenced();
-		bool IsVictim();
-};
-
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "page.h"
+#include "latch.h"
+
+#define INVALID_FRAME -1
+
+class Frame 
+{
+	private :
+
+		// A pin, with whether a log record of the thread that holds it
+		// has covered the page since it was taken.
+		struct PinHolder
+		{
+			std::thread::id thread;
+			bool logged;
+		};
+
+		PageID pid;
+		Page   *data;
+		int    pinCount;
+		int    dirty;
+		bool   referenced;
+		LSN    lsn;         // newest log record for a change to the page
+		LSN    recLSN;      // oldest one since the page was last written
+		std::vector<PinHolder> holders;   // one for each pin
+		Latch  latch;       // of the page, taken by those who pin it
+		std::atomic<bool> reading;   // the page is being read in or written out
+		Status readStatus;  // how the last read of the page went
+
+		int FindHolder(bool anyThread);
+
+	public :
+		
+		Frame();
+		~Frame();
+		void Pin();
+		void Unpin();
+		void EmptyIt();
+		void DirtyIt();
+		void SetPageID(PageID pid);
+		bool IsDirty();
+		bool IsValid();
+		Status Write();
+		Status WriteBack();
+		void Cleaned();
+		Status Read(PageID pid);
+
+		// A page is marked as reading until it is in, so that those who
+		// pin it meanwhile can wait for it (see BufMgr::PinPage).
+		void StartRead() { reading.store(true); }
+		bool IsReading() { return reading.load(); }
+
+		// Ends a read of the page made by someone else (see BufMgr::Prewarm).
+		void EndRead(Status status) { readStatus = status; reading.store(false); }
+		Status WaitForRead();
+
+		// Those who pin a page being written out by an eviction wait for
+		// the write as for a read; whatever the write's outcome, the page
+		// in memory is intact (see BufMgr::EvictFrame).
+		void StartWrite() { reading.store(true); }
+		void EndWrite() { EndRead(OK); }
+		Status Free();
+		bool NotPinned();
+		bool HasPageID(PageID pid);
+		PageID GetPageID();
+		Page *GetPage();
+		Latch *GetLatch();
+
+		void UnsetReferenced();
+		bool IsReferenced();
+		bool IsVictim();
+
+		void SetLSN(LSN pageLSN);
+		void SetRecLSN(LSN pageLSN);
+		LSN GetLSN();
+		LSN GetRecLSN();
+		bool IsLogged();
+};
+
 #endif
\ No newline at end of file
@@ -1,79 +1,123 @@
-#ifndef _HASH_H
-#define _HASH_H
-
-#include "minirel.h"
-#include "frame.h"
-
-#define NUM_OF_BUCKETS 21
-#define HASH(k)  k % NUM_OF_BUCKETS
-
-	
-class Map
-{
-	friend class MapIterator;
-
-private :
-
-	int pid;
-	int frameNo;
-	class Map *next;
-	class Map *prev;
-
-public :
-	
-	Map(PageID p, int f);
-	~Map();
-	void AddBehind(Map *m);
-	void DeleteMe();
-	bool HasPageID(PageID p);
-	int FrameNo();
-
-};
-
-
-class MapIterator
-{
-	Map *head;		// not used?
-	Map *current;
-
-public :
-
-	MapIterator(Map *maps);
-	Map* operator() ();
-
-};
-
-
-class Bucket
-{
-private:
-
-	Map *maps;
-
-public :
-
-	Bucket();
-	~Bucket();
-	void Insert(PageID pid, int frameNo);
-	Status Delete(PageID pid);
-	int Find(PageID pid);
-	void EmptyIt();
-};
-
-
-class HashTable
-{
-private:
-
-	Bucket buckets[NUM_OF_BUCKETS];
-
-public :
-
-	void Insert(PageID pid, int frameNo);
-	Status Delete(PageID pid);
-	int LookUp(PageID pid);
-	void EmptyIt();
-};
-
-
+#ifndef _HASH_H
+#define _HASH_H
+
+#include <vector>
+
+#include "minirel.h"
+#include "frame.h"
+
+#define NUM_OF_BUCKETS 21
+#define HASH(k)  k % NUM_OF_BUCKETS
+
+	
+class Map
+{
+	friend class MapIterator;
+	friend class MapPool;
+
+private :
+
+	int pid;
+	int frameNo;
+	class Map *next;
+	class Map *prev;
+
+public :
+	
+	Map(PageID p, int f);
+	~Map();
+	void AddBehind(Map *m);
+	void DeleteMe();
+	bool HasPageID(PageID p);
+	int FrameNo();
+
+};
+
+
+class MapIterator
+{
+	Map *head;		// not used?
+	Map *current;
+
+public :
+
+	MapIterator(Map *maps);
+	Map* operator() ();
+
+};
+
+
+//
+// The maps of a hash table, allocated together when the table is built so
+// that pinning and evicting pages allocate nothing.  Free maps are chained
+// through their next pointers.  Should the pool run dry, maps come from the
+// heap instead, and go back there.  Grow adds another array of maps, for a
+// buffer pool given more frames.
+//
+class MapPool
+{
+private:
+
+	struct Chunk
+	{
+		Map *maps;
+		int numOfMaps;
+	};
+
+	std::vector<Chunk> chunks;	// the arrays of maps
+	int numOfMaps;
+	Map *freeMaps;		// chained through next
+
+public :
+
+	MapPool(int numOfMaps);
+	~MapPool();
+	void Grow(int numOfMaps);
+	int GetNumOfMaps() { return numOfMaps; }
+	Map *Get(PageID pid, int frameNo);
+	void Put(Map *m);
+};
+
+
+class Bucket
+{
+private:
+
+	Map *maps;
+	MapPool *pool;
+
+public :
+
+	Bucket();
+	~Bucket();
+	void SetPool(MapPool *pool);
+	void Insert(PageID pid, int frameNo);
+	Status Delete(PageID pid);
+	int Find(PageID pid);
+	void EmptyIt();
+};
+
+
+class HashTable
+{
+private:
+
+	MapPool pool;
+	Bucket buckets[NUM_OF_BUCKETS];
+
+public :
+
+	// The pool holds numOfMaps maps, one for each frame.
+	HashTable(int numOfMaps);
+
+	// Makes sure the pool holds numOfMaps maps at least.
+	void Reserve(int numOfMaps);
+
+	void Insert(PageID pid, int frameNo);
+	Status Delete(PageID pid);
+	int LookUp(PageID pid);
+	void EmptyIt();
+};
+
+
 #endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+#ifndef _HASHINDEX_H
+#define _HASHINDEX_H
+
+#include <vector>
+
+#include "index.h"
+#include "page.h"
+
+// Number of buckets of a new hash index.
+#define HASH_INDEX_BUCKETS 4
+
+// A bucket is split whenever the entries fill more than this percentage of
+// the primary pages of the buckets.
+#define HASH_INDEX_FILL 75
+
+//
+// A page of a bucket of a hash index: entries of a key followed by a record
+// ID, packed from the start of the data area.  A bucket is its primary page
+// and a chain of overflow pages.
+//
+class HashBucketPage
+{
+private :
+
+	PageID overflow;       // next page of the bucket, INVALID_PAGE if none.
+	short  numOfEntries;
+	short  entryLen;
+
+	#define HASH_BUCKET_SIZE (MAX_SPACE - sizeof(PageID) - 2*sizeof(short))
+
+	char data[HASH_BUCKET_SIZE];
+
+public :
+
+	void   Init(int entryLength);
+	PageID GetOverflow()     { return overflow; }
+	void   SetOverflow(PageID pid) { overflow = pid; }
+	int    GetNumOfEntries() { return numOfEntries; }
+	bool   IsFull()          { return (numOfEntries + 1) * entryLen > (int)HASH_BUCKET_SIZE; }
+	char  *GetKey(int entry) { return data + entry * entryLen; }
+	void   GetRecordID(int entry, RecordID& rid);
+	void   Append(const char* key, int keyLength, const RecordID& rid);
+	void   Remove(int entry);
+};
+
+//
+// A disk-resident hash index, kept in the database as a file of its own.
+// It uses linear hashing: buckets are split one at a time, in order, as the
+// index grows, so the bucket of a key is found with no directory lookup
+// beyond an array kept in memory.  An equality lookup reads the primary page
+// of one bucket, and its overflow pages if it has any.
+//
+// The first page of the file holds the key description, the hashing state
+// and the pages of the bucket array, which is stored on pages of its own.
+//
+class HashIndex : public Index
+{
+public:
+
+	// Opens the index of the given name, or creates it empty if the
+	// database has no such file.  An existing index must have been created
+	// with the same key.
+	HashIndex(const char* name, int keyOffset, AttrType keyType, int keyLength,
+	          Status& status);
+	~HashIndex();
+
+	Status Insert(const char* key, const RecordID& rid);
+	Status Delete(const char* key, const RecordID& rid);
+
+	Status Lookup(const char* key, std::vector<RecordID>& rids);
+
+	int GetNumOfEntries() { return numOfEntries; }
+	int GetNumOfBuckets() { return (int)buckets.size(); }
+
+	// Frees every page of the index and removes it from the database.
+	Status DeleteFile();
+
+private:
+
+	string filename;
+	PageID headerPid;
+
+	std::vector<PageID> arrayPids;   // pages of the bucket array.
+	std::vector<PageID> buckets;     // primary page of each bucket.
+
+	int level;           // the buckets have doubled level times from
+	int next;            // HASH_INDEX_BUCKETS, and those below next have
+	                     // been split once more.
+	int numOfEntries;
+	int entryLen;        // bytes of an entry: key and record ID.
+	int entriesPerPage;
+
+	Status   Create(const char* name);
+	Status   Open();
+	Status   Clear();
+	unsigned Hash(const char* key) const;
+	int      BucketOf(unsigned hash) const;
+	Status   NewBucket(PageID& pid);
+	Status   Append(PageID primary, const char* key, const RecordID& rid);
+	Status   Split();
+	Status   WriteBucketArray(int bucket);
+	Status   WriteHeader();
+};
+
+#endif
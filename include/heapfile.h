@@ -1,46 +1,201 @@
-#ifndef _HEAPFILE_H
-#define _HEAPFILE_H
-
-#include "minirel.h"
-#include "page.h"
-
-#define TEMPORARY 0
-#define PERMANENT 1
-
-class HeapPage;
-
-class HeapFile 
-{
-	friend class Scan;
-
-private :
-	
-	string filename;
-	int    type;
-
-	PageID dirPid;
-	PageID lastDirPid;
-
-	PageID NextPage (PageID pid);
-	Status NewPage(PageID &pid, PageID &dirPid);
-
-	PageID GetFirstDirPage() { return dirPid; }
-
-
-public:
-
-    HeapFile( const char* name, Status& returnStatus ); 
-    ~HeapFile();
-	
-    int GetNumOfRecords();
-    Status InsertRecord(char* recPtr, int recLen, RecordID& outRid); 
-    Status DeleteRecord(const RecordID& rid); 
-    Status UpdateRecord(const RecordID& rid, char* recPtr, int recLen);
-    Status GetRecord(const RecordID& rid, char* recPtr, int& recLen); 
-    class Scan* OpenScan(Status& status);
-
-    Status DeleteFile();
-};
-
-
+#ifndef _HEAPFILE_H
+#define _HEAPFILE_H
+
+#include <mutex>
+#include <vector>
+
+#include "minirel.h"
+#include "page.h"
+#include "latch.h"
+#include "ioservice.h"
+
+#define TEMPORARY 0
+#define PERMANENT 1
+
+// Pages are allocated to a heap file in runs of this many, so that the
+// file stays physically contiguous however files are interleaved.
+#define EXTENT_SIZE 64
+
+// Threads inserting into a file at once each keep to a page of their own
+// until it fills, so that they do not queue on one page and its frame.
+// This many threads have pages of their own; more share.
+#define INSERT_TARGETS 16
+
+class HeapPage;
+class LargeRecordReader;
+class DirPage;
+struct PageInfo;
+class Counter;
+class Index;
+struct Snapshot;
+struct VersionInfo;
+struct TxnUndo;
+
+//
+// Inserts, deletes, updates and reads may come from several threads at
+// once.  Each locks the record it works on in MINIBASE_LOCKS for as long
+// as it takes, and latches the data pages it reads or changes.  The file's
+// latch is held shared by all of them and exclusively only to add or free
+// a page, when the directory changes shape; in between, entries in the
+// directory stay where they are and are adjusted atomically, so directory
+// pages are not latched.  A scan does not latch the pages it reads; it
+// should not overlap changes to the file.
+//
+class HeapFile 
+{
+	friend class Scan;
+	friend class TxnMgr;
+
+private :
+	
+	string filename;
+	int    type;
+
+	PageID dirPid;
+	PageID lastDirPid;
+
+	PageID extentNext;    // next unused page of the current extent.
+	PageID extentEnd;     // page just past the current extent.
+
+	int    pool;          // buffer pool its pages are bound to.
+
+	// Metrics heapfile.<name>.insert, .delete, .update, .scan (scans
+	// opened) and .scan.records (records they returned).
+	Counter *inserts;
+	Counter *deletes;
+	Counter *updates;
+	Counter *scans;
+	Counter *scanRecords;
+
+	std::vector<Index*> indexes;   // kept in step with the records.
+	std::mutex indexMutex;         // guards indexes and the calls to them.
+
+	Latch latch;                   // the set of pages and the directory chain.
+
+	// The page the threads given a slot insert into (see ThreadTarget),
+	// and the directory page listing it; INVALID_PAGE if none yet.  Each
+	// fills a cache line.
+	struct InsertTarget
+	{
+		Latch  latch;
+		PageID pid;
+		PageID dirPid;
+		char   pad[64 - sizeof(Latch) - 2 * sizeof(PageID)];
+	};
+
+	InsertTarget targets[INSERT_TARGETS];
+
+	void GetTarget(int slot, PageID& pid, PageID& dirPid);
+	void SetTarget(int slot, PageID pid, PageID dirPid);
+
+	PageID NextPage (PageID pid);
+	Status FindDirPage(PageID pid, PageID& dirPidCur, DirPage*& dirPage, PageInfo*& info);
+	Status Insert(char* recPtr, int recLen, RecordID& outRid, bool append, int kind);
+	Status FindRoom(char* recPtr, int recLen, RecordID& outRid, bool append, int kind);
+	Status InsertInto(PageID pid, PageID dirPidCur, bool wait, char* recPtr, int recLen,
+	                  RecordID& outRid, int kind, bool& busy);
+	Status Follow(const RecordID& rid, RecordID& at, int& kind);
+	PageID MissingPage(const RecordID& rid);
+	void   ReadWhenIn(const RecordID& rid, char* recPtr, ReadCallback done, PageID fetched);
+	Status Replace(const RecordID& rid, const char* recPtr, int recLen, int kind);
+	Status Erase(const RecordID& rid, bool unindex);
+	Status FreeIfEmpty(PageID pid);
+	Status NewPage(PageID &pid, PageID &dirPid);
+	Status NewExtentPage(PageID &pid, Page *&page);
+	Status BindPages();
+
+	PageID GetFirstDirPage() { return dirPid; }
+
+	Status ReadVersion(const RecordID& rid, char* recPtr, int& recLen, VersionInfo& info);
+	Status WriteVersion(const RecordID& rid, char* recPtr, int recLen, const VersionInfo& info);
+	Status FindVisible(const Snapshot& snapshot, char* versionPtr, int versionLen,
+	                   char* recPtr, int& recLen);
+	Status LockVersion(TxnID txn, const RecordID& rid, char* recPtr, int& recLen,
+	                   VersionInfo& info, const char* op);
+	Status UndoVersion(TxnID txn, const TxnUndo& undo);
+	Status UndoAborted(const RecordID& rid, char* recPtr, int& recLen, VersionInfo& info);
+	Status Reclaim(const RecordID& rid, TxnID horizon, int& numOfReclaimed);
+
+
+public:
+
+    HeapFile( const char* name, Status& returnStatus ); 
+
+    // Opens or creates the file with its pages in the named buffer pool
+    // (see BufMgr::AddPool), those it has and those it takes later.
+    // They stay bound there once the file is closed, until freed; the
+    // overflow pages of large records are left in the default pool.
+    HeapFile( const char* name, const char* poolName, Status& returnStatus );
+    ~HeapFile();
+	
+    int GetNumOfRecords();
+    Status InsertRecord(char* recPtr, int recLen, RecordID& outRid); 
+
+    // Inserts the record into the last page of the file, or a new page,
+    // rather than the first with room: records appended to a file nothing
+    // has been deleted from are scanned in the order they were appended.
+    Status AppendRecord(char* recPtr, int recLen, RecordID& outRid);
+
+    // The page the calling thread's inserts go to first, INVALID_PAGE
+    // until it has one.
+    PageID GetInsertTarget();
+    Status DeleteRecord(const RecordID& rid); 
+
+    // Replaces a record with contents of any length under the same
+    // record ID.  A record too big for its page moves to another one,
+    // leaving a stub that GetRecord follows.
+    Status UpdateRecord(const RecordID& rid, char* recPtr, int recLen);
+    Status GetRecord(const RecordID& rid, char* recPtr, int& recLen); 
+
+    // Reads a record without waiting for the disk: if its pages are in
+    // the pool it is read at once and done called before this returns,
+    // and otherwise they are fetched through MINIBASE_IO (see
+    // BufMgr::FetchPage) and done is called from there.  recPtr must stay
+    // valid until then.
+    void GetRecordAsync(const RecordID& rid, char* recPtr, ReadCallback done);
+    class Scan* OpenScan(Status& status);
+
+    // Inserts a record of any length, kept on overflow pages of its own;
+    // its slot holds a LargeRecordHeader, which GetRecord and scans give
+    // in place of the record.  OpenLargeRecord starts reading it back.
+    // DeleteRecord frees the pages; such a record cannot be updated.
+    Status InsertLargeRecord(const char* recPtr, int recLen, RecordID& outRid);
+    Status OpenLargeRecord(const RecordID& rid, LargeRecordReader& reader);
+
+    // Indexes attached are updated with every later change to the file,
+    // until detached.  The file does not own them; attaching an index
+    // does not build it (see Index::Build), unless a restart left it
+    // stale (see Index::IsStale).
+    Status AttachIndex(Index* index);
+    void DetachIndex(Index* index);
+
+    Status DeleteFile();
+
+    // Versioned (MVCC) access, for a file changed only in transactions
+    // (see TxnMgr).  Each record carries a VersionInfo after its data,
+    // which these add and strip.  Indexes are not versioned and should
+    // not be attached to such a file.
+    //
+    // Changes fail if another transaction changed the record since txn
+    // began, and are DONE if it is deleted as txn sees it.
+    Status InsertRecord(TxnID txn, char* recPtr, int recLen, RecordID& outRid);
+    Status DeleteRecord(TxnID txn, const RecordID& rid);
+    Status UpdateRecord(TxnID txn, const RecordID& rid, char* recPtr, int recLen);
+
+    // Reads the version of the record the snapshot sees; DONE if none.
+    Status GetRecord(const Snapshot& snapshot, const RecordID& rid, char* recPtr, int& recLen);
+    class Scan* OpenScan(const Snapshot& snapshot, Status& status);
+
+    // Deletes the versions no running transaction nor any to come can
+    // see: versions replaced, and records deleted, by transactions that
+    // committed before the oldest snapshot still in use was taken, and
+    // the changes of transactions a crash aborted.
+    Status Vacuum(int& numOfReclaimed);
+
+    // Gives back the pages of the current extent the file has not used
+    // yet, as closing it would, for a file done growing.
+    Status ReleaseExtent();
+};
+
+
 #endif
\ No newline at end of file
@@ -1,88 +1,131 @@
-#ifndef HFPAGE_H
-#define HFPAGE_H
-
-#include "minirel.h"
-#include "page.h"
-
-const int INVALID_SLOT =  -1;
-
-//
-// CHANGE this constant whenever you update the structure of HeapPage class.
-//
-const int HEAPPAGE_DATA_SIZE=(MAX_SPACE - 3*sizeof(PageID) - 6*sizeof(short));
-
-class HeapPage {
-
-protected :
-
-	struct Slot 
-	{
-		short offset;    // offset of record from the start of dataarea.
-		short length;    // length of the record.
-	};
-
-
-	short   numOfSlots;  // Number of slots available (maybe filled or
-	                     // empty).
-	short   fillPtr;     // Offset from start of data area, where 
-	                     // the records resides.
-	short   freeSpace;   // Amount of free space in bytes in this page.
-	
-	short   type;        // Not used for HeapFile assignment, but will 
-	                     // be used in B+-tree assignment.
-
-	PageID  pid;         // Page ID of this page  
-	PageID  nextPage;    // Page ID of the next page in a link list.
-	PageID  prevPage;    // Page ID of the prev page in a link list.
-
-	Slot    slots[1];    // Slots for the page.  May grow towards
-	                     // the end of a page.  (May overflow into
-			   			 // the data area.)
-
-	char data[HEAPPAGE_DATA_SIZE];
-
-	                     // Data area for this page.  Actual records
-			             // grows from the back towards to start of 
-			             // a page. 
-
-	void CompactSlotDir();
-
-public:
-
-	void Init(PageID pageNo);
-
-	PageID GetNextPage();
-	PageID GetPrevPage();
-	PageID PageNo() {return pid;}   
-	void   SetNextPage(PageID pageNo);
-	void   SetPrevPage(PageID pageNo);
-	Status InsertRecord(char* recPtr, int recLen, RecordID& rid);
-	Status DeleteRecord(const RecordID& rid);
-	Status FirstRecord(RecordID& firstRid);
-	Status NextRecord (RecordID curRid, RecordID& nextRid);
-	Status GetRecord(RecordID rid, char* recPtr, int& recLen);
-	Status ReturnRecord(RecordID rid, char*& recPtr, int& recLen);
-	Status ReturnOffset(RecordID rid, int& offset);
-	int    AvailableSpace(void);
-	bool   IsEmpty(void);
-	int    GetNumOfRecords();
-};
-
-#define SLOT_IS_EMPTY(s)  ((s).length == INVALID_SLOT)
-#define SLOT_FILL(s, o, l) { (s).offset = (o); (s).length = (l); }
-#define SLOT_SET_EMPTY(s)  (s).length = INVALID_SLOT
-
-#define PIN(a, b)   if (MINIBASE_BM->PinPage((a), (Page *&)(b)) != OK) {\
-						cerr << "Unable to pin page " << a << endl; return FAIL; }
-#define UNPIN(a, b) if (MINIBASE_BM->UnpinPage((a), (b)) != OK) {\
-						cerr << "Unable to unpin page " << a << endl; return FAIL; }
-#define FREEPAGE(a) if (MINIBASE_BM->FreePage((a)) != OK) {\
-						cerr << "Unable to free page " << a << endl; return FAIL; }
-#define NEWPAGE(a, b)  if (MINIBASE_BM->NewPage((a), (Page *&)(b)) != OK) {\
-						cerr << "Unable to allocate new page " << a << endl; return FAIL; }
-
-#define DIRTY true
-#define CLEAN false
-
-
-#endif
+#ifndef HFPAGE_H
+#define HFPAGE_H
+
+#include <cstddef>
+
+#include "minirel.h"
+#include "page.h"
+
+const int INVALID_SLOT =  -1;
+
+//
+// What a slot holds.  A record that grows too big for its page moves to
+// another one and leaves a stub in its slot, so that its record ID stays
+// the same (see HeapFile::UpdateRecord).
+//
+enum SlotKind
+{
+	SLOT_RECORD,         // a record.
+	SLOT_FORWARD,        // a stub: the RecordID of the record, moved away.
+	SLOT_MOVED,          // a record moved here; it is reached from its stub.
+	SLOT_LARGE           // the LargeRecordHeader of a record kept on
+	                     // overflow pages (see LargeRecordReader).
+};
+
+//
+// CHANGE this constant whenever you update the structure of HeapPage class.
+//
+const int HEAPPAGE_DATA_SIZE=(MAX_SPACE - sizeof(LSN) - 3*sizeof(PageID) - 6*sizeof(short));
+
+class HeapPage {
+
+	friend class SealedPage;
+
+protected :
+
+	struct Slot 
+	{
+		short offset;    // offset of record from the start of dataarea,
+		                 // the SlotKind in the bits above SLOT_KIND_SHIFT.
+		short length;    // length of the record.
+	};
+
+
+	short   numOfSlots;  // Number of slots available (maybe filled or
+	                     // empty).
+	short   fillPtr;     // Offset from start of data area, where 
+	                     // the records resides.
+	short   freeSpace;   // Amount of free space in bytes in this page.
+	
+	short   type;        // Not used for HeapFile assignment, but will 
+	                     // be used in B+-tree assignment.
+
+	LSN     lsn;         // LSN of the last logged change to this page.
+
+	PageID  pid;         // Page ID of this page  
+	PageID  nextPage;    // Page ID of the next page in a link list.
+	PageID  prevPage;    // Page ID of the prev page in a link list.
+
+	Slot    slots[1];    // Slots for the page.  May grow towards
+	                     // the end of a page.  (May overflow into
+			   			 // the data area.)
+
+	char data[HEAPPAGE_DATA_SIZE];
+
+	                     // Data area for this page.  Actual records
+			             // grows from the back towards to start of 
+			             // a page. 
+
+	void CompactSlotDir();
+
+	// The slots run on past slots[0] into the data area, so they are
+	// reached through a pointer: indexing slots itself past 0 lets an
+	// optimizing compiler take the index to be 0.
+	Slot *Slots() { return (Slot *)((char *)this + offsetof(HeapPage, slots)); }
+
+public:
+
+	void Init(PageID pageNo);
+
+	PageID GetNextPage();
+	PageID GetPrevPage();
+	PageID PageNo() {return pid;}   
+	LSN    GetLSN() {return lsn;}
+	void   SetLSN(LSN pageLSN) {lsn = pageLSN;}
+	void   SetNextPage(PageID pageNo);
+	void   SetPrevPage(PageID pageNo);
+	Status InsertRecord(char* recPtr, int recLen, RecordID& rid, int kind = SLOT_RECORD);
+	Status InsertRecordAt(const RecordID& rid, const char* recPtr, int recLen,
+	                      int kind = SLOT_RECORD);
+	Status UpdateRecord(const RecordID& rid, const char* recPtr, int recLen, int kind);
+	Status DeleteRecord(const RecordID& rid);
+	Status FirstRecord(RecordID& firstRid);
+	Status NextRecord (RecordID curRid, RecordID& nextRid);
+	Status GetRecord(RecordID rid, char* recPtr, int& recLen);
+	Status ReturnRecord(RecordID rid, char*& recPtr, int& recLen);
+	Status ReturnOffset(RecordID rid, int& offset);
+	int    GetSlotKind(const RecordID& rid);
+	int    AvailableSpace(void);
+	bool   IsEmpty(void);
+	int    GetNumOfRecords();
+
+	// Length of the longest record an empty page has room for.
+	static int MaxRecordLength() { return HEAPPAGE_DATA_SIZE - (int)sizeof(Slot); }
+};
+
+// Offsets are below 1 << SLOT_KIND_SHIFT, which leaves the bits above for
+// the SlotKind.
+#define SLOT_KIND_SHIFT 13
+#define SLOT_OFFSET_MASK ((1 << SLOT_KIND_SHIFT) - 1)
+
+#define SLOT_IS_EMPTY(s)  ((s).length == INVALID_SLOT)
+#define SLOT_FILL(s, o, l) { (s).offset = (o); (s).length = (l); }
+#define SLOT_OFFSET(s)     ((s).offset & SLOT_OFFSET_MASK)
+#define SLOT_KIND(s)       ((s).offset >> SLOT_KIND_SHIFT)
+#define SLOT_SET_KIND(s, k) (s).offset = (short)(SLOT_OFFSET(s) | ((k) << SLOT_KIND_SHIFT))
+#define SLOT_SET_EMPTY(s)  (s).length = INVALID_SLOT
+
+#define PIN(a, b)   if (MINIBASE_BM->PinPage((a), (Page *&)(b)) != OK) {\
+						cerr << "Unable to pin page " << a << endl; return FAIL; }
+#define UNPIN(a, b) if (MINIBASE_BM->UnpinPage((a), (b)) != OK) {\
+						cerr << "Unable to unpin page " << a << endl; return FAIL; }
+#define FREEPAGE(a) if (MINIBASE_BM->FreePage((a)) != OK) {\
+						cerr << "Unable to free page " << a << endl; return FAIL; }
+#define NEWPAGE(a, b)  if (MINIBASE_BM->NewPage((a), (Page *&)(b)) != OK) {\
+						cerr << "Unable to allocate new page " << a << endl; return FAIL; }
+
+#define DIRTY true
+#define CLEAN false
+
+
+#endif
@@ -1,29 +1,60 @@
-#ifndef _HEAP_DRIVER_H_
-#define _HEAP_DRIVER_H_
-
-#include "test.h"
-
-class HeapDriver : public TestDriver
-{
-public:
-
-    HeapDriver();
-   ~HeapDriver();
-
-    Status RunTests();
-
-private:
-    int choice;
-
-    bool Test1();
-    bool Test2();
-    bool Test3();
-    bool Test4();
-    bool Test5();
-    bool Test6();
-
-    Status RunAllTests();
-    const char* TestName();
-};
-
-#endif
+#ifndef _HEAP_DRIVER_H_
+#define _HEAP_DRIVER_H_
+
+#include "test.h"
+
+class HeapDriver : public TestDriver
+{
+public:
+
+    HeapDriver();
+   ~HeapDriver();
+
+    Status RunTests();
+
+    // Reopens the database and checks what the given test left in it,
+    // in a process of its own (see Restart in heaptest.cpp).
+    Status RunRestart(int test);
+
+private:
+    int choice;
+
+    bool Test1();
+    bool Test2();
+    bool Test3();
+    bool Test4();
+    bool Test5();
+    bool Test6();
+    bool Test7();
+    bool Test8();
+    bool Test9();
+    bool Test10();
+    bool Test11();
+    bool Test12();
+    bool Test13();
+    bool Test14();
+    bool Test15();
+    bool Test16();
+    bool Test17();
+    bool Test18();
+    bool Test19();
+    bool Test20();
+    bool Test21();
+    bool Test22();
+    bool Test23();
+    bool Test24();
+    bool Test25();
+    bool Test26();
+    bool Test27();
+    bool Test28();
+    bool Test29();
+    bool Test30();
+    bool Test31();
+    bool Test32();
+    bool Test33();
+
+    Status RunAllTests();
+    const char* TestName();
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef _INDEX_H
+#define _INDEX_H
+
+#include <vector>
+
+#include "minirel.h"
+
+class HeapFile;
+
+// Tells whether a key of the given type and length can be indexed or
+// sorted on (see Index).
+bool KeyIsValid(int keyOffset, AttrType keyType, int keyLength);
+
+// Orders two keys of the given type and length, which need not be
+// aligned; less than, equal to or greater than 0 as a is.
+int CompareKeys(AttrType keyType, int keyLength, const char* a, const char* b);
+
+// Hashes a key of the given type and length so that keys that compare
+// equal hash alike.
+unsigned HashKey(AttrType keyType, int keyLength, const char* key);
+
+//
+// A secondary index on one attribute of the records of a heap file: it maps
+// each key to the record IDs of the records holding it.  The key is the
+// keyLength bytes at keyOffset in each record, read as keyType:
+//
+//   attrInteger  an int
+//   attrReal     a float, or a double if keyLength is sizeof(double)
+//   attrString   up to keyLength characters, ended early by a NUL
+//
+// A heap file keeps the indexes attached to it (HeapFile::AttachIndex) in
+// step with its inserts, deletes and updates.  Those changes are not logged
+// record by record, so an index is stale once a restart has redone or undone
+// changes after it was built; attaching it rebuilds it then.
+//
+class Index
+{
+public:
+
+	Index(int keyOffset, AttrType keyType, int keyLength);
+	virtual ~Index();
+
+	// Adds the entry (key, rid).  Keys need not be unique.
+	virtual Status Insert(const char* key, const RecordID& rid) = 0;
+
+	// Removes the entry (key, rid); DONE if there is none.
+	virtual Status Delete(const char* key, const RecordID& rid) = 0;
+
+	// Finds the record IDs of every entry of the key.
+	virtual Status Lookup(const char* key, std::vector<RecordID>& rids) = 0;
+
+	// Keep the index in step with a change to the record rid.
+	Status InsertRecord(const char* recPtr, int recLen, const RecordID& rid);
+	Status DeleteRecord(const char* recPtr, int recLen, const RecordID& rid);
+	Status UpdateRecord(const char* oldRecPtr, int oldRecLen,
+	                    const char* newRecPtr, int newRecLen, const RecordID& rid);
+
+	// Adds an entry for every record of the file.
+	virtual Status Build(HeapFile& file);
+
+	// Tells whether a restart recovered the database since the index was
+	// created or rebuilt, and empties and builds it again.
+	bool   IsStale();
+	Status Rebuild(HeapFile& file);
+
+	int CompareKeys(const char* a, const char* b) const
+	{
+		return ::CompareKeys(keyType, keyLength, a, b);
+	}
+
+	int GetKeyLength() const { return keyLength; }
+
+protected:
+
+	bool KeyIsValid() const { return ::KeyIsValid(keyOffset, keyType, keyLength); }
+
+	// Frees every page of the index but leaves it in the database, as
+	// created: empty, and built at builtLSN.
+	virtual Status Clear() = 0;
+
+	int      keyOffset;
+	AttrType keyType;
+	int      keyLength;
+	LSN      builtLSN;     // end of the log when the index was built empty;
+	                       // subclasses keep it in their header.
+};
+
+#endif
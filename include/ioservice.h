@@ -0,0 +1,116 @@
+#ifndef _IOSERVICE_H
+#define _IOSERVICE_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "minirel.h"
+
+// Threads of the I/O service SystemDefs starts, which run the work handed
+// over and the completions of reads.
+#define IO_THREADS 4
+
+// Reads the service keeps under way in the kernel at once unless told
+// otherwise (see IOService::SetQueueDepth), and the most it can keep.
+#define IO_QUEUE_DEPTH 32
+#define IO_MAX_QUEUE_DEPTH 256
+
+// Completion of an asynchronous read: how it went and, if OK, the length
+// of the record read.
+typedef std::function<void (Status status, int recLen)> ReadCallback;
+
+// Completion of a read handed to IOService::Read: what pread would have
+// returned.
+typedef std::function<void (ssize_t len)> IOCallback;
+
+//
+// A few threads that run, in turn, work handed to them because it may have
+// to wait for the disk, so that the threads handing it over never do; see
+// HeapFile::GetRecordAsync and Scan::GetNextAsync.  The work is done, and
+// its callback called, on one of these threads.
+//
+// Reads handed over with Read are not made by the threads: they go to the
+// kernel through an io_uring, up to the queue depth at once and the rest
+// queued until some complete, and a thread of its own waits for them to
+// complete and calls their callbacks.  So the reads under way are as many
+// as the queue depth, however few the threads are, and a read completes
+// even while every thread waits for one.  Where the kernel offers no
+// io_uring, each read is made with pread as work handed to the threads,
+// and as many are under way as there are threads.
+//
+class IOService
+{
+public:
+
+	IOService(int numOfThreads);
+
+	// Finishes the work and reads handed over, then stops the threads.
+	~IOService();
+
+	void Submit(const std::function<void ()>& work);
+
+	// Reads len bytes at offset in fd into buf, then calls done; buf must
+	// stay valid until then.  done may hold up the reads that complete
+	// after this one, so it must not wait: it hands what may to Submit.
+	void Read(int fd, void* buf, size_t len, off_t offset, const IOCallback& done);
+
+	// Sets how many reads may be under way at once, from 1 to
+	// IO_MAX_QUEUE_DEPTH; those under way already are not held back.
+	void SetQueueDepth(int depth);
+	int GetQueueDepth();
+
+	// True if reads go through an io_uring.
+	bool HasKernelQueue() { return ringFd >= 0; }
+
+	// Waits until all the work handed over so far, and any it handed over
+	// in turn, is done, and every read has completed.
+	void Drain();
+
+private:
+
+	// A read handed over, queued or under way.
+	struct PendingRead
+	{
+		int          fd;
+		struct iovec iov;
+		off_t        offset;
+		IOCallback   done;
+	};
+
+	void Run();
+	bool SetUpRing();
+	void StartReads();
+	void Reap();
+
+	std::mutex mutex;
+	std::condition_variable ready;     // work was handed over, or stopping.
+	std::condition_variable idle;      // the last work running is done.
+	std::deque<std::function<void ()> > queue;
+	int  numOfRunning;
+	bool stopping;
+	std::vector<std::thread> threads;
+
+	// The io_uring, where there is one; guarded by mutex but for the
+	// completion queue, which only the reaper reads.
+	int  ringFd;
+	void *sqRing, *cqRing, *sqes;
+	size_t sqRingSize, cqRingSize, sqesSize;
+	unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+	unsigned *cqHead, *cqTail, *cqMask;
+	void *cqes;
+	unsigned ringEntries;
+
+	std::deque<PendingRead*> waiting;  // reads queued for the ring.
+	int  numOfReads;                   // handed over and not yet completed.
+	int  numOfInKernel;                // in the ring.
+	int  queueDepth;
+	std::thread reaper;
+};
+
+#endif
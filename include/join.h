@@ -0,0 +1,110 @@
+#ifndef _JOIN_H
+#define _JOIN_H
+
+#include <functional>
+#include <vector>
+
+#include "minirel.h"
+#include "page.h"
+#include "spill.h"
+
+class HeapFile;
+
+// Levels of partitioning after which a hash join whose build partition
+// still does not fit in memory joins it a memoryful at a time.
+#define HASH_JOIN_MAX_DEPTH 3
+
+//
+// The key of one input of a join: keyLength bytes at keyOffset in each
+// record, read as keyType (see Index).  Both keys of a join must have the
+// same type and length.
+//
+struct JoinKey
+{
+	int      keyOffset;
+	AttrType keyType;
+	int      keyLength;
+};
+
+//
+// Called with each pair of records whose keys are equal, the left one from
+// the first input of the join and the right one from the second.  Any
+// status but OK stops the join, which returns it.
+//
+typedef std::function<Status (const char* leftRec, int leftLen,
+                              const char* rightRec, int rightLen)> JoinCallback;
+
+//
+// A grace hash join.  The first (build) input is loaded into a hash table
+// in the frames of the join, taken from the buffer pool for as long as it
+// runs, and the second (probe) input is scanned against it.  If the build
+// input does not fit, both are split by hash of the key into numOfFrames - 1
+// partitions, spilled (see SpillRun), and each pair of partitions joined
+// the same way, repartitioning with another hash up to HASH_JOIN_MAX_DEPTH
+// levels deep.  Pairs come in no particular order.
+//
+class HashJoin
+{
+public:
+
+	// numOfFrames is the memory of the join, at least 3 frames.
+	HashJoin(const JoinKey& buildKey, const JoinKey& probeKey, int numOfFrames);
+
+	// Joins build with probe, giving each pair to emit, or appending it to
+	// result as a record made of the two one after the other.
+	Status Run(HeapFile& build, HeapFile& probe, const JoinCallback& emit);
+	Status Run(HeapFile& build, HeapFile& probe, HeapFile& result);
+
+	// Of the last Run: partitions each input was split into, over every
+	// level, and the deepest level reached, 0 if the build input fit.
+	int GetNumOfPartitions() { return numOfPartitions; }
+	int GetDepth()           { return depth; }
+
+private:
+
+	struct JoinRecord
+	{
+		char *recPtr;
+		int  recLen;
+		int  next;        // next record in the bucket, -1 after the last.
+	};
+
+	JoinKey buildKey;
+	JoinKey probeKey;
+	int     numOfFrames;
+
+	int numOfPartitions;
+	int depth;
+
+	std::vector<Page*> frames;
+	SpillSpace         space;
+
+	Status Join(HeapFile* buildFile, SpillRun* buildRun, HeapFile* probeFile,
+	            SpillRun* probeRun, int level, const JoinCallback& emit);
+	Status Partition(HeapFile* file, SpillRun* run, const JoinKey& key,
+	                 int level, std::vector<SpillRun>& parts);
+};
+
+//
+// A sort-merge join of two inputs already in ascending order of their keys,
+// such as ExternalSort writes.  Each group of right records with equal keys
+// is held in memory while the left records with that key are joined with
+// it.  Pairs come in order of key.
+//
+class SortMergeJoin
+{
+public:
+
+	SortMergeJoin(const JoinKey& leftKey, const JoinKey& rightKey);
+
+	// As for HashJoin; FAIL if an input turns out not to be sorted.
+	Status Run(HeapFile& left, HeapFile& right, const JoinCallback& emit);
+	Status Run(HeapFile& left, HeapFile& right, HeapFile& result);
+
+private:
+
+	JoinKey leftKey;
+	JoinKey rightKey;
+};
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef _LARGERECORD_H
+#define _LARGERECORD_H
+
+#include "minirel.h"
+#include "page.h"
+
+//
+// A record too long for a heap page (see HeapFile::InsertLargeRecord) is
+// kept on a chain of overflow pages, allocated in runs as long as the free
+// space allows so that reading it back is sequential.  Its slot, of kind
+// SLOT_LARGE, holds this header, which is what GetRecord and scans return
+// for it.
+//
+struct LargeRecordHeader
+{
+	int    length;        // bytes of the record.
+	PageID firstPage;     // first overflow page, INVALID_PAGE if none.
+	int    numOfPages;    // overflow pages in the chain.
+};
+
+// Bytes of a record an overflow page holds.
+#define OVERFLOW_DATA_SIZE (MINIBASE_PAGESIZE - (int)sizeof(PageID))
+
+struct OverflowPage
+{
+	PageID next;                       // INVALID_PAGE on the last page.
+	char   data[OVERFLOW_DATA_SIZE];
+};
+
+// Writes the record to a new chain of overflow pages, each logged as an
+// image, and describes it in header.
+Status WriteOverflow(const char* recPtr, int recLen, LargeRecordHeader& header);
+
+// Frees the overflow pages of a record.
+Status FreeOverflow(const LargeRecordHeader& header);
+
+//
+// Reads a large record a piece at a time, so that it never has to be in
+// memory whole.  The overflow page being read stays pinned until the
+// reader moves past it or is closed.
+//
+class LargeRecordReader
+{
+public:
+
+	LargeRecordReader() : pos(0), pid(INVALID_PAGE), page(NULL), offset(0)
+	{
+		header.length = 0;
+		header.firstPage = INVALID_PAGE;
+		header.numOfPages = 0;
+	}
+	~LargeRecordReader() { Close(); }
+
+	// Starts reading the record header describes (see HeapFile::OpenLargeRecord).
+	void Open(const LargeRecordHeader& header);
+
+	int GetLength() const { return header.length; }
+
+	// Copies the next bytes of the record, up to max of them, to buf;
+	// DONE once the whole record has been read.
+	Status Read(char* buf, int max, int& numOfBytes);
+
+	void Close();
+
+private:
+
+	LargeRecordHeader header;
+	int          pos;       // bytes of the record read so far.
+	PageID       pid;       // the overflow page pinned, if any.
+	OverflowPage *page;
+	int          offset;    // of the next byte in page->data.
+};
+
+#endif
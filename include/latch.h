@@ -0,0 +1,126 @@
+#ifndef _LATCH_H
+#define _LATCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+//
+// A reader-writer latch, held for the few instructions it takes to read or
+// change a page or a structure in memory.  It is one word: a thread that
+// finds it taken yields until it is free, never sleeps.  A writer waiting
+// keeps new readers out, so that a stream of readers cannot starve it.
+//
+// Latches are not reentrant: a thread must not take a latch it holds, in
+// either mode.
+//
+class Latch
+{
+public:
+
+	Latch() : state(0) {}
+
+	void LockShared()
+	{
+		int s = state.load(std::memory_order_relaxed);
+		while ((s & (HELD | WAITING_MASK)) != 0
+		       || !state.compare_exchange_weak(s, s + 1, std::memory_order_acquire))
+		{
+			std::this_thread::yield();
+			s = state.load(std::memory_order_relaxed);
+		}
+	}
+
+	void UnlockShared() { state.fetch_sub(1, std::memory_order_release); }
+
+	void LockExclusive()
+	{
+		state.fetch_add(WAITING, std::memory_order_relaxed);
+		int s = state.load(std::memory_order_relaxed);
+		while ((s & (HELD | READERS_MASK)) != 0
+		       || !state.compare_exchange_weak(s, s - WAITING + HELD, std::memory_order_acquire))
+		{
+			std::this_thread::yield();
+			s = state.load(std::memory_order_relaxed);
+		}
+	}
+
+	// Takes the latch exclusively if no one holds it or waits for it.
+	bool TryLockExclusive()
+	{
+		int s = 0;
+		return state.compare_exchange_strong(s, HELD, std::memory_order_acquire);
+	}
+
+	void UnlockExclusive() { state.fetch_sub(HELD, std::memory_order_release); }
+
+private:
+
+	// Readers holding the latch are counted in the low bits, writers
+	// waiting for it above them, and the top bit is set while a writer
+	// holds it.
+	enum
+	{
+		READERS_MASK = 0xffff,
+		WAITING      = 0x10000,
+		WAITING_MASK = 0x3fff0000,
+		HELD         = 0x40000000
+	};
+
+	std::atomic<int> state;
+};
+
+//
+// Holds a latch until it goes out of scope, so that no return path can
+// leave it taken.
+//
+class LatchGuard
+{
+public:
+
+	LatchGuard() : latch(NULL), exclusive(false) {}
+	LatchGuard(Latch* l, bool x) : latch(NULL), exclusive(false) { Lock(l, x); }
+	~LatchGuard() { Unlock(); }
+
+	void Lock(Latch* l, bool x)
+	{
+		Unlock();
+		if (x)
+			l->LockExclusive();
+		else
+			l->LockShared();
+		latch = l;
+		exclusive = x;
+	}
+
+	bool TryLockExclusive(Latch* l)
+	{
+		Unlock();
+		if (!l->TryLockExclusive())
+			return false;
+		latch = l;
+		exclusive = true;
+		return true;
+	}
+
+	void Unlock()
+	{
+		if (latch == NULL)
+			return;
+		if (exclusive)
+			latch->UnlockExclusive();
+		else
+			latch->UnlockShared();
+		latch = NULL;
+	}
+
+private:
+
+	LatchGuard(const LatchGuard&);
+	LatchGuard& operator=(const LatchGuard&);
+
+	Latch *latch;
+	bool  exclusive;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef _LOCKTABLE_H
+#define _LOCKTABLE_H
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "minirel.h"
+
+// Number of parts the lock table is split into, each with a mutex of its
+// own, so that threads locking different records seldom meet.
+#define LOCK_TABLE_SHARDS 64
+
+//
+// Locks on records, shared or exclusive, keyed on record ID.  HeapFile
+// locks a record for as long as an operation on it takes, so that, for
+// instance, a reader never sees a record half moved by an update; callers
+// may also lock records themselves around several operations.
+//
+// Locks are reentrant for the thread holding a record exclusively: it may
+// lock the record again in either mode, and unlocks it as often.  A thread
+// holding a record shared must not ask for it exclusively.
+//
+class LockTable
+{
+public:
+
+	// Waits until the record can be locked in the mode asked for.
+	void Lock(const RecordID& rid, bool exclusive);
+	void Unlock(const RecordID& rid);
+
+private:
+
+	struct LockState
+	{
+		int shared;                // threads holding the record shared.
+		int exclusive;             // times the owner has locked it.
+		std::thread::id owner;     // holding it exclusively, if any.
+	};
+
+	struct Shard
+	{
+		std::mutex mutex;
+		std::condition_variable released;
+		std::map<RecordID, LockState> locks;   // records locked or awaited.
+	};
+
+	Shard& ShardOf(const RecordID& rid);
+
+	Shard shards[LOCK_TABLE_SHARDS];
+};
+
+//
+// Holds the lock on a record until it goes out of scope.
+//
+class RecordLock
+{
+public:
+
+	RecordLock(const RecordID& rid, bool exclusive);
+	~RecordLock();
+
+private:
+
+	RecordLock(const RecordLock&);
+	RecordLock& operator=(const RecordLock&);
+
+	RecordID rid;
+};
+
+#endif
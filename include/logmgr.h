@@ -0,0 +1,214 @@
+#ifndef _LOGMGR_H
+#define _LOGMGR_H
+
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "minirel.h"
+#include "page.h"
+#include "mvcc.h"
+
+//
+// Kinds of log records.  Heap page records are physiological: they name a
+// page and a slot, and describe the change made to it.  Any other page that
+// changes (directory pages, the database header and space map) is logged as
+// a full image.
+//
+enum LogRecType
+{
+	LOG_PAGE_INIT,       // a data page was initialized.
+	LOG_INSERT,          // a record was inserted; data is the record.
+	LOG_DELETE,          // a record was deleted; data is the old record.
+	                     // Both carry the SlotKind of the slot.
+	LOG_UPDATE,          // a record was overwritten; data is the new record
+	                     // followed by the old one.
+	LOG_COMMIT,          // the changes logged before this are committed;
+	                     // data is the TxnID of the transaction that
+	                     // committed, or empty if there is none.
+	LOG_PAGE_IMAGE,      // a page was changed; data is its new contents.
+	LOG_PAGE_FREE,       // a page was deallocated.
+	LOG_CHECKPOINT,      // data is a CheckpointData and the dirty page table.
+	LOG_ABORTED_TXNS     // data is a TxnRange for each run of transactions
+	                     // a crash aborted, sorted (see StartRun).
+};
+
+//
+// Header of every log record; the record data follows it.
+//
+struct LogRecord
+{
+	LSN      lsn;        // offset of the record in the log file.
+	LSN      undone;     // for a compensation record, the LSN of the record
+	                     // it undid; INVALID_LSN otherwise.
+	int      length;     // length of the record, data included.
+	int      dataLen;    // bytes of data after the header.
+	short    type;       // one of LogRecType.
+	short    kind;       // for LOG_INSERT and LOG_DELETE, the SlotKind.
+	PageID   pid;        // page that was changed.
+	PageID   dirPid;     // directory page listing pid, for heap records.
+	int      slotNo;     // slot of the record on that page.
+	unsigned checksum;   // CRC-32C of the record, taken with this field 0.
+};
+
+//
+// Data of a checkpoint record.  numOfPages DirtyPageEntry follow it.
+//
+struct CheckpointData
+{
+	LSN beginLSN;        // end of the log when the dirty page table was
+	                     // taken; pages changed from here on are not in it.
+	LSN lastCommitLSN;   // newest commit record before the checkpoint.
+	int numOfPages;      // number of pages in the dirty page table.
+};
+
+//
+// Records start after the log header page, so no record has LSN 0
+// (INVALID_LSN).
+//
+const LSN LOG_START = MINIBASE_PAGESIZE;
+
+//
+// The write-ahead log.  Records are appended to a buffer in memory and reach
+// the log file when some LSN has to be made durable: before a dirty page is
+// written (the WAL rule, enforced by the buffer manager) and on commit.
+//
+// Commits are grouped: while one thread writes and syncs the log, others
+// append their commit records and wait, and the next sync covers all of them.
+//
+// A checkpoint is taken each time the log grows by a quarter of its size
+// limit.  Restart reads the log from the last checkpoint, or from the last
+// commit or oldest lost change before it if that is older (see RecoveryMgr),
+// and the commits from where the present run began.  Once a checkpoint is
+// in the header, the space the records before all of these took is given
+// back to the file system; the file keeps its length, so that LSNs stay
+// offsets into it.  So that old pages and transactions do not hold on to
+// the log, a checkpoint writes back pages changed before the last one
+// began, and logs the transactions that aborted below the oldest one
+// running (see Checkpoint).  The log then holds about half its size limit
+// at most, unless a page stays pinned, a transaction runs, or nothing
+// commits for longer.
+//
+class LogMgr
+{
+public:
+
+	// Creates a new, empty log if create is true, and opens an existing
+	// one otherwise.  maxlogsize is in pages.
+	LogMgr(const char* name, unsigned maxlogsize, bool create, Status& status);
+	~LogMgr();
+
+	LSN LogPageInit(PageID pid, PageID dirPid);
+	// kind is the SlotKind of the slot; 0 is a record.
+	LSN LogInsert(const RecordID& rid, PageID dirPid, const char* recPtr, int recLen,
+	              short kind = 0);
+	LSN LogDelete(const RecordID& rid, PageID dirPid, const char* oldRecPtr, int recLen,
+	              short kind = 0);
+	LSN LogUpdate(const RecordID& rid, PageID dirPid, const char* recPtr,
+	              const char* oldRecPtr, int recLen);
+	LSN LogPageImage(PageID pid, const Page* page);
+	LSN LogPageFree(PageID pid);
+
+	// Logs a change made to undo the record at undone.  Compensation
+	// records are redone after a crash but never undone.
+	LSN LogCompensation(short type, const RecordID& rid, PageID dirPid,
+	                    const char* data, int dataLen, LSN undone, short kind = 0);
+
+	// Appends a commit record and returns once it is durable.  txn, if
+	// given, is the transaction committing.
+	Status Commit(TxnID txn = INVALID_TXN);
+
+	// Returns once every record up to and including lsn is durable.
+	Status Flush(LSN lsn);
+
+	// Takes a fuzzy checkpoint: logs the dirty page table of the buffer
+	// manager without writing any page, and makes the checkpoint the one
+	// restart begins from.  taken, if given, is called once the table is
+	// taken, so that a test can change pages while the checkpoint is on.
+	Status Checkpoint();
+	Status Checkpoint(const std::function<void()>& taken);
+	bool CheckpointDue();
+
+	// Where the last checkpoint began, INVALID_LSN before the first of
+	// this run.  A page changed before is best written back, so that
+	// the log before can be given back (see BufMgr::UnpinPage).
+	LSN GetWriteBackLSN() { return lastBeginLSN.load(); }
+
+	// Turns the checkpoints taken as the log grows off or on; restart
+	// turns them off until it has finished.
+	void SetAutoCheckpoint(bool on);
+
+	// Reserves count transaction IDs never handed out before (see TxnMgr).
+	Status ReserveTxnIDs(TxnID& first, int count);
+
+	// The run of the database since it was last opened: the first
+	// transaction ID it reserved, the LSN of its first record, and the
+	// first ID not reserved yet.
+	void GetLastRun(TxnID& first, LSN& start, TxnID& limit);
+
+	// Logs the transactions of the last run that never committed, in
+	// aborted, as aborted, with those of the runs before; restart calls
+	// it once done, and a new run begins.
+	Status StartRun(const std::vector<TxnRange>& aborted);
+
+	// Every transaction that was running at a crash, sorted.
+	Status GetAbortedTxns(std::vector<TxnRange>& aborted);
+
+	// Notes that restart redid or undid changes; GetRecoveredLSN gives
+	// the end of the log when it last did, INVALID_LSN if it never has.
+	Status SetRecovered();
+	LSN GetRecoveredLSN();
+
+	// Reads a durable record; data, if not NULL, receives its data.
+	Status ReadRecord(LSN lsn, LogRecord& rec, std::vector<char>* data);
+
+	LSN GetEndLSN();
+	LSN GetDurableLSN();
+	LSN GetCheckpointLSN();
+	void GetStat(long& commitNo, long& syncNo);
+
+private:
+
+	LSN Append(short type, PageID pid, PageID dirPid, int slotNo,
+	           const char* data, int dataLen, LSN undone = INVALID_LSN,
+	           short kind = 0);
+	Status WriteBatch(LSN start, const std::vector<char>& batch);
+	Status WriteHeader();
+	Status LogAborted(const std::vector<TxnRange>& aborted, LSN& lsn);
+	Status SettleRun(TxnID txn, LSN begun, LSN keepLSN);
+	void Reclaim(LSN keepLSN);
+
+	int fd;
+	unsigned maxSize;            // size limit given at creation, in bytes.
+	LSN  checkpointLSN;          // checkpoint restart begins from.
+	LSN  recoveredLSN;           // see SetRecovered.
+	LSN  abortedLSN;             // newest LOG_ABORTED_TXNS record.
+	TxnID runTxn;                // first ID reserved in this run.
+	LSN  runLSN;                 // first record of this run.
+	bool autoCheckpoint;         // CheckpointDue may return true.
+
+	// Checkpoints settle the run and give space back one at a time.
+	std::mutex settling;         // guards the one below.
+	LSN  reclaimedLSN;           // the log before this is given back.
+	std::atomic<LSN> lastBeginLSN;   // beginLSN of the last checkpoint.
+
+	std::mutex mutex;            // guards everything below.
+	std::condition_variable flushed;
+
+	std::vector<char> buffer;    // records appended but not yet written.
+	LSN  bufferLSN;              // LSN of the first byte in buffer.
+	LSN  endLSN;                 // LSN the next record will get.
+	LSN  durableLSN;             // everything before this is on disk.
+	LSN  lastCommitLSN;          // newest commit record.
+	TxnID txnLimit;              // first transaction ID not yet reserved.
+	bool flushing;               // a thread is writing the log.
+	bool runKnown;               // runCommits holds every commit of the run.
+	std::vector<TxnID> runCommits;   // transactions of the run that committed.
+
+	long numOfCommits;
+	long numOfSyncs;
+};
+
+#endif
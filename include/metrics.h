@@ -0,0 +1,167 @@
+#ifndef _METRICS_H
+#define _METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <ostream>
+
+//
+// Counters and histograms of what the storage layer does, kept in one
+// registry under dotted names such as "bufmgr.pin.hit".
+//
+// Updates are cheap enough for the hot paths: each metric is split into
+// shards, a thread always updates the same shard, and shards are combined
+// only when a snapshot is taken.  The registry hands out a metric once, by
+// name; callers keep the reference and never look it up again.
+//
+
+// Number of shards of every metric.  Threads beyond this share shards.
+const int METRICS_SHARDS = 8;
+
+class Counter
+{
+public:
+
+	Counter();
+
+	void Add(long n = 1)
+	{
+		shards[ThreadShard()].value.fetch_add(n, std::memory_order_relaxed);
+	}
+
+	long Get() const;
+	void Reset();
+
+	// The shard the calling thread updates.
+	static int ThreadShard();
+
+private:
+
+	// A shard fills a cache line, so that threads do not share lines.
+	struct Shard
+	{
+		std::atomic<long> value;
+		char pad[64 - sizeof(std::atomic<long>)];
+	};
+
+	Shard shards[METRICS_SHARDS];
+};
+
+//
+// A histogram of non-negative values, usually latencies in nanoseconds.
+// Like HdrHistogram it keeps a fixed relative precision: values below 8
+// have a bucket each, and every power of two above that is split into 8
+// buckets, so a value is known to within 12.5% over the whole range of
+// a long.
+//
+const int HISTOGRAM_SUB_BITS = 3;
+const int HISTOGRAM_BUCKETS = (64 - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS;
+
+struct HistogramSnapshot
+{
+	long count;
+	long sum;
+	std::vector<long> buckets;     // HISTOGRAM_BUCKETS counts.
+
+	// Upper bound of the bucket holding the fraction p of the values.
+	long GetPercentile(double p) const;
+	long GetMax() const;
+};
+
+class Histogram
+{
+public:
+
+	Histogram();
+
+	void Record(long value)
+	{
+		Shard& shard = shards[Counter::ThreadShard()];
+		shard.buckets[Bucket(value)].fetch_add(1, std::memory_order_relaxed);
+		shard.sum.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	void Snapshot(HistogramSnapshot& snapshot) const;
+	void Reset();
+
+	static int Bucket(long value);
+	static long BucketLow(int bucket);
+	static long BucketHigh(int bucket);
+
+private:
+
+	struct Shard
+	{
+		std::atomic<long> buckets[HISTOGRAM_BUCKETS];
+		std::atomic<long> sum;
+		char pad[64 - sizeof(std::atomic<long>)];
+	};
+
+	Shard shards[METRICS_SHARDS];
+};
+
+//
+// Records into a histogram the nanoseconds between its construction and
+// its destruction.
+//
+class MetricsTimer
+{
+public:
+
+	MetricsTimer(Histogram& histogram)
+		: histogram(histogram), start(std::chrono::steady_clock::now()) {}
+
+	~MetricsTimer()
+	{
+		histogram.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start).count());
+	}
+
+private:
+
+	Histogram& histogram;
+	std::chrono::steady_clock::time_point start;
+};
+
+//
+// The values of every metric at one moment.
+//
+struct MetricsSnapshot
+{
+	std::map<std::string, long> counters;
+	std::map<std::string, HistogramSnapshot> histograms;
+
+	void WriteText(std::ostream& out) const;
+	void WriteJson(std::ostream& out) const;
+};
+
+class MetricsRegistry
+{
+public:
+
+	~MetricsRegistry();
+
+	// Returns the metric of the given name, creating it on first use.
+	// The metric lives as long as the registry.
+	Counter& GetCounter(const std::string& name);
+	Histogram& GetHistogram(const std::string& name);
+
+	void Snapshot(MetricsSnapshot& snapshot);
+
+	// Sets every metric back to zero.
+	void Reset();
+
+private:
+
+	std::mutex mutex;
+	std::map<std::string, Counter*> counters;
+	std::map<std::string, Histogram*> histograms;
+};
+
+extern MetricsRegistry minibase_metrics;
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef _MVCC_H
+#define _MVCC_H
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "minirel.h"
+
+class HeapFile;
+class LogMgr;
+
+// Transaction IDs are reserved in the log header this many at a time, so
+// that no ID is handed out twice across restarts.
+#define TXN_ID_BATCH 1024
+
+//
+// The transaction IDs from first up to, not including, limit.
+//
+struct TxnRange
+{
+	TxnID first;
+	TxnID limit;
+};
+
+//
+// What a transaction sees: every transaction that had committed when it
+// began, and itself.
+//
+struct Snapshot
+{
+	TxnID txn;                   // the transaction the snapshot is of.
+	TxnID xmin;                  // every ID below had finished.
+	TxnID xmax;                  // no ID from here on had begun.
+	std::vector<TxnID> active;   // IDs in between still running, sorted.
+	const std::vector<TxnRange> *aborted;
+	                             // IDs below xmin that never committed, as
+	                             // they were running at a crash.
+
+	bool Sees(TxnID id) const;
+};
+
+//
+// Kept at the end of each record of a versioned heap file, after the data,
+// so that keys are where they would be in an unversioned record.
+//
+// A record's own slot holds its newest version.  An update moves the old
+// version to a record of its own, a copy, and chains it from the new one
+// through prev, so record IDs never change however often a record is
+// updated; readers go down the chain to the newest version they see.
+//
+struct VersionInfo
+{
+	TxnID    xmin;     // the transaction that wrote the version.
+	TxnID    xmax;     // the one that deleted or replaced it, or INVALID_TXN.
+	RecordID prev;     // the version before, pageNo INVALID_PAGE if none.
+	int      copy;     // 1 for an old version moved out of its record's slot.
+};
+
+//
+// A change a running transaction made to a versioned heap file, undone if
+// it aborts.
+//
+struct TxnUndo
+{
+	enum Kind { undoInsert, undoDelete, undoUpdate };
+
+	Kind     kind;
+	HeapFile *file;
+	RecordID rid;
+};
+
+//
+// Hands out transaction IDs and snapshots for the versioned operations of
+// HeapFile (multiversion concurrency control under snapshot isolation).
+// Readers see the snapshot their transaction took when it began and never
+// wait for writers; a writer changing a record another transaction changed
+// after that snapshot fails and should abort.
+//
+// A transaction that aborts undoes its versions.  One running at a crash
+// cannot, and its versions stay in the files if a later commit made them
+// durable: restart rolls back heap changes by the log, which does not say
+// which transaction made them.  Each commit therefore logs the ID of its
+// transaction, and restart takes every ID of the run before that has no
+// commit record to have aborted (see LogMgr::StartRun).  No snapshot sees
+// their versions, and the first writer or Vacuum to come by a record one of
+// them changed undoes the change, as its abort would have.
+//
+class TxnMgr
+{
+public:
+
+	TxnMgr(LogMgr* log) : log(log), next(INVALID_TXN), limit(INVALID_TXN) {}
+
+	Status Begin(TxnID& txn);
+
+	// Makes the changes of txn durable, then visible to transactions that
+	// begin after.
+	Status Commit(TxnID txn);
+
+	// Undoes the changes of txn, newest first.  Files txn changed must
+	// still be open.
+	Status Abort(TxnID txn);
+
+	// The snapshot of a running transaction, NULL for any other.
+	const Snapshot *GetSnapshot(TxnID txn);
+
+	// A version deleted or replaced by a transaction below the horizon is
+	// seen by no running transaction and none to come.
+	TxnID GetHorizon();
+
+	void AddUndo(TxnID txn, const TxnUndo& undo);
+
+	// True if id was running at a crash, and so aborted.  Known from the
+	// first transaction or horizon of a run on.
+	bool IsAborted(TxnID id) const;
+
+	// The oldest running transaction and the end of the log when it
+	// began, or with none running the ID the next one gets and the end
+	// of the log now; INVALID_TXN if the run has handed out none yet.
+	// Every transaction below txn has finished, and every one from txn
+	// on commits after begun (see LogMgr::Checkpoint).
+	void GetOldestRunning(TxnID& txn, LSN& begun);
+
+private:
+
+	struct TxnState
+	{
+		Snapshot snapshot;
+		std::vector<TxnUndo> undo;
+		LSN      begun;                 // end of the log at Begin.
+	};
+
+	LogMgr *log;
+
+	Status Reserve();
+
+	std::mutex mutex;                   // guards everything below.
+	TxnID next;                         // ID the next transaction gets.
+	TxnID limit;                        // first ID not reserved.
+	std::map<TxnID, TxnState> running;
+	std::vector<TxnRange> aborted;      // read from the log with the first
+	                                    // batch, unchanged after.
+};
+
+#endif
@@ -0,0 +1,314 @@
+#ifndef _OPERATOR_H
+#define _OPERATOR_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "minirel.h"
+
+class HeapFile;
+class Scan;
+class Counter;
+class Histogram;
+
+// Rows an operator hands on at a time, at most.
+#define BATCH_ROWS 256
+
+//
+// A column of the rows operators pass between them: length bytes read as
+// type (see Index).  Read from a record, it is the length bytes at offset;
+// in a row written out as a record, the columns lie back to back and
+// offset is where this one starts.
+//
+struct Column
+{
+	int      offset;
+	AttrType type;
+	int      length;
+};
+
+//
+// Up to BATCH_ROWS rows, stored column by column: the values of a column
+// lie side by side, length bytes apart, so that an operator working on one
+// column touches only its bytes.
+//
+class Batch
+{
+public:
+
+	Batch() : numOfRows(0) {}
+
+	// Empties the batch and gives it the columns of schema.
+	void Reset(const std::vector<Column>& schema);
+
+	int  GetNumOfRows() const    { return numOfRows; }
+	int  GetNumOfColumns() const { return (int)columns.size(); }
+	bool IsFull() const          { return numOfRows == BATCH_ROWS; }
+
+	const Column& GetColumn(int col) const { return columns[col]; }
+
+	char *GetValue(int col, int row)
+	{
+		return &data[col][row * columns[col].length];
+	}
+
+	const char *GetValue(int col, int row) const
+	{
+		return &data[col][row * columns[col].length];
+	}
+
+	// Adds n rows taken from the records recPtrs[0..n), reading each column
+	// at the offset fields gives it in a record, one column at a time.
+	void AppendRecords(const std::vector<Column>& fields, char* const* recPtrs, int n);
+
+	// Writes the row as a record of its columns back to back.
+	void GetRecord(int row, char* recPtr) const;
+
+	// Keeps the rows whose keep flag is set, in order.
+	void Select(const std::vector<char>& keep);
+
+	// Keeps the first n rows.
+	void Truncate(int n) { if (n < numOfRows) numOfRows = n; }
+
+	// Copies column from of batch in to column to of this batch, which must
+	// be of the same length; this batch takes the row count of in.
+	void CopyColumn(int to, const Batch& in, int from);
+
+private:
+
+	int numOfRows;
+	std::vector<Column> columns;
+	std::vector<std::vector<char> > data;   // BATCH_ROWS values a column.
+};
+
+//
+// An operator of a query plan, pulled by its parent a batch at a time:
+// Open, Next until DONE, Close.  An operator does not own its children;
+// Open and Close open and close them.
+//
+// Every operator counts the rows and batches it returns and the time its
+// Open, Next and Close take, its children's included, both for Explain and
+// as the metrics operator.<name>.rows and operator.<name>.next (the
+// nanoseconds of each Next).
+//
+class Operator
+{
+public:
+
+	Operator(const char* name);
+	virtual ~Operator() {}
+
+	Status Open();
+
+	// Fills batch with the next rows, at least one; DONE after the last.
+	Status Next(Batch& batch);
+
+	Status Close();
+
+	// Columns of the rows returned, offsets as in a row written out as a
+	// record (Batch::GetRecord), which is GetRowLength bytes long.
+	const std::vector<Column>& GetSchema() const { return schema; }
+	int GetRowLength() const;
+
+	long GetNumOfRows() const    { return numOfRows; }
+	long GetNumOfBatches() const { return numOfBatches; }
+	long GetNanoseconds() const  { return nanoseconds; }
+
+	// Writes the plan rooted at the operator, one line an operator with its
+	// rows, batches and time, its own and with its children's.
+	void Explain(std::ostream& out, int indent = 0) const;
+
+protected:
+
+	virtual Status DoOpen() = 0;
+	virtual Status DoNext(Batch& batch) = 0;
+	virtual Status DoClose() = 0;
+
+	// Sets the schema to the columns given, offsets made back to back.
+	void SetSchema(const std::vector<Column>& columns);
+
+	std::string name;
+	std::vector<Column> schema;
+	std::vector<Operator*> children;
+
+private:
+
+	long numOfRows;
+	long numOfBatches;
+	long nanoseconds;
+
+	Counter   *rows;
+	Histogram *nextTimes;
+};
+
+//
+// Reads the records of a scan into batches, each record giving a row of
+// the columns at their offsets.
+//
+class BatchReader
+{
+public:
+
+	BatchReader() : scan(NULL), next(0) {}
+	~BatchReader() { Close(); }
+
+	Status Open(HeapFile& file, const std::vector<Column>& columns);
+	Status Read(Batch& batch);
+	void   Close();
+
+private:
+
+	Scan *scan;
+	std::vector<Column> columns;
+	int recLen;                      // bytes a record must have.
+	std::vector<char*> recPtrs;      // of the scan's current page.
+	std::vector<int>   recLens;
+	size_t next;
+};
+
+// Scans a heap file, each record giving a row of the columns read at their
+// offsets.
+class ScanOperator : public Operator
+{
+public:
+
+	ScanOperator(HeapFile& file, const std::vector<Column>& columns);
+
+protected:
+
+	Status DoOpen();
+	Status DoNext(Batch& batch);
+	Status DoClose();
+
+private:
+
+	HeapFile            *file;
+	std::vector<Column> columns;
+	BatchReader         reader;
+};
+
+// Passes on the rows whose column col compares to value by op, aopEQ to
+// aopGE.
+class FilterOperator : public Operator
+{
+public:
+
+	FilterOperator(Operator& child, int col, AttrOperator op, const char* value);
+
+protected:
+
+	Status DoOpen();
+	Status DoNext(Batch& batch);
+	Status DoClose();
+
+private:
+
+	Operator          *child;
+	int               col;
+	AttrOperator      op;
+	std::vector<char> value;
+	std::vector<char> keep;
+};
+
+// Passes on the columns cols of each row, in that order.
+class ProjectOperator : public Operator
+{
+public:
+
+	ProjectOperator(Operator& child, const std::vector<int>& cols);
+
+protected:
+
+	Status DoOpen();
+	Status DoNext(Batch& batch);
+	Status DoClose();
+
+private:
+
+	Operator         *child;
+	std::vector<int> cols;
+	Batch            in;
+};
+
+// Passes on the first limit rows, pulling no more from the child.
+class LimitOperator : public Operator
+{
+public:
+
+	LimitOperator(Operator& child, long limit);
+
+protected:
+
+	Status DoOpen();
+	Status DoNext(Batch& batch);
+	Status DoClose();
+
+private:
+
+	Operator *child;
+	long     limit;
+	long     passed;
+};
+
+//
+// Sorts the rows on column col with an ExternalSort in numOfFrames frames.
+// Open writes the rows of the child to a temporary file and sorts it into
+// another, which Next reads.
+//
+class SortOperator : public Operator
+{
+public:
+
+	SortOperator(Operator& child, int col, TupleOrder order, int numOfFrames);
+	~SortOperator();
+
+protected:
+
+	Status DoOpen();
+	Status DoNext(Batch& batch);
+	Status DoClose();
+
+private:
+
+	Operator   *child;
+	int        col;
+	TupleOrder order;
+	int        numOfFrames;
+	HeapFile   *sorted;
+	BatchReader reader;
+};
+
+//
+// Joins the rows of left and right whose columns leftCol and rightCol are
+// equal, with a HashJoin in numOfFrames frames building on left.  A row of
+// the join is the columns of the left row followed by those of the right.
+// Open writes both inputs to temporary files and joins them into another,
+// which Next reads.
+//
+class JoinOperator : public Operator
+{
+public:
+
+	JoinOperator(Operator& left, Operator& right, int leftCol, int rightCol,
+	             int numOfFrames);
+	~JoinOperator();
+
+protected:
+
+	Status DoOpen();
+	Status DoNext(Batch& batch);
+	Status DoClose();
+
+private:
+
+	Operator   *left;
+	Operator   *right;
+	int        leftCol;
+	int        rightCol;
+	int        numOfFrames;
+	HeapFile   *joined;
+	BatchReader reader;
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef _RECOVERY_H
+#define _RECOVERY_H
+
+#include <vector>
+#include <map>
+
+#include "minirel.h"
+#include "logmgr.h"
+
+class HeapPage;
+
+//
+// Brings the database back to its last committed state when it is opened,
+// in three passes over the log:
+//
+//   analysis - from the last checkpoint, rebuilds the dirty page table and
+//              finds the last commit;
+//   redo     - from the oldest change a dirty page may have lost, repeats
+//              history: a heap record is applied only if the page LSN is
+//              older than the record, page images and page inits always are;
+//   undo     - rolls back every heap change after the last commit, newest
+//              first, logging each undo as a compensation record so that a
+//              crash during restart never undoes anything twice.
+//
+// Page allocation and directory structure are logged as page images and are
+// never undone.  A change to a page that was freed or reinitialized later is
+// therefore not undone either: the page no longer holds what it describes.
+//
+// Undo goes by the last commit, whichever transaction it was of; changes
+// logged before it stay, including those of versioned transactions that were
+// still running.  Commits of transactions name them, so restart then logs
+// every transaction of the run that did not commit as aborted (see TxnMgr).
+//
+// Index changes are logged only as page images, so indexes come back as they
+// were at the crash, not in step with the heap files restart undoes changes
+// to.  Rather than log them record by record, restart notes in the log that
+// it changed the database (LogMgr::SetRecovered): every index built before is
+// then stale, and is rebuilt from its file when attached to it again (see
+// Index::IsStale).  Attachments are not kept on disk, so restart could not
+// reach the indexes itself.
+//
+class RecoveryMgr
+{
+public:
+
+	RecoveryMgr(LogMgr* log);
+
+	Status Recover();
+	void GetStat(long& redoNo, long& undoNo);
+
+private:
+
+	// What analysis keeps of each record it reads.
+	struct RecordInfo
+	{
+		LSN    lsn;
+		LSN    undone;
+		short  type;
+	};
+
+	Status Analysis();
+	Status Redo();
+	Status Undo();
+	Status EndRun();
+
+	Status RedoRecord(const LogRecord& rec, const char* data);
+	Status UndoRecord(const LogRecord& rec, const char* data);
+	Status FixDirEntry(PageID dirPid, PageID pid, HeapPage* page, LSN lsn);
+
+	bool InDirtyPages(PageID pid, LSN lsn);
+	bool ResetAfter(PageID pid, LSN lsn);
+	bool GoneAfter(const LogRecord& rec, const char* data);
+
+	LogMgr* log;
+
+	std::vector<RecordInfo> records;     // every record analysis read.
+	std::map<PageID, LSN> dirtyPages;    // page -> LSN of its oldest lost change.
+	std::map<PageID, LSN> lastReset;     // page -> its last init, image or free.
+	LSN lastCommitLSN;
+
+	long numOfRedos;
+	long numOfUndos;
+};
+
+#endif
@@ -1,42 +1,74 @@
-/* -*- C++ -*- */
-/* 
- * scan.h -  class Scan
- */
-
-#ifndef _SCAN_H_
-#define _SCAN_H_
-
-
-#include "minirel.h"
-#include "dirpage.h"
-#include "heappage.h"
-
-class HeapFile;
-class HeapPage;
-
-class Scan
-{
-public:
-
-  Scan(HeapFile* hf, Status& status);
-  ~Scan();
-
-  Status GetNext(RecordID& rid, char* recPtr, int& recLen );
-  Status MoveTo(RecordID rid);
-
-private:
-
-	PageID currDirPid;
-	PageID firstDirPid;
-	DirPage *dirPage;
-	int currEntry;
-
-	PageID currPid;
-	HeapPage *page;
-
-	RecordID currRid;
-
-	bool noMore;
-};
-
-#endif
+/* -*- C++ -*- */
+/* 
+ * scan.h -  class Scan
+ */
+
+#ifndef _SCAN_H_
+#define _SCAN_H_
+
+
+#include <vector>
+
+#include "minirel.h"
+#include "dirpage.h"
+#include "heappage.h"
+#include "mvcc.h"
+#include "ioservice.h"
+
+class HeapFile;
+class HeapPage;
+class Counter;
+
+class Scan
+{
+public:
+
+  Scan(HeapFile* hf, Status& status);
+  Scan(HeapFile* hf, const Snapshot& snapshot, Status& status);
+  ~Scan();
+
+  Status GetNext(RecordID& rid, char* recPtr, int& recLen );
+
+  // GetNext without waiting for the disk, as HeapFile::GetRecordAsync;
+  // rid and recPtr must stay valid, and the scan must not be used, until
+  // done is called.  Done is then called with DONE when the scan is over.
+  void GetNextAsync(RecordID& rid, char* recPtr, ReadCallback done);
+  Status MoveTo(RecordID rid);
+
+  // Gives the records of the rest of the current data page at once,
+  // without copying them: they point into the page, which stays pinned
+  // until the next call to the scan, except for records moved to other
+  // pages, which are copied.  DONE when the scan is over.
+  Status GetNextBatch(std::vector<char*>& recPtrs, std::vector<int>& recLens);
+
+private:
+
+	void   Open(HeapFile* hf, Status& status);
+	Status NextRecord(RecordID& rid, char* recPtr, int& recLen);
+	Status NextPage();
+	bool   NextIsOnPage();
+	PageID NextListedPage();
+
+	HeapFile *file;
+	bool     versioned;          // scanning the snapshot's versions.
+	Snapshot snapshot;
+	std::vector<char> version;   // the record read, while versioned.
+	std::vector<std::vector<char> > moved;   // copies GetNextBatch returned.
+
+	PageID currDirPid;
+	PageID firstDirPid;
+	DirPage *dirPage;
+	int currEntry;
+
+	PageID currPid;
+	HeapPage *page;
+
+	RecordID currRid;
+
+	bool noMore;
+	bool pageUsedUp;       // GetNextBatch returned the rest of the page.
+
+	Counter *records;      // records returned, counted for the file.
+};
+
+#endif
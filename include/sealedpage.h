@@ -0,0 +1,95 @@
+#ifndef SEALEDPAGE_H
+#define SEALEDPAGE_H
+
+#include "minirel.h"
+#include "page.h"
+#include "heappage.h"
+
+//
+// Describes one fixed-position attribute of the records on a page.  Columns
+// handed to SealedPage::Seal must be sorted by offset and must not overlap.
+//
+struct ColumnDesc
+{
+	short    offset;     // offset of the attribute from the start of the record.
+	short    length;     // length of the attribute in bytes.
+	AttrType type;       // attrInteger uses frame-of-reference, attrString uses
+	                     // a dictionary, everything else is stored as is.
+};
+
+const int MAX_SEALED_COLUMNS = 8;
+
+//
+// CHANGE this constant whenever you update the structure of SealedPage class.
+//
+const int SEALEDPAGE_DATA_SIZE = (MAX_SPACE - sizeof(LSN) - 3*sizeof(PageID) - 6*sizeof(short)
+                                  - MAX_SEALED_COLUMNS*(3*sizeof(short) + 2*sizeof(char) + sizeof(int)));
+
+//
+// A read-only, compressed image of a HeapPage holding fixed-length records.
+// Record IDs are preserved, so a sealed page can stand in for the heap page
+// it was built from; records are decoded one at a time by GetRecord, or the
+// whole page is restored by Unseal.
+//
+// Sealing is done in memory only: the buffer manager neither writes sealed
+// images to disk nor pins them, so a page is sealed and read back by whoever
+// holds the image.  Keeping sealed pages in the pool and on disk, and
+// unsealing them in PinPage, is not done here.
+//
+class SealedPage {
+
+protected :
+
+	struct Block
+	{
+		short colOffset;     // offset of the attribute within the record.
+		short colLength;     // length of the attribute.
+		short dataOffset;    // offset of the encoded column in data.
+		char  encoding;      // one of the SEAL_* encodings below.
+		char  width;         // bits per packed value (FOR and DICT only).
+		int   base;          // FOR: reference value, DICT: number of entries.
+	};
+
+	LSN     lsn;         // LSN copied from the sealed page.
+	PageID  pid;         // Page ID of the page that was sealed.
+	PageID  nextPage;    // Links copied from the sealed page.
+	PageID  prevPage;
+
+	short   numOfSlots;     // Slots of the original page (filled or empty).
+	short   numOfRecords;   // Number of filled slots.
+	short   recLen;         // Length shared by every record on the page.
+	short   numOfCols;      // Number of entries used in blocks.
+	short   residualOffset; // Offset in data of the bytes no column covers.
+	short   dataLen;        // Number of bytes of data in use.
+
+	Block   blocks[MAX_SEALED_COLUMNS];
+
+	char    data[SEALEDPAGE_DATA_SIZE];
+
+	                     // Bitmap of filled slots, followed by one encoded
+	                     // block per column, followed by the residual bytes
+	                     // of every record.
+
+	int  Rank(int slotNo);
+	void DecodeRecord(int rank, char* recPtr);
+
+public:
+
+	Status Seal(HeapPage* page, const ColumnDesc* cols, int numOfCols);
+	Status Unseal(HeapPage* page);
+
+	PageID PageNo() { return pid; }
+	PageID GetNextPage() { return nextPage; }
+	PageID GetPrevPage() { return prevPage; }
+	Status FirstRecord(RecordID& firstRid);
+	Status NextRecord (RecordID curRid, RecordID& nextRid);
+	Status GetRecord(RecordID rid, char* recPtr, int& recLen);
+	int    GetNumOfRecords() { return numOfRecords; }
+	int    SealedSize();
+};
+
+#define SEAL_RAW   0
+#define SEAL_FOR   1
+#define SEAL_DICT  2
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef _SORT_H
+#define _SORT_H
+
+#include <vector>
+
+#include "minirel.h"
+#include "page.h"
+#include "spill.h"
+
+class HeapFile;
+
+//
+// An external merge sort of the records of a heap file on one attribute,
+// the key described as for Index.  It works in a fixed number of frames
+// taken from the buffer pool (BufMgr::GetWorkFrames) for as long as it
+// runs, however large the file:
+//
+// - Records are read through a Scan into all frames but one and sorted
+//   there; each frameful is written out as a run, using the last frame as
+//   the output page.  Runs are spilled (see SpillRun), and each page is
+//   freed as soon as a merge has read it back.
+// - Runs are merged numOfFrames - 1 at a time with a loser tree, one frame
+//   reading each run and one writing, in as many passes as it takes; the
+//   last pass inserts the records into the output file.  A file that fits
+//   in memory is never written as a run.
+//
+// Records with equal keys keep the order the scan gave them.
+//
+class ExternalSort
+{
+public:
+
+	// numOfFrames is the memory of the sort, at least 3 frames.
+	ExternalSort(int keyOffset, AttrType keyType, int keyLength,
+	             TupleOrder order, int numOfFrames);
+
+	// Appends the records of in to out in order, so that a scan of an out
+	// that was empty sees them sorted.  out may be a temporary file
+	// (HeapFile(NULL, status)).
+	Status Run(HeapFile& in, HeapFile& out);
+
+	// Of the last Run: runs generated from the input, none if it fit in
+	// memory, and passes over the data, counting the one reading it.
+	int GetNumOfRuns()   { return numOfRuns; }
+	int GetNumOfPasses() { return numOfPasses; }
+
+private:
+
+	struct SortRecord
+	{
+		char *recPtr;
+		int  recLen;
+	};
+
+	int        keyOffset;
+	AttrType   keyType;
+	int        keyLength;
+	TupleOrder order;
+	int        numOfFrames;
+
+	int numOfRuns;
+	int numOfPasses;
+
+	std::vector<Page*> frames;
+	SpillSpace         space;
+
+	bool   Less(const char* a, const char* b) const;
+	void   SortRecords(std::vector<SortRecord>& recs);
+	Status MakeRuns(HeapFile& in, HeapFile& out, std::vector<SpillRun>& runs);
+	Status WriteRun(std::vector<SortRecord>& recs, std::vector<SpillRun>& runs);
+	Status Merge(std::vector<SpillRun>& runs, size_t first, size_t n,
+	             SpillWriter* writer, HeapFile* out);
+};
+
+#endif
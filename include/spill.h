@@ -0,0 +1,113 @@
+#ifndef _SPILL_H
+#define _SPILL_H
+
+#include <vector>
+
+#include "minirel.h"
+#include "page.h"
+
+class HeapPage;
+
+// Pages spilled data is allocated in at a time, so that a run is written
+// and read back sequentially.
+#define SPILL_EXTENT_SIZE 64
+
+//
+// Records an operator such as a sort or a join spills to disk when its
+// frames are full: a run of heap-page-format pages written once in order,
+// straight to the database, neither buffered nor logged, and read back
+// through a frame of the operator's own.  Nothing outlives the operator,
+// so restart never sees a run.
+//
+struct SpillRun
+{
+	std::vector<PageID> pages;   // in order; INVALID_PAGE once freed.
+
+	// Frees the pages still held.
+	void Free();
+};
+
+//
+// Hands out the pages of the runs of one operator from an extent at a
+// time, so that a run takes only the pages it needs yet most of them are
+// contiguous.  What is left of the extent is given back by Release.
+//
+class SpillSpace
+{
+public:
+
+	SpillSpace() : extentNext(INVALID_PAGE), extentEnd(INVALID_PAGE) {}
+	~SpillSpace() { Release(); }
+
+	Status NewPage(PageID& pid);
+	void   FreePage(PageID pid);
+	void   Release();
+
+private:
+
+	PageID extentNext;
+	PageID extentEnd;
+};
+
+//
+// Writes a run page by page through one frame.
+//
+class SpillWriter
+{
+public:
+
+	SpillWriter(SpillSpace& space, Page* frame);
+
+	Status Begin(SpillRun* run);
+	Status Append(const char* recPtr, int recLen);
+	Status End();
+
+	// Between Begin and End.
+	bool IsOpen() const { return pid != INVALID_PAGE; }
+
+private:
+
+	SpillSpace *space;
+	HeapPage   *page;
+	SpillRun   *run;
+	PageID     pid;
+
+	Status StartPage();
+};
+
+//
+// Reads a run back through one frame, a page at a time; recPtr points into
+// the frame until the next Advance.  A reader that frees the run does so a
+// page at a time as it goes, so a merge needs little more space than its
+// output.
+//
+class SpillReader
+{
+public:
+
+	SpillReader(Page* frame, SpillRun* run, bool freeRun = true);
+
+	// Read the first record and then the next; done is set after the last.
+	Status Start();
+	Status Advance();
+
+	// Or reads the records of the next page at once, pointing into the
+	// frame; DONE after the last page.
+	Status GetNextBatch(std::vector<char*>& recPtrs, std::vector<int>& recLens);
+
+	bool done;
+	char *recPtr;
+	int  recLen;
+
+private:
+
+	HeapPage *page;
+	SpillRun *run;
+	bool     freeRun;
+	size_t   nextPage;
+	RecordID rid;
+
+	Status ReadPage();
+};
+
+#endif
@@ -1,50 +1,77 @@
-// -*- C++ -*-
-/* This file declares TestDriver, a base class for various test driver
-   objects. */
-#ifndef _TEST_DRIVER_H_
-#define _TEST_DRIVER_H_
-
-#include "minirel.h"
-extern "C" int unlink( const char* ) noexcept;
-
-class TestDriver
-{
-public:
-      // This runs a series of tests.  If it returns OK, then everything worked
-      // as advertised.  Otherwise, there were errors reported.
-    virtual Status RunTests();
-
-
-protected:
-      // This constructs the tester.  You supply a name like "dbtest" as the
-      // root of the database and log file names.
-    TestDriver( const char* nameRoot );
-    virtual ~TestDriver();
-
-    char* dbpath;
-    char* logpath;
-
-      // Subclasses override these tests.
-    virtual bool Test1();
-    virtual bool Test2();
-    virtual bool Test3();
-    virtual bool Test4();
-    virtual bool Test5();
-    virtual bool Test6();
-
-      // ...and this method, which is printed as the kind of test being done,
-      // for example "Disk Space Management".
-    virtual const char* TestName();
-
-    void TestFailure( Status& status, Status expectedStatus,
-                      const char* activity, int postedErrExpected = true );
-
-    typedef int (TestDriver::*testFunction)();
-    virtual void RunTest( Status& status, testFunction test );
-
-    virtual Status RunAllTests();
-};
-
-
-
-#endif
+// -*- C++ -*-
+/* This file declares TestDriver, a base class for various test driver
+   objects. */
+#ifndef _TEST_DRIVER_H_
+#define _TEST_DRIVER_H_
+
+#include "minirel.h"
+extern "C" int unlink( const char* ) noexcept;
+
+class TestDriver
+{
+public:
+      // This runs a series of tests.  If it returns OK, then everything worked
+      // as advertised.  Otherwise, there were errors reported.
+    virtual Status RunTests();
+
+
+protected:
+      // This constructs the tester.  You supply a name like "dbtest" as the
+      // root of the database and log file names.
+    TestDriver( const char* nameRoot );
+    virtual ~TestDriver();
+
+    char* dbpath;
+    char* logpath;
+
+      // Subclasses override these tests.
+    virtual bool Test1();
+    virtual bool Test2();
+    virtual bool Test3();
+    virtual bool Test4();
+    virtual bool Test5();
+    virtual bool Test6();
+    virtual bool Test7();
+    virtual bool Test8();
+    virtual bool Test9();
+    virtual bool Test10();
+    virtual bool Test11();
+    virtual bool Test12();
+    virtual bool Test13();
+    virtual bool Test14();
+    virtual bool Test15();
+    virtual bool Test16();
+    virtual bool Test17();
+    virtual bool Test18();
+    virtual bool Test19();
+    virtual bool Test20();
+    virtual bool Test21();
+    virtual bool Test22();
+    virtual bool Test23();
+    virtual bool Test24();
+    virtual bool Test25();
+    virtual bool Test26();
+    virtual bool Test27();
+    virtual bool Test28();
+    virtual bool Test29();
+    virtual bool Test30();
+    virtual bool Test31();
+    virtual bool Test32();
+    virtual bool Test33();
+
+      // ...and this method, which is printed as the kind of test being done,
+      // for example "Disk Space Management".
+    virtual const char* TestName();
+
+    void TestFailure( Status& status, Status expectedStatus,
+                      const char* activity, int postedErrExpected = true );
+
+    typedef int (TestDriver::*testFunction)();
+    virtual void RunTest( Status& status, testFunction test );
+
+    virtual Status RunAllTests();
+};
+
+
+
+#endif
@@ -0,0 +1,462 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "aggregate.h"
+#include "index.h"
+#include "heapfile.h"
+#include "scan.h"
+#include "bufmgr.h"
+
+//
+// Head of a slot of the group table, followed by the key and then the
+// accumulators.
+//
+struct AggSlot
+{
+	unsigned hash;
+	int      used;
+};
+
+
+//------------------------------------------------------------------
+// Constructor of Aggregate
+//
+// Input    : groupOffset, groupType, groupLength - the key to group by,
+//            or a groupLength of 0 for none,
+//            aggs - the aggregates,
+//            numOfFrames - frames of the buffer pool to work in.
+// Output   : None.
+// Purpose  : Records the aggregation; Run checks it.
+//------------------------------------------------------------------
+
+Aggregate::Aggregate(int groupOffset, AttrType groupType, int groupLength,
+                     const std::vector<AggSpec>& aggs, int numOfFrames)
+	: groupOffset(groupOffset), groupType(groupType), groupLength(groupLength),
+	  aggs(aggs), numOfFrames(numOfFrames), numOfGroups(0), numOfSpilled(0),
+	  depth(0)
+{
+	recLen = (groupLength > 0) ? groupOffset + groupLength : 0;
+	for (size_t a = 0; a < aggs.size(); a++)
+	{
+		if (aggs[a].func != aggCount)
+			recLen = std::max(recLen, aggs[a].offset + aggs[a].length);
+	}
+
+	keyPad = (groupLength + 7) & ~7;
+	slotLen = sizeof(AggSlot) + keyPad + aggs.size() * sizeof(AggAcc);
+	slotsPerFrame = sizeof(Page) / slotLen;
+
+	numOfParts = std::max(1, (numOfFrames - 1) / 2);
+	numOfTableFrames = numOfFrames - 1 - numOfParts;
+	numOfSlots = slotsPerFrame * numOfTableFrames;
+	maxGroups = std::max(1, numOfSlots * AGG_TABLE_FILL / 100);
+	groups = 0;
+}
+
+
+char *Aggregate::Slot(int slot)
+{
+	return (char*)frames[slot / slotsPerFrame] + (slot % slotsPerFrame) * slotLen;
+}
+
+
+Aggregate::AggAcc *Aggregate::Acc(int slot, int agg)
+{
+	return (AggAcc*)(Slot(slot) + sizeof(AggSlot) + keyPad) + agg;
+}
+
+
+//------------------------------------------------------------------
+// Aggregate::Run
+//
+// Input    : in - the file to aggregate.
+// Output   : emit - gets each group, or
+//            result - gets a record for each group.
+// Purpose  : Takes the frames from the buffer pool, aggregates the
+//            file, and gives the frames back.
+// Return   : OK on success, FAIL if the key, an aggregate or the memory
+//            is invalid, the pool has too few unpinned frames, a record
+//            is too short, or I/O fails; what emit returns if not OK.
+//------------------------------------------------------------------
+
+Status Aggregate::Run(HeapFile& in, const AggCallback& emit)
+{
+	numOfGroups = numOfSpilled = depth = 0;
+
+	bool valid = groupLength == 0 || KeyIsValid(groupOffset, groupType, groupLength);
+	for (size_t a = 0; a < aggs.size(); a++)
+	{
+		if (aggs[a].func != aggCount)
+			valid = valid && aggs[a].type != attrString
+			        && KeyIsValid(aggs[a].offset, aggs[a].type, aggs[a].length);
+	}
+	if (!valid || slotsPerFrame == 0)
+	{
+		cerr << "Aggregate::Run - cannot aggregate on the attributes\n";
+		return FAIL;
+	}
+	if (numOfFrames < 3)
+	{
+		cerr << "Aggregate::Run - needs at least 3 frames\n";
+		return FAIL;
+	}
+	if (MINIBASE_BM->GetWorkFrames(numOfFrames, frames) != OK)
+	{
+		cerr << "Aggregate::Run - the pool has not " << numOfFrames
+		     << " unpinned frames\n";
+		return FAIL;
+	}
+
+	Status status = Pass(&in, NULL, 0, emit);
+
+	space.Release();
+	MINIBASE_BM->ReleaseWorkFrames(frames);
+	return status;
+}
+
+
+Status Aggregate::Run(HeapFile& in, HeapFile& result)
+{
+	int valuesLen = aggs.size() * sizeof(double);
+
+	return Run(in, [&](const char* key, const double* values) -> Status
+	{
+		if (groupLength + valuesLen > MAX_SPACE - 1)
+		{
+			cerr << "Aggregate::Run - a group is larger than a page\n";
+			return FAIL;
+		}
+
+		char rec[MAX_SPACE];
+		RecordID rid;
+		if (groupLength > 0)
+			memcpy(rec, key, groupLength);
+		memcpy(rec + groupLength, values, valuesLen);
+		return result.AppendRecord(rec, groupLength + valuesLen, rid);
+	});
+}
+
+
+//------------------------------------------------------------------
+// Aggregate::Pass
+//
+// Input    : file or run - the input, the file or a partition of it,
+//            level - levels of spilling above the input,
+//            emit - gets each group.
+// Output   : None.
+// Purpose  : Aggregates the input into an empty table, a batch at a
+//            time, spilling what does not fit to partitions; gives out
+//            the groups of the table, then aggregates each partition a
+//            level down.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status Aggregate::Pass(HeapFile* file, SpillRun* run, int level, const AggCallback& emit)
+{
+	Status status = OK;
+	depth = std::max(depth, level);
+
+	for (int i = 0; i < numOfTableFrames; i++)
+		memset((char*)frames[i], 0, sizeof(Page));
+	groups = 0;
+
+	// Without grouping the one group exists even if there are no records.
+	if (groupLength == 0 && level == 0)
+		FindSlot(0, NULL);
+
+	std::vector<SpillRun> parts(numOfParts);
+	std::vector<SpillWriter> writers;
+	for (int p = 0; p < numOfParts; p++)
+		writers.push_back(SpillWriter(space, frames[numOfTableFrames + p]));
+
+	Batch batch;
+	if (file != NULL)
+	{
+		Scan *scan = file->OpenScan(status);
+		while (status == OK && (status = scan->GetNextBatch(batch.recPtrs, batch.recLens)) == OK)
+			status = Consume(batch, level, writers, parts);
+		delete scan;
+	}
+	else
+	{
+		SpillReader reader(frames[numOfFrames - 1], run);
+		while ((status = reader.GetNextBatch(batch.recPtrs, batch.recLens)) == OK)
+		{
+			status = Consume(batch, level, writers, parts);
+			if (status != OK)
+				break;
+		}
+	}
+	if (status == DONE)
+		status = OK;
+
+	for (int p = 0; p < numOfParts; p++)
+	{
+		Status endStatus = writers[p].End();
+		if (status == OK)
+			status = endStatus;
+	}
+
+	if (status == OK)
+		status = EmitGroups(emit);
+
+	for (int p = 0; p < numOfParts; p++)
+	{
+		if (status == OK && !parts[p].pages.empty())
+			status = Pass(NULL, &parts[p], level + 1, emit);
+		parts[p].Free();
+	}
+
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// Aggregate::Consume
+//
+// Input    : batch - records to aggregate,
+//            level - levels of spilling above them,
+//            writers - the writers of the partitions of this level.
+// Output   : parts - the partitions, begun by the first record spilled.
+// Purpose  : Hashes the keys of the batch, finds or adds their groups,
+//            spills the records whose group has no room, and folds each
+//            aggregate over the rest.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status Aggregate::Consume(Batch& batch, int level, std::vector<SpillWriter>& writers,
+                          std::vector<SpillRun>& parts)
+{
+	int n = batch.recPtrs.size();
+	if (n == 0)
+		return OK;
+	char **recPtrs = &batch.recPtrs[0];
+
+	batch.hashes.resize(n);
+	batch.slots.resize(n);
+	batch.values.resize(n);
+	unsigned *hashes = &batch.hashes[0];
+	int *slots = &batch.slots[0];
+	double *values = &batch.values[0];
+
+	for (int i = 0; i < n; i++)
+	{
+		if (batch.recLens[i] < recLen)
+		{
+			cerr << "Aggregate::Run - a record is too short\n";
+			return FAIL;
+		}
+	}
+
+	if (groupLength > 0)
+	{
+		for (int i = 0; i < n; i++)
+			hashes[i] = HashKey(groupType, groupLength, recPtrs[i] + groupOffset);
+	}
+	else
+		memset(hashes, 0, batch.hashes.size() * sizeof(unsigned));
+
+	for (int i = 0; i < n; i++)
+	{
+		slots[i] = FindSlot(hashes[i], recPtrs[i] + groupOffset);
+		if (slots[i] >= 0)
+			continue;
+
+		// The table is full; the record goes to a partition picked by
+		// another hash for each level.
+
+		unsigned h = hashes[i] ^ ((level + 1) * 0x9e3779b9u);
+		h ^= h >> 16;
+		h *= 0x85ebca6b;
+		h ^= h >> 13;
+		int p = h % numOfParts;
+
+		if (!writers[p].IsOpen() && writers[p].Begin(&parts[p]) != OK)
+			return FAIL;
+		if (writers[p].Append(recPtrs[i], batch.recLens[i]) != OK)
+			return FAIL;
+		numOfSpilled++;
+	}
+
+	for (size_t a = 0; a < aggs.size(); a++)
+	{
+		const AggSpec& agg = aggs[a];
+
+		if (agg.func != aggCount)
+		{
+			if (agg.type == attrInteger)
+			{
+				for (int i = 0; i < n; i++)
+				{
+					int v;
+					memcpy(&v, recPtrs[i] + agg.offset, sizeof(int));
+					values[i] = v;
+				}
+			}
+			else if (agg.length == sizeof(double))
+			{
+				for (int i = 0; i < n; i++)
+					memcpy(&values[i], recPtrs[i] + agg.offset, sizeof(double));
+			}
+			else
+			{
+				for (int i = 0; i < n; i++)
+				{
+					float v;
+					memcpy(&v, recPtrs[i] + agg.offset, sizeof(float));
+					values[i] = v;
+				}
+			}
+		}
+
+		switch (agg.func)
+		{
+		case aggCount :
+			for (int i = 0; i < n; i++)
+				if (slots[i] >= 0)
+					Acc(slots[i], a)->count++;
+			break;
+		case aggSum :
+		case aggAvg :
+			for (int i = 0; i < n; i++)
+			{
+				if (slots[i] < 0)
+					continue;
+				AggAcc *acc = Acc(slots[i], a);
+				acc->value += values[i];
+				acc->count++;
+			}
+			break;
+		case aggMin :
+			for (int i = 0; i < n; i++)
+			{
+				if (slots[i] < 0)
+					continue;
+				AggAcc *acc = Acc(slots[i], a);
+				acc->value = std::min(acc->value, values[i]);
+				acc->count++;
+			}
+			break;
+		case aggMax :
+			for (int i = 0; i < n; i++)
+			{
+				if (slots[i] < 0)
+					continue;
+				AggAcc *acc = Acc(slots[i], a);
+				acc->value = std::max(acc->value, values[i]);
+				acc->count++;
+			}
+			break;
+		}
+	}
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// Aggregate::FindSlot
+//
+// Input    : hash - the hash of the key,
+//            key - the key, ignored without grouping.
+// Output   : None.
+// Purpose  : Probes the table linearly from the slot the hash picks
+//            for the group of the key, adding the group in the first
+//            free slot if it is not there and the table has room.
+// Return   : The slot of the group, -1 if it has none and cannot.
+//------------------------------------------------------------------
+
+int Aggregate::FindSlot(unsigned hash, const char* key)
+{
+	int slot = hash % numOfSlots;
+
+	for (;;)
+	{
+		AggSlot *head = (AggSlot*)Slot(slot);
+
+		if (!head->used)
+		{
+			if (groups == maxGroups)
+				return -1;
+
+			head->used = 1;
+			head->hash = hash;
+			if (groupLength > 0)
+				memcpy(head + 1, key, groupLength);
+			for (size_t a = 0; a < aggs.size(); a++)
+			{
+				AggAcc *acc = Acc(slot, a);
+				acc->count = 0;
+				if (aggs[a].func == aggMin)
+					acc->value = std::numeric_limits<double>::infinity();
+				else if (aggs[a].func == aggMax)
+					acc->value = -std::numeric_limits<double>::infinity();
+				else
+					acc->value = 0;
+			}
+			groups++;
+			return slot;
+		}
+
+		if (head->hash == hash && (groupLength == 0
+		    || CompareKeys(groupType, groupLength, (char*)(head + 1), key) == 0))
+			return slot;
+
+		if (++slot == numOfSlots)
+			slot = 0;
+	}
+}
+
+
+//------------------------------------------------------------------
+// Aggregate::EmitGroups
+//
+// Input    : emit - gets each group.
+// Output   : None.
+// Purpose  : Finishes the aggregates of every group of the table and
+//            gives the groups out in the order of their slots.
+// Return   : OK, or what emit returns if not OK.
+//------------------------------------------------------------------
+
+Status Aggregate::EmitGroups(const AggCallback& emit)
+{
+	std::vector<double> values(aggs.size());
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	for (int slot = 0; slot < numOfSlots; slot++)
+	{
+		AggSlot *head = (AggSlot*)Slot(slot);
+		if (!head->used)
+			continue;
+
+		for (size_t a = 0; a < aggs.size(); a++)
+		{
+			AggAcc *acc = Acc(slot, a);
+			switch (aggs[a].func)
+			{
+			case aggCount :
+				values[a] = acc->count;
+				break;
+			case aggSum :
+				values[a] = acc->value;
+				break;
+			case aggAvg :
+				values[a] = (acc->count > 0) ? acc->value / acc->count : nan;
+				break;
+			case aggMin :
+			case aggMax :
+				values[a] = (acc->count > 0) ? acc->value : nan;
+				break;
+			}
+		}
+
+		Status status = emit((groupLength > 0) ? (char*)(head + 1) : NULL,
+		                     values.empty() ? NULL : &values[0]);
+		if (status != OK)
+			return status;
+		numOfGroups++;
+	}
+
+	return OK;
+}
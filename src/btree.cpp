@@ -0,0 +1,1070 @@
+#include <algorithm>
+#include <cstring>
+
+#include "btree.h"
+#include "heapfile.h"
+#include "heappage.h"
+#include "scan.h"
+#include "bufmgr.h"
+#include "db.h"
+
+#define BTREE_MAGIC 0x42545245
+
+//
+// First page of a B+-tree.
+//
+struct BTreeHeader
+{
+	int    magic;
+	int    keyOffset;
+	int    keyType;
+	int    keyLength;
+	PageID rootPid;
+	int    height;
+	int    numOfEntries;
+	LSN    builtLSN;
+};
+
+
+void BTreePage::Init(short pageType)
+{
+	type = pageType;
+	numOfEntries = 0;
+	prev = INVALID_PAGE;
+	next = INVALID_PAGE;
+	leftmost = INVALID_PAGE;
+}
+
+
+PageID BTreePage::GetChild(int entry, int entryLen)
+{
+	PageID child;
+	memcpy(&child, data + (entry + 1) * entryLen - sizeof(PageID), sizeof(PageID));
+	return child;
+}
+
+
+void BTreePage::InsertEntry(int entry, const char* entryPtr, int entryLen)
+{
+	memmove(data + (entry + 1) * entryLen, data + entry * entryLen,
+	        (numOfEntries - entry) * entryLen);
+	memcpy(data + entry * entryLen, entryPtr, entryLen);
+	numOfEntries++;
+}
+
+
+void BTreePage::RemoveEntry(int entry, int entryLen)
+{
+	numOfEntries--;
+	memmove(data + entry * entryLen, data + (entry + 1) * entryLen,
+	        (numOfEntries - entry) * entryLen);
+}
+
+
+void BTreePage::SetEntries(const char* entries, int n, int entryLen)
+{
+	memcpy(data, entries, n * entryLen);
+	numOfEntries = n;
+}
+
+
+//------------------------------------------------------------------
+// Constructor of BTreeIndex
+//
+// Input    : name - name of the index file,
+//            keyOffset, keyType, keyLength - the key (see Index).
+// Output   : status - OK if the index was opened or created.
+// Purpose  : Opens the index if the database has an entry for it,
+//            and creates it with an empty leaf as root otherwise.
+//------------------------------------------------------------------
+
+BTreeIndex::BTreeIndex(const char* name, int keyOffset, AttrType keyType,
+                       int keyLength, Status& status)
+	: Index(keyOffset, keyType, keyLength)
+{
+	headerPid = INVALID_PAGE;
+	rootPid = INVALID_PAGE;
+	height = 1;
+	numOfEntries = 0;
+	keyPad = (keyLength + 3) / 4 * 4;
+	leafLen = keyPad + sizeof(RecordID);
+	indexLen = leafLen + sizeof(PageID);
+	bulkLoading = false;
+	bulkLeaf = INVALID_PAGE;
+
+	// Splits need room for at least three index entries.
+	if (name == NULL || !KeyIsValid() || 3 * indexLen > (int)BTREE_PAGE_SIZE)
+	{
+		cerr << "BTreeIndex::BTreeIndex - Bad index name or key\n";
+		status = FAIL;
+		return;
+	}
+
+	filename = name;
+	if (MINIBASE_DB->GetFileEntry(name, headerPid) == OK)
+		status = Open();
+	else
+		status = Create(name);
+}
+
+
+BTreeIndex::~BTreeIndex()
+{
+}
+
+
+Status BTreeIndex::Create(const char* name)
+{
+	Page *header;
+	BTreePage *root;
+
+	NEWPAGE(headerPid, header);
+	UNPIN(headerPid, DIRTY);
+
+	NEWPAGE(rootPid, root);
+	root->Init(BTreePage::BTREE_LEAF);
+	UNPIN(rootPid, DIRTY);
+
+	if (WriteHeader() != OK)
+		return FAIL;
+	return MINIBASE_DB->AddFileEntry(name, headerPid);
+}
+
+
+Status BTreeIndex::Open()
+{
+	BTreeHeader *header;
+
+	PIN(headerPid, header);
+
+	if (header->magic != BTREE_MAGIC || header->keyOffset != keyOffset
+	    || header->keyType != keyType || header->keyLength != keyLength)
+	{
+		cerr << "BTreeIndex::Open - " << filename << " is not an index on this key\n";
+		UNPIN(headerPid, CLEAN);
+		return FAIL;
+	}
+
+	rootPid = header->rootPid;
+	height = header->height;
+	numOfEntries = header->numOfEntries;
+	builtLSN = header->builtLSN;
+
+	UNPIN(headerPid, CLEAN);
+	return OK;
+}
+
+
+Status BTreeIndex::WriteHeader()
+{
+	BTreeHeader *header;
+
+	PIN(headerPid, header);
+
+	header->magic = BTREE_MAGIC;
+	header->keyOffset = keyOffset;
+	header->keyType = keyType;
+	header->keyLength = keyLength;
+	header->rootPid = rootPid;
+	header->height = height;
+	header->numOfEntries = numOfEntries;
+	header->builtLSN = builtLSN;
+
+	UNPIN(headerPid, DIRTY);
+	return OK;
+}
+
+
+void BTreeIndex::MakeEntry(char* entry, const char* key, const RecordID& rid)
+{
+	memset(entry, 0, keyPad);
+	memcpy(entry, key, keyLength);
+	memcpy(entry + keyPad, &rid, sizeof(RecordID));
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::Compare
+//
+// Input    : entry - a leaf or index entry,
+//            key - a key,
+//            rid - a record ID, or NULL for one below every other.
+// Output   : None.
+// Purpose  : Orders an entry against a key and record ID.
+// Return   : Less than, equal to or greater than 0 as the entry is.
+//------------------------------------------------------------------
+
+int BTreeIndex::Compare(const char* entry, const char* key, const RecordID* rid) const
+{
+	int c = CompareKeys(entry, key);
+	if (c != 0)
+		return c;
+	if (rid == NULL)
+		return 1;
+
+	RecordID entryRid;
+	memcpy(&entryRid, entry + keyPad, sizeof(RecordID));
+	return (entryRid > *rid) - (entryRid < *rid);
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::LeafPosition
+//
+// Input    : page - a leaf,
+//            key, rid - what to look for (see Compare).
+// Output   : None.
+// Purpose  : Binary search of the leaf.
+// Return   : The first entry not below key and rid, or the number of
+//            entries if there is none.
+//------------------------------------------------------------------
+
+int BTreeIndex::LeafPosition(BTreePage* page, const char* key, const RecordID* rid)
+{
+	int lo = 0, hi = page->GetNumOfEntries();
+
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+		if (Compare(page->GetEntry(mid, leafLen), key, rid) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::ChildOf
+//
+// Input    : page - an index node,
+//            key, rid - what to look for (see Compare).
+// Output   : None.
+// Purpose  : Binary search of the node.
+// Return   : The child that would hold key and rid: that of the last
+//            entry not above them, or the leftmost child.
+//------------------------------------------------------------------
+
+PageID BTreeIndex::ChildOf(BTreePage* page, const char* key, const RecordID* rid)
+{
+	int lo = 0, hi = page->GetNumOfEntries();
+
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+		if (Compare(page->GetEntry(mid, indexLen), key, rid) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return (lo == 0) ? page->GetLeftmost() : page->GetChild(lo - 1, indexLen);
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::FindLeaf
+//
+// Input    : key, rid - what to look for (see Compare), or key NULL
+//            for the leftmost leaf.
+// Output   : leaf - the leaf that would hold key and rid.
+// Purpose  : Walks down from the root.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status BTreeIndex::FindLeaf(const char* key, const RecordID* rid, PageID& leaf)
+{
+	BTreePage *page;
+	PageID pid = rootPid;
+
+	for (;;)
+	{
+		PIN(pid, page);
+		if (page->IsLeaf())
+			break;
+
+		PageID child = (key == NULL) ? page->GetLeftmost() : ChildOf(page, key, rid);
+		UNPIN(pid, CLEAN);
+		pid = child;
+	}
+
+	UNPIN(pid, CLEAN);
+	leaf = pid;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::Insert
+//
+// Input    : key, rid - the entry to add.
+// Output   : None.
+// Purpose  : Adds the entry to its leaf, splitting nodes on the way
+//            back up, and the root too, which adds a level.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status BTreeIndex::Insert(const char* key, const RecordID& rid)
+{
+	std::vector<char> entry(leafLen), upEntry(indexLen);
+	bool split;
+
+	MakeEntry(&entry[0], key, rid);
+	if (InsertInto(rootPid, &entry[0], &upEntry[0], split) != OK)
+		return FAIL;
+
+	if (split)
+	{
+		BTreePage *root;
+		PageID newRootPid;
+
+		NEWPAGE(newRootPid, root);
+		root->Init(BTreePage::BTREE_INDEX);
+		root->SetLeftmost(rootPid);
+		root->InsertEntry(0, &upEntry[0], indexLen);
+		UNPIN(newRootPid, DIRTY);
+
+		rootPid = newRootPid;
+		height++;
+	}
+
+	numOfEntries++;
+	return WriteHeader();
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::InsertInto
+//
+// Input    : pid - root of a subtree,
+//            entry - the leaf entry to add.
+// Output   : upEntry - if the root of the subtree split, the index
+//            entry of the new node,
+//            split - whether it split.
+// Purpose  : Adds the entry to the subtree.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status BTreeIndex::InsertInto(PageID pid, const char* entry, char* upEntry, bool& split)
+{
+	BTreePage *page;
+	RecordID rid;
+
+	memcpy(&rid, entry + keyPad, sizeof(RecordID));
+	split = false;
+
+	PIN(pid, page);
+
+	if (page->IsLeaf())
+	{
+		int pos = LeafPosition(page, entry, &rid);
+		if (!page->IsFull(leafLen))
+		{
+			page->InsertEntry(pos, entry, leafLen);
+			UNPIN(pid, DIRTY);
+			return OK;
+		}
+
+		split = true;
+		return SplitLeaf(pid, page, pos, entry, upEntry);
+	}
+
+	PageID child = ChildOf(page, entry, &rid);
+	UNPIN(pid, CLEAN);
+
+	std::vector<char> childUp(indexLen);
+	bool childSplit;
+	if (InsertInto(child, entry, &childUp[0], childSplit) != OK)
+		return FAIL;
+	if (!childSplit)
+		return OK;
+
+	// The new child goes right after the entry of the one that split.
+
+	PIN(pid, page);
+
+	RecordID upRid;
+	memcpy(&upRid, &childUp[keyPad], sizeof(RecordID));
+	int pos = 0;
+	while (pos < page->GetNumOfEntries()
+	       && Compare(page->GetEntry(pos, indexLen), &childUp[0], &upRid) < 0)
+		pos++;
+
+	if (!page->IsFull(indexLen))
+	{
+		page->InsertEntry(pos, &childUp[0], indexLen);
+		UNPIN(pid, DIRTY);
+		return OK;
+	}
+
+	split = true;
+	return SplitIndex(pid, page, pos, &childUp[0], upEntry);
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::SplitLeaf
+//
+// Input    : pid, page - a full leaf, pinned,
+//            pos, entry - an entry to add at that position.
+// Output   : upEntry - index entry of the new leaf.
+// Purpose  : Moves the upper half of the entries, the new one counted,
+//            to a new leaf linked in after this one.  Unpins the leaf.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status BTreeIndex::SplitLeaf(PageID pid, BTreePage* page, int pos,
+                             const char* entry, char* upEntry)
+{
+	int n = page->GetNumOfEntries();
+	std::vector<char> all((n + 1) * leafLen);
+
+	memcpy(&all[0], page->GetEntry(0, leafLen), pos * leafLen);
+	memcpy(&all[pos * leafLen], entry, leafLen);
+	memcpy(&all[(pos + 1) * leafLen], page->GetEntry(pos, leafLen), (n - pos) * leafLen);
+
+	BTreePage *right;
+	PageID rightPid;
+	int half = (n + 1) / 2;
+
+	NEWPAGE(rightPid, right);
+	right->Init(BTreePage::BTREE_LEAF);
+	right->SetEntries(&all[half * leafLen], n + 1 - half, leafLen);
+	page->SetEntries(&all[0], half, leafLen);
+
+	PageID nextPid = page->GetNextPage();
+	right->SetNextPage(nextPid);
+	right->SetPrevPage(pid);
+	page->SetNextPage(rightPid);
+
+	if (nextPid != INVALID_PAGE)
+	{
+		BTreePage *nextPage;
+		PIN(nextPid, nextPage);
+		nextPage->SetPrevPage(rightPid);
+		UNPIN(nextPid, DIRTY);
+	}
+
+	memcpy(upEntry, right->GetEntry(0, leafLen), leafLen);
+	memcpy(upEntry + leafLen, &rightPid, sizeof(PageID));
+
+	UNPIN(rightPid, DIRTY);
+	UNPIN(pid, DIRTY);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::SplitIndex
+//
+// Input    : pid, page - a full index node, pinned,
+//            pos, entry - an entry to add at that position.
+// Output   : upEntry - index entry of the new node.
+// Purpose  : Moves the entries above the middle one, the new one
+//            counted, to a new node.  The middle entry moves up, and
+//            its child becomes the leftmost of the new node.  Unpins
+//            the node.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status BTreeIndex::SplitIndex(PageID pid, BTreePage* page, int pos,
+                              const char* entry, char* upEntry)
+{
+	int n = page->GetNumOfEntries();
+	std::vector<char> all((n + 1) * indexLen);
+
+	memcpy(&all[0], page->GetEntry(0, indexLen), pos * indexLen);
+	memcpy(&all[pos * indexLen], entry, indexLen);
+	memcpy(&all[(pos + 1) * indexLen], page->GetEntry(pos, indexLen), (n - pos) * indexLen);
+
+	BTreePage *right;
+	PageID rightPid, middleChild;
+	int mid = (n + 1) / 2;
+
+	memcpy(&middleChild, &all[(mid + 1) * indexLen - sizeof(PageID)], sizeof(PageID));
+
+	NEWPAGE(rightPid, right);
+	right->Init(BTreePage::BTREE_INDEX);
+	right->SetLeftmost(middleChild);
+	right->SetEntries(&all[(mid + 1) * indexLen], n - mid, indexLen);
+	page->SetEntries(&all[0], mid, indexLen);
+
+	memcpy(upEntry, &all[mid * indexLen], leafLen);
+	memcpy(upEntry + leafLen, &rightPid, sizeof(PageID));
+
+	UNPIN(rightPid, DIRTY);
+	UNPIN(pid, DIRTY);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::Delete
+//
+// Input    : key, rid - the entry to remove.
+// Output   : None.
+// Purpose  : Removes the entry from its leaf.  The leaf stays even
+//            if it is left empty.
+// Return   : OK on success, DONE if there is no such entry, FAIL
+//            otherwise.
+//------------------------------------------------------------------
+
+Status BTreeIndex::Delete(const char* key, const RecordID& rid)
+{
+	BTreePage *page;
+	PageID pid;
+
+	if (FindLeaf(key, &rid, pid) != OK)
+		return FAIL;
+
+	PIN(pid, page);
+
+	int pos = LeafPosition(page, key, &rid);
+	if (pos == page->GetNumOfEntries()
+	    || Compare(page->GetEntry(pos, leafLen), key, &rid) != 0)
+	{
+		UNPIN(pid, CLEAN);
+		return DONE;
+	}
+
+	page->RemoveEntry(pos, leafLen);
+	UNPIN(pid, DIRTY);
+
+	numOfEntries--;
+	return WriteHeader();
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::Lookup
+//
+// Input    : key - the key to look up.
+// Output   : rids - the record ID of every entry of the key, in
+//            order.
+// Purpose  : Scans the entries equal to the key.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status BTreeIndex::Lookup(const char* key, std::vector<RecordID>& rids)
+{
+	Status status;
+	BTreeScan *scan = OpenScan(aopEQ, key, NULL, status);
+	if (status != OK)
+		return status;
+
+	RecordID rid;
+	rids.clear();
+	while ((status = scan->GetNext(rid)) == OK)
+		rids.push_back(rid);
+	delete scan;
+
+	return (status == DONE) ? OK : status;
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::Build
+//
+// Input    : file - the heap file to index.
+// Output   : None.
+// Purpose  : Reads the entries of every record of the file, sorts
+//            them in memory and loads them in bulk.  An index that
+//            is not empty gets them one at a time instead.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status BTreeIndex::Build(HeapFile& file)
+{
+	if (numOfEntries != 0 || height != 1)
+		return Index::Build(file);
+
+	Status status;
+	Scan *scan = file.OpenScan(status);
+	if (status != OK)
+		return status;
+
+	std::vector<char> entries;
+	char rec[MAX_SPACE];
+	RecordID rid;
+	int len;
+
+	while ((status = scan->GetNext(rid, rec, len)) == OK)
+	{
+		if (keyOffset + keyLength > len)
+		{
+			cerr << "BTreeIndex::Build - record " << rid << " has no key\n";
+			status = FAIL;
+			break;
+		}
+		entries.resize(entries.size() + leafLen);
+		MakeEntry(&entries[entries.size() - leafLen], rec + keyOffset, rid);
+	}
+	delete scan;
+	if (status != DONE)
+		return status;
+
+	int n = entries.size() / leafLen;
+	std::vector<int> order(n);
+	for (int i = 0; i < n; i++)
+		order[i] = i;
+
+	std::sort(order.begin(), order.end(), [&](int a, int b)
+	{
+		RecordID ridB;
+		memcpy(&ridB, &entries[b * leafLen + keyPad], sizeof(RecordID));
+		return Compare(&entries[a * leafLen], &entries[b * leafLen], &ridB) < 0;
+	});
+
+	status = BeginBulkLoad();
+	for (int i = 0; i < n && status == OK; i++)
+	{
+		const char *entry = &entries[order[i] * leafLen];
+		memcpy(&rid, entry + keyPad, sizeof(RecordID));
+		status = BulkAppend(entry, rid);
+	}
+	if (status == OK)
+		status = EndBulkLoad();
+
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::BeginBulkLoad
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Starts a bulk load, which fills the root leaf first.
+// Return   : OK on success, FAIL if the tree is not empty.
+//------------------------------------------------------------------
+
+Status BTreeIndex::BeginBulkLoad()
+{
+	if (bulkLoading || numOfEntries != 0 || height != 1)
+	{
+		cerr << "BTreeIndex::BeginBulkLoad - " << filename << " is not empty\n";
+		return FAIL;
+	}
+
+	bulkLoading = true;
+	bulkLeaf = rootPid;
+	bulkLast.clear();
+	bulkSeps.clear();
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::BulkAppend
+//
+// Input    : key, rid - the next entry, above every one so far.
+// Output   : None.
+// Purpose  : Adds the entry to the leaf being filled, starting a new
+//            leaf when it is BTREE_BULK_FILL percent full.
+// Return   : OK on success, FAIL if the entry is out of order.
+//------------------------------------------------------------------
+
+Status BTreeIndex::BulkAppend(const char* key, const RecordID& rid)
+{
+	if (!bulkLoading)
+		return FAIL;
+
+	std::vector<char> entry(leafLen);
+	MakeEntry(&entry[0], key, rid);
+
+	if (!bulkLast.empty() && Compare(&bulkLast[0], key, &rid) >= 0)
+	{
+		cerr << "BTreeIndex::BulkAppend - entry of record " << rid << " is out of order\n";
+		return FAIL;
+	}
+	bulkLast = entry;
+
+	BTreePage *page;
+	int fill = std::max(1, (int)(BTREE_PAGE_SIZE / leafLen) * BTREE_BULK_FILL / 100);
+
+	PIN(bulkLeaf, page);
+
+	if (page->GetNumOfEntries() >= fill)
+	{
+		BTreePage *newPage;
+		PageID newPid;
+
+		NEWPAGE(newPid, newPage);
+		newPage->Init(BTreePage::BTREE_LEAF);
+		newPage->SetPrevPage(bulkLeaf);
+		page->SetNextPage(newPid);
+		UNPIN(bulkLeaf, DIRTY);
+
+		bulkSeps.insert(bulkSeps.end(), entry.begin(), entry.end());
+		bulkSeps.insert(bulkSeps.end(), (char *)&newPid, (char *)&newPid + sizeof(PageID));
+
+		bulkLeaf = newPid;
+		page = newPage;
+	}
+
+	page->InsertEntry(page->GetNumOfEntries(), &entry[0], leafLen);
+	UNPIN(bulkLeaf, DIRTY);
+
+	numOfEntries++;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::EndBulkLoad
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Builds the index levels over the leaves, one level at a
+//            time from the index entries of the level below, until a
+//            level has a single node, the root.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status BTreeIndex::EndBulkLoad()
+{
+	if (!bulkLoading)
+		return FAIL;
+	bulkLoading = false;
+
+	int fill = std::max(2, (int)(BTREE_PAGE_SIZE / indexLen) * BTREE_BULK_FILL / 100);
+	PageID leftmost = rootPid;
+	std::vector<char> seps;
+	seps.swap(bulkSeps);
+
+	while (!seps.empty())
+	{
+		std::vector<char> upSeps;
+		BTreePage *page;
+		PageID pid;
+		PageID firstPid;
+
+		NEWPAGE(pid, page);
+		page->Init(BTreePage::BTREE_INDEX);
+		page->SetLeftmost(leftmost);
+		firstPid = pid;
+
+		for (size_t s = 0; s < seps.size(); s += indexLen)
+		{
+			const char *sep = &seps[s];
+
+			if (page->GetNumOfEntries() < fill)
+			{
+				page->InsertEntry(page->GetNumOfEntries(), sep, indexLen);
+				continue;
+			}
+
+			// The entry starts a new node, and its key goes up a level.
+
+			UNPIN(pid, DIRTY);
+			NEWPAGE(pid, page);
+			page->Init(BTreePage::BTREE_INDEX);
+			memcpy(&leftmost, sep + leafLen, sizeof(PageID));
+			page->SetLeftmost(leftmost);
+
+			upSeps.insert(upSeps.end(), sep, sep + leafLen);
+			upSeps.insert(upSeps.end(), (char *)&pid, (char *)&pid + sizeof(PageID));
+		}
+		UNPIN(pid, DIRTY);
+
+		leftmost = firstPid;
+		seps.swap(upSeps);
+		height++;
+	}
+
+	rootPid = leftmost;
+	return WriteHeader();
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::OpenScan
+//
+// Input    : op - how keys compare to key; opRANGE for a range,
+//            key, key2 - the bounds; key2 is for opRANGE only.
+// Output   : status - OK if the scan was opened.
+// Purpose  : Opens a scan of the entries in the range.
+// Return   : The scan, or NULL if it could not be opened.
+//------------------------------------------------------------------
+
+BTreeScan* BTreeIndex::OpenScan(AttrOperator op, const char* key, const char* key2,
+                                Status& status)
+{
+	BTreeScan *scan = new BTreeScan(this);
+
+	status = scan->Start(op, key, key2);
+	if (status == OK)
+		return scan;
+
+	delete scan;
+	return NULL;
+}
+
+
+Status BTreeIndex::FreeSubtree(PageID pid)
+{
+	BTreePage *page;
+	std::vector<PageID> children;
+
+	PIN(pid, page);
+	if (!page->IsLeaf())
+	{
+		children.push_back(page->GetLeftmost());
+		for (int i = 0; i < page->GetNumOfEntries(); i++)
+			children.push_back(page->GetChild(i, indexLen));
+	}
+	UNPIN(pid, CLEAN);
+
+	for (size_t i = 0; i < children.size(); i++)
+	{
+		if (FreeSubtree(children[i]) != OK)
+			return FAIL;
+	}
+
+	FREEPAGE(pid);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::DeleteFile
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Frees every node and the header, and removes the index
+//            from the database.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status BTreeIndex::DeleteFile()
+{
+	if (FreeSubtree(rootPid) != OK)
+		return FAIL;
+	FREEPAGE(headerPid);
+
+	rootPid = INVALID_PAGE;
+	numOfEntries = 0;
+
+	return MINIBASE_DB->DeleteFileEntry(filename.c_str());
+}
+
+
+//------------------------------------------------------------------
+// BTreeIndex::Clear
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Deletes the tree and creates it again under its name,
+//            a lone empty leaf.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status BTreeIndex::Clear()
+{
+	if (DeleteFile() != OK)
+		return FAIL;
+
+	height = 1;
+	return Create(filename.c_str());
+}
+
+
+BTreeScan::BTreeScan(BTreeIndex* tree)
+	: tree(tree), currPid(INVALID_PAGE), page(NULL), currEntry(0),
+	  lowInclusive(true), highInclusive(true)
+{
+}
+
+
+BTreeScan::~BTreeScan()
+{
+	if (currPid != INVALID_PAGE)
+		MINIBASE_BM->UnpinPage(currPid, CLEAN);
+}
+
+
+//------------------------------------------------------------------
+// BTreeScan::Start
+//
+// Input    : op, key, key2 - the range (see BTreeIndex::OpenScan).
+// Output   : None.
+// Purpose  : Sets the bounds and pins the leaf that would hold the
+//            first entry of the range, at that entry.
+// Return   : OK on success, FAIL for aopNE or a bad operator.
+//------------------------------------------------------------------
+
+Status BTreeScan::Start(AttrOperator op, const char* key, const char* key2)
+{
+	int keyLength = tree->GetKeyLength();
+
+	switch (op)
+	{
+	case aopEQ :
+	case aopGE :
+	case aopGT :
+	case opRANGE :
+		low.assign(key, key + keyLength);
+		lowInclusive = (op != aopGT);
+		if (op == aopEQ)
+			high = low;
+		else if (op == opRANGE)
+			high.assign(key2, key2 + keyLength);
+		break;
+	case aopLT :
+	case aopLE :
+		high.assign(key, key + keyLength);
+		highInclusive = (op == aopLE);
+		break;
+	case aopNOP :
+		break;
+	default :
+		cerr << "BTreeScan::Start - Unsupported operator " << op << endl;
+		return FAIL;
+	}
+
+	const char *first = low.empty() ? NULL : &low[0];
+	if (tree->FindLeaf(first, NULL, currPid) != OK)
+	{
+		currPid = INVALID_PAGE;
+		return FAIL;
+	}
+
+	if (MINIBASE_BM->PinPage(currPid, (Page *&)page) != OK)
+	{
+		currPid = INVALID_PAGE;
+		return FAIL;
+	}
+
+	currEntry = (first == NULL) ? 0 : tree->LeafPosition(page, first, NULL);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BTreeScan::GetNext
+//
+// Input    : None.
+// Output   : rid - record ID of the next entry in the range,
+//            key - its key, if not NULL.
+// Purpose  : Steps to the next entry, following the leaf links.
+// Return   : OK, DONE after the last entry, FAIL on error.
+//------------------------------------------------------------------
+
+Status BTreeScan::GetNext(RecordID& rid, char* key)
+{
+	int leafLen = tree->leafLen;
+
+	while (currPid != INVALID_PAGE)
+	{
+		if (currEntry == page->GetNumOfEntries())
+		{
+			PageID nextPid = page->GetNextPage();
+			UNPIN(currPid, CLEAN);
+
+			currPid = INVALID_PAGE;
+			currEntry = 0;
+			if (nextPid != INVALID_PAGE)
+			{
+				PIN(nextPid, page);
+				currPid = nextPid;
+			}
+			continue;
+		}
+
+		const char *entry = page->GetEntry(currEntry, leafLen);
+
+		if (!low.empty() && !lowInclusive && tree->CompareKeys(entry, &low[0]) == 0)
+		{
+			currEntry++;
+			continue;
+		}
+
+		if (!high.empty())
+		{
+			int c = tree->CompareKeys(entry, &high[0]);
+			if (c > 0 || (c == 0 && !highInclusive))
+			{
+				UNPIN(currPid, CLEAN);
+				currPid = INVALID_PAGE;
+				break;
+			}
+		}
+
+		memcpy(&rid, entry + tree->keyPad, sizeof(RecordID));
+		if (key != NULL)
+			memcpy(key, entry, tree->GetKeyLength());
+		currEntry++;
+		return OK;
+	}
+
+	return DONE;
+}
+
+
+//------------------------------------------------------------------
+// Constructor of IndexScan
+//
+// Input    : scan - an open B+-tree scan.
+// Output   : status - OK if every entry was read.
+// Purpose  : Collects the record IDs of the scan and sorts them.
+//------------------------------------------------------------------
+
+IndexScan::IndexScan(BTreeScan* scan, Status& status)
+	: currRid(0), currPid(INVALID_PAGE), page(NULL)
+{
+	RecordID rid;
+
+	while ((status = scan->GetNext(rid)) == OK)
+		rids.push_back(rid);
+	delete scan;
+
+	if (status == DONE)
+		status = OK;
+	std::sort(rids.begin(), rids.end());
+}
+
+
+IndexScan::~IndexScan()
+{
+	if (currPid != INVALID_PAGE)
+		MINIBASE_BM->UnpinPage(currPid, CLEAN);
+}
+
+
+//------------------------------------------------------------------
+// IndexScan::GetNext
+//
+// Input    : None.
+// Output   : rid - record ID of the next record,
+//            recPtr - a copy of the record,
+//            recLen - its length.
+// Purpose  : Reads the next record, keeping its page pinned for the
+//            records after it on the same page.
+// Return   : OK, DONE after the last record, FAIL on error.
+//------------------------------------------------------------------
+
+Status IndexScan::GetNext(RecordID& rid, char* recPtr, int& recLen)
+{
+	if (currRid == rids.size())
+	{
+		if (currPid != INVALID_PAGE)
+		{
+			UNPIN(currPid, CLEAN);
+			currPid = INVALID_PAGE;
+		}
+		return DONE;
+	}
+
+	rid = rids[currRid++];
+
+	if (rid.pageNo != currPid)
+	{
+		if (currPid != INVALID_PAGE)
+			UNPIN(currPid, CLEAN);
+		currPid = INVALID_PAGE;
+		PIN(rid.pageNo, page);
+		currPid = rid.pageNo;
+	}
+
+	return page->GetRecord(rid, recPtr, recLen);
+}
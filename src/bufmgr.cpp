@@ -0,0 +1,1603 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <thread>
+
+#include "bufmgr.h"
+#include "dirpage.h"
+#include "logmgr.h"
+#include "metrics.h"
+#include "ioservice.h"
+
+// First word of a page list file.
+#define PAGE_LIST_MAGIC 0x504c5354
+
+// The replacer of the named policy over a pool's frames, NULL if there
+// is no such policy.
+static Replacer *NewReplacer(const char* policy, int numOfFrames, Frame **frames)
+{
+	if (strcmp(policy, "Clock") == 0)
+		return new Clock(numOfFrames, frames);
+	return NULL;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::BufMgr
+//
+// Input    : bufsize - number of frames in the default pool,
+//            policy - its replacement policy; Clock if NULL or
+//            unknown.
+// Output   : None.
+// Purpose  : Sets up the default pool.
+//------------------------------------------------------------------
+
+BufMgr::BufMgr(int bufsize, const char* policy)
+{
+	numOfFrames = 0;
+	numOfSlots = 0;
+	frames = NULL;
+
+	if (policy == NULL)
+		policy = "Clock";
+	if (AddPool("default", bufsize, policy) != OK)
+		AddPool("default", bufsize, "Clock");
+
+	ResetStat();
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::~BufMgr
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Releases the buffer pool.  Pages are not written back;
+//            call FlushAllPages first to keep them.
+//------------------------------------------------------------------
+
+BufMgr::~BufMgr()
+{
+	for (unsigned int i = 0; i < numOfSlots; i++)
+		delete frames[i];
+	free(frames);
+
+	for (size_t i = 0; i < pools.size(); i++)
+	{
+		delete pools[i]->replacer;
+		delete pools[i]->hashTable;
+		free(pools[i]->frames);
+		free(pools[i]->frameNos);
+		delete pools[i];
+	}
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::AddPool
+//
+// Input    : name - name of the new pool,
+//            numOfFrames - its size,
+//            policy - name of its replacement policy.
+// Output   : None.
+// Purpose  : Adds numOfFrames frames to the manager, with a hash table
+//            and a replacer of their own.  No page is bound to the
+//            pool until BindPages binds it.
+// Return   : OK on success, FAIL if the name is taken, the size is
+//            not positive or the policy is unknown.
+//------------------------------------------------------------------
+
+Status BufMgr::AddPool(const char* name, int numOfFrames, const char* policy)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	if (numOfFrames <= 0 || GetPoolNo(name) != -1)
+	{
+		cerr << "BufMgr::AddPool - cannot add a pool " << name
+		     << " of " << numOfFrames << " frames\n";
+		return FAIL;
+	}
+
+	BufferPool *pool = new BufferPool;
+	pool->name = name;
+	pool->policy = policy;
+	pool->numOfFrames = 0;
+	pool->frames = NULL;
+	pool->frameNos = NULL;
+	pool->hashTable = new HashTable(numOfFrames);
+	pool->replacer = NULL;
+	pool->totalCall = 0;
+	pool->totalHit = 0;
+
+	if (AddFrames(pool, numOfFrames) != OK)
+	{
+		cerr << "BufMgr::AddPool - no replacement policy " << policy << endl;
+		delete pool->hashTable;
+		delete pool;
+		return FAIL;
+	}
+
+	pools.push_back(pool);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::Resize
+//
+// Input    : numOfFrames - the size wanted,
+//            poolName - the pool to resize.
+// Output   : None.
+// Purpose  : Grows or shrinks the pool to numOfFrames frames.  Resizes
+//            run one at a time, each sizing the pool from what the last
+//            left, since a shrink lets the mutex go between victims.
+// Return   : OK on success, FAIL if there is no such pool, the size
+//            is not positive or too many frames are pinned to give
+//            up enough of them.
+//------------------------------------------------------------------
+
+Status BufMgr::Resize(int numOfFrames, const char* poolName)
+{
+	std::lock_guard<std::mutex> resizing(resizeMutex);
+	std::unique_lock<std::recursive_mutex> lock(mutex);
+
+	int poolNo = GetPoolNo(poolName);
+	if (poolNo == -1 || numOfFrames <= 0)
+	{
+		cerr << "BufMgr::Resize - cannot give pool " << poolName << " "
+		     << numOfFrames << " frames\n";
+		return FAIL;
+	}
+
+	BufferPool *pool = pools[poolNo];
+	int n = numOfFrames - (int)pool->numOfFrames;
+	if (n > 0)
+		return AddFrames(pool, n);
+
+	lock.unlock();
+	return (n < 0) ? RemoveFrames(pool, -n) : OK;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::SetFrames
+//
+// Input    : pool - a pool,
+//            frameNos - the frames it is to have.
+// Output   : None.
+// Purpose  : Hands the pool its new set of frames, with a replacer
+//            built afresh over them and room in its hash table for a
+//            page in each.
+// Return   : OK on success, FAIL if the pool's policy is unknown;
+//            then the pool is left as it was.
+//------------------------------------------------------------------
+
+Status BufMgr::SetFrames(BufferPool* pool, std::vector<int>& frameNos)
+{
+	int n = frameNos.size();
+	Frame **poolFrames = (Frame **)malloc(n * sizeof(Frame *));
+	int *poolFrameNos = (int *)malloc(n * sizeof(int));
+	for (int i = 0; i < n; i++)
+	{
+		poolFrames[i] = frames[frameNos[i]];
+		poolFrameNos[i] = frameNos[i];
+	}
+
+	Replacer *replacer = NewReplacer(pool->policy.c_str(), n, poolFrames);
+	if (replacer == NULL)
+	{
+		free(poolFrames);
+		free(poolFrameNos);
+		return FAIL;
+	}
+	pool->hashTable->Reserve(n);
+
+	delete pool->replacer;
+	free(pool->frames);
+	free(pool->frameNos);
+	pool->replacer = replacer;
+	pool->frames = poolFrames;
+	pool->frameNos = poolFrameNos;
+	pool->numOfFrames = n;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::AddFrames
+//
+// Input    : pool - a pool,
+//            n - number of frames to add.
+// Output   : None.
+// Purpose  : Makes n new frames and gives them to the pool, taking
+//            the numbers of frames given up before any new ones.
+// Return   : OK on success, FAIL if the pool's policy is unknown;
+//            then no frame is added.
+//------------------------------------------------------------------
+
+Status BufMgr::AddFrames(BufferPool* pool, int n)
+{
+	int numOfNew = n - (int)freeSlots.size();
+	if (numOfNew > 0)
+	{
+		frames = (Frame **)realloc(frames, (numOfSlots + numOfNew) * sizeof(Frame *));
+		for (int i = numOfNew - 1; i >= 0; i--)
+		{
+			frames[numOfSlots + i] = NULL;
+			freeSlots.push_back(numOfSlots + i);
+		}
+		numOfSlots += numOfNew;
+	}
+
+	std::vector<int> frameNos(pool->frameNos, pool->frameNos + pool->numOfFrames);
+	for (int i = 0; i < n; i++)
+	{
+		int frameNo = freeSlots.back();
+		freeSlots.pop_back();
+		frames[frameNo] = new Frame();
+		frameNos.push_back(frameNo);
+	}
+
+	if (SetFrames(pool, frameNos) != OK)
+	{
+		for (int i = 0; i < n; i++)
+		{
+			int frameNo = frameNos[frameNos.size() - 1 - i];
+			delete frames[frameNo];
+			frames[frameNo] = NULL;
+			freeSlots.push_back(frameNo);
+		}
+		return FAIL;
+	}
+
+	numOfFrames += n;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::RemoveFrames
+//
+// Input    : pool - a pool,
+//            n - number of frames to take away.
+// Output   : None.
+// Purpose  : Has the pool's replacer pick n victims, as for pinning
+//            pages, and deletes their frames.  The mutex is let go
+//            after each victim, so that pins wait for one eviction at
+//            most; the victims are kept pinned meanwhile.
+// Return   : OK on success, FAIL if fewer than n frames are unpinned;
+//            then the pool keeps all its frames.
+//------------------------------------------------------------------
+
+Status BufMgr::RemoveFrames(BufferPool* pool, int n)
+{
+	std::vector<int> victims;
+	while ((int)victims.size() < n)
+	{
+		std::unique_lock<std::recursive_mutex> lock(mutex);
+
+		int frameNo;
+		if (EvictFrame(pool, lock, frameNo) != OK)
+			break;
+
+		frames[frameNo]->Pin();
+		victims.push_back(frameNo);
+	}
+
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	if ((int)victims.size() < n)
+	{
+		for (size_t i = 0; i < victims.size(); i++)
+			frames[victims[i]]->Unpin();
+		cerr << "BufMgr::RemoveFrames - only " << victims.size() << " of "
+		     << n << " frames of pool " << pool->name << " are unpinned\n";
+		return FAIL;
+	}
+
+	std::vector<bool> removed(numOfSlots, false);
+	for (size_t i = 0; i < victims.size(); i++)
+		removed[victims[i]] = true;
+
+	std::vector<int> frameNos;
+	for (unsigned int i = 0; i < pool->numOfFrames; i++)
+	{
+		if (!removed[pool->frameNos[i]])
+			frameNos.push_back(pool->frameNos[i]);
+	}
+
+	Status status = SetFrames(pool, frameNos);
+	if (status != OK)
+		return status;
+
+	for (size_t i = 0; i < victims.size(); i++)
+	{
+		delete frames[victims[i]];
+		frames[victims[i]] = NULL;
+		freeSlots.push_back(victims[i]);
+	}
+	numOfFrames -= n;
+	return OK;
+}
+
+
+int BufMgr::GetPoolNo(const char* name)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	for (size_t i = 0; i < pools.size(); i++)
+	{
+		if (pools[i]->name == name)
+			return (int)i;
+	}
+	return -1;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::BindPages
+//
+// Input    : first, n - a run of pages,
+//            poolNo - the pool to bind them to.
+// Output   : None.
+// Purpose  : Makes poolNo the pool the pages are looked for and
+//            brought into.  A page another pool holds is written back
+//            if dirty and dropped from it first, so that no page is
+//            ever in two pools.
+// Return   : OK on success, FAIL if there is no such pool or one of
+//            the pages is pinned in another; then none is moved.
+//------------------------------------------------------------------
+
+Status BufMgr::BindPages(PageID first, int n, int poolNo)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	if (poolNo < 0 || (size_t)poolNo >= pools.size() || first < 0)
+		return FAIL;
+
+	for (PageID pid = first; pid < first + n; pid++)
+	{
+		int frameNo = FindFrame(pid);
+		if (frameNo != INVALID_FRAME && PoolOf(pid) != poolNo
+		    && !frames[frameNo]->NotPinned())
+		{
+			cerr << "BufMgr::BindPages - page " << pid << " is pinned\n";
+			return FAIL;
+		}
+	}
+
+	if ((size_t)(first + n) > pagePools.size())
+		pagePools.resize(first + n, DEFAULT_POOL);
+
+	for (PageID pid = first; pid < first + n; pid++)
+	{
+		if (PoolOf(pid) == poolNo)
+			continue;
+
+		int frameNo = FindFrame(pid);
+		if (frameNo != INVALID_FRAME)
+		{
+			Status status = DropPage(frameNo);
+			if (status != OK)
+				return status;
+		}
+		pagePools[pid] = poolNo;
+	}
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::DropPage
+//
+// Input    : frameNo - a frame holding an unpinned page.
+// Output   : None.
+// Purpose  : Writes the page back if it is dirty and empties the
+//            frame, and its pool's hash table of it.
+// Return   : OK on success, the failing status of the write otherwise.
+//------------------------------------------------------------------
+
+Status BufMgr::DropPage(int frameNo)
+{
+	Frame *frame = frames[frameNo];
+	PageID pid = frame->GetPageID();
+	bool dirty = frame->IsDirty();
+
+	Status status = frame->Write();
+	if (status != OK)
+		return status;
+	if (dirty)
+		numDirtyPageWrites++;
+
+	// Write leaves a clean page where it is.
+	if (frame->IsValid())
+		frame->Free();
+	return pools[PoolOf(pid)]->hashTable->Delete(pid);
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::FlushAllPages
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Writes every dirty page in the pool back to disk and
+//            drops it from the pool.  Pinned pages are left where they
+//            are, unwritten: those who hold them may be changing them.
+//            The list of pages the pool held is saved first, if there
+//            is a file for it.
+// Return   : FAIL if some page was still pinned, otherwise the status
+//            of the writes.
+//------------------------------------------------------------------
+
+Status BufMgr::FlushAllPages()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	SavePageList();
+
+	Status status = OK;
+	bool pinned = false;
+
+	for (unsigned int i = 0; i < numOfSlots && status == OK; i++)
+	{
+		Frame *frame = frames[i];
+		if (frame == NULL || !frame->IsValid())
+			continue;
+		if (frame->NotPinned())
+			status = DropPage(i);
+		else
+			pinned = true;
+	}
+
+	if (pinned)
+		return FAIL;
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::FlushPage
+//
+// Input    : pid - page to write back.
+// Output   : None.
+// Purpose  : Writes an unpinned page back to disk if it is dirty and
+//            drops it from the pool.
+// Return   : OK on success, FAIL if the page is absent or pinned.
+//------------------------------------------------------------------
+
+Status BufMgr::FlushPage(PageID pid)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	int frameNo = FindFrame(pid);
+	if (frameNo == INVALID_FRAME)
+	{
+		cerr << "Error : Unable to find the page with page id " << pid << endl;
+		return FAIL;
+	}
+
+	if (!frames[frameNo]->NotPinned())
+		return FAIL;
+
+	return DropPage(frameNo);
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::PinPage
+//
+// Input    : pid - page to pin,
+//            isEmpty - true if the page need not be read from disk.
+// Output   : page - the page in the buffer pool.
+// Purpose  : Pins a page, as Pin does, counting the pin against it.
+// Return   : As for Pin.
+//------------------------------------------------------------------
+
+Status BufMgr::PinPage(PageID pid, Page*& page, bool isEmpty)
+{
+	bool hit;
+	return Pin(pid, page, isEmpty, true, hit);
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::Pin
+//
+// Input    : pid - page to pin,
+//            isEmpty - true if the page need not be read from disk,
+//            count - false if the pin is not to be counted against the
+//            page (see GetFileResidency).
+// Output   : page - the page in the buffer pool,
+//            hit - true if the page was in the pool already.
+// Purpose  : Pins a page, bringing it into the pool first if needed.
+//            The page is read, and the victim's page written back,
+//            with the mutex released, so that hits and misses on other
+//            pages go on meanwhile and several reads can be under way
+//            at once; those who pin the page before it is in wait for
+//            it.
+// Return   : OK on success, FAIL if every frame is pinned, or the
+//            failing status if the victim's page could not be written
+//            or the page read.
+//------------------------------------------------------------------
+
+Status BufMgr::Pin(PageID pid, Page*& page, bool isEmpty, bool count, bool& hit)
+{
+	static Counter& hits = minibase_metrics.GetCounter("bufmgr.pin.hit");
+	static Counter& misses = minibase_metrics.GetCounter("bufmgr.pin.miss");
+
+	std::unique_lock<std::recursive_mutex> lock(mutex);
+
+	BufferPool *pool = pools[PoolOf(pid)];
+	totalCall++;
+	pool->totalCall++;
+
+	int frameNo = FindFrame(pid);
+	if (count && pid >= 0)
+	{
+		if ((size_t)pid >= pagePins.size())
+		{
+			pagePins.resize(pid + 1, 0);
+			pageHits.resize(pid + 1, 0);
+		}
+		pagePins[pid]++;
+		if (frameNo != INVALID_FRAME)
+			pageHits[pid]++;
+	}
+
+	bool miss = (frameNo == INVALID_FRAME);
+	if (miss)
+	{
+		misses.Add();
+		Status status = EvictFrame(pool, lock, frameNo);
+		if (status == DONE)
+		{
+			cerr << "   Buffer is full.\n";
+			return FAIL;
+		}
+		if (status != OK)
+			return status;
+
+		// The mutex may have been let go for the eviction, and the page
+		// brought in meanwhile; the frame freed is then left free.
+
+		int inFrameNo = FindFrame(pid);
+		if (inFrameNo == INVALID_FRAME)
+		{
+			frames[frameNo]->SetPageID(pid);
+			pool->hashTable->Insert(pid, frameNo);
+		}
+		else
+		{
+			frameNo = inFrameNo;
+			miss = false;
+		}
+	}
+	else
+	{
+		totalHit++;
+		pool->totalHit++;
+		hits.Add();
+	}
+
+	Frame *frame = frames[frameNo];
+	frame->Pin();
+	page = frame->GetPage();
+	hit = !miss;
+
+	Status status;
+	if (miss && !isEmpty)
+	{
+		frame->StartRead();
+		lock.unlock();
+		status = frame->Read(pid);
+	}
+	else
+	{
+		lock.unlock();
+		status = frame->WaitForRead();
+	}
+
+	if (status != OK)
+		DropFailedRead(frameNo);
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::DropFailedRead
+//
+// Input    : frameNo - a frame pinned for a page that could not be
+//            read.
+// Output   : None.
+// Purpose  : Drops the pin; the last to drop one empties the frame.
+// Return   : None.
+//------------------------------------------------------------------
+
+void BufMgr::DropFailedRead(int frameNo)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	Frame *frame = frames[frameNo];
+	frame->Unpin();
+	if (frame->NotPinned())
+	{
+		PageID pid = frame->GetPageID();
+		pools[PoolOf(pid)]->hashTable->Delete(pid);
+		frame->Free();
+	}
+}
+
+
+bool BufMgr::IsResident(PageID pid)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	int frameNo = FindFrame(pid);
+	return frameNo != INVALID_FRAME && !frames[frameNo]->IsReading();
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::FetchPage
+//
+// Input    : pid - page to bring in,
+//            done - called once it is in, or could not be read.
+// Output   : None.
+// Purpose  : Finds the page a frame as PinPage does, and hands its
+//            read to the database to make asynchronously; the frame
+//            is pinned and marked as reading meanwhile, so that those
+//            who pin the page wait for it.  A page another thread is
+//            reading is waited for on one of MINIBASE_IO's threads.
+// Return   : None.
+//------------------------------------------------------------------
+
+void BufMgr::FetchPage(PageID pid, const std::function<void (Status)>& done)
+{
+	static Counter& fetches = minibase_metrics.GetCounter("bufmgr.fetch");
+
+	std::unique_lock<std::recursive_mutex> lock(mutex);
+
+	BufferPool *pool = pools[PoolOf(pid)];
+	int frameNo = FindFrame(pid);
+	if (frameNo != INVALID_FRAME)
+	{
+		bool reading = frames[frameNo]->IsReading();
+		lock.unlock();
+
+		if (!reading)
+			done(OK);
+		else
+			MINIBASE_IO->Submit([this, pid, done]() {
+				Page *page;
+				Status status = PinPage(pid, page);
+				if (status == OK)
+					status = UnpinPage(pid, CLEAN);
+				done(status);
+			});
+		return;
+	}
+
+	Status status = EvictFrame(pool, lock, frameNo);
+	if (status == DONE)
+	{
+		cerr << "   Buffer is full.\n";
+		status = FAIL;
+	}
+	if (status != OK)
+	{
+		lock.unlock();
+		done(status);
+		return;
+	}
+
+	// The mutex may have been let go for the eviction, and the page
+	// brought in meanwhile; the frame freed is then left free.
+
+	if (FindFrame(pid) != INVALID_FRAME)
+	{
+		lock.unlock();
+		FetchPage(pid, done);
+		return;
+	}
+
+	fetches.Add();
+	Frame *frame = frames[frameNo];
+	frame->SetPageID(pid);
+	pool->hashTable->Insert(pid, frameNo);
+	frame->Pin();
+	frame->StartRead();
+	DB *db = MINIBASE_DB;
+	lock.unlock();
+
+	// The read is ended where it completes, and done, which may wait,
+	// is handed to the threads.
+
+	db->ReadPageAsync(pid, frame->GetPage(), [this, frame, frameNo, done](Status status) {
+		frame->EndRead(status);
+		if (status != OK)
+			DropFailedRead(frameNo);
+		else
+		{
+			std::lock_guard<std::recursive_mutex> lock(mutex);
+			frame->Unpin();
+		}
+		MINIBASE_IO->Submit([done, status]() { done(status); });
+	});
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::UnpinPage
+//
+// Input    : pid - page to unpin,
+//            dirty - true if the caller modified the page.
+// Output   : None.
+// Purpose  : Drops one pin on a page.  A change the caller made that
+//            no log record of its own covers is logged as an image of
+//            the whole page, taken while the caller still holds
+//            whatever keeps others off the page; a change others logged
+//            since it pinned the page does not count.  A page dirty
+//            since before the last checkpoint began is written back as
+//            its last pin goes, and a checkpoint is taken if one is due.
+// Return   : OK on success, FAIL if the page is absent or not pinned.
+//------------------------------------------------------------------
+
+Status BufMgr::UnpinPage(PageID pid, bool dirty)
+{
+	LSN oldLSN = (dirty && MINIBASE_LOG != NULL) ? MINIBASE_LOG->GetWriteBackLSN() : INVALID_LSN;
+	{
+		std::unique_lock<std::recursive_mutex> lock(mutex);
+
+		int frameNo = FindFrame(pid);
+		if (frameNo == INVALID_FRAME)
+		{
+			cerr << "   Page " << pid << " is not in the buffer\n";
+			return FAIL;
+		}
+
+		Frame *frame = frames[frameNo];
+		if (frame->NotPinned())
+		{
+			cerr << "   Trying to unpin page " << pid << ", which is not pinned.\n";
+			return FAIL;
+		}
+
+		if (dirty)
+		{
+			frame->DirtyIt();
+			if (!frame->IsLogged() && MINIBASE_LOG != NULL)
+				frame->SetLSN(MINIBASE_LOG->LogPageImage(pid, frame->GetPage()));
+		}
+		frame->Unpin();
+
+		// A page changed again and again is seldom unpinned when a
+		// checkpoint comes by, so it is written back here once it has
+		// been dirty since before the last one began.  If the write
+		// fails, the page stays dirty for a later one.
+		if (oldLSN != INVALID_LSN && frame->NotPinned() && frame->IsDirty()
+		    && frame->GetRecLSN() != INVALID_LSN && frame->GetRecLSN() < oldLSN)
+			WriteBackFrame(frameNo, lock);
+	}
+
+	if (dirty && MINIBASE_LOG != NULL && MINIBASE_LOG->CheckpointDue())
+		return MINIBASE_LOG->Checkpoint();
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::SetPageLSN
+//
+// Input    : pid - a pinned page,
+//            lsn - LSN of the log record for a change made to it.
+// Output   : None.
+// Purpose  : Tells the pool that the page may not be written until
+//            the log is durable up to lsn.
+// Return   : OK on success, FAIL if the page is not in the pool.
+//------------------------------------------------------------------
+
+Status BufMgr::SetPageLSN(PageID pid, LSN lsn)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	int frameNo = FindFrame(pid);
+	if (frameNo == INVALID_FRAME)
+		return FAIL;
+
+	frames[frameNo]->SetLSN(lsn);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::SetRecLSN
+//
+// Input    : pid - a page about to change,
+//            lsn - the log's end LSN, before the change is logged.
+// Output   : None.
+// Purpose  : Puts the page in the dirty page table before its log
+//            record is appended rather than after, so that a
+//            checkpoint begun in between finds it there.
+// Return   : None.
+//------------------------------------------------------------------
+
+void BufMgr::SetRecLSN(PageID pid, LSN lsn)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	int frameNo = FindFrame(pid);
+	if (frameNo != INVALID_FRAME)
+		frames[frameNo]->SetRecLSN(lsn);
+}
+
+
+Latch *BufMgr::GetPageLatch(PageID pid)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	int frameNo = FindFrame(pid);
+	return (frameNo == INVALID_FRAME) ? NULL : frames[frameNo]->GetLatch();
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::GetDirtyPages
+//
+// Input    : None.
+// Output   : table - every page changed since it was last written,
+//            with the LSN of the first such change.
+// Purpose  : Builds the dirty page table for a checkpoint.
+// Return   : None.
+//------------------------------------------------------------------
+
+void BufMgr::GetDirtyPages(std::vector<DirtyPageEntry>& table)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	table.clear();
+	for (unsigned int i = 0; i < numOfSlots; i++)
+	{
+		Frame *frame = frames[i];
+		if (frame != NULL && frame->IsValid() && frame->GetRecLSN() != INVALID_LSN)
+		{
+			DirtyPageEntry entry = { frame->GetPageID(), frame->GetRecLSN() };
+			table.push_back(entry);
+		}
+	}
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::WriteOldPages
+//
+// Input    : lsn - a log record.
+// Output   : None.
+// Purpose  : Writes back every unpinned page whose first change since
+//            it was last written is older than lsn, as an eviction
+//            would, and marks it clean.  The mutex is let go for each
+//            write; those who pin the page meanwhile wait for it.
+// Return   : OK on success, the failing status of a write otherwise.
+//------------------------------------------------------------------
+
+Status BufMgr::WriteOldPages(LSN lsn)
+{
+	std::unique_lock<std::recursive_mutex> lock(mutex);
+
+	for (unsigned int i = 0; i < numOfSlots; i++)
+	{
+		Frame *frame = frames[i];
+		if (frame == NULL || !frame->IsValid() || !frame->IsDirty() || !frame->NotPinned()
+		    || frame->GetRecLSN() == INVALID_LSN || frame->GetRecLSN() >= lsn)
+			continue;
+
+		Status status = WriteBackFrame(i, lock);
+		if (status != OK)
+			return status;
+	}
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::WriteBackFrame
+//
+// Input    : frameNo - a frame holding a dirty page,
+//            lock - holds the mutex.
+// Output   : None.
+// Purpose  : Writes the page back and marks it clean, keeping it in
+//            the frame.  The mutex is let go for the write, and the
+//            frame pinned meanwhile; those who pin the page wait for
+//            the write as for a read.
+// Return   : OK on success, the failing status of the write otherwise.
+//------------------------------------------------------------------
+
+Status BufMgr::WriteBackFrame(int frameNo, std::unique_lock<std::recursive_mutex>& lock)
+{
+	Frame *frame = frames[frameNo];
+	frame->Pin();
+	frame->StartWrite();
+	lock.unlock();
+	Status status = frame->WriteBack();
+	lock.lock();
+	if (status == OK)
+	{
+		frame->Cleaned();
+		numDirtyPageWrites++;
+	}
+	frame->EndWrite();
+	frame->Unpin();
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::FreePage
+//
+// Input    : pid - page to deallocate.
+// Output   : None.
+// Purpose  : Deallocates a page, removing it from its pool if it is
+//            there, and unbinds it.  The log notes the page is gone, so that restart
+//            leaves alone what was logged for it before.  The pool is
+//            let go before the space map is changed, since the database
+//            pins its space map pages through the pool.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status BufMgr::FreePage(PageID pid)
+{
+	if (MINIBASE_LOG != NULL)
+		MINIBASE_LOG->LogPageFree(pid);
+
+	{
+		std::unique_lock<std::recursive_mutex> lock(mutex);
+
+		// A page an eviction is writing out is waited for.
+		int frameNo;
+		while ((frameNo = FindFrame(pid)) != INVALID_FRAME && frames[frameNo]->IsReading())
+		{
+			lock.unlock();
+			std::this_thread::yield();
+			lock.lock();
+		}
+
+		if (frameNo != INVALID_FRAME)
+		{
+			Status status = frames[frameNo]->Free();
+			if (status != OK)
+				return status;
+			pools[PoolOf(pid)]->hashTable->Delete(pid);
+		}
+
+		// Whoever takes the page next starts in the default pool.
+		if ((size_t)pid < pagePools.size())
+			pagePools[pid] = DEFAULT_POOL;
+	}
+
+	return MINIBASE_DB->DeallocatePage(pid, 1);
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::NewPage
+//
+// Input    : howmany - number of consecutive pages to allocate.
+// Output   : pid - the first page allocated,
+//            page - that page, pinned in the pool.
+// Purpose  : Allocates a run of pages and pins the first one.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status BufMgr::NewPage(PageID& pid, Page*& page, int howmany)
+{
+	if (MINIBASE_DB->AllocatePage(pid, howmany) != OK)
+	{
+		cerr << "  BufMgr :: Unable to allocate " << howmany << " pages\n";
+		return FAIL;
+	}
+
+	return PinPage(pid, page, true);
+}
+
+
+unsigned int BufMgr::GetNumOfFrames()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	return numOfFrames;
+}
+
+
+unsigned int BufMgr::GetNumOfFrames(const char* poolName)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	int poolNo = GetPoolNo(poolName);
+	return (poolNo == -1) ? 0 : pools[poolNo]->numOfFrames;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::GetWorkFrames
+//
+// Input    : n - number of frames wanted.
+// Output   : pages - the memory of the frames.
+// Purpose  : Evicts n pages of the default pool as PinPage would and
+//            keeps their frames, pinned and empty, out of the pool.
+// Return   : OK on success, FAIL if fewer than n frames are unpinned;
+//            then no frame is taken.
+//------------------------------------------------------------------
+
+Status BufMgr::GetWorkFrames(int n, std::vector<Page*>& pages)
+{
+	std::unique_lock<std::recursive_mutex> lock(mutex);
+
+	pages.clear();
+
+	for (int i = 0; i < n; i++)
+	{
+		int frameNo;
+		if (EvictFrame(pools[DEFAULT_POOL], lock, frameNo) != OK)
+		{
+			ReleaseWorkFrames(pages);
+			return FAIL;
+		}
+
+		frames[frameNo]->Pin();
+		pages.push_back(frames[frameNo]->GetPage());
+	}
+
+	return OK;
+}
+
+
+void BufMgr::ReleaseWorkFrames(std::vector<Page*>& pages)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	for (unsigned int i = 0; i < numOfSlots; i++)
+	{
+		if (frames[i] != NULL && !frames[i]->IsValid() && !frames[i]->NotPinned()
+		    && std::find(pages.begin(), pages.end(), frames[i]->GetPage()) != pages.end())
+			frames[i]->Unpin();
+	}
+	pages.clear();
+}
+
+
+unsigned int BufMgr::GetNumOfUnpinnedFrames()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < numOfSlots; i++)
+	{
+		if (frames[i] != NULL && frames[i]->NotPinned())
+			count++;
+	}
+	return count;
+}
+
+
+void BufMgr::SetPageListFile(const char* fileName)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	pageListFile = (fileName == NULL) ? "" : fileName;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::SavePageList
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Writes the pages in the pool, with their reference bits,
+//            to the page list file.  The list is written to another
+//            file and renamed, so that a crash leaves the old list or
+//            the new one.  With no page in the pool the old list is
+//            kept, as an empty pool says nothing of what will be
+//            wanted.
+// Return   : OK on success or if there is no file to write, FAIL
+//            otherwise.
+//------------------------------------------------------------------
+
+Status BufMgr::SavePageList()
+{
+	std::vector<PageListEntry> list;
+	std::string fileName;
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		fileName = pageListFile;
+		for (unsigned int i = 0; i < numOfSlots && !fileName.empty(); i++)
+		{
+			Frame *frame = frames[i];
+			if (frame != NULL && frame->IsValid() && !frame->IsReading())
+			{
+				PageListEntry entry = { frame->GetPageID(), frame->IsReferenced() ? 1 : 0 };
+				list.push_back(entry);
+			}
+		}
+	}
+
+	if (list.empty())
+		return OK;
+
+	std::string tmpName = fileName + ".tmp";
+	int header[2] = { PAGE_LIST_MAGIC, (int)list.size() };
+	ssize_t len = list.size() * sizeof(PageListEntry);
+
+	int fd = ::open(tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	bool written = fd >= 0
+	               && write(fd, header, sizeof(header)) == (ssize_t)sizeof(header)
+	               && write(fd, &list[0], len) == len;
+	if (fd >= 0)
+		::close(fd);
+
+	if (!written || rename(tmpName.c_str(), fileName.c_str()) != 0)
+	{
+		cerr << "BufMgr::SavePageList - cannot write " << fileName << endl;
+		unlink(tmpName.c_str());
+		return FAIL;
+	}
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::Prewarm
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Reads the page list file and hands the loading of its
+//            pages to MINIBASE_IO, or loads them at once if there is
+//            no I/O service.
+// Return   : OK on success or if no list was saved, FAIL if the file
+//            is not a page list.
+//------------------------------------------------------------------
+
+Status BufMgr::Prewarm()
+{
+	std::string fileName;
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		fileName = pageListFile;
+	}
+
+	int fd = fileName.empty() ? -1 : ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return OK;
+
+	std::vector<PageListEntry> list;
+	int header[2];
+	bool valid = read(fd, header, sizeof(header)) == (ssize_t)sizeof(header)
+	             && header[0] == PAGE_LIST_MAGIC && header[1] >= 0;
+	if (valid && header[1] > 0)
+	{
+		list.resize(header[1]);
+		ssize_t len = list.size() * sizeof(PageListEntry);
+		valid = (read(fd, &list[0], len) == len);
+	}
+	::close(fd);
+
+	if (!valid)
+	{
+		cerr << "BufMgr::Prewarm - " << fileName << " is not a page list\n";
+		return FAIL;
+	}
+
+	// The database is passed on rather than read from minibase_globals,
+	// which whoever is opening it may still be setting.
+
+	DB *db = MINIBASE_DB;
+	if (MINIBASE_IO == NULL)
+		LoadPages(db, list);
+	else
+		MINIBASE_IO->Submit([this, db, list]() mutable { LoadPages(db, list); });
+	return OK;
+}
+
+
+static bool IsReferenced(const PageListEntry& entry)
+{
+	return entry.referenced != 0;
+}
+
+
+static bool LowerPageID(const PageListEntry& a, const PageListEntry& b)
+{
+	return a.pid < b.pid;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::LoadPages
+//
+// Input    : db - the database to read them from,
+//            list - pages to bring in.
+// Output   : None.
+// Purpose  : Keeps as many pages of the list as their pools have
+//            frames free, those referenced first, and reads them in
+//            physical order, each run of consecutive pages in one
+//            vectored read.  The frames are pinned and marked as
+//            reading meanwhile, as PinPage would, so that those who
+//            pin a page wait for it.  Pages already in, or with no
+//            frame free left in their pool, are skipped.  Each page
+//            gets back the reference bit it had.
+// Return   : None.
+//------------------------------------------------------------------
+
+void BufMgr::LoadPages(DB *db, std::vector<PageListEntry>& list)
+{
+	static Counter& loaded = minibase_metrics.GetCounter("bufmgr.prewarm.pages");
+
+	std::stable_partition(list.begin(), list.end(), IsReferenced);
+	{
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+
+		std::vector<size_t> numOfFree(pools.size(), 0);
+		for (size_t p = 0; p < pools.size(); p++)
+		{
+			BufferPool *pool = pools[p];
+			for (unsigned int i = 0; i < pool->numOfFrames; i++)
+			{
+				if (!pool->frames[i]->IsValid() && pool->frames[i]->NotPinned())
+					numOfFree[p]++;
+			}
+		}
+
+		size_t kept = 0;
+		for (size_t i = 0; i < list.size(); i++)
+		{
+			int p = PoolOf(list[i].pid);
+			if (numOfFree[p] > 0)
+			{
+				numOfFree[p]--;
+				list[kept++] = list[i];
+			}
+		}
+		list.resize(kept);
+	}
+	std::sort(list.begin(), list.end(), LowerPageID);
+
+	size_t i = 0;
+	while (i < list.size())
+	{
+		PageID first = list[i].pid;
+		size_t start = i;
+		std::vector<int> frameNos;
+		std::vector<Page*> pages;
+		{
+			std::lock_guard<std::recursive_mutex> lock(mutex);
+
+			while (i < list.size() && frameNos.size() < PREWARM_RUN
+			       && list[i].pid == first + (PageID)frameNos.size())
+			{
+				PageID pid = list[i].pid;
+				BufferPool *pool = pools[PoolOf(pid)];
+				int frameNo = (FindFrame(pid) == INVALID_FRAME) ? FreeFrame(pool) : INVALID_FRAME;
+				if (frameNo == INVALID_FRAME)
+					break;
+
+				Frame *frame = frames[frameNo];
+				frame->SetPageID(pid);
+				pool->hashTable->Insert(pid, frameNo);
+				frame->Pin();
+				frame->StartRead();
+				frameNos.push_back(frameNo);
+				pages.push_back(frame->GetPage());
+				i++;
+			}
+		}
+
+		if (frameNos.empty())
+		{
+			i++;
+			continue;
+		}
+
+		Status status = db->ReadPages(first, frameNos.size(), &pages[0]);
+
+		std::lock_guard<std::recursive_mutex> lock(mutex);
+		for (size_t j = 0; j < frameNos.size(); j++)
+		{
+			Frame *frame = frames[frameNos[j]];
+			frame->EndRead(status);
+			if (status != OK)
+			{
+				DropFailedRead(frameNos[j]);
+				continue;
+			}
+
+			frame->Unpin();
+			if (!list[start + j].referenced)
+				frame->UnsetReferenced();
+		}
+		if (status == OK)
+			loaded.Add(frameNos.size());
+	}
+}
+
+
+// The number of a frame of the pool that holds no page and is not
+// pinned, INVALID_FRAME if there is none.
+int BufMgr::FreeFrame(BufferPool* pool)
+{
+	for (unsigned int i = 0; i < pool->numOfFrames; i++)
+	{
+		if (!pool->frames[i]->IsValid() && pool->frames[i]->NotPinned())
+			return pool->frameNos[i];
+	}
+	return INVALID_FRAME;
+}
+
+
+int BufMgr::PoolOf(PageID pid)
+{
+	if (pid < 0 || (size_t)pid >= pagePools.size())
+		return DEFAULT_POOL;
+	return pagePools[pid];
+}
+
+
+int BufMgr::FindFrame(PageID pid)
+{
+	return pools[PoolOf(pid)]->hashTable->LookUp(pid);
+}
+
+
+// The frame number of a victim the pool's replacer picks, INVALID_FRAME
+// if all its frames are pinned.
+int BufMgr::PickVictim(BufferPool* pool)
+{
+	int i = pool->replacer->PickVictim();
+	return (i == INVALID_FRAME) ? INVALID_FRAME : pool->frameNos[i];
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::EvictFrame
+//
+// Input    : pool - the pool to free a frame of,
+//            lock - the caller's hold on the mutex.
+// Output   : frameNo - the frame freed.
+// Purpose  : Has the pool's replacer pick a victim and empties it.
+//            A dirty page is written back first with the mutex let
+//            go, so that one miss does not hold up every other pin
+//            while the log is forced and the page written; those who
+//            pin the page meanwhile wait for the write, as for a read.
+//            A victim pinned again by the time its write is done is
+//            kept, clean, and another one picked.
+// Return   : OK on success, DONE if every frame of the pool is pinned,
+//            or the failing status of the write, with the page left
+//            in its frame, dirty.
+//------------------------------------------------------------------
+
+Status BufMgr::EvictFrame(BufferPool* pool, std::unique_lock<std::recursive_mutex>& lock,
+                          int& frameNo)
+{
+	for (;;)
+	{
+		frameNo = PickVictim(pool);
+		if (frameNo == INVALID_FRAME)
+			return DONE;
+
+		Frame *frame = frames[frameNo];
+		if (frame->IsValid() && frame->IsDirty())
+		{
+			Status status = WriteBackFrame(frameNo, lock);
+			if (status != OK)
+				return status;
+			if (!frame->NotPinned())
+				continue;
+		}
+
+		if (frame->IsValid())
+			pool->hashTable->Delete(frame->GetPageID());
+		frame->EmptyIt();
+		return OK;
+	}
+}
+
+
+Status BufMgr::GetStat(const char* poolName, long& pinNo, long& missNo)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	int poolNo = GetPoolNo(poolName);
+	if (poolNo == -1)
+		return FAIL;
+
+	pinNo = pools[poolNo]->totalCall;
+	missNo = pools[poolNo]->totalCall - pools[poolNo]->totalHit;
+	return OK;
+}
+
+
+long BufMgr::GetNumOfDirtyPageWrites()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+	return numDirtyPageWrites;
+}
+
+
+void BufMgr::ResetStat()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex);
+
+	totalHit = 0;
+	totalCall = 0;
+	numDirtyPageWrites = 0;
+	pagePins.clear();
+	pageHits.clear();
+
+	for (size_t i = 0; i < pools.size(); i++)
+	{
+		pools[i]->totalCall = 0;
+		pools[i]->totalHit = 0;
+	}
+}
+
+
+void BufMgr::PrintStat()
+{
+	cout << "** Buffer Manager Statistics **" << endl;
+	cout << "Number of Dirty Pages Written to Disk: " << numDirtyPageWrites << endl;
+	cout << "Number of Pin Page Requests: " << totalCall << endl;
+	cout << "Number of Pin Page Request Misses: " << totalCall - totalHit << endl;
+
+	if (pools.size() > 1)
+	{
+		for (size_t i = 0; i < pools.size(); i++)
+			cout << "Pool " << pools[i]->name << " (" << pools[i]->numOfFrames
+			     << " frames): " << pools[i]->totalCall << " requests, "
+			     << pools[i]->totalCall - pools[i]->totalHit << " misses" << endl;
+	}
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::AddPage
+//
+// Input    : pid - a page of the file,
+//            resident - true if the page is in the pool.
+// Output   : residency - counts the page, its frame and its pins.
+// Purpose  : Adds a page to a residency report.
+// Return   : None.
+//------------------------------------------------------------------
+
+void BufMgr::AddPage(PageID pid, FileResidency& residency, bool resident)
+{
+	PageAccess access = { pid, 0, 0 };
+	if (pid >= 0 && (size_t)pid < pagePins.size())
+	{
+		access.pins = pagePins[pid];
+		access.hits = pageHits[pid];
+	}
+
+	residency.numOfPages++;
+	if (resident)
+		residency.numOfFrames++;
+	residency.pins += access.pins;
+	residency.hits += access.hits;
+	residency.hottest.push_back(access);
+}
+
+
+static bool MorePins(const PageAccess& a, const PageAccess& b)
+{
+	return a.pins > b.pins || (a.pins == b.pins && a.pid < b.pid);
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::GetFileResidency
+//
+// Input    : fileName - name of a heap file,
+//            numOfHottest - number of pages to list.
+// Output   : residency - the report.
+// Purpose  : Walks the directory of the file to find its pages, and
+//            looks each one up in the pool and in the pin counts kept
+//            since ResetStat.  The pins of the walk itself are not
+//            counted, while those of other threads meanwhile are, and
+//            a directory page counts as resident only if it was before
+//            the walk brought it in.
+// Return   : OK on success, FAIL if there is no such file or its
+//            directory cannot be pinned.
+//------------------------------------------------------------------
+
+Status BufMgr::GetFileResidency(const char* fileName, FileResidency& residency,
+                                int numOfHottest)
+{
+	residency.numOfPages = 0;
+	residency.numOfFrames = 0;
+	residency.pins = 0;
+	residency.hits = 0;
+	residency.hottest.clear();
+
+	PageID firstDirPid;
+	if (MINIBASE_DB->GetFileEntry(fileName, firstDirPid) != OK)
+		return FAIL;
+
+	// The directory is followed page by page rather than with a
+	// DirPageIterator, whose pins would count; the mutex is taken only
+	// to look the pages up, not while a directory page is read in.
+
+	PageID dirPid = firstDirPid;
+	DirPage *dirPage;
+	PageInfo *info;
+	std::vector<PageID> pids;
+	Status status = OK;
+
+	while (status == OK && dirPid != INVALID_PAGE)
+	{
+		bool resident;
+		status = Pin(dirPid, (Page *&)dirPage, false, false, resident);
+		if (status != OK)
+			break;
+
+		pids.clear();
+		PageInfoIterator infoIter(dirPage);
+		while ((info = infoIter()) != NULL)
+			pids.push_back(info->pid);
+
+		{
+			std::lock_guard<std::recursive_mutex> lock(mutex);
+			AddPage(dirPid, residency, resident);
+			for (size_t i = 0; i < pids.size(); i++)
+				AddPage(pids[i], residency, FindFrame(pids[i]) != INVALID_FRAME);
+		}
+
+		PageID nextPid = dirPage->GetNextPage();
+		status = UnpinPage(dirPid, CLEAN);
+		dirPid = nextPid;
+	}
+
+	if (numOfHottest < 0)
+		numOfHottest = 0;
+	if ((size_t)numOfHottest < residency.hottest.size())
+	{
+		std::partial_sort(residency.hottest.begin(),
+		                  residency.hottest.begin() + numOfHottest,
+		                  residency.hottest.end(), MorePins);
+		residency.hottest.resize(numOfHottest);
+	}
+	else
+		std::sort(residency.hottest.begin(), residency.hottest.end(), MorePins);
+
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// BufMgr::PrintFileStat
+//
+// Input    : fileName - name of a heap file.
+// Output   : None.
+// Purpose  : Prints the residency report of the file.
+// Return   : None.
+//------------------------------------------------------------------
+
+void BufMgr::PrintFileStat(const char* fileName)
+{
+	FileResidency residency;
+	if (GetFileResidency(fileName, residency) != OK)
+	{
+		cout << "No heap file " << fileName << endl;
+		return;
+	}
+
+	cout << "** Buffer Pool Use of " << fileName << " **" << endl;
+	cout << "Number of Pages: " << residency.numOfPages << endl;
+	cout << "Number of Frames Held: " << residency.numOfFrames
+	     << " of " << numOfFrames << endl;
+	cout << "Number of Pin Page Requests: " << residency.pins << endl;
+	cout << "Number of Pin Page Request Misses: "
+	     << residency.pins - residency.hits << endl;
+	cout << "Hottest Pages (page: pins/misses):";
+	for (size_t i = 0; i < residency.hottest.size(); i++)
+		cout << " " << residency.hottest[i].pid << ": " << residency.hottest[i].pins
+		     << "/" << residency.hottest[i].pins - residency.hottest[i].hits;
+	cout << endl;
+}
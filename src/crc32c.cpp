@@ -0,0 +1,153 @@
+#include <string.h>
+
+#include "crc32c.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC32C_HW
+#include <nmmintrin.h>
+#endif
+
+static const unsigned int CRC32C_POLY = 0x82F63B78;   // reversed Castagnoli
+
+static unsigned int crcTable[256];
+
+#if defined(CRC32C_HW) && defined(__x86_64__)
+// The crc32 instruction takes three cycles but can start one each cycle,
+// so long buffers are checksummed as three lanes of CRC32C_LANE bytes side
+// by side, and the lane CRCs joined after.  A page of 1024 bytes is two such
+// runs and a short tail.
+#define CRC32C_LANE 168
+
+// shiftTable[i][b] is the CRC register b << 8*i takes to after CRC32C_LANE
+// zero bytes; the register after any value is the XOR of its four bytes'.
+static unsigned int shiftTable[4][256];
+#endif
+
+
+static unsigned int SoftCrc32c(unsigned int crc, const unsigned char* p, int len)
+{
+	while (len-- > 0)
+		crc = crcTable[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+	return crc;
+}
+
+
+//------------------------------------------------------------------
+// InitCrc32c
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Fills the lookup table and decides whether the crc32
+//            instruction can be used.
+// Return   : 1 to use the table, 2 to use the instruction.
+//------------------------------------------------------------------
+
+static int InitCrc32c()
+{
+	for (unsigned int i = 0; i < 256; i++)
+	{
+		unsigned int crc = i;
+		for (int j = 0; j < 8; j++)
+			crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : (crc >> 1);
+		crcTable[i] = crc;
+	}
+
+#if defined(CRC32C_HW) && defined(__x86_64__)
+	static const unsigned char zeros[CRC32C_LANE] = { 0 };
+	for (int i = 0; i < 4; i++)
+		for (unsigned int b = 0; b < 256; b++)
+			shiftTable[i][b] = SoftCrc32c(b << (8 * i), zeros, CRC32C_LANE);
+#endif
+
+#ifdef CRC32C_HW
+	if (__builtin_cpu_supports("sse4.2"))
+		return 2;
+#endif
+	return 1;
+}
+
+
+#ifdef CRC32C_HW
+#ifdef __x86_64__
+static inline unsigned int ShiftCrc32c(unsigned int crc)
+{
+	return shiftTable[0][crc & 0xff] ^ shiftTable[1][(crc >> 8) & 0xff]
+	       ^ shiftTable[2][(crc >> 16) & 0xff] ^ shiftTable[3][crc >> 24];
+}
+#endif
+
+
+__attribute__((target("sse4.2")))
+static unsigned int HardCrc32c(unsigned int crc, const unsigned char* p, int len)
+{
+#ifdef __x86_64__
+	unsigned long long crc64 = crc;
+	while (len >= 3 * CRC32C_LANE)
+	{
+		unsigned long long crc1 = 0, crc2 = 0;
+		for (int i = 0; i < CRC32C_LANE; i += 8)
+		{
+			unsigned long long word0, word1, word2;
+			memcpy(&word0, p + i, sizeof(word0));
+			memcpy(&word1, p + CRC32C_LANE + i, sizeof(word1));
+			memcpy(&word2, p + 2 * CRC32C_LANE + i, sizeof(word2));
+			crc64 = _mm_crc32_u64(crc64, word0);
+			crc1 = _mm_crc32_u64(crc1, word1);
+			crc2 = _mm_crc32_u64(crc2, word2);
+		}
+
+		// The register is linear in what it starts from and in the data,
+		// so a lane begun at 0 adds to the one before it moved on over
+		// the lane's length in zeros.
+		crc64 = ShiftCrc32c(ShiftCrc32c((unsigned int)crc64) ^ (unsigned int)crc1)
+		        ^ (unsigned int)crc2;
+		p += 3 * CRC32C_LANE;
+		len -= 3 * CRC32C_LANE;
+	}
+	while (len >= 8)
+	{
+		unsigned long long word;
+		memcpy(&word, p, sizeof(word));
+		crc64 = _mm_crc32_u64(crc64, word);
+		p += 8;
+		len -= 8;
+	}
+	crc = (unsigned int)crc64;
+#endif
+	while (len >= 4)
+	{
+		unsigned int word;
+		memcpy(&word, p, sizeof(word));
+		crc = _mm_crc32_u32(crc, word);
+		p += 4;
+		len -= 4;
+	}
+	while (len-- > 0)
+		crc = _mm_crc32_u8(crc, *p++);
+	return crc;
+}
+#endif
+
+
+//------------------------------------------------------------------
+// Crc32c
+//
+// Input    : buf - start of the memory to checksum,
+//            len - number of bytes.
+// Output   : None.
+// Purpose  : Computes the CRC-32C of the given bytes.
+// Return   : The checksum.
+//------------------------------------------------------------------
+
+unsigned int Crc32c(const void* buf, int len)
+{
+	// Initialized once, by the first caller, while any other waits.
+	static const int crcMode = InitCrc32c();
+
+	const unsigned char* p = (const unsigned char*)buf;
+#ifdef CRC32C_HW
+	if (crcMode == 2)
+		return ~HardCrc32c(~0u, p, len);
+#endif
+	return ~SoftCrc32c(~0u, p, len);
+}
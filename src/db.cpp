@@ -0,0 +1,842 @@
+/*
+ * Implementation of the DB class, which manages the space map and the
+ * file directory of a Minibase database.
+ * $Id
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+
+#include "db.h"
+#include "bufmgr.h"
+#include "crc32c.h"
+#include "metrics.h"
+#include "ioservice.h"
+
+static const char* dbErrMsgs[] = {
+    "Database is full",
+    "Duplicate file entry",
+    "Unix error",
+    "bad page number",
+    "File IO error",
+    "File not found",
+    "File name too long",
+    "Negative run size",
+    "Page checksum mismatch",
+    "Log file IO error",
+    "Not a log file",
+};
+
+static error_string_table dbTable( DBMGR, dbErrMsgs );
+
+static const unsigned bits_per_page = MINIBASE_PAGESIZE * 8;
+
+// A checksum of 0 marks a page of a file written before checksums existed,
+// so a page whose CRC happens to be 0 is stored as 1 instead.
+static unsigned page_checksum( const Page* pageptr )
+{
+    unsigned crc = Crc32c( pageptr, MINIBASE_PAGESIZE );
+    return crc ? crc : 1;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+DB::DB( const char* fname, unsigned num_pgs, Status& status )
+{
+    name = strcpy( new char[strlen(fname)+1], fname );
+    num_pages = (num_pgs > 2) ? num_pgs : 2;
+    checksums = 0;
+    verify_checksums = true;
+    num_checksum_writes = 0;
+    num_checksums_synced = 0;
+    syncing = false;
+
+    // Create the file if needed and open it in read/write mode, emptying
+    // any file left behind by an earlier database.
+    fd = ::open( name, O_RDWR | O_CREAT | O_TRUNC, 0666 );
+    if ( fd < 0 ) {
+        status = MINIBASE_FIRST_ERROR( DBMGR, UNIX_ERROR );
+        return;
+    }
+
+    // Make the file num_pages pages long, followed by the checksum region.
+    // Every page reads as zeros until it is written, and both checksums
+    // of every page start as those of a page of zeros.
+    char zeros[MINIBASE_PAGESIZE];
+    memset( zeros, 0, sizeof(zeros) );
+    checksums = new unsigned[2 * num_pages];
+    std::fill( checksums, checksums + 2 * num_pages, page_checksum( (Page*)zeros ) );
+    if ( pwrite( fd, checksums, 2 * num_pages * sizeof(unsigned),
+                 checksum_offset(0) ) != (ssize_t)(2 * num_pages * sizeof(unsigned)) ) {
+        status = MINIBASE_FIRST_ERROR( DBMGR, FILE_IO_ERROR );
+        return;
+    }
+
+    // Initialize space map and directory pages.
+    MINIBASE_DB = this;
+
+    first_page* fp;
+    status = MINIBASE_BM->PinPage( 0, (Page*&)fp, true /*empty*/ );
+    if ( status != OK ) {
+        status = MINIBASE_CHAIN_ERROR( DBMGR, status );
+        return;
+    }
+
+    fp->num_db_pages = num_pages;
+    init_dir_page( &fp->dir, offsetof(first_page, dir)
+                             + offsetof(directory_page, entries) );
+
+    status = MINIBASE_BM->UnpinPage( 0, true /*dirty*/ );
+    if ( status != OK ) {
+        status = MINIBASE_CHAIN_ERROR( DBMGR, status );
+        return;
+    }
+
+    // Calculate how many pages are needed for the space map.  Reserve pages
+    // 0 and 1 and as many additional pages for the space map as are needed.
+    unsigned num_map_pages = (num_pages + bits_per_page - 1) / bits_per_page;
+    status = set_bits( 0, 1 + num_map_pages, 1 );
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+DB::DB( const char* fname, Status& status )
+{
+    name = strcpy( new char[strlen(fname)+1], fname );
+    checksums = 0;
+    verify_checksums = true;
+    num_checksum_writes = 0;
+    num_checksums_synced = 0;
+    syncing = false;
+
+    // Open the file in read/write mode.
+    fd = ::open( name, O_RDWR );
+    if ( fd < 0 ) {
+        status = MINIBASE_FIRST_ERROR( DBMGR, UNIX_ERROR );
+        return;
+    }
+
+    MINIBASE_DB = this;
+
+    // Set num_pages to 1 so that page 0 can be read; its checksum cannot be
+    // checked until the real size, and with it the checksum region, is known.
+    num_pages = 1;
+
+    first_page* fp;
+    status = MINIBASE_BM->PinPage( 0, (Page*&)fp );
+    if ( status != OK ) {
+        status = MINIBASE_CHAIN_ERROR( DBMGR, status );
+        return;
+    }
+
+    num_pages = fp->num_db_pages;
+
+    status = MINIBASE_BM->UnpinPage( 0 );
+    if ( status != OK ) {
+        status = MINIBASE_CHAIN_ERROR( DBMGR, status );
+        return;
+    }
+
+    // Load the checksum region.  A file written before checksums existed
+    // has none; its pages go unchecked until they are next written.
+    checksums = new unsigned[2 * num_pages];
+    memset( checksums, 0, 2 * num_pages * sizeof(unsigned) );
+    if ( pread( fd, checksums, 2 * num_pages * sizeof(unsigned),
+                checksum_offset(0) ) < 0 ) {
+        status = MINIBASE_FIRST_ERROR( DBMGR, UNIX_ERROR );
+        return;
+    }
+
+    // Now that its checksum is known, check page 0 as well.
+    char page0[MINIBASE_PAGESIZE];
+    status = ReadPage( 0, (Page*)page0 );
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+DB::~DB()
+{
+    ::close( fd );
+    fd = -1;
+    delete [] checksums;
+    delete [] name;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+Status DB::Destroy()
+{
+    ::close( fd );
+    fd = -1;
+    if ( unlink( name ) < 0 )
+        return MINIBASE_FIRST_ERROR( DBMGR, UNIX_ERROR );
+    return OK;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+const char* DB::GetName() const
+{
+    return name;
+}
+
+int DB::GetNumOfPages() const
+{
+    return num_pages;
+}
+
+int DB::GetPageSize() const
+{
+    return MINIBASE_PAGESIZE;
+}
+
+void DB::SetVerifyChecksums( bool verify )
+{
+    verify_checksums = verify;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+Status DB::AllocatePage( PageID& start_page_num, int run_size_int )
+{
+    std::lock_guard<std::recursive_mutex> lock( mutex );
+
+    if ( run_size_int < 0 ) {
+        cerr << "Allocating a negative run of pages.\n";
+        return MINIBASE_FIRST_ERROR( DBMGR, NEG_RUN_SIZE );
+    }
+
+    unsigned run_size = run_size_int;
+    unsigned num_map_pages = (num_pages + bits_per_page - 1) / bits_per_page;
+    unsigned current_run_start = 0, current_run_length = 0;
+
+    // This loop goes over each page in the space map.
+    Status status;
+    for ( unsigned i = 0; i < num_map_pages; ++i ) {
+        PageID pgid = 1 + i;    // The space map starts at page #1.
+
+        char* pg;
+        status = MINIBASE_BM->PinPage( pgid, (Page*&)pg );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+
+        // How many bits should we examine on this page?
+        int num_bits_this_page = num_pages - i*bits_per_page;
+        if ( num_bits_this_page > (int)bits_per_page )
+            num_bits_this_page = bits_per_page;
+
+        // Walk the page looking for a sequence of 0 bits of the appropriate
+        // length.  The outer loop steps through the page's bytes, the inner
+        // one steps through each byte's bits.
+        for ( ; num_bits_this_page > 0
+                    && current_run_length < run_size; ++pg )
+            for ( unsigned mask = 1;
+                  mask < 256 && num_bits_this_page > 0
+                    && current_run_length < run_size;
+                  mask <<= 1, --num_bits_this_page )
+
+                if ( *pg & mask ) {
+                    current_run_start += current_run_length + 1;
+                    current_run_length = 0;
+                } else
+                    ++current_run_length;
+
+        status = MINIBASE_BM->UnpinPage( pgid );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+    }
+
+    if ( current_run_length >= run_size ) {
+        start_page_num = current_run_start;
+        return set_bits( start_page_num, run_size, 1 );
+    }
+
+    return MINIBASE_FIRST_ERROR( DBMGR, DB_FULL );
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+Status DB::AllocateExtent( PageID& start_page_num, int& run_size_int,
+                           PageID near )
+{
+    std::lock_guard<std::recursive_mutex> lock( mutex );
+
+    if ( run_size_int < 0 ) {
+        cerr << "Allocating a negative run of pages.\n";
+        return MINIBASE_FIRST_ERROR( DBMGR, NEG_RUN_SIZE );
+    }
+
+    unsigned run_size = run_size_int;
+    unsigned num_map_pages = (num_pages + bits_per_page - 1) / bits_per_page;
+    PageID page_num = 0, current_run_start = 0;
+    unsigned current_run_length = 0;
+    PageID best_run_start = INVALID_PAGE;
+    unsigned best_run_length = 0;
+    bool found = false;
+
+    // Same walk over the space map as AllocatePage, but a free run is also
+    // cut at near, so that the part of it from near on is a run of its own.
+    // best_run remembers the first run of full length, or failing that the
+    // longest run, in case there is none at or after near.
+    Status status;
+    for ( unsigned i = 0; i < num_map_pages && !found; ++i ) {
+        PageID pgid = 1 + i;    // The space map starts at page #1.
+
+        char* pg;
+        status = MINIBASE_BM->PinPage( pgid, (Page*&)pg );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+
+        int num_bits_this_page = num_pages - i*bits_per_page;
+        if ( num_bits_this_page > (int)bits_per_page )
+            num_bits_this_page = bits_per_page;
+
+        for ( ; num_bits_this_page > 0 && !found; ++pg )
+            for ( unsigned mask = 1;
+                  mask < 256 && num_bits_this_page > 0 && !found;
+                  mask <<= 1, --num_bits_this_page, ++page_num ) {
+
+                if ( *pg & mask ) {
+                    current_run_length = 0;
+                    continue;
+                }
+
+                if ( current_run_length == 0 || page_num == near )
+                    current_run_start = page_num, current_run_length = 0;
+                ++current_run_length;
+
+                if ( current_run_length > best_run_length
+                     && best_run_length < run_size ) {
+                    best_run_start = current_run_start;
+                    best_run_length = current_run_length;
+                }
+
+                if ( current_run_length == run_size
+                     && current_run_start >= near ) {
+                    best_run_start = current_run_start;
+                    best_run_length = current_run_length;
+                    found = true;
+                }
+            }
+
+        status = MINIBASE_BM->UnpinPage( pgid );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+    }
+
+    if ( best_run_length == 0 )
+        return MINIBASE_FIRST_ERROR( DBMGR, DB_FULL );
+
+    start_page_num = best_run_start;
+    run_size_int = best_run_length;
+    return set_bits( start_page_num, best_run_length, 1 );
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+Status DB::DeallocatePage( PageID start_page_num, int run_size )
+{
+    std::lock_guard<std::recursive_mutex> lock( mutex );
+
+    if ( run_size < 0 ) {
+        cerr << "Allocating a negative run of pages.\n";
+        return MINIBASE_FIRST_ERROR( DBMGR, NEG_RUN_SIZE );
+    }
+
+    return set_bits( start_page_num, run_size, 0 );
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+Status DB::AddFileEntry( const char* fname, PageID start_page_num )
+{
+    std::lock_guard<std::recursive_mutex> lock( mutex );
+
+    if ( strlen(fname) >= MAX_NAME )
+        return MINIBASE_FIRST_ERROR( DBMGR, FILE_NAME_TOO_LONG );
+
+    if ( start_page_num < 0 || start_page_num >= (int)num_pages )
+        return MINIBASE_FIRST_ERROR( DBMGR, BAD_PAGE_NO );
+
+    // Does the file already exist?
+    PageID tmp;
+    if ( GetFileEntry( fname, tmp ) == OK )
+        return MINIBASE_FIRST_ERROR( DBMGR, DUPLICATE_ENTRY );
+
+    directory_page* dp = 0;
+    bool found = false;
+    unsigned free_slot = 0;
+    PageID hpid, nexthpid = 0;
+    Status status;
+    do {
+        hpid = nexthpid;
+
+        status = MINIBASE_BM->PinPage( hpid, (Page*&)dp );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+
+        // This complication is because the first page has a different
+        // structure from that of subsequent pages.
+        if ( hpid == 0 )
+            dp = &((first_page*)dp)->dir;
+
+        nexthpid = dp->next_page;
+
+        unsigned entry = 0;
+        while ( entry < dp->num_entries
+                && dp->entries[entry].pagenum != INVALID_PAGE )
+            ++entry;
+
+        if ( entry < dp->num_entries ) {
+            free_slot = entry;
+            found = true;
+        } else if ( nexthpid != INVALID_PAGE ) {
+            // We only unpin if we're going to continue looping.
+            status = MINIBASE_BM->UnpinPage( hpid );
+            if ( status != OK )
+                return MINIBASE_CHAIN_ERROR( DBMGR, status );
+        }
+    } while ( nexthpid != INVALID_PAGE && !found );
+
+    // Have to add a new directory page if possible.
+    if ( !found ) {
+        status = AllocatePage( nexthpid );
+        if ( status != OK ) {
+            MINIBASE_BM->UnpinPage( hpid );
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+        }
+
+        // Set the next-page pointer on the previous directory page.
+        dp->next_page = nexthpid;
+        status = MINIBASE_BM->UnpinPage( hpid, true /*dirty*/ );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+
+        // Pin the newly-allocated directory page.
+        hpid = nexthpid;
+        status = MINIBASE_BM->PinPage( hpid, (Page*&)dp, true /*empty*/ );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+
+        init_dir_page( dp, offsetof(directory_page, entries) );
+        free_slot = 0;
+    }
+
+    // At this point, "hpid" has the page id of the directory page with the
+    // free slot; "dp" points to the pinned directory page; and "free_slot"
+    // is the entry number where the new file entry goes.
+    dp->entries[free_slot].pagenum = start_page_num;
+    strcpy( dp->entries[free_slot].fname, fname );
+
+    status = MINIBASE_BM->UnpinPage( hpid, true /*dirty*/ );
+    if ( status != OK )
+        return MINIBASE_CHAIN_ERROR( DBMGR, status );
+
+    return OK;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+Status DB::DeleteFileEntry( const char* fname )
+{
+    std::lock_guard<std::recursive_mutex> lock( mutex );
+
+    directory_page* dp = 0;
+    bool found = false;
+    unsigned slot = 0;
+    PageID hpid, nexthpid = 0;
+    Status status;
+    do {
+        hpid = nexthpid;
+
+        status = MINIBASE_BM->PinPage( hpid, (Page*&)dp );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+
+        if ( hpid == 0 )
+            dp = &((first_page*)dp)->dir;
+
+        nexthpid = dp->next_page;
+
+        unsigned entry = 0;
+        while ( entry < dp->num_entries
+                && (dp->entries[entry].pagenum == INVALID_PAGE
+                    || strcmp( fname, dp->entries[entry].fname ) != 0) )
+            ++entry;
+
+        if ( entry < dp->num_entries ) {
+            slot = entry;
+            found = true;
+        } else {
+            status = MINIBASE_BM->UnpinPage( hpid );
+            if ( status != OK )
+                return MINIBASE_CHAIN_ERROR( DBMGR, status );
+        }
+    } while ( nexthpid != INVALID_PAGE && !found );
+
+    if ( !found )
+        return MINIBASE_FIRST_ERROR( DBMGR, FILE_NOT_FOUND );
+
+    // Have to delete the record at hpnum:slot.
+    dp->entries[slot].pagenum = INVALID_PAGE;
+
+    status = MINIBASE_BM->UnpinPage( hpid, true /*dirty*/ );
+    if ( status != OK )
+        return MINIBASE_CHAIN_ERROR( DBMGR, status );
+
+    return OK;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+Status DB::GetFileEntry( const char* name, PageID& start_page )
+{
+    std::lock_guard<std::recursive_mutex> lock( mutex );
+
+    directory_page* dp = 0;
+    bool found = false;
+    unsigned slot = 0;
+    PageID hpid, nexthpid = 0;
+    Status status;
+    do {
+        hpid = nexthpid;
+
+        status = MINIBASE_BM->PinPage( hpid, (Page*&)dp );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+
+        if ( hpid == 0 )
+            dp = &((first_page*)dp)->dir;
+
+        nexthpid = dp->next_page;
+
+        unsigned entry = 0;
+        while ( entry < dp->num_entries
+                && (dp->entries[entry].pagenum == INVALID_PAGE
+                    || strcmp( name, dp->entries[entry].fname ) != 0) )
+            ++entry;
+
+        if ( entry < dp->num_entries ) {
+            slot = entry;
+            found = true;
+        }
+
+        status = MINIBASE_BM->UnpinPage( hpid );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+    } while ( nexthpid != INVALID_PAGE && !found );
+
+    // Not an error: callers use this to find out whether a file exists.
+    if ( !found )
+        return FAIL;
+
+    start_page = dp->entries[slot].pagenum;
+    return OK;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+off_t DB::checksum_offset( PageID pageno ) const
+{
+    return (off_t)num_pages * MINIBASE_PAGESIZE
+           + (off_t)pageno * 2 * sizeof(unsigned);
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+bool DB::checksum_matches( PageID pageno, const Page* pageptr ) const
+{
+    if ( !verify_checksums || !checksums || checksums[2*pageno+1] == 0 )
+        return true;
+
+    // The page is as it was either before its last write or after it.
+    unsigned crc = page_checksum( pageptr );
+    return crc == checksums[2*pageno+1] || crc == checksums[2*pageno];
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+Status DB::ReadPage( PageID pageno, Page* pageptr )
+{
+    static Histogram& latency = minibase_metrics.GetHistogram( "db.read.ns" );
+    static Counter& bytes = minibase_metrics.GetCounter( "db.read.bytes" );
+    MetricsTimer timer( latency );
+
+    if ( pageno < 0 || pageno >= (int)num_pages )
+        return MINIBASE_FIRST_ERROR( DBMGR, BAD_PAGE_NO );
+
+    // Read the page at its offset; pread leaves the file offset alone,
+    // so threads may read and write pages at once.
+    if ( pread( fd, pageptr, MINIBASE_PAGESIZE,
+                (off_t)pageno * MINIBASE_PAGESIZE ) != MINIBASE_PAGESIZE )
+        return MINIBASE_FIRST_ERROR( DBMGR, FILE_IO_ERROR );
+    bytes.Add( MINIBASE_PAGESIZE );
+
+    // Check the page against the checksums stored when it was written.
+    if ( !checksum_matches( pageno, pageptr ) )
+        return MINIBASE_FIRST_ERROR( DBMGR, BAD_CHECKSUM );
+
+    return OK;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+void DB::ReadPageAsync( PageID pageno, Page* pageptr,
+                        const std::function<void (Status)>& done )
+{
+    static Counter& bytes = minibase_metrics.GetCounter( "db.read.bytes" );
+
+    if ( pageno < 0 || pageno >= (int)num_pages ) {
+        done( MINIBASE_FIRST_ERROR( DBMGR, BAD_PAGE_NO ) );
+        return;
+    }
+
+    DB *db = this;
+    MINIBASE_IO->Read( fd, pageptr, MINIBASE_PAGESIZE, (off_t)pageno * MINIBASE_PAGESIZE,
+                       [db, pageno, pageptr, done]( ssize_t len ) {
+        if ( len != MINIBASE_PAGESIZE )
+            done( MINIBASE_FIRST_ERROR( DBMGR, FILE_IO_ERROR ) );
+        else if ( !db->checksum_matches( pageno, pageptr ) )
+            done( MINIBASE_FIRST_ERROR( DBMGR, BAD_CHECKSUM ) );
+        else {
+            bytes.Add( MINIBASE_PAGESIZE );
+            done( OK );
+        }
+    } );
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+Status DB::ReadPages( PageID start_page_num, int run_size, Page** pageptrs )
+{
+    static Histogram& latency = minibase_metrics.GetHistogram( "db.readv.ns" );
+    static Counter& bytes = minibase_metrics.GetCounter( "db.readv.bytes" );
+    MetricsTimer timer( latency );
+
+    if ( start_page_num < 0 || run_size <= 0
+         || start_page_num + run_size > (int)num_pages )
+        return MINIBASE_FIRST_ERROR( DBMGR, BAD_PAGE_NO );
+
+    // One vectored read scatters the run over the pages given.
+    std::vector<struct iovec> iov( run_size );
+    for ( int i = 0; i < run_size; ++i ) {
+        iov[i].iov_base = pageptrs[i];
+        iov[i].iov_len = MINIBASE_PAGESIZE;
+    }
+    ssize_t len = (ssize_t)run_size * MINIBASE_PAGESIZE;
+    if ( preadv( fd, &iov[0], run_size,
+                 (off_t)start_page_num * MINIBASE_PAGESIZE ) != len )
+        return MINIBASE_FIRST_ERROR( DBMGR, FILE_IO_ERROR );
+    bytes.Add( len );
+
+    for ( int i = 0; i < run_size; ++i ) {
+        if ( !checksum_matches( start_page_num + i, pageptrs[i] ) )
+            return MINIBASE_FIRST_ERROR( DBMGR, BAD_CHECKSUM );
+    }
+
+    return OK;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+Status DB::WritePage( PageID pageno, Page* pageptr, bool scratch )
+{
+    static Histogram& latency = minibase_metrics.GetHistogram( "db.write.ns" );
+    static Counter& bytes = minibase_metrics.GetCounter( "db.write.bytes" );
+    MetricsTimer timer( latency );
+
+    if ( pageno < 0 || pageno >= (int)num_pages )
+        return MINIBASE_FIRST_ERROR( DBMGR, BAD_PAGE_NO );
+
+    // Record the checksum of the page as it is on disk and as it will be,
+    // in the checksum region and then in memory, and make them durable
+    // before writing the page: a crash at any point leaves a page on disk
+    // that matches one of them.  A page written as it was last time
+    // matches the checksums on disk already.
+    if ( checksums ) {
+        unsigned pair[2] = { checksums[2*pageno+1], page_checksum( pageptr ) };
+        if ( pair[1] != pair[0] ) {
+            if ( pwrite( fd, pair, sizeof(pair), checksum_offset( pageno ) )
+                 != sizeof(pair) )
+                return MINIBASE_FIRST_ERROR( DBMGR, FILE_IO_ERROR );
+            if ( !scratch ) {
+                Status status = sync_checksums();
+                if ( status != OK )
+                    return status;
+            }
+            checksums[2*pageno] = pair[0];
+            checksums[2*pageno+1] = pair[1];
+        }
+    }
+
+    // Write the page at its offset, as ReadPage reads it.
+    if ( pwrite( fd, pageptr, MINIBASE_PAGESIZE,
+                 (off_t)pageno * MINIBASE_PAGESIZE ) != MINIBASE_PAGESIZE )
+        return MINIBASE_FIRST_ERROR( DBMGR, FILE_IO_ERROR );
+    bytes.Add( MINIBASE_PAGESIZE );
+
+    return OK;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+// Counts the checksums written before the call, and syncs the file if
+// they are not on disk yet.  The first thread to find them short syncs;
+// threads arriving meanwhile wait and share the next sync, as commits
+// share log writes (see LogMgr::Flush).
+
+Status DB::sync_checksums()
+{
+    std::unique_lock<std::mutex> lock( sync_mutex );
+    unsigned long ticket = ++num_checksum_writes;
+
+    while ( num_checksums_synced < ticket ) {
+        if ( syncing ) {
+            synced.wait( lock );
+            continue;
+        }
+
+        unsigned long upto = num_checksum_writes;
+        syncing = true;
+        lock.unlock();
+        int rc = fdatasync( fd );
+        lock.lock();
+        syncing = false;
+
+        if ( rc == 0 )
+            num_checksums_synced = upto;
+        synced.notify_all();
+        if ( rc != 0 )
+            return MINIBASE_FIRST_ERROR( DBMGR, FILE_IO_ERROR );
+    }
+    return OK;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+Status DB::Sync()
+{
+    if ( fdatasync( fd ) != 0 )
+        return MINIBASE_FIRST_ERROR( DBMGR, FILE_IO_ERROR );
+    return OK;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+Status DB::set_bits( PageID start_page, unsigned run_size, int bit )
+{
+    if ( start_page < 0 || start_page + run_size > num_pages )
+        return MINIBASE_FIRST_ERROR( DBMGR, BAD_PAGE_NO );
+
+    // Locate the run within the space map.
+    PageID first_map_page = start_page / bits_per_page + 1;
+    PageID last_map_page = (start_page + run_size - 1) / bits_per_page + 1;
+    unsigned first_bit_no = start_page % bits_per_page;
+
+    // The outer loop goes over all space-map pages we need to touch.
+    for ( PageID pgid = first_map_page; pgid <= last_map_page;
+          ++pgid, first_bit_no = 0 ) {
+
+        char* pg;
+        Status status = MINIBASE_BM->PinPage( pgid, (Page*&)pg );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+
+        // Locate the piece of the run that fits on this page.
+        unsigned first_byte_no = first_bit_no / 8;
+        unsigned first_bit_offset = first_bit_no % 8;
+        unsigned last_bit_no = first_bit_no + run_size - 1;
+
+        if ( last_bit_no >= bits_per_page )
+            last_bit_no = bits_per_page - 1;
+
+        unsigned last_byte_no = last_bit_no / 8;
+
+        // This loop actually flips the bits on the current page.
+        char* p = pg + first_byte_no;
+        char* end = pg + last_byte_no;
+        for ( ; p <= end; ++p, first_bit_offset = 0 ) {
+            unsigned max_bits_this_byte = 8 - first_bit_offset;
+            unsigned num_bits_this_byte = (run_size > max_bits_this_byte ?
+                                           max_bits_this_byte : run_size);
+            unsigned mask = ((1 << num_bits_this_byte) - 1) << first_bit_offset;
+            if ( bit )
+                *p |= mask;
+            else
+                *p &= ~mask;
+            run_size -= num_bits_this_byte;
+        }
+
+        status = MINIBASE_BM->UnpinPage( pgid, true /*dirty*/ );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+    }
+
+    return OK;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+void DB::init_dir_page( directory_page* dp, unsigned used_bytes )
+{
+    dp->next_page = INVALID_PAGE;
+    dp->num_entries = (MINIBASE_PAGESIZE - used_bytes) / sizeof(file_entry);
+
+    for ( unsigned index = 0; index < dp->num_entries; ++index )
+        dp->entries[index].pagenum = INVALID_PAGE;
+}
+
+// oooooooooooooooooooooooooooooooooooooo
+
+Status DB::dump_space_map()
+{
+    std::lock_guard<std::recursive_mutex> lock( mutex );
+
+    unsigned num_map_pages = (num_pages + bits_per_page - 1) / bits_per_page;
+    unsigned bit_number = 0;
+
+    // This loop goes over each page in the space map.
+    for ( unsigned i = 0; i < num_map_pages; ++i ) {
+        PageID pgid = 1 + i;    // The space map starts at page #1.
+
+        char* pg;
+        Status status = MINIBASE_BM->PinPage( pgid, (Page*&)pg );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+
+        // How many bits should we examine on this page?
+        int num_bits_this_page = num_pages - i*bits_per_page;
+        if ( num_bits_this_page > (int)bits_per_page )
+            num_bits_this_page = bits_per_page;
+
+        // Walk the page, printing each bit: 50 to a line, in groups of 10.
+        for ( ; num_bits_this_page > 0; ++pg )
+            for ( unsigned mask = 1;
+                  mask < 256 && num_bits_this_page > 0;
+                  mask <<= 1, --num_bits_this_page, ++bit_number ) {
+
+                int bit = (*pg & mask) != 0;
+                if ( bit_number % 10 == 0 ) {
+                    if ( bit_number % 50 == 0 ) {
+                        if ( bit_number > 0 )
+                            cout << endl;
+                        cout << setw(8) << bit_number << ": ";
+                    } else
+                        cout << ' ';
+                }
+                cout << bit;
+            }
+
+        status = MINIBASE_BM->UnpinPage( pgid );
+        if ( status != OK )
+            return MINIBASE_CHAIN_ERROR( DBMGR, status );
+    }
+
+    cout << endl;
+    return OK;
+}
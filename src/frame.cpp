@@ -0,0 +1,343 @@
+#include <thread>
+
+#include "frame.h"
+#include "db.h"
+#include "logmgr.h"
+
+//------------------------------------------------------------------
+// Frame::Frame
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Creates an empty frame with its own page of memory.
+//------------------------------------------------------------------
+
+Frame::Frame()
+{
+	pid = INVALID_PAGE;
+	data = new Page();
+	pinCount = 0;
+	dirty = 0;
+	referenced = false;
+	lsn = INVALID_LSN;
+	recLSN = INVALID_LSN;
+	reading = false;
+	readStatus = OK;
+}
+
+
+Frame::~Frame()
+{
+	delete data;
+}
+
+
+//------------------------------------------------------------------
+// Frame::Pin
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Adds a pin for the calling thread.  It may change the
+//            page, so until a log record of its own covers the page
+//            again, what it did counts as not logged.  What other
+//            threads holding the page log does not count for it.
+//------------------------------------------------------------------
+
+void Frame::Pin()
+{
+	PinHolder holder = { std::this_thread::get_id(), false };
+	pinCount++;
+	holders.push_back(holder);
+}
+
+
+//------------------------------------------------------------------
+// Frame::Unpin
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Drops one pin.  A frame whose last pin goes away is
+//            marked as referenced so that the clock gives it a
+//            second chance.
+//------------------------------------------------------------------
+
+void Frame::Unpin()
+{
+	int i = FindHolder(true);
+	if (i >= 0)
+		holders.erase(holders.begin() + i);
+	pinCount--;
+	if (NotPinned())
+		referenced = true;
+}
+
+
+// The newest pin of the calling thread; with anyThread, the newest pin
+// of all if the thread holds none, as when a scan moves on to another
+// thread.  -1 if there is no such pin.
+int Frame::FindHolder(bool anyThread)
+{
+	std::thread::id self = std::this_thread::get_id();
+	for (int i = (int)holders.size() - 1; i >= 0; i--)
+	{
+		if (holders[i].thread == self)
+			return i;
+	}
+	return anyThread ? (int)holders.size() - 1 : -1;
+}
+
+
+void Frame::EmptyIt()
+{
+	pid = INVALID_PAGE;
+	pinCount = 0;
+	dirty = 0;
+	lsn = INVALID_LSN;
+	recLSN = INVALID_LSN;
+	holders.clear();
+}
+
+
+void Frame::DirtyIt()
+{
+	dirty = 1;
+}
+
+
+void Frame::SetPageID(PageID pageNo)
+{
+	pid = pageNo;
+	lsn = INVALID_LSN;
+	recLSN = INVALID_LSN;
+	readStatus = OK;
+}
+
+
+bool Frame::IsDirty()
+{
+	return dirty;
+}
+
+
+bool Frame::IsValid()
+{
+	return pid != INVALID_PAGE;
+}
+
+
+//------------------------------------------------------------------
+// Frame::Write
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Writes the page back to disk if it is dirty and empties
+//            the frame.  The log is forced up to the frame's LSN
+//            first, so no change reaches the database before its log
+//            record does.
+// Return   : OK if the page was clean or written, the failing status
+//            otherwise.
+//------------------------------------------------------------------
+
+Status Frame::Write()
+{
+	if (!IsDirty())
+		return OK;
+
+	Status status = WriteBack();
+	if (status == OK)
+		EmptyIt();
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// Frame::WriteBack
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Forces the log up to the frame's LSN and writes the page
+//            to disk, leaving the frame as it is.  No one may change
+//            the page meanwhile.
+// Return   : OK if the page was written, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status Frame::WriteBack()
+{
+	if (lsn != INVALID_LSN && MINIBASE_LOG != NULL)
+	{
+		Status status = MINIBASE_LOG->Flush(lsn);
+		if (status != OK)
+			return status;
+	}
+
+	return MINIBASE_DB->WritePage(pid, data);
+}
+
+
+// Marks the page, just written back and changed by no one since, as
+// clean, keeping it in the frame.
+void Frame::Cleaned()
+{
+	dirty = 0;
+	recLSN = INVALID_LSN;
+}
+
+
+Status Frame::Read(PageID pageNo)
+{
+	pid = pageNo;
+	lsn = INVALID_LSN;
+	recLSN = INVALID_LSN;
+	EndRead(MINIBASE_DB->ReadPage(pid, data));
+	return readStatus;
+}
+
+
+//------------------------------------------------------------------
+// Frame::WaitForRead
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Waits for the page, pinned by the caller, to be read in
+//            if another thread is still reading it.  The frame's latch
+//            is not used for this: a thread may still hold it for the
+//            page the frame held before.
+// Return   : How the read went.
+//------------------------------------------------------------------
+
+Status Frame::WaitForRead()
+{
+	while (reading.load())
+		std::this_thread::yield();
+	return readStatus;
+}
+
+
+//------------------------------------------------------------------
+// Frame::Free
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Empties the frame of a page about to be deallocated,
+//            without writing it.  The caller may hold at most one pin
+//            on it.
+// Return   : OK on success, FAIL if the page is pinned more than once.
+//------------------------------------------------------------------
+
+Status Frame::Free()
+{
+	if (pinCount > 1)
+	{
+		cerr << "   Free a page that is pinned more than once.\n";
+		return FAIL;
+	}
+
+	EmptyIt();
+	referenced = false;
+	return OK;
+}
+
+
+bool Frame::NotPinned()
+{
+	return pinCount == 0;
+}
+
+
+bool Frame::HasPageID(PageID pageNo)
+{
+	return pid == pageNo;
+}
+
+
+PageID Frame::GetPageID()
+{
+	return pid;
+}
+
+
+Page* Frame::GetPage()
+{
+	return data;
+}
+
+
+Latch* Frame::GetLatch()
+{
+	return &latch;
+}
+
+
+//------------------------------------------------------------------
+// Frame::SetLSN
+//
+// Input    : pageLSN - LSN of a log record describing a change to
+//            the page in this frame.
+// Output   : None.
+// Purpose  : Remembers the newest such LSN, which the log must reach
+//            before the page can be written, and the oldest one
+//            since the page was last written, where redo of the page
+//            would have to begin.  Threads changing a page at once may
+//            set their LSNs out of order.
+// Return   : None.
+//------------------------------------------------------------------
+
+void Frame::SetLSN(LSN pageLSN)
+{
+	if (pageLSN > lsn)
+		lsn = pageLSN;
+	if (recLSN == INVALID_LSN || pageLSN < recLSN)
+		recLSN = pageLSN;
+
+	int i = FindHolder(false);
+	if (i >= 0)
+		holders[i].logged = true;
+}
+
+
+// Keeps the page in the dirty page table from pageLSN on, before the
+// record of a change to it is logged (see BufMgr::SetRecLSN).
+void Frame::SetRecLSN(LSN pageLSN)
+{
+	if (recLSN == INVALID_LSN || pageLSN < recLSN)
+		recLSN = pageLSN;
+}
+
+
+LSN Frame::GetLSN()
+{
+	return lsn;
+}
+
+
+void Frame::UnsetReferenced()
+{
+	referenced = false;
+}
+
+
+bool Frame::IsReferenced()
+{
+	return referenced;
+}
+
+
+bool Frame::IsVictim()
+{
+	return !referenced && NotPinned();
+}
+
+
+LSN Frame::GetRecLSN()
+{
+	return recLSN;
+}
+
+
+// True if a log record of the calling thread covers the page since
+// it pinned it.
+bool Frame::IsLogged()
+{
+	int i = FindHolder(false);
+	return i >= 0 && holders[i].logged;
+}
@@ -0,0 +1,270 @@
+#include <stdlib.h>
+#include <new>
+
+#include "hash.h"
+
+//------------------------------------------------------------------
+// Map
+//
+// A node of the doubly linked list kept in every bucket, mapping a
+// page ID to the frame that holds it.
+//------------------------------------------------------------------
+
+Map::Map(PageID p, int f)
+{
+	pid = p;
+	frameNo = f;
+	next = NULL;
+	prev = NULL;
+}
+
+
+Map::~Map()
+{
+}
+
+
+void Map::AddBehind(Map *m)
+{
+	m->next = next;
+	m->prev = this;
+	if (next != NULL)
+		next->prev = m;
+	next = m;
+}
+
+
+void Map::DeleteMe()
+{
+	if (next != NULL)
+		next->prev = prev;
+	if (prev != NULL)
+		prev->next = next;
+}
+
+
+bool Map::HasPageID(PageID p)
+{
+	return pid == p;
+}
+
+
+int Map::FrameNo()
+{
+	return frameNo;
+}
+
+
+//------------------------------------------------------------------
+// MapPool
+//
+// Maps for a hash table, preallocated in arrays.
+//------------------------------------------------------------------
+
+MapPool::MapPool(int numOfMaps)
+{
+	this->numOfMaps = 0;
+	freeMaps = NULL;
+	Grow(numOfMaps);
+}
+
+
+MapPool::~MapPool()
+{
+	for (size_t i = 0; i < chunks.size(); i++)
+		free(chunks[i].maps);
+}
+
+
+void MapPool::Grow(int numOfMaps)
+{
+	if (numOfMaps <= 0)
+		return;
+
+	Chunk chunk = { (Map *)malloc(numOfMaps * sizeof(Map)), numOfMaps };
+	for (int i = numOfMaps - 1; i >= 0; i--)
+	{
+		new (&chunk.maps[i]) Map(INVALID_PAGE, INVALID_FRAME);
+		chunk.maps[i].next = freeMaps;
+		freeMaps = &chunk.maps[i];
+	}
+	chunks.push_back(chunk);
+	this->numOfMaps += numOfMaps;
+}
+
+
+Map *MapPool::Get(PageID pid, int frameNo)
+{
+	Map *m = freeMaps;
+	if (m == NULL)
+		return new Map(pid, frameNo);
+
+	freeMaps = m->next;
+	m->pid = pid;
+	m->frameNo = frameNo;
+	m->next = NULL;
+	m->prev = NULL;
+	return m;
+}
+
+
+void MapPool::Put(Map *m)
+{
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		if (m >= chunks[i].maps && m < chunks[i].maps + chunks[i].numOfMaps)
+		{
+			m->next = freeMaps;
+			freeMaps = m;
+			return;
+		}
+	}
+
+	delete m;
+}
+
+
+//------------------------------------------------------------------
+// MapIterator
+//
+// Walks the nodes of a bucket, skipping the sentinel at its head.
+//------------------------------------------------------------------
+
+MapIterator::MapIterator(Map *maps)
+{
+	head = maps;
+	current = maps->next;
+}
+
+
+Map* MapIterator::operator() ()
+{
+	Map *m = current;
+	if (m != NULL)
+		current = m->next;
+	return m;
+}
+
+
+//------------------------------------------------------------------
+// Bucket
+//
+// A list of maps headed by a sentinel node that is never removed.
+//------------------------------------------------------------------
+
+Bucket::Bucket()
+{
+	maps = new Map(INVALID_PAGE, INVALID_FRAME);
+	pool = NULL;
+}
+
+
+Bucket::~Bucket()
+{
+	EmptyIt();
+	delete maps;
+}
+
+
+void Bucket::SetPool(MapPool *pool)
+{
+	this->pool = pool;
+}
+
+
+void Bucket::Insert(PageID pid, int frameNo)
+{
+	Map *m = pool->Get(pid, frameNo);
+	maps->AddBehind(m);
+}
+
+
+Status Bucket::Delete(PageID pid)
+{
+	MapIterator iter(maps);
+	Map *m;
+
+	while ((m = iter()) != NULL)
+	{
+		if (m->HasPageID(pid))
+		{
+			m->DeleteMe();
+			pool->Put(m);
+			return OK;
+		}
+	}
+
+	return FAIL;
+}
+
+
+int Bucket::Find(PageID pid)
+{
+	MapIterator iter(maps);
+	Map *m;
+
+	while ((m = iter()) != NULL)
+	{
+		if (m->HasPageID(pid))
+			return m->FrameNo();
+	}
+
+	return INVALID_FRAME;
+}
+
+
+void Bucket::EmptyIt()
+{
+	MapIterator iter(maps);
+	Map *m;
+
+	while ((m = iter()) != NULL)
+	{
+		m->DeleteMe();
+		pool->Put(m);
+	}
+}
+
+
+//------------------------------------------------------------------
+// HashTable
+//
+// Maps page IDs to frame numbers; each page goes to bucket HASH(pid).
+//------------------------------------------------------------------
+
+HashTable::HashTable(int numOfMaps) : pool(numOfMaps)
+{
+	for (int i = 0; i < NUM_OF_BUCKETS; i++)
+		buckets[i].SetPool(&pool);
+}
+
+
+void HashTable::Reserve(int numOfMaps)
+{
+	pool.Grow(numOfMaps - pool.GetNumOfMaps());
+}
+
+
+void HashTable::Insert(PageID pid, int frameNo)
+{
+	buckets[HASH(pid)].Insert(pid, frameNo);
+}
+
+
+Status HashTable::Delete(PageID pid)
+{
+	return buckets[HASH(pid)].Delete(pid);
+}
+
+
+int HashTable::LookUp(PageID pid)
+{
+	return buckets[HASH(pid)].Find(pid);
+}
+
+
+void HashTable::EmptyIt()
+{
+	for (int i = 0; i < NUM_OF_BUCKETS; i++)
+		buckets[i].EmptyIt();
+}
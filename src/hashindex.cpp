@@ -0,0 +1,611 @@
+#include <cstring>
+
+#include "hashindex.h"
+#include "heappage.h"
+#include "bufmgr.h"
+#include "db.h"
+
+#define HASH_INDEX_MAGIC 0x48494458
+
+// Pages of the bucket array the header can list, after nine ints, the
+// padding that aligns builtLSN, and builtLSN.
+#define HASH_ARRAY_PAGES ((MAX_SPACE - 10*sizeof(int) - sizeof(LSN)) / sizeof(PageID))
+
+// Buckets listed on one page of the bucket array.
+#define HASH_ARRAY_BUCKETS (MAX_SPACE / sizeof(PageID))
+
+//
+// First page of a hash index.
+//
+struct HashIndexHeader
+{
+	int    magic;
+	int    keyOffset;
+	int    keyType;
+	int    keyLength;
+	int    level;
+	int    next;
+	int    numOfBuckets;
+	int    numOfEntries;
+	int    numOfArrayPages;
+	LSN    builtLSN;
+	PageID arrayPids[HASH_ARRAY_PAGES];
+};
+
+//
+// A page of the bucket array: the primary page of HASH_ARRAY_BUCKETS
+// consecutive buckets.
+//
+struct HashArrayPage
+{
+	PageID buckets[HASH_ARRAY_BUCKETS];
+};
+
+
+void HashBucketPage::Init(int entryLength)
+{
+	overflow = INVALID_PAGE;
+	numOfEntries = 0;
+	entryLen = entryLength;
+}
+
+
+void HashBucketPage::GetRecordID(int entry, RecordID& rid)
+{
+	memcpy(&rid, data + (entry + 1) * entryLen - sizeof(RecordID), sizeof(RecordID));
+}
+
+
+//------------------------------------------------------------------
+// HashBucketPage::Append
+//
+// Input    : key - the key of the entry,
+//            keyLength - its length,
+//            rid - the record ID of the entry.
+// Output   : None.
+// Purpose  : Adds an entry after the last one.  The caller checks the
+//            page is not full.
+// Return   : None.
+//------------------------------------------------------------------
+
+void HashBucketPage::Append(const char* key, int keyLength, const RecordID& rid)
+{
+	char *entry = data + numOfEntries * entryLen;
+
+	memset(entry, 0, entryLen - sizeof(RecordID));
+	memcpy(entry, key, keyLength);
+	memcpy(entry + entryLen - sizeof(RecordID), &rid, sizeof(RecordID));
+	numOfEntries++;
+}
+
+
+//------------------------------------------------------------------
+// HashBucketPage::Remove
+//
+// Input    : entry - the entry to remove.
+// Output   : None.
+// Purpose  : Removes an entry, moving the last one into its place.
+// Return   : None.
+//------------------------------------------------------------------
+
+void HashBucketPage::Remove(int entry)
+{
+	numOfEntries--;
+	if (entry != numOfEntries)
+		memcpy(data + entry * entryLen, data + numOfEntries * entryLen, entryLen);
+}
+
+
+//------------------------------------------------------------------
+// Constructor of HashIndex
+//
+// Input    : name - name of the index file,
+//            keyOffset, keyType, keyLength - the key (see Index).
+// Output   : status - OK if the index was opened or created.
+// Purpose  : Opens the index if the database has an entry for it,
+//            and creates it with HASH_INDEX_BUCKETS empty buckets
+//            otherwise.
+//------------------------------------------------------------------
+
+HashIndex::HashIndex(const char* name, int keyOffset, AttrType keyType,
+                     int keyLength, Status& status)
+	: Index(keyOffset, keyType, keyLength)
+{
+	headerPid = INVALID_PAGE;
+	level = 0;
+	next = 0;
+	numOfEntries = 0;
+	entryLen = (keyLength + 3) / 4 * 4 + sizeof(RecordID);
+	entriesPerPage = HASH_BUCKET_SIZE / entryLen;
+
+	if (name == NULL || !KeyIsValid() || entriesPerPage < 2)
+	{
+		cerr << "HashIndex::HashIndex - Bad index name or key\n";
+		status = FAIL;
+		return;
+	}
+
+	filename = name;
+	if (MINIBASE_DB->GetFileEntry(name, headerPid) == OK)
+		status = Open();
+	else
+		status = Create(name);
+}
+
+
+HashIndex::~HashIndex()
+{
+}
+
+
+//------------------------------------------------------------------
+// HashIndex::Create
+//
+// Input    : name - name of the index file.
+// Output   : None.
+// Purpose  : Allocates the header and the first buckets of a new
+//            index and adds it to the database.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HashIndex::Create(const char* name)
+{
+	Page *page;
+
+	NEWPAGE(headerPid, page);
+	UNPIN(headerPid, DIRTY);
+
+	for (int i = 0; i < HASH_INDEX_BUCKETS; i++)
+	{
+		PageID pid;
+		if (NewBucket(pid) != OK)
+			return FAIL;
+		buckets.push_back(pid);
+		if (WriteBucketArray(i) != OK)
+			return FAIL;
+	}
+
+	if (WriteHeader() != OK)
+		return FAIL;
+	return MINIBASE_DB->AddFileEntry(name, headerPid);
+}
+
+
+//------------------------------------------------------------------
+// HashIndex::Open
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Reads the header and the bucket array of an existing
+//            index.
+// Return   : OK on success, FAIL if the file is not a hash index on
+//            the same key.
+//------------------------------------------------------------------
+
+Status HashIndex::Open()
+{
+	HashIndexHeader *header;
+	HashArrayPage *arrayPage;
+
+	PIN(headerPid, header);
+
+	if (header->magic != HASH_INDEX_MAGIC || header->keyOffset != keyOffset
+	    || header->keyType != keyType || header->keyLength != keyLength)
+	{
+		cerr << "HashIndex::Open - " << filename << " is not an index on this key\n";
+		UNPIN(headerPid, CLEAN);
+		return FAIL;
+	}
+
+	level = header->level;
+	next = header->next;
+	numOfEntries = header->numOfEntries;
+	builtLSN = header->builtLSN;
+	buckets.resize(header->numOfBuckets);
+	arrayPids.assign(header->arrayPids, header->arrayPids + header->numOfArrayPages);
+
+	UNPIN(headerPid, CLEAN);
+
+	for (size_t i = 0; i < arrayPids.size(); i++)
+	{
+		PIN(arrayPids[i], arrayPage);
+		for (size_t b = i * HASH_ARRAY_BUCKETS;
+		     b < buckets.size() && b < (i + 1) * HASH_ARRAY_BUCKETS; b++)
+			buckets[b] = arrayPage->buckets[b % HASH_ARRAY_BUCKETS];
+		UNPIN(arrayPids[i], CLEAN);
+	}
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HashIndex::Hash
+//
+// Input    : key - a key.
+// Output   : None.
+// Purpose  : Hashes a key with HashKey, whose low bits linear hashing
+//            uses.
+// Return   : The hash value.
+//------------------------------------------------------------------
+
+unsigned HashIndex::Hash(const char* key) const
+{
+	return HashKey(keyType, keyLength, key);
+}
+
+
+int HashIndex::BucketOf(unsigned hash) const
+{
+	unsigned n = (unsigned)HASH_INDEX_BUCKETS << level;
+	unsigned bucket = hash % n;
+
+	if (bucket < (unsigned)next)
+		bucket = hash % (2 * n);
+	return (int)bucket;
+}
+
+
+Status HashIndex::NewBucket(PageID& pid)
+{
+	HashBucketPage *page;
+
+	NEWPAGE(pid, page);
+	page->Init(entryLen);
+	UNPIN(pid, DIRTY);
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HashIndex::Append
+//
+// Input    : primary - primary page of a bucket,
+//            key, rid - an entry.
+// Output   : None.
+// Purpose  : Adds an entry to the first page of the bucket with room
+//            for it, adding an overflow page if there is none.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HashIndex::Append(PageID primary, const char* key, const RecordID& rid)
+{
+	HashBucketPage *page;
+	PageID pid = primary;
+
+	for (;;)
+	{
+		PIN(pid, page);
+
+		if (!page->IsFull())
+		{
+			page->Append(key, keyLength, rid);
+			UNPIN(pid, DIRTY);
+			return OK;
+		}
+
+		PageID nextPid = page->GetOverflow();
+		if (nextPid == INVALID_PAGE)
+		{
+			if (NewBucket(nextPid) != OK)
+			{
+				UNPIN(pid, CLEAN);
+				return FAIL;
+			}
+			page->SetOverflow(nextPid);
+			UNPIN(pid, DIRTY);
+		}
+		else
+		{
+			UNPIN(pid, CLEAN);
+		}
+		pid = nextPid;
+	}
+}
+
+
+//------------------------------------------------------------------
+// HashIndex::Insert
+//
+// Input    : key, rid - the entry to add.
+// Output   : None.
+// Purpose  : Adds the entry to the bucket of its key, then splits the
+//            next bucket if the index is fuller than HASH_INDEX_FILL.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HashIndex::Insert(const char* key, const RecordID& rid)
+{
+	if (Append(buckets[BucketOf(Hash(key))], key, rid) != OK)
+		return FAIL;
+	numOfEntries++;
+
+	long capacity = (long)buckets.size() * entriesPerPage;
+	if ((long)numOfEntries * 100 > capacity * HASH_INDEX_FILL
+	    && buckets.size() < HASH_ARRAY_PAGES * HASH_ARRAY_BUCKETS)
+	{
+		if (Split() != OK)
+			return FAIL;
+	}
+
+	return WriteHeader();
+}
+
+
+//------------------------------------------------------------------
+// HashIndex::Delete
+//
+// Input    : key, rid - the entry to remove.
+// Output   : None.
+// Purpose  : Removes the entry from the bucket of its key.  An
+//            overflow page left empty is freed.
+// Return   : OK on success, DONE if there is no such entry, FAIL
+//            otherwise.
+//------------------------------------------------------------------
+
+Status HashIndex::Delete(const char* key, const RecordID& rid)
+{
+	HashBucketPage *page;
+	PageID primary = buckets[BucketOf(Hash(key))];
+	PageID prevPid = INVALID_PAGE;
+	PageID pid = primary;
+
+	while (pid != INVALID_PAGE)
+	{
+		PIN(pid, page);
+
+		for (int i = 0; i < page->GetNumOfEntries(); i++)
+		{
+			RecordID entryRid;
+			page->GetRecordID(i, entryRid);
+			if (entryRid != rid || CompareKeys(page->GetKey(i), key) != 0)
+				continue;
+
+			page->Remove(i);
+
+			if (page->GetNumOfEntries() == 0 && pid != primary)
+			{
+				HashBucketPage *prevPage;
+				PageID nextPid = page->GetOverflow();
+
+				FREEPAGE(pid);
+				PIN(prevPid, prevPage);
+				prevPage->SetOverflow(nextPid);
+				UNPIN(prevPid, DIRTY);
+			}
+			else
+			{
+				UNPIN(pid, DIRTY);
+			}
+
+			numOfEntries--;
+			return WriteHeader();
+		}
+
+		prevPid = pid;
+		pid = page->GetOverflow();
+		UNPIN(prevPid, CLEAN);
+	}
+
+	return DONE;
+}
+
+
+//------------------------------------------------------------------
+// HashIndex::Lookup
+//
+// Input    : key - the key to look up.
+// Output   : rids - the record ID of every entry of the key, in no
+//            particular order.
+// Purpose  : Reads the bucket of the key.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HashIndex::Lookup(const char* key, std::vector<RecordID>& rids)
+{
+	HashBucketPage *page;
+	PageID pid = buckets[BucketOf(Hash(key))];
+
+	rids.clear();
+	while (pid != INVALID_PAGE)
+	{
+		PIN(pid, page);
+
+		for (int i = 0; i < page->GetNumOfEntries(); i++)
+		{
+			if (CompareKeys(page->GetKey(i), key) == 0)
+			{
+				RecordID rid;
+				page->GetRecordID(i, rid);
+				rids.push_back(rid);
+			}
+		}
+
+		PageID nextPid = page->GetOverflow();
+		UNPIN(pid, CLEAN);
+		pid = nextPid;
+	}
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HashIndex::Split
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Splits bucket next: adds bucket next + n, where n is the
+//            number of buckets at the start of this round, and moves
+//            there the entries whose hash says so.  The overflow pages
+//            of the old bucket are freed and its entries put back.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HashIndex::Split()
+{
+	HashBucketPage *page;
+	PageID primary = buckets[next];
+	PageID pid = primary;
+	std::vector<char> entries;
+
+	while (pid != INVALID_PAGE)
+	{
+		PIN(pid, page);
+
+		entries.insert(entries.end(), page->GetKey(0),
+		               page->GetKey(0) + page->GetNumOfEntries() * entryLen);
+		PageID nextPid = page->GetOverflow();
+
+		if (pid == primary)
+		{
+			page->Init(entryLen);
+			UNPIN(pid, DIRTY);
+		}
+		else
+		{
+			FREEPAGE(pid);
+		}
+		pid = nextPid;
+	}
+
+	PageID newPid;
+	if (NewBucket(newPid) != OK)
+		return FAIL;
+	buckets.push_back(newPid);
+
+	if (++next == (HASH_INDEX_BUCKETS << level))
+	{
+		level++;
+		next = 0;
+	}
+
+	for (size_t e = 0; e < entries.size(); e += entryLen)
+	{
+		const char *key = &entries[e];
+		RecordID rid;
+		memcpy(&rid, key + entryLen - sizeof(RecordID), sizeof(RecordID));
+
+		if (Append(buckets[BucketOf(Hash(key))], key, rid) != OK)
+			return FAIL;
+	}
+
+	return WriteBucketArray(buckets.size() - 1);
+}
+
+
+//------------------------------------------------------------------
+// HashIndex::WriteBucketArray
+//
+// Input    : bucket - a bucket.
+// Output   : None.
+// Purpose  : Stores the primary page of the bucket in the bucket
+//            array, adding a page to the array if it is full.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HashIndex::WriteBucketArray(int bucket)
+{
+	HashArrayPage *arrayPage;
+	size_t i = bucket / HASH_ARRAY_BUCKETS;
+
+	if (i == arrayPids.size())
+	{
+		PageID pid;
+		NEWPAGE(pid, arrayPage);
+		arrayPids.push_back(pid);
+	}
+	else
+	{
+		PIN(arrayPids[i], arrayPage);
+	}
+
+	arrayPage->buckets[bucket % HASH_ARRAY_BUCKETS] = buckets[bucket];
+	UNPIN(arrayPids[i], DIRTY);
+
+	return OK;
+}
+
+
+Status HashIndex::WriteHeader()
+{
+	HashIndexHeader *header;
+
+	PIN(headerPid, header);
+
+	header->magic = HASH_INDEX_MAGIC;
+	header->keyOffset = keyOffset;
+	header->keyType = keyType;
+	header->keyLength = keyLength;
+	header->level = level;
+	header->next = next;
+	header->numOfBuckets = buckets.size();
+	header->numOfEntries = numOfEntries;
+	header->numOfArrayPages = arrayPids.size();
+	header->builtLSN = builtLSN;
+	for (size_t i = 0; i < arrayPids.size(); i++)
+		header->arrayPids[i] = arrayPids[i];
+
+	UNPIN(headerPid, DIRTY);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HashIndex::DeleteFile
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Frees every bucket page, the bucket array and the header,
+//            and removes the index from the database.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HashIndex::DeleteFile()
+{
+	HashBucketPage *page;
+
+	for (size_t b = 0; b < buckets.size(); b++)
+	{
+		PageID pid = buckets[b];
+		while (pid != INVALID_PAGE)
+		{
+			PIN(pid, page);
+			PageID nextPid = page->GetOverflow();
+			FREEPAGE(pid);
+			pid = nextPid;
+		}
+	}
+
+	for (size_t i = 0; i < arrayPids.size(); i++)
+		FREEPAGE(arrayPids[i]);
+	FREEPAGE(headerPid);
+
+	buckets.clear();
+	arrayPids.clear();
+	numOfEntries = 0;
+
+	return MINIBASE_DB->DeleteFileEntry(filename.c_str());
+}
+
+
+//------------------------------------------------------------------
+// HashIndex::Clear
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Deletes the index and creates it again under its name,
+//            with HASH_INDEX_BUCKETS empty buckets.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HashIndex::Clear()
+{
+	if (DeleteFile() != OK)
+		return FAIL;
+
+	level = 0;
+	next = 0;
+	return Create(filename.c_str());
+}
@@ -0,0 +1,1975 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "heapfile.h"
+#include "heappage.h"
+#include "dirpage.h"
+#include "scan.h"
+#include "bufmgr.h"
+#include "db.h"
+#include "logmgr.h"
+#include "metrics.h"
+#include "index.h"
+#include "mvcc.h"
+#include "largerecord.h"
+#include "locktable.h"
+
+// Times UpdateRecord moves a record before giving up on finding room for
+// its stub.
+#define STUB_TRIES 3
+
+
+//------------------------------------------------------------------
+// StampPage
+//
+// Input    : pid - a pinned heap page,
+//            page - that page,
+//            lsn - LSN of the log record for the change just made.
+// Output   : None.
+// Purpose  : Records the LSN in the page header and in its frame, so
+//            that the page is not written before its log record.
+// Return   : None.
+//------------------------------------------------------------------
+
+static void StampPage(PageID pid, HeapPage* page, LSN lsn)
+{
+	page->SetLSN(lsn);
+	MINIBASE_BM->SetPageLSN(pid, lsn);
+}
+
+
+// Threads holding each insert target slot, in every file at once.
+static std::atomic<int> slotThreads[INSERT_TARGETS];
+
+// Holds a slot for as long as its thread lives.
+struct ThreadSlot
+{
+	int slot;
+
+	ThreadSlot()
+	{
+		// The slot fewest threads hold; ties go to the lowest.  It is
+		// claimed only if no other thread took it meanwhile, so that
+		// threads starting together do not all pick the same one.
+		for (;;)
+		{
+			slot = 0;
+			int held = slotThreads[0].load();
+			for (int i = 1; i < INSERT_TARGETS; i++)
+			{
+				int n = slotThreads[i].load();
+				if (n < held)
+				{
+					slot = i;
+					held = n;
+				}
+			}
+			if (slotThreads[slot].compare_exchange_strong(held, held + 1))
+				return;
+		}
+	}
+
+	~ThreadSlot() { slotThreads[slot].fetch_sub(1); }
+};
+
+
+//------------------------------------------------------------------
+// ThreadTarget
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Gives each thread, on its first insert into any file, the
+//            insert target slot fewest live threads hold, and takes it
+//            back when the thread exits, so that the pages of threads
+//            gone are left to the threads still inserting.
+// Return   : The slot of the calling thread.
+//------------------------------------------------------------------
+
+static int ThreadTarget()
+{
+	thread_local ThreadSlot slot;
+	return slot.slot;
+}
+
+
+// True if a live thread other than the caller inserts into the page.
+static bool IsOthersTarget(const PageID* targetPids, int own, PageID pid)
+{
+	for (int i = 0; i < INSERT_TARGETS; i++)
+	{
+		if (i != own && targetPids[i] == pid && slotThreads[i].load() > 0)
+			return true;
+	}
+	return false;
+}
+
+
+HeapFile::HeapFile( const char* name, Status& returnStatus )
+	: HeapFile( name, NULL, returnStatus )
+{
+}
+
+
+//------------------------------------------------------------------
+// Constructor of HeapFile
+//
+// Input    : name - name of the file, NULL for a temporary file,
+//            poolName - buffer pool for its pages, NULL for the
+//            default one.
+// Output   : returnStatus - OK if the file was opened or created.
+// Purpose  : Opens the file if the database has an entry for it,
+//            and creates it with an empty directory page otherwise.
+//            An existing file's pages are bound to the pool.
+//------------------------------------------------------------------
+
+HeapFile::HeapFile( const char* name, const char* poolName, Status& returnStatus )
+{
+	DirPage *dirPage;
+
+	extentNext = 0;
+	extentEnd = 0;
+	dirPid = lastDirPid = INVALID_PAGE;
+	for (int i = 0; i < INSERT_TARGETS; i++)
+		SetTarget(i, INVALID_PAGE, INVALID_PAGE);
+
+	pool = DEFAULT_POOL;
+	if (poolName != NULL && (pool = MINIBASE_BM->GetPoolNo(poolName)) == -1)
+	{
+		cerr << "HeapFile::HeapFile - no buffer pool " << poolName << endl;
+		pool = DEFAULT_POOL;
+		returnStatus = FAIL;
+		return;
+	}
+
+	string prefix = string("heapfile.") + (name ? name : "tmp_file") + ".";
+	inserts = &minibase_metrics.GetCounter(prefix + "insert");
+	deletes = &minibase_metrics.GetCounter(prefix + "delete");
+	updates = &minibase_metrics.GetCounter(prefix + "update");
+	scans = &minibase_metrics.GetCounter(prefix + "scan");
+	scanRecords = &minibase_metrics.GetCounter(prefix + "scan.records");
+
+	if (name == NULL)
+	{
+		filename = "tmp_file";
+		type = TEMPORARY;
+		if (NewExtentPage(dirPid, (Page *&)dirPage) != OK)
+		{
+			cerr << "Error creating new file." << endl;
+			returnStatus = FAIL;
+			return;
+		}
+	}
+	else if (MINIBASE_DB->GetFileEntry(name, dirPid) != OK)
+	{
+		filename = name;
+		type = PERMANENT;
+		if (NewExtentPage(dirPid, (Page *&)dirPage) != OK)
+		{
+			cerr << "Error creating new file." << endl;
+			returnStatus = FAIL;
+			return;
+		}
+		MINIBASE_DB->AddFileEntry(name, dirPid);
+	}
+	else
+	{
+		// The file exists; walk its directory to find the last page.
+
+		filename = name;
+		type = PERMANENT;
+
+		if (MINIBASE_BM->PinPage(dirPid, (Page *&)dirPage) != OK)
+		{
+			cerr << "HeapFile::HeapFile - Error pinning the directories\n";
+			returnStatus = FAIL;
+			return;
+		}
+
+		PageID pid = dirPid;
+		PageID nextPid;
+		while ((nextPid = dirPage->GetNextPage()) != INVALID_PAGE)
+		{
+			if (MINIBASE_BM->UnpinPage(pid, CLEAN) != OK)
+			{
+				cerr << "HeapFile::HeapFile - Error unpinning the directories\n";
+				returnStatus = FAIL;
+				return;
+			}
+			if (MINIBASE_BM->PinPage(nextPid, (Page *&)dirPage) != OK)
+			{
+				cerr << "HeapFile::HeapFile - Error pinning the directories\n";
+				returnStatus = FAIL;
+				return;
+			}
+			pid = nextPid;
+		}
+
+		// The first extent taken from now on should follow the file's
+		// last directory page if it can.
+		lastDirPid = pid;
+		extentNext = lastDirPid + 1;
+		extentEnd = extentNext;
+
+		if (MINIBASE_BM->UnpinPage(pid, CLEAN) != OK)
+		{
+			cerr << "Error unpinning the directories\n";
+			returnStatus = FAIL;
+			return;
+		}
+
+		if (pool != DEFAULT_POOL && BindPages() != OK)
+		{
+			cerr << "HeapFile::HeapFile - Error binding the pages to " << poolName << endl;
+			returnStatus = FAIL;
+			return;
+		}
+
+		returnStatus = OK;
+		return;
+	}
+
+	dirPage->Init(dirPid);
+	dirPage->SetNextPage(INVALID_PAGE);
+	dirPage->SetPrevPage(INVALID_PAGE);
+	lastDirPid = dirPid;
+
+	if (MINIBASE_BM->UnpinPage(dirPid, DIRTY) != OK)
+	{
+		cerr << "Error unpinning the directory." << endl;
+		returnStatus = FAIL;
+		return;
+	}
+
+	returnStatus = OK;
+}
+
+
+//------------------------------------------------------------------
+// Destructor of HeapFile
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : A temporary file is deleted when it goes out of scope;
+//            a permanent one gives back the unused part of its extent.
+//------------------------------------------------------------------
+
+HeapFile::~HeapFile()
+{
+	if (type == TEMPORARY && dirPid != INVALID_PAGE)
+		DeleteFile();
+	else
+		ReleaseExtent();
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::DeleteFile
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Frees every data page and directory page of the file
+//            and removes its entry from the database.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::DeleteFile()
+{
+	{
+		LatchGuard dirs(&latch, true);
+		DirPageIterator dirIter(dirPid);
+		PageID pid;
+		DirPage *dirPage;
+		PageInfo *info;
+
+		while ((pid = dirIter()) != INVALID_PAGE)
+		{
+			PIN(pid, dirPage);
+
+			PageInfoIterator infoIter(dirPage);
+			while ((info = infoIter()) != NULL)
+			{
+				FREEPAGE(info->pid);
+			}
+
+			UNPIN(pid, CLEAN);
+			FREEPAGE(pid);
+		}
+
+		for (int i = 0; i < INSERT_TARGETS; i++)
+			SetTarget(i, INVALID_PAGE, INVALID_PAGE);
+	}
+
+	if (ReleaseExtent() != OK)
+		return FAIL;
+
+	if (type == PERMANENT)
+		MINIBASE_DB->DeleteFileEntry(filename.c_str());
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::GetNumOfRecords
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Adds up the record counts kept in the directory.
+// Return   : The number of records in the file.
+//------------------------------------------------------------------
+
+int HeapFile::GetNumOfRecords()
+{
+	LatchGuard dirs(&latch, false);
+	DirPageIterator dirIter(dirPid);
+	PageID pid;
+	DirPage *dirPage;
+	PageInfo *info;
+	int numOfRecords = 0;
+
+	while ((pid = dirIter()) != INVALID_PAGE)
+	{
+		PIN(pid, dirPage);
+
+		PageInfoIterator infoIter(dirPage);
+		while ((info = infoIter()) != NULL)
+			numOfRecords += info->GetNumOfRecords();
+
+		UNPIN(pid, CLEAN);
+	}
+
+	return numOfRecords;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::InsertRecord, HeapFile::AppendRecord
+//
+// Input    : recPtr - the record,
+//            recLen - its length.
+// Output   : outRid - record ID of the inserted record.
+// Purpose  : Inserts the record into the page the calling thread
+//            last inserted into, or else the first page with room for
+//            it that no other thread is inserting into, or for
+//            AppendRecord the last page if it has room, adding a new
+//            page otherwise.  Insert also places records
+//            that UpdateRecord moves, of kind SLOT_MOVED, which the
+//            indexes know under the record ID of their stubs.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::InsertRecord(char *recPtr, int recLen, RecordID& outRid)
+{
+	return Insert(recPtr, recLen, outRid, false, SLOT_RECORD);
+}
+
+
+Status HeapFile::AppendRecord(char *recPtr, int recLen, RecordID& outRid)
+{
+	return Insert(recPtr, recLen, outRid, true, SLOT_RECORD);
+}
+
+
+Status HeapFile::Insert(char *recPtr, int recLen, RecordID& outRid, bool append, int kind)
+{
+	// A record no page can hold would have every page found full, and
+	// pages added until the database is.
+
+	if (recLen < 0 || recLen > HeapPage::MaxRecordLength())
+	{
+		cerr << " Attempting to insert records that is larger than size of a page" << endl;
+		return FAIL;
+	}
+
+	Status status;
+	while ((status = FindRoom(recPtr, recLen, outRid, append, kind)) == DONE)
+	{
+		// No page has room; add one and look again.
+
+		LatchGuard dirs(&latch, true);
+		PageID pid, dirPidCur;
+		if (NewPage(pid, dirPidCur) != OK)
+			return FAIL;
+		if (!append)
+			SetTarget(ThreadTarget(), pid, dirPidCur);
+	}
+	if (status != OK)
+		return FAIL;
+	if (kind != SLOT_RECORD)
+		return OK;
+
+	std::lock_guard<std::mutex> lock(indexMutex);
+	for (size_t i = 0; i < indexes.size(); i++)
+	{
+		if (indexes[i]->InsertRecord(recPtr, recLen, outRid) != OK)
+			return FAIL;
+	}
+
+	inserts->Add();
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::FindRoom
+//
+// Input    : recPtr, recLen, kind - as for Insert,
+//            append - true to insert into the last page only.
+// Output   : outRid - record ID of the inserted record.
+// Purpose  : Inserts the record into the calling thread's target page
+//            if it has room.  Otherwise it walks the directory for a
+//            page with room that is no other thread's target and whose
+//            latch no other thread holds, which becomes the thread's
+//            target, so that threads inserting at once each fill pages
+//            of their own rather than queue on one.  If every such page
+//            is latched, it waits for the first.
+// Return   : OK on success, DONE if no page has room, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::FindRoom(char *recPtr, int recLen, RecordID& outRid, bool append, int kind)
+{
+	LatchGuard dirs(&latch, false);
+	int own = ThreadTarget();
+	PageID targetPids[INSERT_TARGETS];
+	PageID busyPid = INVALID_PAGE;
+	PageID busyDirPid = INVALID_PAGE;
+	Status status;
+	bool busy;
+
+	for (int i = 0; i < INSERT_TARGETS; i++)
+	{
+		PageID targetDirPid;
+		GetTarget(i, targetPids[i], targetDirPid);
+		if (i == own && !append && targetPids[i] != INVALID_PAGE)
+		{
+			status = InsertInto(targetPids[i], targetDirPid, true, recPtr, recLen, outRid, kind, busy);
+			if (status != DONE)
+				return status;
+		}
+	}
+
+	DirPageIterator dirIter(dirPid);
+	PageID dirPidCur = append ? lastDirPid : dirIter();
+
+	for (; dirPidCur != INVALID_PAGE; dirPidCur = append ? INVALID_PAGE : dirIter())
+	{
+		DirPage *dirPage;
+		PageInfo *info, *last = NULL;
+		std::vector<PageID> pids;
+
+		PIN(dirPidCur, dirPage);
+		PageInfoIterator infoIter(dirPage);
+		while ((info = infoIter()) != NULL)
+		{
+			if (!append && info->GetSpaceAvailable() >= recLen && info->pid != targetPids[own]
+			    && !IsOthersTarget(targetPids, own, info->pid))
+				pids.push_back(info->pid);
+			last = info;
+		}
+		if (append && last != NULL && last->GetSpaceAvailable() >= recLen)
+			pids.push_back(last->pid);
+		UNPIN(dirPidCur, CLEAN);
+
+		for (size_t i = 0; i < pids.size(); i++)
+		{
+			status = InsertInto(pids[i], dirPidCur, append, recPtr, recLen, outRid, kind, busy);
+			if (status == OK && !append)
+				SetTarget(own, pids[i], dirPidCur);
+			if (status != DONE)
+				return status;
+			if (busy && busyPid == INVALID_PAGE)
+			{
+				busyPid = pids[i];
+				busyDirPid = dirPidCur;
+			}
+		}
+	}
+
+	if (busyPid == INVALID_PAGE)
+		return DONE;
+	status = InsertInto(busyPid, busyDirPid, true, recPtr, recLen, outRid, kind, busy);
+	if (status == OK && !append)
+		SetTarget(own, busyPid, busyDirPid);
+	return status;
+}
+
+
+void HeapFile::GetTarget(int slot, PageID& pid, PageID& dirPid)
+{
+	LatchGuard guard(&targets[slot].latch, true);
+	pid = targets[slot].pid;
+	dirPid = targets[slot].dirPid;
+}
+
+
+void HeapFile::SetTarget(int slot, PageID pid, PageID dirPid)
+{
+	LatchGuard guard(&targets[slot].latch, true);
+	targets[slot].pid = pid;
+	targets[slot].dirPid = dirPid;
+}
+
+
+PageID HeapFile::GetInsertTarget()
+{
+	PageID pid, targetDirPid;
+	GetTarget(ThreadTarget(), pid, targetDirPid);
+	return pid;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::InsertInto
+//
+// Input    : pid - a data page of the file,
+//            dirPidCur - the directory page listing it,
+//            wait - false to give up if another thread holds the
+//            page's latch,
+//            recPtr, recLen, kind - as for Insert.
+// Output   : outRid - record ID of the inserted record,
+//            busy - true if the page was latched and wait false.
+// Purpose  : Inserts the record into the page and adjusts its entry
+//            in the directory by the space and records it took.  A
+//            moved record counts on the page of its stub, not here.
+// Return   : OK on success, DONE if the page has no room for the
+//            record, or was busy, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::InsertInto(PageID pid, PageID dirPidCur, bool wait, char *recPtr, int recLen,
+                            RecordID& outRid, int kind, bool& busy)
+{
+	HeapPage *page;
+	DirPage *dirPage;
+	LatchGuard pageLatch;
+
+	busy = false;
+	PIN(pid, page);
+	if (wait)
+		pageLatch.Lock(MINIBASE_BM->GetPageLatch(pid), true);
+	else if (!pageLatch.TryLockExclusive(MINIBASE_BM->GetPageLatch(pid)))
+	{
+		busy = true;
+		UNPIN(pid, CLEAN);
+		return DONE;
+	}
+
+	// The directory may be behind a thread that filled the page since.
+
+	int space = page->AvailableSpace();
+	int numOfRecords = page->GetNumOfRecords();
+	if (page->InsertRecord(recPtr, recLen, outRid, kind) != OK)
+	{
+		bool empty = page->IsEmpty();
+		UNPIN(pid, CLEAN);
+		if (!empty)
+			return DONE;
+		cerr << "HeapFile::Insert - no room for a record of " << recLen << " bytes\n";
+		return FAIL;
+	}
+
+	// The directory page changes only in its entry for the page,
+	// which restart recomputes from the page; the same record covers it.
+
+	LSN lsn = MINIBASE_LOG->LogInsert(outRid, dirPidCur, recPtr, recLen, kind);
+	StampPage(pid, page, lsn);
+
+	PIN(dirPidCur, dirPage);
+	dirPage->FindPageInfo(pid)->Adjust(page->AvailableSpace() - space,
+	                                   page->GetNumOfRecords() - numOfRecords);
+	MINIBASE_BM->SetPageLSN(dirPidCur, lsn);
+
+	UNPIN(dirPidCur, DIRTY);
+	UNPIN(pid, DIRTY);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::GetRecord
+//
+// Input    : rid - record ID of the record to read.
+// Output   : recPtr - a copy of the record,
+//            recLen - its length.
+// Purpose  : Reads a record, from the page its stub points to if it
+//            was moved.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::GetRecord(const RecordID& rid, char *recPtr, int& recLen)
+{
+	HeapPage *page;
+	RecordID at;
+	bool forwarded;
+	Status status;
+
+	RecordLock lock(rid, false);
+	LatchGuard dirs(&latch, false);
+
+	PIN(rid.pageNo, page);
+	{
+		LatchGuard pageLatch(MINIBASE_BM->GetPageLatch(rid.pageNo), false);
+		forwarded = (page->GetSlotKind(rid) == SLOT_FORWARD);
+		status = forwarded ? page->GetRecord(rid, (char *)&at, recLen)
+		                   : page->GetRecord(rid, recPtr, recLen);
+	}
+	UNPIN(rid.pageNo, CLEAN);
+
+	if (forwarded && status == OK)
+	{
+		PIN(at.pageNo, page);
+		{
+			LatchGuard pageLatch(MINIBASE_BM->GetPageLatch(at.pageNo), false);
+			status = page->GetRecord(at, recPtr, recLen);
+		}
+		UNPIN(at.pageNo, CLEAN);
+	}
+
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::GetRecordAsync
+//
+// Input    : rid - record ID of the record to read,
+//            done - called with the outcome of the read.
+// Output   : recPtr - a copy of the record, once done is called.
+// Purpose  : Reads the record in the calling thread if that needs no
+//            page read from disk, and otherwise fetches the pages it
+//            needs without a thread waiting for them, and reads it on
+//            one of MINIBASE_IO's threads once they are in, so that
+//            as many such reads can wait for the disk at once as the
+//            I/O service's queue depth.
+// Return   : None.
+//------------------------------------------------------------------
+
+void HeapFile::GetRecordAsync(const RecordID& rid, char *recPtr, ReadCallback done)
+{
+	ReadWhenIn(rid, recPtr, done, INVALID_PAGE);
+}
+
+
+// Fetches the pages the record needs one at a time, then reads it.  A
+// page that was fetched and is gone again by then, evicted by other
+// reads, is left to GetRecord to read rather than fetched over again.
+void HeapFile::ReadWhenIn(const RecordID& rid, char *recPtr, ReadCallback done, PageID fetched)
+{
+	PageID missing = MissingPage(rid);
+	if (missing == INVALID_PAGE || missing == fetched)
+	{
+		int recLen;
+		Status status = GetRecord(rid, recPtr, recLen);
+		done(status, recLen);
+		return;
+	}
+
+	HeapFile *file = this;
+	RecordID at = rid;
+	MINIBASE_BM->FetchPage(missing, [file, at, recPtr, done, missing](Status status) {
+		if (status != OK)
+			done(status, 0);
+		else
+			file->ReadWhenIn(at, recPtr, done, missing);
+	});
+}
+
+
+// A page GetRecord reads for the record that is not in the pool: its
+// own, or the one its stub points to if it was moved.  INVALID_PAGE if
+// both are in.
+PageID HeapFile::MissingPage(const RecordID& rid)
+{
+	if (!MINIBASE_BM->IsResident(rid.pageNo))
+		return rid.pageNo;
+
+	HeapPage *page;
+	RecordID at = rid;
+	int len;
+
+	if (MINIBASE_BM->PinPage(rid.pageNo, (Page *&)page) != OK)
+		return rid.pageNo;
+	{
+		LatchGuard pageLatch(MINIBASE_BM->GetPageLatch(rid.pageNo), false);
+		if (page->GetSlotKind(rid) == SLOT_FORWARD)
+			page->GetRecord(rid, (char *)&at, len);
+	}
+	MINIBASE_BM->UnpinPage(rid.pageNo, CLEAN);
+
+	if (at.pageNo == rid.pageNo || MINIBASE_BM->IsResident(at.pageNo))
+		return INVALID_PAGE;
+	return at.pageNo;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::FindDirPage
+//
+// Input    : pid - a data page.
+// Output   : dirPidCur, dirPage - the directory page listing it, left
+//            pinned,
+//            info - its entry there.
+// Purpose  : Finds the directory entry of a page.
+// Return   : OK on success, DONE if no directory page of the file
+//            lists the page, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::FindDirPage(PageID pid, PageID& dirPidCur, DirPage*& dirPage, PageInfo*& info)
+{
+	DirPageIterator dirIter(dirPid);
+
+	while ((dirPidCur = dirIter()) != INVALID_PAGE)
+	{
+		PIN(dirPidCur, dirPage);
+
+		if ((info = dirPage->FindPageInfo(pid)) != NULL)
+			return OK;
+
+		UNPIN(dirPidCur, CLEAN);
+	}
+
+	return DONE;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::Follow
+//
+// Input    : rid - record ID of a record.
+// Output   : at - where the record is: rid, or the slot its stub
+//            points to if it was moved,
+//            kind - the SlotKind of rid.
+// Purpose  : Looks up where a record is kept.
+// Return   : OK on success, DONE if no page of the file holds the
+//            record, FAIL if rid is not a record.
+//------------------------------------------------------------------
+
+Status HeapFile::Follow(const RecordID& rid, RecordID& at, int& kind)
+{
+	PageID dirPidCur;
+	DirPage *dirPage;
+	PageInfo *info;
+	HeapPage *page;
+
+	LatchGuard dirs(&latch, false);
+	Status status = FindDirPage(rid.pageNo, dirPidCur, dirPage, info);
+	if (status != OK)
+		return status;
+	UNPIN(dirPidCur, CLEAN);
+
+	PIN(rid.pageNo, page);
+	{
+		LatchGuard pageLatch(MINIBASE_BM->GetPageLatch(rid.pageNo), false);
+		kind = page->GetSlotKind(rid);
+		int len;
+		at = rid;
+		if (kind == SLOT_FORWARD)
+			page->GetRecord(rid, (char *)&at, len);
+	}
+	UNPIN(rid.pageNo, CLEAN);
+
+	if (kind != SLOT_RECORD && kind != SLOT_FORWARD && kind != SLOT_LARGE)
+	{
+		cerr << "HeapFile::Follow - " << rid << " is not a record\n";
+		return FAIL;
+	}
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::DeleteRecord
+//
+// Input    : rid - record ID of the record to delete.
+// Output   : None.
+// Purpose  : Deletes a record, and its stub if it was moved, or its
+//            overflow pages if it is large.  The pages go after the
+//            slot, so that no slot is ever left pointing at freed ones.
+// Return   : OK on success, DONE if no page of the file holds the
+//            record, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::DeleteRecord(const RecordID& rid)
+{
+	RecordLock lock(rid, true);
+	RecordID at;
+	int kind;
+	Status status = Follow(rid, at, kind);
+	if (status != OK)
+		return status;
+
+	if (kind == SLOT_LARGE)
+	{
+		LargeRecordHeader header;
+		int len;
+		status = GetRecord(rid, (char *)&header, len);
+		if (status == OK)
+			status = Erase(rid, false);
+		if (status == OK)
+			status = FreeOverflow(header);
+	}
+	else if (at == rid)
+	{
+		status = Erase(rid, true);
+	}
+	else
+	{
+		// The indexes know the record by the record ID of its stub.
+
+		char rec[MAX_SPACE];
+		int len;
+		if (GetRecord(at, rec, len) != OK)
+			return FAIL;
+		{
+			std::lock_guard<std::mutex> lock(indexMutex);
+			for (size_t i = 0; i < indexes.size(); i++)
+			{
+				if (indexes[i]->DeleteRecord(rec, len, rid) == FAIL)
+					return FAIL;
+			}
+		}
+
+		status = Erase(at, false);
+		if (status == OK)
+			status = Erase(rid, false);
+	}
+
+	if (status == OK)
+		deletes->Add();
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::Erase
+//
+// Input    : rid - a slot of the file,
+//            unindex - whether to remove the record from the indexes.
+// Output   : None.
+// Purpose  : Empties the slot.  A data page left empty is freed,
+//            and so is a directory page left empty, unless it is the
+//            only one.
+// Return   : OK on success, DONE if no page of the file holds the
+//            slot, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::Erase(const RecordID& rid, bool unindex)
+{
+	PageID dirPidCur;
+	DirPage *dirPage;
+	HeapPage *page;
+	PageInfo *info;
+	bool empty;
+
+	{
+		LatchGuard dirs(&latch, false);
+		Status status = FindDirPage(rid.pageNo, dirPidCur, dirPage, info);
+		if (status != OK)
+			return status;
+
+		// The directory page that points to the record is still pinned.
+
+		PIN(info->pid, page);
+		LatchGuard pageLatch(MINIBASE_BM->GetPageLatch(info->pid), true);
+
+		char *oldRecPtr;
+		int oldRecLen;
+		int kind = page->GetSlotKind(rid);
+		int space = page->AvailableSpace();
+		int numOfRecords = page->GetNumOfRecords();
+		LSN lsn = INVALID_LSN;
+
+		if (page->ReturnRecord(rid, oldRecPtr, oldRecLen) == OK && oldRecLen != INVALID_SLOT)
+		{
+			std::lock_guard<std::mutex> lock(indexMutex);
+			for (size_t i = 0; unindex && i < indexes.size(); i++)
+			{
+				if (indexes[i]->DeleteRecord(oldRecPtr, oldRecLen, rid) == FAIL)
+				{
+					UNPIN(info->pid, CLEAN);
+					UNPIN(dirPidCur, CLEAN);
+					return FAIL;
+				}
+			}
+
+			lsn = MINIBASE_LOG->LogDelete(rid, dirPidCur, oldRecPtr, oldRecLen, kind);
+			page->DeleteRecord(rid);
+			StampPage(info->pid, page, lsn);
+		}
+
+		// Only the entry of the page changes, as in InsertRecord.
+
+		info->Adjust(page->AvailableSpace() - space, page->GetNumOfRecords() - numOfRecords);
+		if (lsn != INVALID_LSN)
+			MINIBASE_BM->SetPageLSN(dirPidCur, lsn);
+		empty = page->IsEmpty();
+
+		UNPIN(dirPidCur, DIRTY);
+		UNPIN(rid.pageNo, DIRTY);
+	}
+
+	if (empty)
+		return FreeIfEmpty(rid.pageNo);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::FreeIfEmpty
+//
+// Input    : pid - a data page that Erase left empty.
+// Output   : None.
+// Purpose  : Frees the page if it is still empty and still the file's,
+//            since another thread may have inserted into it or freed
+//            it meanwhile, and then its directory page if that is left
+//            empty and is not the only one.  The directory page is
+//            logged as an image when it is unpinned.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::FreeIfEmpty(PageID pid)
+{
+	PageID dirPidCur;
+	DirPage *dirPage;
+	HeapPage *page;
+	PageInfo *info;
+
+	LatchGuard dirs(&latch, true);
+	Status status = FindDirPage(pid, dirPidCur, dirPage, info);
+	if (status == DONE)
+		return OK;
+	if (status != OK)
+		return status;
+
+	PIN(pid, page);
+	if (!page->IsEmpty())
+	{
+		UNPIN(pid, CLEAN);
+		UNPIN(dirPidCur, CLEAN);
+		return OK;
+	}
+
+	FREEPAGE(pid);
+	dirPage->DeletePage(pid);
+
+	for (int i = 0; i < INSERT_TARGETS; i++)
+	{
+		PageID targetPid, targetDirPid;
+		GetTarget(i, targetPid, targetDirPid);
+		if (targetPid == pid)
+			SetTarget(i, INVALID_PAGE, INVALID_PAGE);
+	}
+
+	if (dirPage->IsEmpty() && dirPage->Deletable())
+	{
+		if (dirPidCur == lastDirPid)
+			lastDirPid = dirPage->GetPrevPage();
+		dirPage->DeleteItSelf();
+		if (dirPage->IsHead())
+			dirPid = dirPage->GetNextPage();
+		FREEPAGE(dirPidCur);
+	}
+	else
+	{
+		UNPIN(dirPidCur, DIRTY);
+	}
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::UpdateRecord
+//
+// Input    : rid - record ID of the record to update,
+//            recPtr - the new contents,
+//            recLen - their length.
+// Output   : None.
+// Purpose  : Replaces a record, keeping its record ID whatever its
+//            new length.  The record stays in its slot if its page has
+//            room; otherwise it moves to another page with room and a
+//            stub pointing to it takes its slot.  A moved record goes
+//            back to its slot once it fits there again, and otherwise
+//            stays where it is if it can, or moves on; the stub always
+//            points straight at it.
+// Return   : OK on success, DONE if no page of the file holds the
+//            record, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::UpdateRecord(const RecordID& rid, char *recPtr, int recLen)
+{
+	if (recLen < 0 || recLen > HeapPage::MaxRecordLength())
+	{
+		cerr << " Attempting to update records to larger than size of a page" << endl;
+		return FAIL;
+	}
+
+	RecordLock lock(rid, true);
+	RecordID at;
+	int kind;
+	Status status = Follow(rid, at, kind);
+	if (status != OK)
+		return status;
+	if (kind == SLOT_LARGE)
+	{
+		cerr << "HeapFile::UpdateRecord - " << rid << " is a large record\n";
+		return FAIL;
+	}
+	bool forwarded = (at != rid);
+
+	// The indexes change once the record has, so that an update that
+	// fails leaves them as they were.  The old record is read before
+	// they are locked, since a thread deleting a record locks them with
+	// its page latched.
+
+	char old[MAX_SPACE];
+	int oldLen;
+	bool indexed;
+	{
+		std::lock_guard<std::mutex> lock(indexMutex);
+		indexed = !indexes.empty();
+	}
+	if (indexed && GetRecord(at, old, oldLen) != OK)
+		return FAIL;
+
+	// In its own slot if it fits, else where it was moved to.
+
+	status = Replace(rid, recPtr, recLen, SLOT_RECORD);
+	if (status == OK && forwarded)
+		status = Erase(at, false);
+	else if (status == DONE && forwarded)
+		status = Replace(at, recPtr, recLen, SLOT_MOVED);
+
+	// Moved to a page with room, the stub pointed at it, and then the
+	// copy it replaces dropped.  Other threads may fill the page of the
+	// stub after the record is found not to fit there; the move is then
+	// tried again.
+
+	for (int tries = 0; status == DONE; tries++)
+	{
+		RecordID moved;
+		if (Insert(recPtr, recLen, moved, false, SLOT_MOVED) != OK)
+			return FAIL;
+
+		status = Replace(rid, (char *)&moved, sizeof(RecordID), SLOT_FORWARD);
+		if (status != OK)
+		{
+			Erase(moved, false);
+			if (status == DONE && tries < STUB_TRIES)
+				continue;
+			cerr << "HeapFile::UpdateRecord - no room for a stub at " << rid << endl;
+			return FAIL;
+		}
+		if (forwarded)
+			status = Erase(at, false);
+	}
+
+	if (status != OK)
+		return FAIL;
+
+	if (indexed)
+	{
+		std::lock_guard<std::mutex> lock(indexMutex);
+		for (size_t i = 0; i < indexes.size(); i++)
+		{
+			if (indexes[i]->UpdateRecord(old, oldLen, recPtr, recLen, rid) != OK)
+				return FAIL;
+		}
+	}
+
+	updates->Add();
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::Replace
+//
+// Input    : rid - a slot of the file,
+//            recPtr, recLen - its new contents,
+//            kind - the SlotKind it is to have.
+// Output   : None.
+// Purpose  : Rewrites the slot on its page.  Contents of the same
+//            length and kind are logged as an update, others as the
+//            delete of the old contents and the insert of the new.
+// Return   : OK on success, DONE if the page has no room for the new
+//            contents, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::Replace(const RecordID& rid, const char *recPtr, int recLen, int kind)
+{
+	PageID dirPidCur;
+	DirPage *dirPage;
+	HeapPage *page;
+	PageInfo *info;
+
+	LatchGuard dirs(&latch, false);
+	if (FindDirPage(rid.pageNo, dirPidCur, dirPage, info) != OK)
+		return FAIL;
+
+	PIN(rid.pageNo, page);
+	LatchGuard pageLatch(MINIBASE_BM->GetPageLatch(rid.pageNo), true);
+
+	char old[MAX_SPACE];
+	int oldLen;
+	int oldKind = page->GetSlotKind(rid);
+	if (oldKind == INVALID_SLOT || page->GetRecord(rid, old, oldLen) != OK)
+	{
+		cerr << "HeapFile::Replace - no record at " << rid << endl;
+		UNPIN(rid.pageNo, CLEAN);
+		UNPIN(dirPidCur, CLEAN);
+		return FAIL;
+	}
+
+	int space = page->AvailableSpace();
+	Status status = page->UpdateRecord(rid, recPtr, recLen, kind);
+	if (status != OK)
+	{
+		UNPIN(rid.pageNo, CLEAN);
+		UNPIN(dirPidCur, CLEAN);
+		return status;
+	}
+
+	LSN lsn;
+	if (recLen == oldLen && kind == oldKind)
+	{
+		lsn = MINIBASE_LOG->LogUpdate(rid, dirPidCur, recPtr, old, recLen);
+	}
+	else
+	{
+		MINIBASE_LOG->LogDelete(rid, dirPidCur, old, oldLen, oldKind);
+		lsn = MINIBASE_LOG->LogInsert(rid, dirPidCur, recPtr, recLen, kind);
+	}
+	StampPage(rid.pageNo, page, lsn);
+
+	// As in InsertRecord, the same records cover the directory entry.
+
+	bool resized = (recLen != oldLen);
+	if (resized)
+	{
+		info->Adjust(page->AvailableSpace() - space, 0);
+		MINIBASE_BM->SetPageLSN(dirPidCur, lsn);
+	}
+
+	UNPIN(rid.pageNo, DIRTY);
+	UNPIN(dirPidCur, resized);
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::OpenScan
+//
+// Input    : None.
+// Output   : status - OK if the scan was opened.
+// Purpose  : Opens a scan over every record of the file.
+// Return   : The scan, or NULL if it could not be opened.
+//------------------------------------------------------------------
+
+Scan *HeapFile::OpenScan(Status& status)
+{
+	Scan *scan = new Scan(this, status);
+
+	if (status == OK)
+	{
+		scans->Add();
+		return scan;
+	}
+
+	delete scan;
+	return NULL;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::InsertLargeRecord
+//
+// Input    : recPtr - the record,
+//            recLen - its length, however long.
+// Output   : outRid - record ID of the inserted record.
+// Purpose  : Writes the record to overflow pages, then inserts a slot
+//            for it that holds their header.  The indexes are not told
+//            of it; it has no key for them.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::InsertLargeRecord(const char *recPtr, int recLen, RecordID& outRid)
+{
+	if (recLen < 0)
+		return FAIL;
+
+	LargeRecordHeader header;
+	if (WriteOverflow(recPtr, recLen, header) != OK)
+		return FAIL;
+
+	if (Insert((char *)&header, sizeof(header), outRid, false, SLOT_LARGE) != OK)
+	{
+		FreeOverflow(header);
+		return FAIL;
+	}
+
+	inserts->Add();
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::OpenLargeRecord
+//
+// Input    : rid - record ID of a large record.
+// Output   : reader - opened on the record.
+// Purpose  : Starts reading a record InsertLargeRecord inserted.
+// Return   : OK on success, FAIL if rid is not a large record.
+//------------------------------------------------------------------
+
+Status HeapFile::OpenLargeRecord(const RecordID& rid, LargeRecordReader& reader)
+{
+	RecordLock lock(rid, false);
+	RecordID at;
+	int kind;
+	LargeRecordHeader header;
+	int len;
+
+	if (Follow(rid, at, kind) != OK || kind != SLOT_LARGE
+	    || GetRecord(rid, (char *)&header, len) != OK)
+	{
+		cerr << "HeapFile::OpenLargeRecord - " << rid << " is not a large record\n";
+		return FAIL;
+	}
+
+	reader.Open(header);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::AttachIndex, HeapFile::DetachIndex
+//
+// Input    : index - an index on the records of this file.
+// Output   : None.
+// Purpose  : Starts or stops keeping the index in step with the
+//            inserts, deletes and updates of the file.  An index left
+//            stale by a restart is rebuilt from the file first.
+// Return   : AttachIndex: OK on success, the failing status of the
+//            rebuild otherwise; the index is then not attached.
+//------------------------------------------------------------------
+
+Status HeapFile::AttachIndex(Index* index)
+{
+	std::lock_guard<std::mutex> lock(indexMutex);
+	if (std::find(indexes.begin(), indexes.end(), index) != indexes.end())
+		return OK;
+
+	if (index->IsStale())
+	{
+		Status status = index->Rebuild(*this);
+		if (status != OK)
+			return status;
+	}
+	indexes.push_back(index);
+	return OK;
+}
+
+
+void HeapFile::DetachIndex(Index* index)
+{
+	std::lock_guard<std::mutex> lock(indexMutex);
+	indexes.erase(std::remove(indexes.begin(), indexes.end(), index), indexes.end());
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::NextPage
+//
+// Input    : pid - a data page of the file.
+// Output   : None.
+// Purpose  : Follows the link to the next page.
+// Return   : The next page, or FAIL if the page cannot be pinned.
+//------------------------------------------------------------------
+
+PageID HeapFile::NextPage(PageID pid)
+{
+	HeapPage *page;
+
+	PIN(pid, page);
+	PageID nextPid = page->GetNextPage();
+	UNPIN(pid, CLEAN);
+
+	return nextPid;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::NewPage
+//
+// Input    : None.
+// Output   : pid - the new data page,
+//            dirPidCur - the directory page that points to it.
+// Purpose  : Adds an empty data page to the file, and a directory
+//            page too if every existing one is full.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::NewPage(PageID& pid, PageID& dirPidCur)
+{
+	DirPageIterator dirIter(dirPid);
+	DirPage *dirPage;
+	HeapPage *page;
+
+	while ((dirPidCur = dirIter()) != INVALID_PAGE)
+	{
+		PIN(dirPidCur, dirPage);
+		if (dirPage->HasFreeSpace())
+			break;
+		UNPIN(dirPidCur, CLEAN);
+	}
+
+	if (dirPidCur == INVALID_PAGE)
+	{
+		// Every directory page is full; chain a new one at the end.
+
+		DirPage *lastDirPage;
+
+		if (NewExtentPage(dirPidCur, (Page *&)dirPage) != OK)
+			return FAIL;
+		dirPage->Init(dirPidCur);
+		dirPage->SetNextPage(INVALID_PAGE);
+		dirPage->SetPrevPage(lastDirPid);
+
+		PIN(lastDirPid, lastDirPage);
+		lastDirPage->SetNextPage(dirPidCur);
+		UNPIN(lastDirPid, DIRTY);
+
+		lastDirPid = dirPidCur;
+	}
+
+	if (NewExtentPage(pid, (Page *&)page) != OK)
+	{
+		UNPIN(dirPidCur, CLEAN);
+		return FAIL;
+	}
+	page->Init(pid);
+	StampPage(pid, page, MINIBASE_LOG->LogPageInit(pid, dirPidCur));
+
+	dirPage->InsertPage(pid, page);
+
+	UNPIN(pid, DIRTY);
+	UNPIN(dirPidCur, DIRTY);
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::NewExtentPage
+//
+// Input    : None.
+// Output   : pid - the page allocated,
+//            page - that page, pinned in the pool.
+// Purpose  : Hands out the next page of the file's current extent,
+//            allocating a new extent first if it is used up.  The new
+//            extent follows the old one if those pages are free.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::NewExtentPage(PageID& pid, Page*& page)
+{
+	if (extentNext == extentEnd)
+	{
+		int runSize = EXTENT_SIZE;
+		if (MINIBASE_DB->AllocateExtent(extentNext, runSize, extentEnd) != OK)
+		{
+			cerr << "HeapFile::NewExtentPage - Unable to allocate an extent\n";
+			extentNext = extentEnd;
+			return FAIL;
+		}
+		extentEnd = extentNext + runSize;
+
+		if (pool != DEFAULT_POOL
+		    && MINIBASE_BM->BindPages(extentNext, runSize, pool) != OK)
+		{
+			MINIBASE_DB->DeallocatePage(extentNext, runSize);
+			extentNext = extentEnd;
+			return FAIL;
+		}
+	}
+
+	pid = extentNext;
+	if (MINIBASE_BM->PinPage(pid, page, true) != OK)
+		return FAIL;
+
+	extentNext++;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::ReleaseExtent
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Gives the pages of the current extent that the file has
+//            not used back to the database, and to the default pool.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::ReleaseExtent()
+{
+	LatchGuard dirs(&latch, true);
+	if (extentNext == extentEnd)
+		return OK;
+
+	if (pool != DEFAULT_POOL)
+		MINIBASE_BM->BindPages(extentNext, extentEnd - extentNext, DEFAULT_POOL);
+
+	Status status = MINIBASE_DB->DeallocatePage(extentNext, extentEnd - extentNext);
+	extentEnd = extentNext;
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::BindPages
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Binds the directory and data pages of the file to its
+//            buffer pool.  They are all listed before any is bound,
+//            so that none is pinned when it moves.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::BindPages()
+{
+	std::vector<PageID> pids;
+	DirPageIterator dirIter(dirPid);
+	PageID dirPidCur;
+	DirPage *dirPage;
+	PageInfo *info;
+
+	while ((dirPidCur = dirIter()) != INVALID_PAGE)
+	{
+		pids.push_back(dirPidCur);
+		PIN(dirPidCur, dirPage);
+		PageInfoIterator infoIter(dirPage);
+		while ((info = infoIter()) != NULL)
+			pids.push_back(info->pid);
+		UNPIN(dirPidCur, CLEAN);
+	}
+
+	for (size_t i = 0; i < pids.size(); i++)
+	{
+		if (MINIBASE_BM->BindPages(pids[i], 1, pool) != OK)
+			return FAIL;
+	}
+	return OK;
+}
+
+
+static void GetVersionInfo(const char* recPtr, int recLen, VersionInfo& info)
+{
+	memcpy(&info, recPtr + recLen - sizeof(VersionInfo), sizeof(VersionInfo));
+}
+
+
+static void SetVersionInfo(char* recPtr, int recLen, const VersionInfo& info)
+{
+	memcpy(recPtr + recLen - sizeof(VersionInfo), &info, sizeof(VersionInfo));
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::ReadVersion, HeapFile::WriteVersion
+//
+// Input    : rid - a record of a versioned file,
+//            recPtr, recLen - for WriteVersion, the version, and
+//            info - its VersionInfo.
+// Output   : recPtr, recLen, info - for ReadVersion, the version read.
+// Purpose  : Read or overwrite a version in its slot, the VersionInfo
+//            kept at its end.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::ReadVersion(const RecordID& rid, char *recPtr, int& recLen, VersionInfo& info)
+{
+	Status status = GetRecord(rid, recPtr, recLen);
+
+	if (status != OK || recLen < (int)sizeof(VersionInfo))
+	{
+		cerr << "HeapFile::ReadVersion - no version at " << rid << endl;
+		return FAIL;
+	}
+
+	GetVersionInfo(recPtr, recLen, info);
+	return OK;
+}
+
+
+Status HeapFile::WriteVersion(const RecordID& rid, char *recPtr, int recLen, const VersionInfo& info)
+{
+	SetVersionInfo(recPtr, recLen, info);
+	return UpdateRecord(rid, recPtr, recLen);
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::FindVisible
+//
+// Input    : snapshot - what the reader sees,
+//            versionPtr, versionLen - a copy of the newest version of
+//            a record, which is overwritten by older ones.
+// Output   : recPtr, recLen - the data of the version seen.
+// Purpose  : Goes down the versions of the record, newest first, to
+//            the first the snapshot sees.
+// Return   : OK if it sees a version, DONE if it sees none or sees the
+//            record deleted, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::FindVisible(const Snapshot& snapshot, char *versionPtr, int versionLen,
+                             char *recPtr, int& recLen)
+{
+	VersionInfo info;
+	GetVersionInfo(versionPtr, versionLen, info);
+
+	while (!snapshot.Sees(info.xmin))
+	{
+		if (info.prev.pageNo == INVALID_PAGE)
+			return DONE;
+		if (ReadVersion(info.prev, versionPtr, versionLen, info) != OK)
+			return FAIL;
+	}
+
+	if (info.xmax != INVALID_TXN && snapshot.Sees(info.xmax))
+		return DONE;
+
+	recLen = versionLen - sizeof(VersionInfo);
+	memcpy(recPtr, versionPtr, recLen);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::LockVersion
+//
+// Input    : txn - a running transaction,
+//            rid - a record it is about to change,
+//            op - the change, for messages.
+// Output   : recPtr, recLen, info - the newest version of the record.
+// Purpose  : Reads the record and checks that txn may change it: the
+//            newest version must be one its snapshot sees and no other
+//            transaction may have deleted or replaced it, whether or
+//            not that one has committed.  The first to change a record
+//            wins; the others fail.  A change by a transaction a crash
+//            aborted is undone first.
+// Return   : OK if txn may change the record, DONE if the record is
+//            deleted as txn sees it, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::LockVersion(TxnID txn, const RecordID& rid, char *recPtr, int& recLen,
+                             VersionInfo& info, const char* op)
+{
+	const Snapshot *snapshot = MINIBASE_TXN->GetSnapshot(txn);
+	if (snapshot == NULL)
+	{
+		cerr << op << " - transaction " << txn << " is not running\n";
+		return FAIL;
+	}
+
+	if (ReadVersion(rid, recPtr, recLen, info) != OK)
+		return FAIL;
+	if (info.copy)
+	{
+		cerr << op << " - " << rid << " is an old version, not a record\n";
+		return FAIL;
+	}
+
+	Status status = UndoAborted(rid, recPtr, recLen, info);
+	if (status != OK)
+		return status;
+
+	if (info.xmax != INVALID_TXN && snapshot->Sees(info.xmax))
+		return DONE;
+	if (info.xmax != INVALID_TXN || !snapshot->Sees(info.xmin))
+	{
+		cerr << op << " - " << rid << " was changed by another transaction\n";
+		return FAIL;
+	}
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::InsertRecord
+//
+// Input    : txn - a running transaction,
+//            recPtr - the record,
+//            recLen - its length.
+// Output   : outRid - record ID of the inserted record.
+// Purpose  : Inserts the record as a version written by txn, seen by
+//            no other transaction until txn commits.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::InsertRecord(TxnID txn, char *recPtr, int recLen, RecordID& outRid)
+{
+	if (MINIBASE_TXN->GetSnapshot(txn) == NULL)
+	{
+		cerr << "HeapFile::InsertRecord - transaction " << txn << " is not running\n";
+		return FAIL;
+	}
+	if (recLen < 0 || recLen + (int)sizeof(VersionInfo) > MAX_SPACE)
+	{
+		cerr << " Attempting to insert records that is larger than size of a page" << endl;
+		return FAIL;
+	}
+
+	char rec[MAX_SPACE];
+	int len = recLen + sizeof(VersionInfo);
+	VersionInfo info = { txn, INVALID_TXN, { INVALID_PAGE, INVALID_SLOT }, 0 };
+	memcpy(rec, recPtr, recLen);
+	SetVersionInfo(rec, len, info);
+
+	if (InsertRecord(rec, len, outRid) != OK)
+		return FAIL;
+
+	TxnUndo undo = { TxnUndo::undoInsert, this, outRid };
+	MINIBASE_TXN->AddUndo(txn, undo);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::DeleteRecord
+//
+// Input    : txn - a running transaction,
+//            rid - record ID of the record to delete.
+// Output   : None.
+// Purpose  : Marks the newest version of the record deleted by txn.
+//            It stays for transactions that do not see txn until
+//            Vacuum reclaims it.
+// Return   : OK on success, DONE if txn sees the record deleted
+//            already, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::DeleteRecord(TxnID txn, const RecordID& rid)
+{
+	RecordLock lock(rid, true);
+	char rec[MAX_SPACE];
+	int len;
+	VersionInfo info;
+
+	Status status = LockVersion(txn, rid, rec, len, info, "HeapFile::DeleteRecord");
+	if (status != OK)
+		return status;
+
+	info.xmax = txn;
+	if (WriteVersion(rid, rec, len, info) != OK)
+		return FAIL;
+
+	TxnUndo undo = { TxnUndo::undoDelete, this, rid };
+	MINIBASE_TXN->AddUndo(txn, undo);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::UpdateRecord
+//
+// Input    : txn - a running transaction,
+//            rid - record ID of the record to update,
+//            recPtr - the new contents,
+//            recLen - their length.
+// Output   : None.
+// Purpose  : Writes a new version of the record in its slot.  The old
+//            one, unless txn wrote it, is first moved to a record of
+//            its own, on whatever page has room, and chained from the
+//            new one.
+// Return   : OK on success, DONE if txn sees the record deleted,
+//            FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::UpdateRecord(TxnID txn, const RecordID& rid, char *recPtr, int recLen)
+{
+	RecordLock lock(rid, true);
+	char rec[MAX_SPACE];
+	int len;
+	VersionInfo info;
+
+	Status status = LockVersion(txn, rid, rec, len, info, "HeapFile::UpdateRecord");
+	if (status != OK)
+		return status;
+
+	if (recLen < 0 || recLen + (int)sizeof(VersionInfo) > MAX_SPACE - 1)
+	{
+		cerr << " Attempting to update records to larger than size of a page" << endl;
+		return FAIL;
+	}
+
+	VersionInfo newInfo = { txn, INVALID_TXN, info.prev, 0 };
+	bool moved = (info.xmin != txn);
+	if (moved)
+	{
+		info.xmax = txn;
+		info.copy = 1;
+		SetVersionInfo(rec, len, info);
+		if (InsertRecord(rec, len, newInfo.prev) != OK)
+			return FAIL;
+	}
+
+	len = recLen + sizeof(VersionInfo);
+	memcpy(rec, recPtr, recLen);
+	if (WriteVersion(rid, rec, len, newInfo) != OK)
+	{
+		if (moved)
+			DeleteRecord(newInfo.prev);
+		return FAIL;
+	}
+
+	if (moved)
+	{
+		TxnUndo undo = { TxnUndo::undoUpdate, this, rid };
+		MINIBASE_TXN->AddUndo(txn, undo);
+	}
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::UndoVersion
+//
+// Input    : txn - a transaction that is aborting,
+//            undo - a change it made to this file.
+// Output   : None.
+// Purpose  : Undoes the change: deletes a record txn inserted, clears
+//            the mark of a delete, or moves back the version an update
+//            replaced.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::UndoVersion(TxnID txn, const TxnUndo& undo)
+{
+	RecordLock lock(undo.rid, true);
+	if (undo.kind == TxnUndo::undoInsert)
+		return DeleteRecord(undo.rid);
+
+	char rec[MAX_SPACE];
+	int len;
+	VersionInfo info;
+	if (ReadVersion(undo.rid, rec, len, info) != OK)
+		return FAIL;
+
+	if (undo.kind == TxnUndo::undoDelete)
+	{
+		info.xmax = INVALID_TXN;
+		return WriteVersion(undo.rid, rec, len, info);
+	}
+
+	RecordID old = info.prev;
+	if (ReadVersion(old, rec, len, info) != OK)
+		return FAIL;
+	info.xmax = INVALID_TXN;
+	info.copy = 0;
+	if (WriteVersion(undo.rid, rec, len, info) != OK)
+		return FAIL;
+	return DeleteRecord(old);
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::UndoAborted
+//
+// Input    : rid - a record of a versioned file, locked for writing,
+//            recPtr, recLen, info - its newest version.
+// Output   : recPtr, recLen, info - its newest version once undone.
+// Purpose  : Undoes the change a transaction running at a crash made
+//            to the record, if its newest version shows one, as the
+//            abort of the transaction would have.  Only the newest
+//            version can show one: no transaction changes a version
+//            written by another until that one has committed.
+// Return   : OK if the record is left, DONE if the change undone was
+//            its insert, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::UndoAborted(const RecordID& rid, char *recPtr, int& recLen, VersionInfo& info)
+{
+	TxnUndo undo = { TxnUndo::undoDelete, this, rid };
+	TxnID txn = info.xmax;
+
+	if (MINIBASE_TXN->IsAborted(info.xmin))
+	{
+		undo.kind = (info.prev.pageNo == INVALID_PAGE) ? TxnUndo::undoInsert
+		                                               : TxnUndo::undoUpdate;
+		txn = info.xmin;
+	}
+	else if (!MINIBASE_TXN->IsAborted(info.xmax))
+		return OK;
+
+	if (UndoVersion(txn, undo) != OK)
+	{
+		cerr << "HeapFile::UndoAborted - cannot undo the change to " << rid << endl;
+		return FAIL;
+	}
+	if (undo.kind == TxnUndo::undoInsert)
+		return DONE;
+	return ReadVersion(rid, recPtr, recLen, info);
+}
+
+
+Status HeapFile::GetRecord(const Snapshot& snapshot, const RecordID& rid, char *recPtr, int& recLen)
+{
+	RecordLock lock(rid, false);
+	char rec[MAX_SPACE];
+	int len;
+	VersionInfo info;
+
+	if (ReadVersion(rid, rec, len, info) != OK)
+		return FAIL;
+	if (info.copy)
+	{
+		cerr << "HeapFile::GetRecord - " << rid << " is an old version, not a record\n";
+		return FAIL;
+	}
+	return FindVisible(snapshot, rec, len, recPtr, recLen);
+}
+
+
+Scan *HeapFile::OpenScan(const Snapshot& snapshot, Status& status)
+{
+	Scan *scan = new Scan(this, snapshot, status);
+
+	if (status == OK)
+	{
+		scans->Add();
+		return scan;
+	}
+
+	delete scan;
+	return NULL;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::Vacuum
+//
+// Input    : None.
+// Output   : numOfReclaimed - versions deleted.
+// Purpose  : Finds the records with versions below the horizon of
+//            the transaction manager, or changed by a transaction a
+//            crash aborted, then reclaims them one record at a time.  Deleting a version compacts its page, and
+//            frees it once empty, as DeleteRecord always does.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::Vacuum(int& numOfReclaimed)
+{
+	numOfReclaimed = 0;
+	TxnID horizon = MINIBASE_TXN->GetHorizon();
+
+	// The records are found first, since deleting versions would move
+	// the ground under the scan.
+
+	std::vector<RecordID> rids;
+	Status status;
+	Scan *scan = OpenScan(status);
+	if (status != OK)
+		return FAIL;
+
+	char rec[MAX_SPACE];
+	RecordID rid;
+	int len;
+	VersionInfo info;
+	while ((status = scan->GetNext(rid, rec, len)) == OK)
+	{
+		if (len < (int)sizeof(VersionInfo))
+		{
+			status = FAIL;
+			break;
+		}
+		GetVersionInfo(rec, len, info);
+		if (!info.copy && (info.prev.pageNo != INVALID_PAGE
+		                   || (info.xmax != INVALID_TXN && info.xmax < horizon)
+		                   || MINIBASE_TXN->IsAborted(info.xmin)))
+			rids.push_back(rid);
+	}
+	delete scan;
+	if (status != DONE)
+	{
+		cerr << "HeapFile::Vacuum - cannot read the versions\n";
+		return FAIL;
+	}
+
+	for (size_t i = 0; i < rids.size(); i++)
+	{
+		if (Reclaim(rids[i], horizon, numOfReclaimed) != OK)
+			return FAIL;
+	}
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapFile::Reclaim
+//
+// Input    : rid - a record of a versioned file,
+//            horizon - the horizon of the transaction manager.
+// Output   : numOfReclaimed - incremented for each version deleted.
+// Purpose  : Undoes a change to the record by a transaction a crash
+//            aborted.  Then deletes the record if it was deleted below
+//            the horizon, or otherwise finds the newest version written
+//            below the horizon, which every transaction sees or sees
+//            replaced, and deletes the versions older than it.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HeapFile::Reclaim(const RecordID& rid, TxnID horizon, int& numOfReclaimed)
+{
+	RecordLock lock(rid, true);
+	char rec[MAX_SPACE];
+	int len;
+	VersionInfo info;
+	if (ReadVersion(rid, rec, len, info) != OK)
+		return FAIL;
+
+	Status status = UndoAborted(rid, rec, len, info);
+	if (status == DONE)
+	{
+		numOfReclaimed++;
+		return OK;
+	}
+	if (status != OK)
+		return FAIL;
+
+	RecordID dead;
+	if (info.xmax != INVALID_TXN && info.xmax < horizon)
+	{
+		dead = rid;
+	}
+	else
+	{
+		RecordID keep = rid;
+		while (info.xmin >= horizon && info.prev.pageNo != INVALID_PAGE)
+		{
+			keep = info.prev;
+			if (ReadVersion(keep, rec, len, info) != OK)
+				return FAIL;
+		}
+		if (info.xmin >= horizon || info.prev.pageNo == INVALID_PAGE)
+			return OK;
+
+		dead = info.prev;
+		info.prev.pageNo = INVALID_PAGE;
+		info.prev.slotNo = INVALID_SLOT;
+		if (WriteVersion(keep, rec, len, info) != OK)
+			return FAIL;
+	}
+
+	while (dead.pageNo != INVALID_PAGE)
+	{
+		if (ReadVersion(dead, rec, len, info) != OK || DeleteRecord(dead) != OK)
+			return FAIL;
+		numOfReclaimed++;
+		dead = info.prev;
+	}
+	return OK;
+}
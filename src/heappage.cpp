@@ -1,337 +1,440 @@
-#include <iostream>
-#include <stdlib.h>
-#include <memory.h>
-
-#include "heappage.h"
-#include "heapfile.h"
-#include "bufmgr.h"
-#include "db.h"
-
-using namespace std;
-
-//------------------------------------------------------------------
-// Constructor of HeapPage
-//
-// Input     : Page ID
-// Output    : None
-//------------------------------------------------------------------
-
-void HeapPage::Init(PageID pageNo)
-{
-	SLOT_SET_EMPTY(slots[0]);
-	this->nextPage = INVALID_PAGE;
-	this->prevPage = INVALID_PAGE;
-	this->numOfSlots = 0; // initially 0 slots
-	this->pid = pageNo;
-	this->fillPtr = HEAPPAGE_DATA_SIZE;
-	this->freeSpace = HEAPPAGE_DATA_SIZE;
-}
-
-void HeapPage::SetNextPage(PageID pageNo)
-{
-	this->nextPage = pageNo;
-}
-
-void HeapPage::SetPrevPage(PageID pageNo)
-{
-	this->prevPage = pageNo;
-}
-
-PageID HeapPage::GetNextPage()
-{
-	return nextPage;
-}
-
-PageID HeapPage::GetPrevPage()
-{
-	return prevPage;
-}
-
-
-//------------------------------------------------------------------
-// HeapPage::InsertRecord
-//
-// Input     : Pointer to the record and the record's length 
-// Output    : Record ID of the record inserted.
-// Purpose   : Insert a record into the page
-// Return    : OK if everything went OK, DONE if sufficient space 
-//             does not exist
-//------------------------------------------------------------------
-
-Status HeapPage::InsertRecord(char *recPtr, int length, RecordID& rid)
-{
-	int slotNumber = 0;
-	bool emptySlot = false;
-	while (slotNumber < numOfSlots){
-		if (SLOT_IS_EMPTY(slots[slotNumber])){
-			emptySlot = true;
-			break;
-		}
-		slotNumber += 1;
-	}
-	if (emptySlot){
-		if (length > freeSpace){ 
-			return DONE;
-		}
-		else{
-			SLOT_FILL(slots[slotNumber],fillPtr - length,length);
-		}
-	}
-	else{
-		int total_size = 0;
-		total_size = sizeof(Slot) + length; 
-		if (total_size > freeSpace){
-			return DONE;
-		}
-		else{
-			SLOT_FILL(slots[slotNumber],fillPtr - length,length);
-			numOfSlots += 1;
-			freeSpace -= sizeof(Slot);
-		}
-	}
-	memcpy(&data[fillPtr - length],recPtr,length);
-	freeSpace -= length; 
-	fillPtr -= length;
-	rid.slotNo = slotNumber;
-	rid.pageNo = pid;
-	return OK;
-}
-
-
-//------------------------------------------------------------------
-// HeapPage::DeleteRecord 
-//
-// Input    : Record ID
-// Output   : None
-// Purpose  : Delete a record from the page
-// Return   : OK if successful, FAIL otherwise  
-//------------------------------------------------------------------ 
-
-Status HeapPage::DeleteRecord(const RecordID& rid)
-{
-  if(SLOT_IS_EMPTY(slots[rid.slotNo])){
-	  return FAIL;
-  }
-  if(numOfSlots <= rid.slotNo){
-  return FAIL;
-  }
-  int slotOffset = slots[rid.slotNo].offset;
-  int slotLength = slots[rid.slotNo].length;
-  int slot_index = 0;
-  while(slot_index < numOfSlots){
-    if(!SLOT_IS_EMPTY(slots[slot_index]) && (slots[slot_index].offset < slotOffset)){
-      slots[slot_index].offset += slotLength;
-    }
-    slot_index++;
-  }
-  if(rid.slotNo == numOfSlots - 1){
-    numOfSlots -= 1;
-    freeSpace += sizeof(Slot);
-  }
-  memmove( &(data[fillPtr + slotLength]), &(data[fillPtr]), slotOffset - fillPtr);
-  SLOT_SET_EMPTY(slots[rid.slotNo]);
-  return OK;
-}
-
-
-//------------------------------------------------------------------
-// HeapPage::FirstRecord
-//
-// Input    : None
-// Output   : record id of the first record on a page
-// Purpose  : To find the first record on a page
-// Return   : OK if successful, DONE otherwise
-//------------------------------------------------------------------
-
-Status HeapPage::FirstRecord(RecordID& rid)
-{
-	if (IsEmpty() == true)
-		return DONE;
-	int allSlots = 0;
-	while(allSlots < numOfSlots){
-		if(!SLOT_IS_EMPTY(slots[allSlots])){
-			rid.pageNo = pid;
-			rid.slotNo = allSlots;
-			return OK;
-		}
-		allSlots += 1;
-	}
-	return DONE;
-}
-
-
-//------------------------------------------------------------------
-// HeapPage::NextRecord
-//
-// Input    : ID of the current record
-// Output   : ID of the next record
-// Return   : Return DONE if no more records exist on the page; 
-//            otherwise OK. In case of an error, return FAIL.
-//------------------------------------------------------------------
-
-Status HeapPage::NextRecord(RecordID curRid, RecordID& nextRid)
-{
-	if (numOfSlots <= curRid.slotNo){
-		return DONE;
-	}
-	else{
-		int nextSlot = curRid.slotNo + 1;
-		while(nextSlot < numOfSlots){
-			if (nextSlot >= numOfSlots){
-				return DONE;
-			}
-			else{
-				if (SLOT_IS_EMPTY(slots[nextSlot])){
-					nextSlot++;
-					continue;
-				}
-				else { 
-					nextRid.pageNo = pid;
-					nextRid.slotNo = nextSlot;
-					return OK;
-				}
-			}
-		nextSlot++;	
-		}
-	}
-	return DONE;
-}
-
-
-//------------------------------------------------------------------
-// HeapPage::GetRecord
-//
-// Input    : Record ID
-// Output   : Records length and a copy of the record itself
-// Purpose  : To retrieve a _copy_ of a record with ID rid from a page
-// Return   : OK if successful, FAIL otherwise
-//------------------------------------------------------------------
-
-Status HeapPage::GetRecord(RecordID rid, char *recPtr, int& length)
-{
-	if (numOfSlots <= rid.slotNo){
-		return FAIL;
-	}
-	else{
-		int len = slots[rid.slotNo].length;
-		int offset = slots[rid.slotNo].offset;
-		memcpy(recPtr,&(data[offset]),len);
-		length = len;
-		return OK;
-	}
-}
-
-
-//------------------------------------------------------------------
-// HeapPage::ReturnRecord
-//
-// Input    : Record ID
-// Output   : pointer to the record, record's length
-// Purpose  : To output a _pointer_ to the record
-// Return   : OK if successful, FAIL otherwise
-//------------------------------------------------------------------
-
-Status HeapPage::ReturnRecord(RecordID rid, char*& recPtr, int& length)
-{
-	if (numOfSlots <= rid.slotNo){
-		return FAIL;
-	}
-	else{
-		int len = slots[rid.slotNo].length;
-		int offset = slots[rid.slotNo].offset;
-		recPtr = &data[offset];
-		length = len;
-		return OK;
-	}
-}
-
-
-//------------------------------------------------------------------
-// HeapPage::AvailableSpace
-//
-// Input    : None
-// Output   : None
-// Purpose  : To return the amount of available space
-// Return   : The amount of available space on the heap file page.
-//------------------------------------------------------------------
-
-int HeapPage::AvailableSpace(void)
-{
-	if (GetNumOfRecords() < numOfSlots){
-		return freeSpace;
-	}
-	else{
-		return (freeSpace - sizeof(Slot));
-	}
-}
-
-
-//------------------------------------------------------------------
-// HeapPage::IsEmpty
-// 
-// Input    : None
-// Output   : None
-// Purpose  : Check if there is any record in the page.
-// Return   : true if the HeapPage is empty, and false otherwise.
-//------------------------------------------------------------------
-
-bool HeapPage::IsEmpty(void)
-{
-	if (GetNumOfRecords() == 0){
-		return true;
-	}
-	else{
-		return false;
-	}
-}
-
-
-//------------------------------------------------------------------
-// HeapPage::GetNumOfRecords
-// 
-// Input    : None
-// Output   : None
-// Purpose  : To return the number of records in the page.
-// Return   : The number of records currently stored in the page.
-//------------------------------------------------------------------
-
-int HeapPage::GetNumOfRecords()
-{
-	int valid_slots = 0;
-	int all_slots = 0;
-	while (all_slots < numOfSlots){
-		if(!SLOT_IS_EMPTY(slots[all_slots])){
-			valid_slots += 1;
-		}
-		all_slots += 1;
-	}
-	return valid_slots;
-}
-
-
-//------------------------------------------------------------------
-// HeapPage::CompactSlotDir
-// 
-// Input    : None
-// Output   : None
-// Purpose  : To compact the slot directory (eliminate empty slots).
-// Return   : None
-//------------------------------------------------------------------
-
-void HeapPage::CompactSlotDir()
-{
-  int invalidSlots = 0; 
-  int move_behind_steps = 0;
-  for(int i = 0; i < numOfSlots; i++){
-    if(SLOT_IS_EMPTY( slots[i])){
-      invalidSlots++;
-    }else{
-	  move_behind_steps = i - invalidSlots;
-      slots[move_behind_steps].offset = slots[i].offset; 
-      slots[move_behind_steps].length = slots[i].length;
-    }
-  }
-  numOfSlots -= invalidSlots;
-  long total_free_space = invalidSlots * sizeof(Slot);
-  freeSpace +=  total_free_space;
-}
+#include <iostream>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "heappage.h"
+#include "heapfile.h"
+#include "bufmgr.h"
+#include "db.h"
+
+using namespace std;
+
+//------------------------------------------------------------------
+// Constructor of HeapPage
+//
+// Input     : Page ID
+// Output    : None
+//------------------------------------------------------------------
+
+void HeapPage::Init(PageID pageNo)
+{
+	SLOT_SET_EMPTY(Slots()[0]);
+	this->nextPage = INVALID_PAGE;
+	this->prevPage = INVALID_PAGE;
+	this->numOfSlots = 0; // initially 0 slots
+	this->pid = pageNo;
+	this->lsn = INVALID_LSN;
+	this->fillPtr = HEAPPAGE_DATA_SIZE;
+	this->freeSpace = HEAPPAGE_DATA_SIZE;
+}
+
+void HeapPage::SetNextPage(PageID pageNo)
+{
+	this->nextPage = pageNo;
+}
+
+void HeapPage::SetPrevPage(PageID pageNo)
+{
+	this->prevPage = pageNo;
+}
+
+PageID HeapPage::GetNextPage()
+{
+	return nextPage;
+}
+
+PageID HeapPage::GetPrevPage()
+{
+	return prevPage;
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::InsertRecord
+//
+// Input     : Pointer to the record and the record's length, and the
+//             SlotKind of the slot it takes
+// Output    : Record ID of the record inserted.
+// Purpose   : Insert a record into the page
+// Return    : OK if everything went OK, DONE if sufficient space 
+//             does not exist
+//------------------------------------------------------------------
+
+Status HeapPage::InsertRecord(char *recPtr, int length, RecordID& rid, int kind)
+{
+	int slotNumber = 0;
+	bool emptySlot = false;
+	while (slotNumber < numOfSlots){
+		if (SLOT_IS_EMPTY(Slots()[slotNumber])){
+			emptySlot = true;
+			break;
+		}
+		slotNumber += 1;
+	}
+	if (emptySlot){
+		if (length > freeSpace){ 
+			return DONE;
+		}
+		else{
+			SLOT_FILL(Slots()[slotNumber],fillPtr - length,length);
+		}
+	}
+	else{
+		int total_size = 0;
+		total_size = sizeof(Slot) + length; 
+		if (total_size > freeSpace){
+			return DONE;
+		}
+		else{
+			SLOT_FILL(Slots()[slotNumber],fillPtr - length,length);
+			numOfSlots += 1;
+			freeSpace -= sizeof(Slot);
+		}
+	}
+	SLOT_SET_KIND(Slots()[slotNumber], kind);
+	memcpy(&data[fillPtr - length],recPtr,length);
+	freeSpace -= length; 
+	fillPtr -= length;
+	rid.slotNo = slotNumber;
+	rid.pageNo = pid;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::InsertRecordAt
+//
+// Input     : Record ID to insert at, pointer to the record and the 
+//             record's length, and the SlotKind of the slot
+// Output    : None
+// Purpose   : Insert a record into a given slot, which must be empty.
+//             Recovery uses this to put a record back where the log
+//             says it was.
+// Return    : OK if everything went OK, DONE if sufficient space 
+//             does not exist, FAIL if the slot is in use
+//------------------------------------------------------------------
+
+Status HeapPage::InsertRecordAt(const RecordID& rid, const char *recPtr, int length, int kind)
+{
+	int newSlots = 0;
+	if (rid.slotNo < numOfSlots){
+		if (!SLOT_IS_EMPTY(Slots()[rid.slotNo])){
+			return FAIL;
+		}
+	}
+	else{
+		newSlots = rid.slotNo + 1 - numOfSlots;
+	}
+	if ((int)(newSlots * sizeof(Slot)) + length > freeSpace){
+		return DONE;
+	}
+	while (numOfSlots <= rid.slotNo){
+		SLOT_SET_EMPTY(Slots()[numOfSlots]);
+		numOfSlots += 1;
+		freeSpace -= sizeof(Slot);
+	}
+	SLOT_FILL(Slots()[rid.slotNo],fillPtr - length,length);
+	SLOT_SET_KIND(Slots()[rid.slotNo], kind);
+	memcpy(&data[fillPtr - length],recPtr,length);
+	freeSpace -= length; 
+	fillPtr -= length;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::UpdateRecord
+//
+// Input     : Record ID, pointer to the new contents and their length,
+//             and the SlotKind the slot is to have
+// Output    : None
+// Purpose   : Replace a record, of any length, keeping its slot.  The
+//             records of a page lie back to back at its end, so the
+//             free space is all in one piece and the record grows into
+//             it once the old contents are taken out.  recPtr must not
+//             point into the page.
+// Return    : OK if everything went OK, DONE if sufficient space 
+//             does not exist, FAIL if the slot is empty
+//------------------------------------------------------------------
+
+Status HeapPage::UpdateRecord(const RecordID& rid, const char *recPtr, int length, int kind)
+{
+	if (rid.slotNo >= numOfSlots || SLOT_IS_EMPTY(Slots()[rid.slotNo])){
+		return FAIL;
+	}
+	if (length > Slots()[rid.slotNo].length + freeSpace){
+		return DONE;
+	}
+	if (length == Slots()[rid.slotNo].length){
+		SLOT_SET_KIND(Slots()[rid.slotNo], kind);
+		memcpy(&data[SLOT_OFFSET(Slots()[rid.slotNo])],recPtr,length);
+		return OK;
+	}
+	DeleteRecord(rid);
+	return InsertRecordAt(rid, recPtr, length, kind);
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::DeleteRecord 
+//
+// Input    : Record ID
+// Output   : None
+// Purpose  : Delete a record from the page
+// Return   : OK if successful, FAIL otherwise  
+//------------------------------------------------------------------ 
+
+Status HeapPage::DeleteRecord(const RecordID& rid)
+{
+  if(SLOT_IS_EMPTY(Slots()[rid.slotNo])){
+	  return FAIL;
+  }
+  if(numOfSlots <= rid.slotNo){
+  return FAIL;
+  }
+  int slotOffset = SLOT_OFFSET(Slots()[rid.slotNo]);
+  int slotLength = Slots()[rid.slotNo].length;
+  int slot_index = 0;
+  while(slot_index < numOfSlots){
+    if(!SLOT_IS_EMPTY(Slots()[slot_index]) && (SLOT_OFFSET(Slots()[slot_index]) < slotOffset)){
+      Slots()[slot_index].offset += slotLength;
+    }
+    slot_index++;
+  }
+  if(rid.slotNo == numOfSlots - 1){
+    numOfSlots -= 1;
+    freeSpace += sizeof(Slot);
+  }
+  memmove( &(data[fillPtr + slotLength]), &(data[fillPtr]), slotOffset - fillPtr);
+  fillPtr += slotLength;
+  freeSpace += slotLength;
+  SLOT_SET_EMPTY(Slots()[rid.slotNo]);
+  return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::FirstRecord
+//
+// Input    : None
+// Output   : record id of the first record on a page
+// Purpose  : To find the first record on a page.  Records moved
+//            here from other pages are passed over; they are
+//            reached from their stubs.
+// Return   : OK if successful, DONE otherwise
+//------------------------------------------------------------------
+
+Status HeapPage::FirstRecord(RecordID& rid)
+{
+	if (IsEmpty() == true)
+		return DONE;
+	int allSlots = 0;
+	while(allSlots < numOfSlots){
+		if(!SLOT_IS_EMPTY(Slots()[allSlots]) && SLOT_KIND(Slots()[allSlots]) != SLOT_MOVED){
+			rid.pageNo = pid;
+			rid.slotNo = allSlots;
+			return OK;
+		}
+		allSlots += 1;
+	}
+	return DONE;
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::NextRecord
+//
+// Input    : ID of the current record
+// Output   : ID of the next record, passing over moved records as
+//            FirstRecord does
+// Return   : Return DONE if no more records exist on the page; 
+//            otherwise OK. In case of an error, return FAIL.
+//------------------------------------------------------------------
+
+Status HeapPage::NextRecord(RecordID curRid, RecordID& nextRid)
+{
+	if (numOfSlots <= curRid.slotNo){
+		return DONE;
+	}
+	else{
+		int nextSlot = curRid.slotNo + 1;
+		while(nextSlot < numOfSlots){
+			if (nextSlot >= numOfSlots){
+				return DONE;
+			}
+			else{
+				if (SLOT_IS_EMPTY(Slots()[nextSlot]) || SLOT_KIND(Slots()[nextSlot]) == SLOT_MOVED){
+					nextSlot++;
+					continue;
+				}
+				else { 
+					nextRid.pageNo = pid;
+					nextRid.slotNo = nextSlot;
+					return OK;
+				}
+			}
+		nextSlot++;	
+		}
+	}
+	return DONE;
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::GetRecord
+//
+// Input    : Record ID
+// Output   : Records length and a copy of the record itself
+// Purpose  : To retrieve a _copy_ of a record with ID rid from a page
+// Return   : OK if successful, FAIL otherwise
+//------------------------------------------------------------------
+
+Status HeapPage::GetRecord(RecordID rid, char *recPtr, int& length)
+{
+	if (numOfSlots <= rid.slotNo){
+		return FAIL;
+	}
+	else{
+		int len = Slots()[rid.slotNo].length;
+		int offset = SLOT_OFFSET(Slots()[rid.slotNo]);
+		memcpy(recPtr,&(data[offset]),len);
+		length = len;
+		return OK;
+	}
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::ReturnRecord
+//
+// Input    : Record ID
+// Output   : pointer to the record, record's length
+// Purpose  : To output a _pointer_ to the record
+// Return   : OK if successful, FAIL otherwise
+//------------------------------------------------------------------
+
+Status HeapPage::ReturnRecord(RecordID rid, char*& recPtr, int& length)
+{
+	if (numOfSlots <= rid.slotNo){
+		return FAIL;
+	}
+	else{
+		int len = Slots()[rid.slotNo].length;
+		int offset = SLOT_OFFSET(Slots()[rid.slotNo]);
+		recPtr = &data[offset];
+		length = len;
+		return OK;
+	}
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::GetSlotKind
+//
+// Input    : Record ID
+// Output   : None
+// Purpose  : To tell a record from a stub or a moved record
+// Return   : The SlotKind of the slot, INVALID_SLOT if it is empty
+//------------------------------------------------------------------
+
+int HeapPage::GetSlotKind(const RecordID& rid)
+{
+	if (rid.slotNo < 0 || numOfSlots <= rid.slotNo || SLOT_IS_EMPTY(Slots()[rid.slotNo])){
+		return INVALID_SLOT;
+	}
+	return SLOT_KIND(Slots()[rid.slotNo]);
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::AvailableSpace
+//
+// Input    : None
+// Output   : None
+// Purpose  : To return the amount of available space
+// Return   : The amount of available space on the heap file page.
+//------------------------------------------------------------------
+
+int HeapPage::AvailableSpace(void)
+{
+	for (int i = 0; i < numOfSlots; i++){
+		if (SLOT_IS_EMPTY(Slots()[i])){
+			return freeSpace;
+		}
+	}
+	return (freeSpace - sizeof(Slot));
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::IsEmpty
+// 
+// Input    : None
+// Output   : None
+// Purpose  : Check if there is any record in the page, moved
+//            records and stubs included.
+// Return   : true if the HeapPage is empty, and false otherwise.
+//------------------------------------------------------------------
+
+bool HeapPage::IsEmpty(void)
+{
+	for (int i = 0; i < numOfSlots; i++){
+		if (!SLOT_IS_EMPTY(Slots()[i])){
+			return false;
+		}
+	}
+	return true;
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::GetNumOfRecords
+// 
+// Input    : None
+// Output   : None
+// Purpose  : To return the number of records in the page.  A
+//            record moved to another page counts on the page of its
+//            stub, not where it is stored.
+// Return   : The number of records currently stored in the page.
+//------------------------------------------------------------------
+
+int HeapPage::GetNumOfRecords()
+{
+	int valid_slots = 0;
+	int all_slots = 0;
+	while (all_slots < numOfSlots){
+		if(!SLOT_IS_EMPTY(Slots()[all_slots]) && SLOT_KIND(Slots()[all_slots]) != SLOT_MOVED){
+			valid_slots += 1;
+		}
+		all_slots += 1;
+	}
+	return valid_slots;
+}
+
+
+//------------------------------------------------------------------
+// HeapPage::CompactSlotDir
+// 
+// Input    : None
+// Output   : None
+// Purpose  : To compact the slot directory (eliminate empty slots).
+// Return   : None
+//------------------------------------------------------------------
+
+void HeapPage::CompactSlotDir()
+{
+  int invalidSlots = 0; 
+  int move_behind_steps = 0;
+  for(int i = 0; i < numOfSlots; i++){
+    if(SLOT_IS_EMPTY( Slots()[i])){
+      invalidSlots++;
+    }else{
+	  move_behind_steps = i - invalidSlots;
+      Slots()[move_behind_steps].offset = Slots()[i].offset; 
+      Slots()[move_behind_steps].length = Slots()[i].length;
+    }
+  }
+  numOfSlots -= invalidSlots;
+  long total_free_space = invalidSlots * sizeof(Slot);
+  freeSpace +=  total_free_space;
+}
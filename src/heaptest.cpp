@@ -1,524 +1,4978 @@
-//*****************************************
-//  Driver program for heapfiles
-//****************************************
-
-#include <iostream>
-#include <cstdlib>
-#include <cstring>
-
-#include "db.h"
-#include "heapfile.h"
-#include "scan.h"
-#include "heaptest.h"
-#include "bufmgr.h"
-
-using namespace std;
-
-static const int namelen = 24;
-
-struct Rec
-{
-    int ival;
-    double fval;
-    char name[namelen];
-};
-
-static const int reclen = sizeof(Rec);
-
-HeapDriver::HeapDriver() : TestDriver( "hptest" )
-{
-    choice = 100;       // big enough for file to occupy > 1 page
-    // choice = 1;
-}
-
-HeapDriver::~HeapDriver()
-{}
-
-
-Status HeapDriver::RunTests()
-{
-    return TestDriver::RunTests();
-}
-
-Status HeapDriver::RunAllTests()
-{
-    Status answer;
-    minibase_globals = new SystemDefs(answer, "MINIBASE.DB", "MINIBASE.LOG", 100, 500, 100, "Clock");
-    if ( answer == OK )
-        answer = TestDriver::RunAllTests();
-	
-    delete minibase_globals;
-    return answer;
-}
-
-const char* HeapDriver::TestName()
-{
-    return "Heap File";
-}
-
-
-//********************************************
-
-bool HeapDriver::Test1()
-{
-    cout << "\n  Test 1: Insert and scan fixed-size records\n";
-    Status status = OK;
-    RecordID rid;
-	
-    cout << "  - Create a heap file\n";
-    HeapFile f("file_1", status);
-	
-    if (status != OK) 
-    {
-        cerr << "*** Could not create heap file\n";
-    }
-    else if ( MINIBASE_BM->GetNumOfUnpinnedFrames() != MINIBASE_BM->GetNumOfFrames() )
-	{
-        cerr << "*** The heap file has left pages pinned\n";
-        status = FAIL;
-	}
-	
-	if ( status == OK )
-	{
-        cout << "  - Add " << choice << " records to the file\n";
-        
-        for (int i = 0; i < choice && status == OK; i++)
-		{
-            Rec rec = { i, i*2.5 };
-            sprintf(rec.name, "record %i", i);
-			
-            status = f.InsertRecord((char *)&rec, reclen, rid);
-			
-            if (status != OK)
-            {
-                cerr << "*** Error inserting record " << i << endl;
-            }
-            else if ( MINIBASE_BM->GetNumOfUnpinnedFrames() != MINIBASE_BM->GetNumOfFrames() )
-			{
-                cerr << "*** Insertion left a page pinned\n";
-                status = FAIL;
-			}
-		}
-		
-        if ( f.GetNumOfRecords() != choice )
-		{
-            status = FAIL;
-            cerr << "*** File reports " << f.GetNumOfRecords() << " records, not "
-				 << choice << endl;
-                 
-		}
-	}
-
-	// the scan must return the insertion order.
-    Scan* scan = 0;
-    if ( status == OK )
-	{
-        cout << "  - Scan the records just inserted\n";
-        scan = f.OpenScan(status);
-		
-        if (status != OK)
-        {
-            cerr << "*** Error opening scan\n";
-        }
-        else if ( MINIBASE_BM->GetNumOfUnpinnedFrames() == MINIBASE_BM->GetNumOfFrames() )
-		{
-            cerr << "*** The heap-file scan has not pinned the first page\n";
-            status = FAIL;
-		}
-	}
-    if ( status == OK )
-	{
-        int len, i = 0;
-        Rec rec;
-		
-        while ( (status = scan->GetNext(rid, (char *)&rec, len)) == OK )
-		{
-            if ( len != reclen )
-			{
-                cerr << "*** Record " << i << " had unexpected length " << len << endl;
-                status = FAIL;
-                break;
-			}
-            else if ( MINIBASE_BM->GetNumOfUnpinnedFrames() == MINIBASE_BM->GetNumOfFrames() && i != choice - 1)
-			{
-                cerr << "*** The heap-file scan has not left its page pinned\n";
-                status = FAIL;
-                break;
-			}
-            char name[ sizeof(rec.name) ];
-            sprintf( name, "record %i", i );
-            if( rec.ival != i  ||
-                rec.fval != i*2.5  ||
-                0 != strcmp( rec.name, name ) )
-			{
-                cerr << "*** Record " << i << " differs from what we inserted\n";
-                status = FAIL;
-                break;
-			}
-            ++i;
-		}
-		
-        if ( status == DONE )
-		{
-            if ( MINIBASE_BM->GetNumOfUnpinnedFrames() != MINIBASE_BM->GetNumOfFrames() )
-                cerr << "*** The heap-file scan has not unpinned its page after finishing\n";
-            else if ( i == choice )
-                status = OK;
-            else
-                cerr << "*** Scanned " << i << " records instead of "
-				<< choice << endl;
-		}
-	}
-	
-    delete scan;
-	
-    if ( status == OK )
-        cout << "  Test 1 completed successfully.\n";
-    return (status == OK);
-}
-
-
-//***************************************************
-
-bool HeapDriver::Test2()
-{
-    cout << "\n  Test 2: Delete fixed-size records\n";
-    Status status = OK;
-    Scan* scan = 0;
-    RecordID rid;
-	
-    cout << "  - Open the same heap file as Test 1\n";
-    HeapFile f("file_1", status);
-	
-    if (status != OK)
-        cerr << "*** Error opening heap file\n";
-	
-	
-    if ( status == OK )
-	{
-        cout << "  - Delete half the records\n";
-        scan = f.OpenScan(status);
-        if (status != OK)
-            cerr << "*** Error opening scan\n";
-	}
-    if ( status == OK )
-	{
-        int len, i = 0;
-        Rec rec;
-		
-        while ( (status = scan->GetNext(rid, (char *)&rec, len)) == OK )
-		{
-            if ( i & 1 )        // Delete the odd-numbered ones.
-			{
-                status = f.DeleteRecord( rid );
-                if ( status != OK )
-				{
-                    cerr << "*** Error deleting record " << i << endl;
-                    break;
-				}
-			}
-            ++i;
-		}
-		
-        if ( status == DONE )
-            status = OK;
-	}
-	
-    delete scan;
-    scan = 0;
-	
-    if ( status == OK
-		&& MINIBASE_BM->GetNumOfUnpinnedFrames() != MINIBASE_BM->GetNumOfFrames() )
-	{
-        cerr << "*** Deletion left a page pinned\n";
-        status = FAIL;
-	}
-	
-    if ( status == OK )
-	{
-        cout << "  - Scan the remaining records\n";
-        scan = f.OpenScan(status);
-        if (status != OK)
-            cerr << "*** Error opening scan\n";
-	}
-    if ( status == OK )
-	{
-        int len, i = 0;
-        Rec rec;
-		
-        while ( (status = scan->GetNext(rid, (char *)&rec, len)) == OK )
-		{
-            if( rec.ival != i  ||
-                rec.fval != i*2.5 )
-			{
-                cerr << "*** Record " << i << " differs from what we "
-                    "inserted\n";
-                status = FAIL;
-                break;
-			}
-            i += 2;     // Because we deleted the odd ones...
-		}
-		
-        if ( status == DONE )
-            status = OK;
-	}
-	
-    delete scan;
-	
-    if ( status == OK )
-        cout << "  Test 2 completed successfully.\n";
-    return (status == OK);
-}
-
-
-//********************************************************
-
-bool HeapDriver::Test3()
-{
-    cout << "\n  Test 3: Update fixed-size records\n";
-    Status status = OK;
-    Scan* scan = 0;
-    RecordID rid;
-	
-    cout << "  - Open the same heap file as tests 1 and 2\n";
-    HeapFile f("file_1", status);
-	
-    if (status != OK)
-        cerr << "*** Error opening heap file\n";
-
-    if ( status == OK )
-	{
-        cout << "  - Change the records\n";
-        scan = f.OpenScan(status);
-        if (status != OK)
-            cerr << "*** Error opening scan\n";
-	}
-
-    if ( status == OK )
-	{
-        int len, i = 0;
-        Rec rec;
-		
-        while ( (status = scan->GetNext(rid, (char *)&rec, len)) == OK )
-		{
-            rec.fval = (float)7*i;     // We'll check that i==rec.ival below.
-            status = f.UpdateRecord( rid, (char*)&rec, len );
-            if ( status != OK )
-			{
-                cerr << "*** Error updating record " << i << endl;
-                break;
-			}
-            i += 2;     // Recall, we deleted every other record above.
-		}
-		
-        if ( status == DONE )
-            status = OK;
-	}
-	
-    delete scan;
-    scan = 0;
-	
-    if ( status == OK && 
-            MINIBASE_BM->GetNumOfUnpinnedFrames() != MINIBASE_BM->GetNumOfFrames() )
-	{
-        cerr << "*** Updating left pages pinned\n";
-        status = FAIL;
-	}
-	
-    if ( status == OK )
-	{
-        cout << "  - Check that the updates are really there\n";
-        scan = f.OpenScan(status);
-        if (status != OK)
-            cerr << "*** Error opening scan\n";
-	}
-
-    if ( status == OK )
-	{
-        int len, i = 0;
-        Rec rec, rec2;
-		
-        while ( (status = scan->GetNext(rid, (char *)&rec, len)) == OK )
-		{
-			// While we're at it, Test the getRecord method too.
-            status = f.GetRecord( rid, (char*)&rec2, len );
-            if ( status != OK )
-			{
-                cerr << "*** Error getting record " << i << endl;
-                break;
-			}
-            if( rec.ival != i || rec.fval != i*7 ||
-                    rec2.ival != i || rec2.fval != i*7 )
-			{
-                cerr << "*** Record " << i << " differs from our "
-                    "update\n";
-                status = FAIL;
-                break;
-			}
-            i += 2;     // Because we deleted the odd ones...
-		}
-		
-        if ( status == DONE )
-            status = OK;
-	}
-	
-    delete scan;
-	
-    if ( status == OK )
-        cout << "  Test 3 completed successfully.\n";
-    return (status == OK);
-}
-
-
-//*****************************************************************
-
-bool HeapDriver::Test4()
-{
-    cout << "\n  Test 4: Temporary heap files and variable-length records\n";
-    Status status = OK;
-    Scan* scan = 0;
-    RecordID rid;
-	
-    cout << "  - Create a temporary heap file\n";
-    HeapFile f( 0, status );
-	
-    if (status != OK)
-        cerr << "*** Error creating temp file\n";
-
-    if ( status == OK )
-        cout << "  - Add variable-sized records\n";
-	
-    unsigned recSize = MINIBASE_PAGESIZE / 2;
-	/* We use half a page as the starting size so that a single page won't
-	hold more than one record.  We add a series of records at this size,
-	then halve the size and add some more, and so on.  We store the index
-	number of each record on the record itself. */
-    unsigned numRecs = 0;
-    char record[MINIBASE_PAGESIZE] = "";
-    for ( ; recSize >= (sizeof(numRecs) + sizeof(recSize)) && status == OK;
-	recSize /= 2 )
-        for ( unsigned i=0; i < 10 && status == OK; ++i, ++numRecs )
-	{
-		memcpy( record, &numRecs, sizeof(numRecs) );
-		memcpy( record+(sizeof(numRecs)), &recSize, sizeof(recSize) );
-		status = f.InsertRecord( record, recSize, rid );
-		if ( status != OK )
-			cerr << "*** Failed inserting record " << numRecs
-			<< ", of size " << recSize << endl;
-	}
-	
-	
-    int *seen = new int[numRecs];
-	for (int i = 0; i < (int)numRecs; i++)
-	{
-		seen[i] = false;
-	}
-
-    // memset( seen, 0, sizeof(seen) );
-    if ( status == OK )
-	{
-        cout << "  - Check that all the records were inserted\n";
-        scan = f.OpenScan(status);
-        if (status != OK)
-            cerr << "*** Error opening scan\n";
-	}
-    if ( status == OK )
-	{
-        int len;
-        while ( (status = scan->GetNext(rid, record, len)) == OK )
-		{
-            unsigned recNum;
-            memcpy( &recNum, record, sizeof(recNum) );
-            if ( seen[recNum])
-			{
-                cerr << "*** Found record " << recNum << " twice!\n";
-                status = FAIL;
-                break;
-			}
-            seen[recNum] = true;
-			
-            memcpy( &recSize, record + sizeof(recNum), sizeof(recSize) );
-            if ( recSize != (unsigned)len )
-			{
-                cerr << "*** Record size mismatch: stored " << recSize
-					<< ", but retrieved " << len << endl;
-                status = FAIL;
-                break;
-			}
-			
-            --numRecs;
-		}
-		
-        if ( status == DONE ) {
-            if ( numRecs )
-                cerr << "*** Scan missed " << numRecs << " records\n";
-		    else
-                status = OK;
-        }
-	}
-	
-    delete scan;
-	
-    if ( status == OK )
-        cout << "  Test 4 completed successfully.\n";
-    return (status == OK);
-}
-
-
-bool HeapDriver::Test5()
-{
-    cout << "\n  Test 5: Test some error conditions\n";
-    Status status = OK;
-    Scan* scan = 0;
-    RecordID rid;
-	
-    HeapFile f("file_1", status);
-    if (status != OK)
-        cerr << "*** Error opening heap file\n";
-	
-    if ( status == OK )
-	{
-        cout << "  - Try to change the size of a record\n";
-        scan = f.OpenScan(status);
-        if (status != OK)
-            cerr << "*** Error opening scan\n";
-	}
-    if ( status == OK )
-	{
-        int len;
-        Rec rec;
-        status = scan->GetNext(rid, (char *)&rec, len);
-        if ( status != OK )
-            cerr << "*** Error reading first record\n";
-        else
-		{
-            status = f.UpdateRecord( rid, (char*)&rec, len-1 );
-            TestFailure( status, HEAPFILE, "Shortening a record" );
-            if ( status == OK )
-			{
-                status = f.UpdateRecord( rid, (char*)&rec, len+1 );
-                TestFailure( status, HEAPFILE, "Lengthening a record" );
-			}
-		}
-	}
-	
-    delete scan;
-
-    if ( status == OK )
-	{
-        cout << "  - Try to insert a record that's too long\n";
-        char record[MINIBASE_PAGESIZE] = "";
-        status = f.InsertRecord( record, MINIBASE_PAGESIZE, rid );
-        TestFailure( status, HEAPFILE, "Inserting a too-long record" );
-	}
-
-    if ( status == OK )
-        cout << "  Test 5 completed successfully.\n";
-    return (status == OK);
-}
-
-
-bool HeapDriver::Test6()
-{
-    return true;
-}
+//*****************************************
+//  Driver program for heapfiles
+//****************************************
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <sstream>
+#include <string>
+#include <map>
+#include <cmath>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "db.h"
+#include "heapfile.h"
+#include "scan.h"
+#include "heaptest.h"
+#include "bufmgr.h"
+#include "ioservice.h"
+#include "sealedpage.h"
+#include "logmgr.h"
+#include "metrics.h"
+#include "hashindex.h"
+#include "btree.h"
+#include "sort.h"
+#include "join.h"
+#include "aggregate.h"
+#include "operator.h"
+#include "mvcc.h"
+#include "largerecord.h"
+#include "locktable.h"
+
+using namespace std;
+
+static const int namelen = 24;
+
+struct Rec
+{
+    int ival;
+    double fval;
+    char name[namelen];
+};
+
+static const int reclen = sizeof(Rec);
+
+HeapDriver::HeapDriver() : TestDriver( "hptest" )
+{
+    choice = 100;       // big enough for file to occupy > 1 page
+    // choice = 1;
+}
+
+HeapDriver::~HeapDriver()
+{}
+
+
+Status HeapDriver::RunTests()
+{
+    return TestDriver::RunTests();
+}
+
+Status HeapDriver::RunAllTests()
+{
+    Status answer;
+    minibase_globals = new SystemDefs(answer, "MINIBASE.DB", "MINIBASE.LOG", 100, 500, 100, "Clock");
+    if ( answer == OK )
+        answer = TestDriver::RunAllTests();
+	
+    delete minibase_globals;
+    return answer;
+}
+
+const char* HeapDriver::TestName()
+{
+    return "Heap File";
+}
+
+
+//********************************************
+
+bool HeapDriver::Test1()
+{
+    cout << "\n  Test 1: Insert and scan fixed-size records\n";
+    Status status = OK;
+    RecordID rid;
+	
+    cout << "  - Create a heap file\n";
+    HeapFile f("file_1", status);
+	
+    if (status != OK) 
+    {
+        cerr << "*** Could not create heap file\n";
+    }
+    else if ( MINIBASE_BM->GetNumOfUnpinnedFrames() != MINIBASE_BM->GetNumOfFrames() )
+	{
+        cerr << "*** The heap file has left pages pinned\n";
+        status = FAIL;
+	}
+	
+	if ( status == OK )
+	{
+        cout << "  - Add " << choice << " records to the file\n";
+        
+        for (int i = 0; i < choice && status == OK; i++)
+		{
+            Rec rec = { i, i*2.5 };
+            sprintf(rec.name, "record %i", i);
+			
+            status = f.InsertRecord((char *)&rec, reclen, rid);
+			
+            if (status != OK)
+            {
+                cerr << "*** Error inserting record " << i << endl;
+            }
+            else if ( MINIBASE_BM->GetNumOfUnpinnedFrames() != MINIBASE_BM->GetNumOfFrames() )
+			{
+                cerr << "*** Insertion left a page pinned\n";
+                status = FAIL;
+			}
+		}
+		
+        if ( f.GetNumOfRecords() != choice )
+		{
+            status = FAIL;
+            cerr << "*** File reports " << f.GetNumOfRecords() << " records, not "
+				 << choice << endl;
+                 
+		}
+	}
+
+	// the scan must return the insertion order.
+    Scan* scan = 0;
+    if ( status == OK )
+	{
+        cout << "  - Scan the records just inserted\n";
+        scan = f.OpenScan(status);
+		
+        if (status != OK)
+        {
+            cerr << "*** Error opening scan\n";
+        }
+        else if ( MINIBASE_BM->GetNumOfUnpinnedFrames() == MINIBASE_BM->GetNumOfFrames() )
+		{
+            cerr << "*** The heap-file scan has not pinned the first page\n";
+            status = FAIL;
+		}
+	}
+    if ( status == OK )
+	{
+        int len, i = 0;
+        Rec rec;
+		
+        while ( (status = scan->GetNext(rid, (char *)&rec, len)) == OK )
+		{
+            if ( len != reclen )
+			{
+                cerr << "*** Record " << i << " had unexpected length " << len << endl;
+                status = FAIL;
+                break;
+			}
+            else if ( MINIBASE_BM->GetNumOfUnpinnedFrames() == MINIBASE_BM->GetNumOfFrames() && i != choice - 1)
+			{
+                cerr << "*** The heap-file scan has not left its page pinned\n";
+                status = FAIL;
+                break;
+			}
+            char name[ sizeof(rec.name) ];
+            sprintf( name, "record %i", i );
+            if( rec.ival != i  ||
+                rec.fval != i*2.5  ||
+                0 != strcmp( rec.name, name ) )
+			{
+                cerr << "*** Record " << i << " differs from what we inserted\n";
+                status = FAIL;
+                break;
+			}
+            ++i;
+		}
+		
+        if ( status == DONE )
+		{
+            if ( MINIBASE_BM->GetNumOfUnpinnedFrames() != MINIBASE_BM->GetNumOfFrames() )
+                cerr << "*** The heap-file scan has not unpinned its page after finishing\n";
+            else if ( i == choice )
+                status = OK;
+            else
+                cerr << "*** Scanned " << i << " records instead of "
+				<< choice << endl;
+		}
+	}
+	
+    delete scan;
+	
+    if ( status == OK )
+        cout << "  Test 1 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//***************************************************
+
+bool HeapDriver::Test2()
+{
+    cout << "\n  Test 2: Delete fixed-size records\n";
+    Status status = OK;
+    Scan* scan = 0;
+    RecordID rid;
+	
+    cout << "  - Open the same heap file as Test 1\n";
+    HeapFile f("file_1", status);
+	
+    if (status != OK)
+        cerr << "*** Error opening heap file\n";
+	
+	
+    if ( status == OK )
+	{
+        cout << "  - Delete half the records\n";
+        scan = f.OpenScan(status);
+        if (status != OK)
+            cerr << "*** Error opening scan\n";
+	}
+    if ( status == OK )
+	{
+        int len, i = 0;
+        Rec rec;
+		
+        while ( (status = scan->GetNext(rid, (char *)&rec, len)) == OK )
+		{
+            if ( i & 1 )        // Delete the odd-numbered ones.
+			{
+                status = f.DeleteRecord( rid );
+                if ( status != OK )
+				{
+                    cerr << "*** Error deleting record " << i << endl;
+                    break;
+				}
+			}
+            ++i;
+		}
+		
+        if ( status == DONE )
+            status = OK;
+	}
+	
+    delete scan;
+    scan = 0;
+	
+    if ( status == OK
+		&& MINIBASE_BM->GetNumOfUnpinnedFrames() != MINIBASE_BM->GetNumOfFrames() )
+	{
+        cerr << "*** Deletion left a page pinned\n";
+        status = FAIL;
+	}
+	
+    if ( status == OK )
+	{
+        cout << "  - Scan the remaining records\n";
+        scan = f.OpenScan(status);
+        if (status != OK)
+            cerr << "*** Error opening scan\n";
+	}
+    if ( status == OK )
+	{
+        int len, i = 0;
+        Rec rec;
+		
+        while ( (status = scan->GetNext(rid, (char *)&rec, len)) == OK )
+		{
+            if( rec.ival != i  ||
+                rec.fval != i*2.5 )
+			{
+                cerr << "*** Record " << i << " differs from what we "
+                    "inserted\n";
+                status = FAIL;
+                break;
+			}
+            i += 2;     // Because we deleted the odd ones...
+		}
+		
+        if ( status == DONE )
+            status = OK;
+	}
+	
+    delete scan;
+	
+    if ( status == OK )
+        cout << "  Test 2 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//********************************************************
+
+bool HeapDriver::Test3()
+{
+    cout << "\n  Test 3: Update fixed-size records\n";
+    Status status = OK;
+    Scan* scan = 0;
+    RecordID rid;
+	
+    cout << "  - Open the same heap file as tests 1 and 2\n";
+    HeapFile f("file_1", status);
+	
+    if (status != OK)
+        cerr << "*** Error opening heap file\n";
+
+    if ( status == OK )
+	{
+        cout << "  - Change the records\n";
+        scan = f.OpenScan(status);
+        if (status != OK)
+            cerr << "*** Error opening scan\n";
+	}
+
+    if ( status == OK )
+	{
+        int len, i = 0;
+        Rec rec;
+		
+        while ( (status = scan->GetNext(rid, (char *)&rec, len)) == OK )
+		{
+            rec.fval = (float)7*i;     // We'll check that i==rec.ival below.
+            status = f.UpdateRecord( rid, (char*)&rec, len );
+            if ( status != OK )
+			{
+                cerr << "*** Error updating record " << i << endl;
+                break;
+			}
+            i += 2;     // Recall, we deleted every other record above.
+		}
+		
+        if ( status == DONE )
+            status = OK;
+	}
+	
+    delete scan;
+    scan = 0;
+	
+    if ( status == OK && 
+            MINIBASE_BM->GetNumOfUnpinnedFrames() != MINIBASE_BM->GetNumOfFrames() )
+	{
+        cerr << "*** Updating left pages pinned\n";
+        status = FAIL;
+	}
+	
+    if ( status == OK )
+	{
+        cout << "  - Check that the updates are really there\n";
+        scan = f.OpenScan(status);
+        if (status != OK)
+            cerr << "*** Error opening scan\n";
+	}
+
+    if ( status == OK )
+	{
+        int len, i = 0;
+        Rec rec, rec2;
+		
+        while ( (status = scan->GetNext(rid, (char *)&rec, len)) == OK )
+		{
+			// While we're at it, Test the getRecord method too.
+            status = f.GetRecord( rid, (char*)&rec2, len );
+            if ( status != OK )
+			{
+                cerr << "*** Error getting record " << i << endl;
+                break;
+			}
+            if( rec.ival != i || rec.fval != i*7 ||
+                    rec2.ival != i || rec2.fval != i*7 )
+			{
+                cerr << "*** Record " << i << " differs from our "
+                    "update\n";
+                status = FAIL;
+                break;
+			}
+            i += 2;     // Because we deleted the odd ones...
+		}
+		
+        if ( status == DONE )
+            status = OK;
+	}
+	
+    delete scan;
+	
+    if ( status == OK )
+        cout << "  Test 3 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//*****************************************************************
+
+bool HeapDriver::Test4()
+{
+    cout << "\n  Test 4: Temporary heap files and variable-length records\n";
+    Status status = OK;
+    Scan* scan = 0;
+    RecordID rid;
+	
+    cout << "  - Create a temporary heap file\n";
+    HeapFile f( 0, status );
+	
+    if (status != OK)
+        cerr << "*** Error creating temp file\n";
+
+    if ( status == OK )
+        cout << "  - Add variable-sized records\n";
+	
+    unsigned recSize = MINIBASE_PAGESIZE / 2;
+	/* We use half a page as the starting size so that a single page won't
+	hold more than one record.  We add a series of records at this size,
+	then halve the size and add some more, and so on.  We store the index
+	number of each record on the record itself. */
+    unsigned numRecs = 0;
+    char record[MINIBASE_PAGESIZE] = "";
+    for ( ; recSize >= (sizeof(numRecs) + sizeof(recSize)) && status == OK;
+	recSize /= 2 )
+        for ( unsigned i=0; i < 10 && status == OK; ++i, ++numRecs )
+	{
+		memcpy( record, &numRecs, sizeof(numRecs) );
+		memcpy( record+(sizeof(numRecs)), &recSize, sizeof(recSize) );
+		status = f.InsertRecord( record, recSize, rid );
+		if ( status != OK )
+			cerr << "*** Failed inserting record " << numRecs
+			<< ", of size " << recSize << endl;
+	}
+	
+	
+    int *seen = new int[numRecs];
+	for (int i = 0; i < (int)numRecs; i++)
+	{
+		seen[i] = false;
+	}
+
+    // memset( seen, 0, sizeof(seen) );
+    if ( status == OK )
+	{
+        cout << "  - Check that all the records were inserted\n";
+        scan = f.OpenScan(status);
+        if (status != OK)
+            cerr << "*** Error opening scan\n";
+	}
+    if ( status == OK )
+	{
+        int len;
+        while ( (status = scan->GetNext(rid, record, len)) == OK )
+		{
+            unsigned recNum;
+            memcpy( &recNum, record, sizeof(recNum) );
+            if ( seen[recNum])
+			{
+                cerr << "*** Found record " << recNum << " twice!\n";
+                status = FAIL;
+                break;
+			}
+            seen[recNum] = true;
+			
+            memcpy( &recSize, record + sizeof(recNum), sizeof(recSize) );
+            if ( recSize != (unsigned)len )
+			{
+                cerr << "*** Record size mismatch: stored " << recSize
+					<< ", but retrieved " << len << endl;
+                status = FAIL;
+                break;
+			}
+			
+            --numRecs;
+		}
+		
+        if ( status == DONE ) {
+            if ( numRecs )
+                cerr << "*** Scan missed " << numRecs << " records\n";
+		    else
+                status = OK;
+        }
+	}
+	
+    delete scan;
+	
+    if ( status == OK )
+        cout << "  Test 4 completed successfully.\n";
+    return (status == OK);
+}
+
+
+bool HeapDriver::Test5()
+{
+    cout << "\n  Test 5: Test some error conditions\n";
+    Status status = OK;
+    Scan* scan = 0;
+    RecordID rid;
+	
+    HeapFile f("file_1", status);
+    if (status != OK)
+        cerr << "*** Error opening heap file\n";
+	
+    if ( status == OK )
+	{
+        cout << "  - Try to make a record longer than a page\n";
+        scan = f.OpenScan(status);
+        if (status != OK)
+            cerr << "*** Error opening scan\n";
+	}
+    if ( status == OK )
+	{
+        int len;
+        Rec rec;
+        status = scan->GetNext(rid, (char *)&rec, len);
+        if ( status != OK )
+            cerr << "*** Error reading first record\n";
+        else
+		{
+            char record[MINIBASE_PAGESIZE] = "";
+            status = f.UpdateRecord( rid, record, MINIBASE_PAGESIZE );
+            TestFailure( status, HEAPFILE, "Lengthening a record past a page" );
+		}
+	}
+	
+    delete scan;
+
+    if ( status == OK )
+	{
+        cout << "  - Try to insert a record that's too long\n";
+        char record[MINIBASE_PAGESIZE] = "";
+        status = f.InsertRecord( record, MINIBASE_PAGESIZE, rid );
+        TestFailure( status, HEAPFILE, "Inserting a too-long record" );
+	}
+
+    // One byte over what a page holds must fail without adding pages,
+    // and a record that just fits must go in.
+
+    FileResidency before, after;
+    if ( status == OK )
+        status = MINIBASE_BM->GetFileResidency( "file_1", before );
+    if ( status == OK )
+	{
+        cout << "  - Try to insert and append a record one byte too long\n";
+        char record[MINIBASE_PAGESIZE] = "";
+        status = f.InsertRecord( record, HeapPage::MaxRecordLength() + 1, rid );
+        TestFailure( status, HEAPFILE, "Inserting a record one byte too long" );
+        if ( status == OK )
+		{
+            status = f.AppendRecord( record, HeapPage::MaxRecordLength() + 1, rid );
+            TestFailure( status, HEAPFILE, "Appending a record one byte too long" );
+		}
+	}
+    if ( status == OK )
+        status = MINIBASE_BM->GetFileResidency( "file_1", after );
+    if ( status == OK && after.numOfPages != before.numOfPages )
+	{
+        cerr << "*** The file grew from " << before.numOfPages << " to "
+             << after.numOfPages << " pages\n";
+        status = FAIL;
+	}
+
+    if ( status == OK )
+	{
+        cout << "  - Insert a record that fills a page\n";
+        char record[MINIBASE_PAGESIZE] = "";
+        status = f.AppendRecord( record, HeapPage::MaxRecordLength(), rid );
+        if ( status == OK )
+            status = f.DeleteRecord( rid );
+        if ( status != OK )
+            cerr << "*** Error inserting a record that fits a page\n";
+	}
+
+    if ( status == OK )
+        cout << "  Test 5 completed successfully.\n";
+    return (status == OK);
+}
+
+
+bool HeapDriver::Test6()
+{
+    cout << "\n  Test 6: Seal and unseal heap pages\n";
+    Status status = OK;
+    Scan* scan = 0;
+    RecordID rid;
+
+    cout << "  - Create a heap file\n";
+    HeapFile f("file_6", status);
+
+    if (status != OK)
+        cerr << "*** Could not create heap file\n";
+
+    for (int i = 0; i < choice && status == OK; i++)
+    {
+        Rec rec = { 1000 + i, i*2.5 };
+        sprintf(rec.name, "record %i", i % 4);
+        status = f.InsertRecord((char *)&rec, reclen, rid);
+        if (status != OK)
+            cerr << "*** Error inserting record " << i << endl;
+    }
+
+    if ( status == OK )
+    {
+        cout << "  - Seal every page and read the records back\n";
+        scan = f.OpenScan(status);
+        if (status != OK)
+            cerr << "*** Error opening scan\n";
+    }
+
+    const ColumnDesc cols[] = {
+        { offsetof(Rec, ival), sizeof(int), attrInteger },
+        { offsetof(Rec, name), namelen, attrString },
+    };
+    SealedPage sealed;
+    Page restored;
+    PageID lastPid = INVALID_PAGE;
+    int pages = 0, heapBytes = 0, sealedBytes = 0;
+
+    if ( status == OK )
+    {
+        int len;
+        Rec rec;
+
+        while ( (status = scan->GetNext(rid, (char *)&rec, len)) == OK )
+        {
+            if ( rid.pageNo == lastPid )
+                continue;
+            lastPid = rid.pageNo;
+
+            HeapPage *page;
+            if ( MINIBASE_BM->PinPage(rid.pageNo, (Page *&)page) != OK )
+            {
+                status = FAIL;
+                break;
+            }
+
+            status = sealed.Seal(page, cols, 2);
+            if ( status != OK )
+                cerr << "*** Could not seal page " << rid.pageNo << endl;
+
+            HeapPage *copy = (HeapPage *)&restored;
+            if ( status == OK )
+                status = sealed.Unseal(copy);
+
+            RecordID cur;
+            Status more = page->FirstRecord(cur);
+            while ( status == OK && more == OK )
+            {
+                Rec orig, fromSealed, fromCopy;
+                int l1, l2, l3;
+                page->GetRecord(cur, (char *)&orig, l1);
+                if ( sealed.GetRecord(cur, (char *)&fromSealed, l2) != OK ||
+                     copy->GetRecord(cur, (char *)&fromCopy, l3) != OK ||
+                     l1 != l2 || l1 != l3 ||
+                     memcmp(&orig, &fromSealed, l1) != 0 ||
+                     memcmp(&orig, &fromCopy, l1) != 0 )
+                {
+                    cerr << "*** Record " << cur << " differs after sealing\n";
+                    status = FAIL;
+                }
+                more = page->NextRecord(cur, cur);
+            }
+
+            if ( status == OK && copy->GetNumOfRecords() != page->GetNumOfRecords() )
+            {
+                cerr << "*** Page " << rid.pageNo << " lost records when unsealed\n";
+                status = FAIL;
+            }
+
+            pages++;
+            heapBytes += MAX_SPACE - page->AvailableSpace();
+            sealedBytes += sealed.SealedSize();
+
+            if ( MINIBASE_BM->UnpinPage(rid.pageNo, CLEAN) != OK )
+                status = FAIL;
+            if ( status != OK )
+                break;
+        }
+
+        if ( status == DONE )
+            status = OK;
+    }
+
+    delete scan;
+
+    if ( status == OK )
+        cout << "  - Sealed " << pages << " pages from " << heapBytes
+             << " to " << sealedBytes << " bytes\n";
+
+    if ( status == OK )
+        status = f.DeleteFile();
+
+    if ( status == OK )
+        cout << "  Test 6 completed successfully.\n";
+    return (status == OK);
+}
+
+
+bool HeapDriver::Test7()
+{
+    cout << "\n  Test 7: Detect corrupted pages\n";
+    Status status = OK;
+    RecordID rid;
+
+    cout << "  - Create a heap file\n";
+    HeapFile f("file_7", status);
+
+    if (status != OK)
+        cerr << "*** Could not create heap file\n";
+
+    for (int i = 0; i < choice && status == OK; i++)
+    {
+        Rec rec = { i, i*2.5 };
+        sprintf(rec.name, "record %i", i);
+        status = f.InsertRecord((char *)&rec, reclen, rid);
+        if (status != OK)
+            cerr << "*** Error inserting record " << i << endl;
+    }
+
+    // Write the page holding the last record through to disk, then flip
+    // one of its bytes behind the buffer manager's back.
+    Page page;
+    if ( status == OK )
+    {
+        Page *frame;
+        status = MINIBASE_BM->PinPage(rid.pageNo, frame);
+        if ( status == OK )
+        {
+            page = *frame;
+            status = MINIBASE_BM->UnpinPage(rid.pageNo, CLEAN);
+        }
+        if ( status == OK )
+            status = MINIBASE_DB->WritePage(rid.pageNo, &page);
+        if ( status != OK )
+            cerr << "*** Could not write page " << rid.pageNo << endl;
+    }
+
+    fstream db(MINIBASE_DB->GetName(), ios::in | ios::out | ios::binary);
+    streamoff where = (streamoff)rid.pageNo * MINIBASE_PAGESIZE + MINIBASE_PAGESIZE / 2;
+    char byte = 0;
+
+    if ( status == OK )
+    {
+        cout << "  - Corrupt page " << rid.pageNo << " and read it back\n";
+        db.seekg(where);
+        db.get(byte);
+        db.seekp(where);
+        db.put(byte ^ 0x5a);
+        db.flush();
+        if ( !db )
+        {
+            cerr << "*** Could not modify the database file\n";
+            status = FAIL;
+        }
+    }
+
+    if ( status == OK )
+    {
+        status = MINIBASE_DB->ReadPage(rid.pageNo, &page);
+        if ( status != OK && minibase_errors.error_index() != BAD_CHECKSUM )
+            cerr << "*** Reading a corrupted page failed for the wrong reason\n";
+        else
+            TestFailure( status, DBMGR, "Reading a corrupted page" );
+    }
+
+    if ( status == OK )
+    {
+        cout << "  - Repair the page and read it again\n";
+        db.seekp(where);
+        db.put(byte);
+        db.flush();
+        status = MINIBASE_DB->ReadPage(rid.pageNo, &page);
+        if ( status != OK )
+            cerr << "*** Could not read the repaired page\n";
+    }
+
+    // A crash after the checksums of a write are stored but before the
+    // page is leaves the page as it was, which must still read back.
+    if ( status == OK )
+    {
+        cout << "  - Undo a write of the page, as a crash would, and read it again\n";
+        Page changed = page;
+        ((char *)&changed)[MINIBASE_PAGESIZE / 2] ^= 0x5a;
+        status = MINIBASE_DB->WritePage(rid.pageNo, &changed);
+        if ( status == OK )
+        {
+            db.seekp((streamoff)rid.pageNo * MINIBASE_PAGESIZE);
+            db.write((const char *)&page, MINIBASE_PAGESIZE);
+            db.flush();
+            if ( !db )
+                status = FAIL;
+        }
+        if ( status == OK )
+            status = MINIBASE_DB->ReadPage(rid.pageNo, &changed);
+        if ( status == OK && memcmp(&changed, &page, MINIBASE_PAGESIZE) != 0 )
+            status = FAIL;
+        if ( status != OK )
+            cerr << "*** Could not read the page as it was before the write\n";
+    }
+
+    if ( status == OK )
+        status = f.DeleteFile();
+
+    if ( status == OK )
+        cout << "  Test 7 completed successfully.\n";
+    return (status == OK);
+}
+
+
+bool HeapDriver::Test8()
+{
+    cout << "\n  Test 8: Write-ahead logging and group commit\n";
+    Status status = OK;
+    RecordID rid;
+
+    cout << "  - Create a heap file\n";
+    HeapFile f("file_8", status);
+
+    if (status != OK)
+        cerr << "*** Could not create heap file\n";
+
+    LSN before = MINIBASE_LOG->GetEndLSN();
+    for (int i = 0; i < choice && status == OK; i++)
+    {
+        Rec rec = { i, i*2.5 };
+        sprintf(rec.name, "record %i", i);
+        status = f.InsertRecord((char *)&rec, reclen, rid);
+        if (status != OK)
+            cerr << "*** Error inserting record " << i << endl;
+    }
+
+    if ( status == OK )
+    {
+        cout << "  - Update and delete a record\n";
+        Rec rec = { -1, -1.0 };
+        sprintf(rec.name, "updated");
+        status = f.UpdateRecord(rid, (char *)&rec, reclen);
+        if ( status != OK )
+            cerr << "*** Error updating record " << rid << endl;
+    }
+
+    // The page of the last record must carry the LSN of its newest change,
+    // and must not reach disk before that log record does.
+    LSN pageLSN = INVALID_LSN;
+    if ( status == OK )
+    {
+        HeapPage *page;
+        status = MINIBASE_BM->PinPage(rid.pageNo, (Page *&)page);
+        if ( status == OK )
+        {
+            pageLSN = page->GetLSN();
+            status = MINIBASE_BM->UnpinPage(rid.pageNo, CLEAN);
+        }
+
+        if ( status == OK && (pageLSN < before || pageLSN >= MINIBASE_LOG->GetEndLSN()) )
+        {
+            cerr << "*** Page " << rid.pageNo << " has LSN " << pageLSN
+                 << ", expected one in [" << before << ", "
+                 << MINIBASE_LOG->GetEndLSN() << ")\n";
+            status = FAIL;
+        }
+    }
+
+    if ( status == OK )
+    {
+        cout << "  - Flush page " << rid.pageNo << "\n";
+        status = MINIBASE_BM->FlushPage(rid.pageNo);
+        if ( status == OK && MINIBASE_LOG->GetDurableLSN() <= pageLSN )
+        {
+            cerr << "*** Page written before its log record\n";
+            status = FAIL;
+        }
+    }
+
+    if ( status == OK )
+    {
+        const int numOfThreads = 8;
+        const int commitsPerThread = 50;
+        long commitsBefore, syncsBefore, commitsAfter, syncsAfter;
+
+        cout << "  - Commit from " << numOfThreads << " threads at once\n";
+        MINIBASE_LOG->GetStat(commitsBefore, syncsBefore);
+
+        std::vector<std::thread> threads;
+        std::vector<Status> results(numOfThreads, OK);
+        for (int t = 0; t < numOfThreads; t++)
+            threads.push_back(std::thread([t, &results]() {
+                for (int i = 0; i < commitsPerThread && results[t] == OK; i++)
+                    results[t] = MINIBASE_LOG->Commit();
+            }));
+        for (int t = 0; t < numOfThreads; t++)
+        {
+            threads[t].join();
+            if ( results[t] != OK )
+                status = results[t];
+        }
+
+        MINIBASE_LOG->GetStat(commitsAfter, syncsAfter);
+        long commits = commitsAfter - commitsBefore;
+        long syncs = syncsAfter - syncsBefore;
+
+        if ( status != OK || commits != numOfThreads * commitsPerThread || syncs > commits )
+        {
+            cerr << "*** " << commits << " commits took " << syncs << " syncs\n";
+            status = FAIL;
+        }
+        else if ( MINIBASE_LOG->GetDurableLSN() != MINIBASE_LOG->GetEndLSN() )
+        {
+            cerr << "*** Committed records are not durable\n";
+            status = FAIL;
+        }
+        else
+            cout << "  - " << commits << " commits took " << syncs << " log syncs\n";
+    }
+
+    if ( status == OK )
+        status = f.DeleteFile();
+
+    if ( status == OK )
+        cout << "  Test 8 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//------------------------------------------------------------------
+// CheckRecovered
+//
+// Input    : numOfRecords - number of committed records in file_9.
+// Output   : None.
+// Purpose  : Checks that file_9 holds exactly the committed records,
+//            as they were committed, after a restart.
+// Return   : OK if it does, FAIL otherwise.
+//------------------------------------------------------------------
+
+static Status CheckRecovered(int numOfRecords)
+{
+    Status status = OK;
+    RecordID rid;
+    HeapFile f("file_9", status);
+
+    if (status != OK)
+    {
+        cerr << "*** Could not open heap file after restart\n";
+        return FAIL;
+    }
+
+    if ( f.GetNumOfRecords() != numOfRecords )
+    {
+        cerr << "*** File reports " << f.GetNumOfRecords()
+             << " records instead of " << numOfRecords << endl;
+        return FAIL;
+    }
+
+    Scan *scan = f.OpenScan(status);
+    if (status != OK)
+    {
+        cerr << "*** Error opening scan\n";
+        return FAIL;
+    }
+
+    vector<bool> seen(numOfRecords, false);
+    int len, count = 0;
+    Rec rec;
+
+    while ( (status = scan->GetNext(rid, (char *)&rec, len)) == OK )
+    {
+        if ( len != reclen || rec.ival < 0 || rec.ival >= numOfRecords ||
+             seen[rec.ival] || rec.fval != rec.ival*2.5 )
+        {
+            cerr << "*** Record " << rid << " is not a committed record\n";
+            status = FAIL;
+            break;
+        }
+        seen[rec.ival] = true;
+        count++;
+    }
+    delete scan;
+
+    if ( status == DONE && count != numOfRecords )
+    {
+        cerr << "*** Scanned " << count << " records instead of "
+             << numOfRecords << endl;
+        status = FAIL;
+    }
+
+    return (status == DONE) ? OK : FAIL;
+}
+
+
+// A record of Tests 20 on: its number, then as many bytes as it is long.
+static void FillRecord(char* rec, int id, int len)
+{
+    memset(rec, 'a' + id % 26, len);
+    memcpy(rec, &id, sizeof(int));
+}
+
+
+// Test 26's records, read after a restart: the pages they are on were
+// brought back, so that reading them misses nothing.
+static Status CheckWarmed()
+{
+    const int numOfRecords = 40;
+    const int len = 200;
+    Status status = OK;
+
+    MINIBASE_IO->Drain();
+    MINIBASE_BM->ResetStat();
+
+    HeapFile f("file_26", status);
+    Scan *scan = (status == OK) ? f.OpenScan(status) : NULL;
+    vector<bool> seen(numOfRecords, false);
+    char rec[MAX_SPACE], expected[MAX_SPACE];
+    RecordID rid;
+    int recLen, count = 0;
+    while (status == OK && (status = scan->GetNext(rid, rec, recLen)) == OK)
+    {
+        int id;
+        memcpy(&id, rec, sizeof(int));
+        if (id >= 0 && id < numOfRecords)
+            FillRecord(expected, id, len);
+        if (id < 0 || id >= numOfRecords || seen[id] || recLen != len
+            || memcmp(rec, expected, len) != 0)
+        {
+            cerr << "*** Record " << rid << " is wrong\n";
+            status = FAIL;
+            break;
+        }
+        seen[id] = true;
+        count++;
+    }
+    delete scan;
+    if (status != DONE || count != numOfRecords)
+    {
+        cerr << "*** Read " << count << " of " << numOfRecords << " records\n";
+        return FAIL;
+    }
+
+    long pins, misses;
+    status = MINIBASE_BM->GetStat(pins, misses);
+    if (status == OK && misses != 0)
+    {
+        cerr << "*** Reading the records missed " << misses << " times\n";
+        status = FAIL;
+    }
+    return status;
+}
+
+
+// What Test 28 committed while its checkpoint was being taken.
+static const int CHECKPOINT_RECORDS = 40;
+static const int CHECKPOINT_LEN = 40;
+
+static Status CheckChangedInCheckpoint()
+{
+    Status status;
+    HeapFile f("file_28", status);
+    if ( status != OK )
+        return status;
+
+    // Every other record was updated to the one after it, and the rest
+    // deleted.
+    Scan *scan = f.OpenScan(status);
+    char rec[MAX_SPACE];
+    RecordID rid;
+    int len, count = 0;
+    while ( status == OK && (status = scan->GetNext(rid, rec, len)) == OK )
+    {
+        int id;
+        memcpy(&id, rec, sizeof(int));
+        char expected[MAX_SPACE];
+        FillRecord(expected, id, CHECKPOINT_LEN);
+        if ( len != CHECKPOINT_LEN || id % 2 != 1 || memcmp(rec, expected, len) != 0 )
+        {
+            cerr << "*** Record " << rid << " is not as committed during the checkpoint\n";
+            status = FAIL;
+        }
+        count++;
+    }
+    delete scan;
+
+    if ( status == DONE && count != CHECKPOINT_RECORDS / 2 )
+    {
+        cerr << "*** Found " << count << " records instead of "
+             << CHECKPOINT_RECORDS / 2 << endl;
+        status = FAIL;
+    }
+    return (status == DONE) ? OK : FAIL;
+}
+
+
+static const int INDEXED_RECORDS = 60;
+static const int INDEXED_LEN = 20;
+
+// Test 31's indexes after a restart undid the inserts and deletes of a
+// process that crashed: each committed record has one entry in each,
+// the records it inserted none.  A process that restarted the database
+// finds the indexes stale until it attaches them.
+static Status CheckIndexesRecovered(bool mustBeStale)
+{
+    Status status;
+    HeapFile f("file_31", status);
+    if ( status != OK )
+        return status;
+    HashIndex hash("file_31.hash", 0, attrInteger, sizeof(int), status);
+    if ( status != OK )
+        return status;
+    BTreeIndex tree("file_31.tree", 0, attrInteger, sizeof(int), status);
+    if ( status != OK )
+        return status;
+
+    if ( mustBeStale && (!hash.IsStale() || !tree.IsStale()) )
+    {
+        cerr << "*** The restart did not leave the indexes stale\n";
+        return FAIL;
+    }
+    status = f.AttachIndex(&hash);
+    if ( status == OK )
+        status = f.AttachIndex(&tree);
+    if ( status == OK && (hash.IsStale() || tree.IsStale()) )
+    {
+        cerr << "*** Attaching the indexes did not rebuild them\n";
+        status = FAIL;
+    }
+
+    for (int key = 0; key < INDEXED_RECORDS + INDEXED_RECORDS/4 && status == OK; key++)
+    {
+        size_t expected = (key < INDEXED_RECORDS) ? 1 : 0;
+        vector<RecordID> hashRids, treeRids;
+        status = hash.Lookup((char *)&key, hashRids);
+        if ( status == OK )
+            status = tree.Lookup((char *)&key, treeRids);
+        if ( status != OK )
+            break;
+
+        if ( hashRids.size() != expected || treeRids.size() != expected )
+        {
+            cerr << "*** Key " << key << " has " << hashRids.size() << " hash and "
+                 << treeRids.size() << " B+-tree entries instead of " << expected << endl;
+            status = FAIL;
+        }
+        else if ( expected == 1 )
+        {
+            char rec[MAX_SPACE];
+            int len, id = -1;
+            if ( !(hashRids[0] == treeRids[0]) || f.GetRecord(hashRids[0], rec, len) != OK )
+                status = FAIL;
+            else
+                memcpy(&id, rec, sizeof(int));
+            if ( id != key )
+            {
+                cerr << "*** The entries of key " << key << " point to the wrong record\n";
+                status = FAIL;
+            }
+        }
+    }
+
+    f.DetachIndex(&hash);
+    f.DetachIndex(&tree);
+    return status;
+}
+
+
+static Status ReadSnapshot(HeapFile& f, TxnID txn, map<RecordID, int>& ivals);
+
+// Test 32 commits records with ivals 0 up to CRASHED_RECORDS, then a process
+// changes some in a transaction and crashes while it runs, after another
+// commits the record with ival CRASHED_RECORDS.
+static const int CRASHED_RECORDS = 20;
+
+// A transaction sees what Test 32 committed and nothing of what the
+// transaction running at the crash wrote.
+static Status CheckCrashedTxn()
+{
+    Status status;
+    HeapFile f("file_32", status);
+    TxnID txn;
+    if ( status == OK )
+        status = MINIBASE_TXN->Begin(txn);
+    if ( status != OK )
+        return status;
+
+    map<RecordID, int> seen;
+    status = ReadSnapshot(f, txn, seen);
+    vector<bool> found(CRASHED_RECORDS + 1, false);
+    for (map<RecordID, int>::iterator i = seen.begin(); i != seen.end() && status == OK; ++i)
+    {
+        if ( i->second < 0 || i->second > CRASHED_RECORDS || found[i->second] )
+        {
+            cerr << "*** " << i->first << " has ival " << i->second
+                 << ", which no transaction that committed wrote\n";
+            status = FAIL;
+        }
+        else
+            found[i->second] = true;
+    }
+    if ( status == OK && seen.size() != found.size() )
+    {
+        cerr << "*** Saw " << seen.size() << " records instead of " << found.size() << endl;
+        status = FAIL;
+    }
+
+    MINIBASE_TXN->Abort(txn);
+    return status;
+}
+
+
+// Test 33 churns records until the log has grown several times past
+// its size limit, in pages, which is what the tests open the database
+// with; at the end the file holds the records with these ids.
+static const int LOG_LIMIT = 500;
+static const int CHURN_LEN = 100;
+static const int KEPT_RECORDS = 2;
+
+// Bytes of disk the log takes up, the holes in it left out.
+static long LogSpace()
+{
+    struct stat st;
+    if ( stat("MINIBASE.LOG", &st) != 0 )
+        return -1;
+    return (long)st.st_blocks * 512;
+}
+
+// Test 33's records, read after a restart that had only what the log
+// kept to go by.
+static Status CheckLogReclaimed()
+{
+    Status status;
+    HeapFile f("file_33", status);
+    if ( status != OK )
+        return status;
+
+    Scan *scan = f.OpenScan(status);
+    vector<bool> seen(KEPT_RECORDS, false);
+    char rec[MAX_SPACE], expected[MAX_SPACE];
+    RecordID rid;
+    int len, count = 0;
+    while ( status == OK && (status = scan->GetNext(rid, rec, len)) == OK )
+    {
+        int id;
+        memcpy(&id, rec, sizeof(int));
+        if ( id >= 0 && id < KEPT_RECORDS )
+            FillRecord(expected, id, CHURN_LEN);
+        if ( id < 0 || id >= KEPT_RECORDS || seen[id] || len != CHURN_LEN
+             || memcmp(rec, expected, len) != 0 )
+        {
+            cerr << "*** Record " << rid << " is not one that was kept\n";
+            status = FAIL;
+        }
+        else
+            seen[id] = true;
+        count++;
+    }
+    delete scan;
+
+    if ( status == DONE && count != KEPT_RECORDS )
+    {
+        cerr << "*** Found " << count << " records instead of " << KEPT_RECORDS << endl;
+        status = FAIL;
+    }
+    return (status == DONE) ? OK : FAIL;
+}
+
+
+//------------------------------------------------------------------
+// Restart
+//
+// Runs this program again as "heappage -restart test", which opens the
+// database, recovering it, and makes test's checks (see
+// HeapDriver::RunRestart), in a process that shares no memory with
+// this one.  The database must be closed here meanwhile.
+// Returns OK if the checks passed.
+//------------------------------------------------------------------
+
+static Status Restart(int test)
+{
+    cout.flush();
+
+    pid_t child = fork();
+    if ( child == 0 )
+    {
+        char arg[16];
+        sprintf(arg, "%d", test);
+        execl("/proc/self/exe", "heappage", "-restart", arg, (char *)NULL);
+        _exit(127);
+    }
+
+    int childStatus;
+    if ( child < 0 || waitpid(child, &childStatus, 0) != child ||
+         !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0 )
+        return FAIL;
+    return OK;
+}
+
+
+//------------------------------------------------------------------
+// HeapDriver::RunRestart
+//
+// Opens the database, recovering it, and checks what the given test
+// left in it, in the process Restart runs.  The database is left open,
+// as a crash would leave it, and nothing is written back.
+//------------------------------------------------------------------
+
+Status HeapDriver::RunRestart(int test)
+{
+    Status status;
+    minibase_globals = new SystemDefs(status, "MINIBASE.DB", "MINIBASE.LOG", 0, 500, 100, "Clock");
+    if ( status != OK )
+    {
+        cerr << "*** Error reopening the database\n";
+        return status;
+    }
+
+    switch ( test )
+    {
+    case 9:
+        status = CheckRecovered(choice + choice/2);
+        break;
+    case 26:
+        status = CheckWarmed();
+        break;
+    case 28:
+        status = CheckChangedInCheckpoint();
+        break;
+    case 31:
+        status = CheckIndexesRecovered(true);
+        break;
+    case 32:
+        status = CheckCrashedTxn();
+        break;
+    case 33:
+        status = CheckLogReclaimed();
+        break;
+    default:
+        cerr << "*** Test " << test << " does not restart\n";
+        status = FAIL;
+    }
+
+    MINIBASE_IO->Drain();
+    return status;
+}
+
+
+bool HeapDriver::Test9()
+{
+    cout << "\n  Test 9: Crash recovery\n";
+    Status status = OK;
+    RecordID rid;
+    int numOfCommitted = choice + choice/2;
+
+    cout << "  - Insert " << choice << " records and commit\n";
+    {
+        HeapFile f("file_9", status);
+        if (status != OK)
+            cerr << "*** Could not create heap file\n";
+
+        for (int i = 0; i < choice && status == OK; i++)
+        {
+            Rec rec = { i, i*2.5 };
+            sprintf(rec.name, "record %i", i);
+            status = f.InsertRecord((char *)&rec, reclen, rid);
+            if (status != OK)
+                cerr << "*** Error inserting record " << i << endl;
+        }
+
+        if ( status == OK )
+            status = MINIBASE_LOG->Commit();
+    }
+
+    if ( status != OK )
+        return false;
+
+    // The child shares the database and the log.  It checkpoints, commits
+    // more records, then changes the committed ones without committing:
+    // some of those changes reach the database, and it dies with the rest
+    // still in the buffer pool.
+
+    cout << "  - Crash while uncommitted changes are on disk\n";
+    cout.flush();
+
+    pid_t child = fork();
+    if ( child == 0 )
+    {
+        HeapFile f("file_9", status);
+
+        if ( status == OK )
+            status = MINIBASE_LOG->Checkpoint();
+
+        for (int i = choice; i < numOfCommitted && status == OK; i++)
+        {
+            Rec rec = { i, i*2.5 };
+            sprintf(rec.name, "record %i", i);
+            status = f.InsertRecord((char *)&rec, reclen, rid);
+        }
+
+        if ( status == OK )
+            status = MINIBASE_LOG->Commit();
+
+        vector<RecordID> rids;
+        Scan *scan = (status == OK) ? f.OpenScan(status) : NULL;
+        if ( status == OK )
+        {
+            int len;
+            Rec rec;
+            while ( (status = scan->GetNext(rid, (char *)&rec, len)) == OK )
+                rids.push_back(rid);
+            if ( status == DONE )
+                status = OK;
+        }
+        delete scan;
+
+        // Some of the updates shrink records, and some grow them out of
+        // their pages.
+        for (size_t i = 0; i < rids.size() && status == OK; i += 3)
+        {
+            char rec[3 * reclen] = "";
+            Rec uncommitted = { -1, -1.0 };
+            sprintf(uncommitted.name, "uncommitted");
+            memcpy(rec, &uncommitted, reclen);
+            int len = (i % 9 == 0) ? 3 * reclen : (i % 9 == 3) ? reclen / 2 : reclen;
+            status = f.UpdateRecord(rids[i], rec, len);
+            if ( status == OK && i + 1 < rids.size() )
+                status = f.DeleteRecord(rids[i + 1]);
+        }
+
+        if ( status == OK )
+            status = MINIBASE_BM->FlushPage(rids[0].pageNo);
+
+        for (int i = 0; i < choice && status == OK; i++)
+        {
+            Rec rec = { -2, -2.0 };
+            sprintf(rec.name, "uncommitted");
+            status = f.InsertRecord((char *)&rec, reclen, rid);
+        }
+
+        if ( status == OK )
+            status = MINIBASE_LOG->Flush(MINIBASE_LOG->GetEndLSN());
+
+        _exit(status == OK ? 0 : 1);
+    }
+
+    int childStatus;
+    if ( child < 0 || waitpid(child, &childStatus, 0) != child ||
+         !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0 )
+    {
+        cerr << "*** The crashing process failed before it crashed\n";
+        return false;
+    }
+
+    // Restart twice, each time in a process of its own that exits
+    // without closing the database: the second restart finds the first
+    // one's work only in the log, as nothing was written back in between.
+
+    delete minibase_globals;
+    minibase_globals = NULL;
+
+    for (int restart = 1; restart <= 2 && status == OK; restart++)
+    {
+        cout << "  - Restart " << restart << "\n";
+        status = Restart(9);
+        if ( status != OK )
+            cerr << "*** Restart " << restart << " failed\n";
+    }
+
+    // Reopen even if the restart failed, for the tests that follow.
+
+    Status reopened;
+    minibase_globals = new SystemDefs(reopened, "MINIBASE.DB", "MINIBASE.LOG", 0, 500, 100, "Clock");
+    if ( reopened != OK )
+    {
+        cerr << "*** Error reopening the database\n";
+        status = FAIL;
+    }
+
+    if ( status == OK )
+        status = CheckRecovered(numOfCommitted);
+
+    if ( status == OK )
+    {
+        cout << "  - All " << numOfCommitted << " committed records, and nothing else\n";
+        HeapFile f("file_9", status);
+        if ( status == OK )
+            status = f.DeleteFile();
+        if ( status == OK )
+            status = MINIBASE_LOG->Commit();
+    }
+
+    if ( status == OK )
+        cout << "  Test 9 completed successfully.\n";
+    return (status == OK);
+}
+
+
+// Returns in pages the data pages of f, in the order a scan visits them.
+static Status ScanPages(HeapFile& f, vector<PageID>& pages)
+{
+    Status status;
+    Scan* scan = f.OpenScan(status);
+    if (status != OK)
+        return status;
+
+    RecordID rid;
+    Rec rec;
+    int len;
+    while ((status = scan->GetNext(rid, (char *)&rec, len)) == OK)
+        if (pages.empty() || pages.back() != rid.pageNo)
+            pages.push_back(rid.pageNo);
+    delete scan;
+
+    return (status == DONE) ? OK : status;
+}
+
+
+bool HeapDriver::Test10()
+{
+    cout << "\n  Test 10: Extent allocation\n";
+    Status status = OK;
+    RecordID rid;
+
+    cout << "  - Create two heap files and fill them in turn\n";
+    HeapFile f("file_10a", status);
+    if (status != OK)
+        cerr << "*** Could not create heap file\n";
+
+    HeapFile g("file_10b", status);
+    if (status != OK)
+        cerr << "*** Could not create heap file\n";
+
+    for (int i = 0; i < choice && status == OK; i++)
+    {
+        Rec rec = { i, i*2.5 };
+        sprintf(rec.name, "record %i", i);
+        status = f.InsertRecord((char *)&rec, reclen, rid);
+        if (status == OK)
+            status = g.InsertRecord((char *)&rec, reclen, rid);
+        if (status != OK)
+            cerr << "*** Error inserting record " << i << endl;
+    }
+
+    // However the inserts were interleaved, each file's data pages must
+    // be consecutive on disk.
+    for (int n = 0; n < 2 && status == OK; n++)
+    {
+        HeapFile& h = (n == 0) ? f : g;
+        vector<PageID> pages;
+        status = ScanPages(h, pages);
+        if (status != OK)
+            cerr << "*** Error scanning file " << n << endl;
+
+        cout << "  - File " << n << " has " << pages.size() << " pages";
+        if (!pages.empty())
+            cout << ", " << pages.front() << " to " << pages.back();
+        cout << "\n";
+
+        for (size_t i = 1; i < pages.size() && status == OK; i++)
+            if (pages[i] != pages[i-1] + 1)
+            {
+                cerr << "*** Page " << pages[i] << " does not follow page "
+                     << pages[i-1] << endl;
+                status = FAIL;
+            }
+        if (status == OK && pages.size() < 2)
+        {
+            cerr << "*** Expected the file to span several pages\n";
+            status = FAIL;
+        }
+    }
+
+    if (status == OK)
+        status = f.DeleteFile();
+    if (status == OK)
+        status = g.DeleteFile();
+
+    if (status == OK)
+        cout << "  Test 10 completed successfully.\n";
+    return (status == OK);
+}
+
+
+// Returns how much counter name of the registry grew since before.
+static long Grew(const MetricsSnapshot& before, const MetricsSnapshot& after,
+                 const char* name)
+{
+    map<string, long>::const_iterator a = after.counters.find(name);
+    map<string, long>::const_iterator b = before.counters.find(name);
+    return (a == after.counters.end() ? 0 : a->second)
+         - (b == before.counters.end() ? 0 : b->second);
+}
+
+
+bool HeapDriver::Test11()
+{
+    cout << "\n  Test 11: Metrics\n";
+    Status status = OK;
+    RecordID rid;
+
+    cout << "  - Check histogram percentiles\n";
+    Histogram h;
+    for (long v = 1; v <= 1000; v++)
+        h.Record(v);
+    HistogramSnapshot hs;
+    h.Snapshot(hs);
+    long p50 = hs.GetPercentile(0.5);
+    if (hs.count != 1000 || hs.sum != 500500 || p50 < 500 || p50 > 500 * 9 / 8
+        || hs.GetMax() < 1000 || hs.GetMax() > 1000 * 9 / 8)
+    {
+        cerr << "*** Histogram of 1 to 1000 has count " << hs.count << ", sum "
+             << hs.sum << ", median " << p50 << ", max " << hs.GetMax() << endl;
+        status = FAIL;
+    }
+
+    MetricsSnapshot before, after;
+    long pinsBefore, missesBefore, pins, misses;
+    minibase_metrics.Snapshot(before);
+    MINIBASE_BM->GetStat(pinsBefore, missesBefore);
+
+    cout << "  - Insert and scan records, then write a page out and read it back\n";
+    HeapFile f("file_11", status);
+    if (status != OK)
+        cerr << "*** Could not create heap file\n";
+
+    for (int i = 0; i < choice && status == OK; i++)
+    {
+        Rec rec = { i, i*2.5 };
+        sprintf(rec.name, "record %i", i);
+        status = f.InsertRecord((char *)&rec, reclen, rid);
+        if (status != OK)
+            cerr << "*** Error inserting record " << i << endl;
+    }
+
+    if (status == OK)
+    {
+        vector<PageID> pages;
+        status = ScanPages(f, pages);
+    }
+
+    if (status == OK)
+        status = MINIBASE_BM->FlushPage(rid.pageNo);
+    if (status == OK)
+    {
+        Page *page;
+        status = MINIBASE_BM->PinPage(rid.pageNo, page);
+        if (status == OK)
+            status = MINIBASE_BM->UnpinPage(rid.pageNo, CLEAN);
+    }
+
+    minibase_metrics.Snapshot(after);
+    MINIBASE_BM->GetStat(pins, misses);
+
+    if (status == OK)
+    {
+        long inserted = Grew(before, after, "heapfile.file_11.insert");
+        long scanned = Grew(before, after, "heapfile.file_11.scan.records");
+        long hits = Grew(before, after, "bufmgr.pin.hit");
+        long missed = Grew(before, after, "bufmgr.pin.miss");
+        long read = Grew(before, after, "db.read.bytes");
+        long written = Grew(before, after, "db.write.bytes");
+
+        cout << "  - " << inserted << " inserts, " << scanned << " records scanned, "
+             << hits << " pin hits, " << missed << " misses, "
+             << read << " bytes read, " << written << " written\n";
+
+        if (inserted != choice || scanned != choice)
+        {
+            cerr << "*** Expected " << choice << " inserts and records scanned\n";
+            status = FAIL;
+        }
+        if (hits + missed != pins - pinsBefore || missed != misses - missesBefore)
+        {
+            cerr << "*** Pin metrics disagree with BufMgr::GetStat\n";
+            status = FAIL;
+        }
+        if (read < MINIBASE_PAGESIZE || written < MINIBASE_PAGESIZE
+            || after.histograms["db.read.ns"].count * MINIBASE_PAGESIZE
+               != after.counters["db.read.bytes"])
+        {
+            cerr << "*** Page reads and writes were not counted\n";
+            status = FAIL;
+        }
+    }
+
+    if (status == OK)
+    {
+        ostringstream json;
+        after.WriteJson(json);
+        if (json.str().find("\"bufmgr.evict.scan\": {\"count\"") == string::npos)
+        {
+            cerr << "*** The JSON dump lacks the eviction histogram\n";
+            status = FAIL;
+        }
+    }
+
+    if (status == OK)
+        status = f.DeleteFile();
+
+    if (status == OK)
+        cout << "  Test 11 completed successfully.\n";
+    return (status == OK);
+}
+
+
+bool HeapDriver::Test12()
+{
+    cout << "\n  Test 12: Buffer pool residency of a heap file\n";
+    Status status = OK;
+    RecordID rid, hotRid;
+
+    cout << "  - Create a heap file and read one record of it many times\n";
+    HeapFile f("file_12", status);
+    if (status != OK)
+        cerr << "*** Could not create heap file\n";
+
+    for (int i = 0; i < choice && status == OK; i++)
+    {
+        Rec rec = { i, i*2.5 };
+        sprintf(rec.name, "record %i", i);
+        status = f.InsertRecord((char *)&rec, reclen, rid);
+        if (i == choice / 2)
+            hotRid = rid;
+    }
+
+    vector<PageID> pages;
+    if (status == OK)
+        status = ScanPages(f, pages);
+
+    MINIBASE_BM->ResetStat();
+    const int numOfReads = 50;
+    for (int i = 0; i < numOfReads && status == OK; i++)
+    {
+        Rec rec;
+        int len;
+        status = f.GetRecord(hotRid, (char *)&rec, len);
+    }
+
+    FileResidency residency;
+    if (status == OK)
+        status = MINIBASE_BM->GetFileResidency("file_12", residency, 3);
+
+    if (status == OK)
+    {
+        MINIBASE_BM->PrintFileStat("file_12");
+
+        // Each read pins the data page of the record; all pages of the
+        // file stay in the pool, so every pin is a hit.
+        if (residency.numOfPages <= (int)pages.size()
+            || residency.numOfFrames != residency.numOfPages)
+        {
+            cerr << "*** Expected more than " << pages.size()
+                 << " pages, all resident\n";
+            status = FAIL;
+        }
+        else if (residency.pins != numOfReads || residency.hits != residency.pins)
+        {
+            cerr << "*** Expected " << numOfReads << " pins, all hits\n";
+            status = FAIL;
+        }
+        else if (residency.hottest.size() != 3
+                 || residency.hottest[0].pins != numOfReads
+                 || residency.hottest[0].pid != hotRid.pageNo
+                 || residency.hottest[1].pins != 0)
+        {
+            cerr << "*** Page " << hotRid.pageNo << " is not the hottest\n";
+            status = FAIL;
+        }
+    }
+
+    // Writing back the page once it is changed counts as a dirty write;
+    // flushing a clean page does not.
+    if (status == OK)
+    {
+        MINIBASE_BM->ResetStat();
+        Page *page;
+        status = MINIBASE_BM->PinPage(hotRid.pageNo, page);
+        if (status == OK)
+            status = MINIBASE_BM->UnpinPage(hotRid.pageNo, true);
+        if (status == OK)
+            status = MINIBASE_BM->FlushPage(hotRid.pageNo);
+        if (status == OK)
+            status = MINIBASE_BM->PinPage(hotRid.pageNo, page);
+        if (status == OK)
+            status = MINIBASE_BM->UnpinPage(hotRid.pageNo, false);
+        if (status == OK)
+            status = MINIBASE_BM->FlushPage(hotRid.pageNo);
+        if (status == OK && MINIBASE_BM->GetNumOfDirtyPageWrites() != 1)
+        {
+            cerr << "*** Expected 1 dirty page write, got "
+                 << MINIBASE_BM->GetNumOfDirtyPageWrites() << endl;
+            status = FAIL;
+        }
+    }
+
+    if (status == OK && MINIBASE_BM->GetFileResidency("no_such_file", residency) != FAIL)
+    {
+        cerr << "*** Got a report for a file that does not exist\n";
+        status = FAIL;
+    }
+
+    if (status == OK)
+        status = f.DeleteFile();
+
+    if (status == OK)
+        cout << "  Test 12 completed successfully.\n";
+    return (status == OK);
+}
+
+
+// Checks that the index maps key to rid alone, or to nothing if rid is
+// INVALID_PAGE.
+static Status CheckLookup(HashIndex& index, int key, const RecordID& rid)
+{
+    vector<RecordID> rids;
+    if (index.Lookup((char *)&key, rids) != OK)
+        return FAIL;
+
+    if ((rid.pageNo == INVALID_PAGE && !rids.empty())
+        || (rid.pageNo != INVALID_PAGE && (rids.size() != 1 || rids[0] != rid)))
+    {
+        cerr << "*** Key " << key << " maps to " << rids.size() << " records";
+        if (!rids.empty())
+            cerr << ", the first " << rids[0];
+        cerr << endl;
+        return FAIL;
+    }
+    return OK;
+}
+
+
+bool HeapDriver::Test13()
+{
+    cout << "\n  Test 13: Hash index\n";
+    Status status = OK;
+    vector<RecordID> rids(2 * choice);
+    RecordID none = { INVALID_PAGE, INVALID_SLOT };
+
+    cout << "  - Build an index on ival of a heap file\n";
+    HeapFile f("file_13", status);
+    if (status != OK)
+        cerr << "*** Could not create heap file\n";
+
+    for (int i = 0; i < choice && status == OK; i++)
+    {
+        Rec rec = { i, i*2.5 };
+        sprintf(rec.name, "record %i", i);
+        status = f.InsertRecord((char *)&rec, reclen, rids[i]);
+    }
+
+    HashIndex *index = NULL;
+    if (status == OK)
+        index = new HashIndex("file_13.ival", offsetof(Rec, ival), attrInteger,
+                              sizeof(int), status);
+    if (status == OK)
+        status = index->Build(f);
+    if (status == OK)
+        f.AttachIndex(index);
+
+    cout << "  - Insert, delete and update records through the heap file\n";
+    for (int i = choice; i < 2 * choice && status == OK; i++)
+    {
+        Rec rec = { i, i*2.5 };
+        sprintf(rec.name, "record %i", i);
+        status = f.InsertRecord((char *)&rec, reclen, rids[i]);
+    }
+    for (int i = 0; i < 2 * choice && status == OK; i += 3)
+    {
+        status = f.DeleteRecord(rids[i]);
+        rids[i] = none;
+    }
+    for (int i = 1; i < 2 * choice && status == OK; i += 3)
+    {
+        Rec rec = { i + 10 * choice, i*2.5 };
+        sprintf(rec.name, "record %i", i);
+        status = f.UpdateRecord(rids[i], (char *)&rec, reclen);
+    }
+    if (status != OK)
+        cerr << "*** Error changing the heap file\n";
+
+    for (int i = 0; i < 2 * choice && status == OK; i++)
+    {
+        if (i % 3 == 1)
+        {
+            status = CheckLookup(*index, i, none);
+            if (status == OK)
+                status = CheckLookup(*index, i + 10 * choice, rids[i]);
+        }
+        else
+            status = CheckLookup(*index, i, rids[i]);
+    }
+    if (status == OK && index->GetNumOfEntries() != f.GetNumOfRecords())
+    {
+        cerr << "*** The index has " << index->GetNumOfEntries() << " entries\n";
+        status = FAIL;
+    }
+
+    if (status == OK)
+    {
+        long pinsBefore, missesBefore, pins, misses;
+        vector<RecordID> found;
+        int key = 2;
+
+        MINIBASE_BM->GetStat(pinsBefore, missesBefore);
+        status = index->Lookup((char *)&key, found);
+        MINIBASE_BM->GetStat(pins, misses);
+        cout << "  - A lookup pinned " << pins - pinsBefore << " page(s)\n";
+        if (status == OK && pins - pinsBefore != 1)
+        {
+            cerr << "*** Expected a lookup to read one bucket page\n";
+            status = FAIL;
+        }
+    }
+
+    f.DetachIndex(index);
+    if (status == OK)
+        status = f.DeleteFile();
+
+    // The entries of the deleted file stay; the keys added now are new.
+
+    cout << "  - Grow the index with duplicate keys, then reopen it\n";
+    const int numOfEntries = 1200, numOfKeys = 400, firstKey = 100 * choice;
+    int numOfOld = (index == NULL) ? 0 : index->GetNumOfEntries();
+    for (int i = 0; i < numOfEntries && status == OK; i++)
+    {
+        int key = firstKey + i % numOfKeys;
+        RecordID rid = { i, i };
+        status = index->Insert((char *)&key, rid);
+    }
+    if (status == OK && index->GetNumOfBuckets() <= HASH_INDEX_BUCKETS)
+    {
+        cerr << "*** The index did not split its buckets\n";
+        status = FAIL;
+    }
+    if (status == OK)
+        cout << "  - " << index->GetNumOfEntries() << " entries in "
+             << index->GetNumOfBuckets() << " buckets\n";
+
+    delete index;
+    index = NULL;
+    if (status == OK)
+        index = new HashIndex("file_13.ival", offsetof(Rec, ival), attrInteger,
+                              sizeof(int), status);
+
+    for (int key = firstKey; key < firstKey + numOfKeys && status == OK; key++)
+    {
+        vector<RecordID> found;
+        status = index->Lookup((char *)&key, found);
+        if (status == OK && found.size() != (size_t)numOfEntries / numOfKeys)
+        {
+            cerr << "*** Key " << key << " maps to " << found.size() << " records\n";
+            status = FAIL;
+        }
+    }
+
+    for (int i = 0; i < numOfEntries && status == OK; i++)
+    {
+        int key = firstKey + i % numOfKeys;
+        RecordID rid = { i, i };
+        status = index->Delete((char *)&key, rid);
+    }
+    if (status == OK && index->GetNumOfEntries() != numOfOld)
+    {
+        cerr << "*** Expected " << numOfOld << " entries after deleting the new ones\n";
+        status = FAIL;
+    }
+
+    if (status == OK)
+    {
+        HashIndex other("file_13.ival", offsetof(Rec, name), attrString,
+                        namelen, status);
+        if (status != FAIL)
+        {
+            cerr << "*** Opened the index with a different key\n";
+            status = FAIL;
+        }
+        else
+            status = OK;
+    }
+
+    if (status == OK)
+        status = index->DeleteFile();
+    delete index;
+
+    if (status == OK)
+        cout << "  Test 13 completed successfully.\n";
+    return (status == OK);
+}
+
+
+// Scans the tree with op and the bounds, checking that the keys come in
+// order and that there are as many as the keys of keys that satisfy op.
+static Status CheckRange(BTreeIndex& tree, AttrOperator op, int key, int key2,
+                         const vector<int>& keys)
+{
+    Status status;
+    BTreeScan *scan = tree.OpenScan(op, (char *)&key, (char *)&key2, status);
+    if (status != OK)
+        return status;
+
+    size_t expected = 0;
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        int k = keys[i];
+        if ((op == aopEQ && k == key) || (op == aopLT && k < key)
+            || (op == aopLE && k <= key) || (op == aopGT && k > key)
+            || (op == aopGE && k >= key) || (op == opRANGE && k >= key && k <= key2)
+            || op == aopNOP)
+            expected++;
+    }
+
+    RecordID rid;
+    int k, last = 0;
+    size_t found = 0;
+    while ((status = scan->GetNext(rid, (char *)&k)) == OK)
+    {
+        if (found > 0 && k < last)
+        {
+            cerr << "*** Key " << k << " came after " << last << endl;
+            status = FAIL;
+            break;
+        }
+        last = k;
+        found++;
+    }
+    delete scan;
+
+    if (status == DONE && found != expected)
+    {
+        cerr << "*** Operator " << op << " on " << key << " found " << found
+             << " entries instead of " << expected << endl;
+        status = FAIL;
+    }
+    return (status == DONE) ? OK : status;
+}
+
+
+bool HeapDriver::Test14()
+{
+    cout << "\n  Test 14: B+-tree index\n";
+    Status status = OK;
+    vector<RecordID> rids(2 * choice);
+    vector<int> keys;
+
+    // Keys are a permutation of 0 to 2 * choice - 1, five times each.
+
+    cout << "  - Build a B+-tree on ival of a heap file in bulk\n";
+    HeapFile f("file_14", status);
+    if (status != OK)
+        cerr << "*** Could not create heap file\n";
+
+    BTreeIndex *tree = NULL;
+    for (int i = 0; i < 2 * choice && status == OK; i++)
+    {
+        if (i == choice)
+        {
+            tree = new BTreeIndex("file_14.ival", offsetof(Rec, ival),
+                                  attrInteger, sizeof(int), status);
+            if (status == OK)
+                status = tree->Build(f);
+            if (status != OK)
+                break;
+
+            cout << "  - " << tree->GetNumOfEntries() << " entries, height "
+                 << tree->GetHeight() << "\n";
+            f.AttachIndex(tree);
+            cout << "  - Insert more records through the heap file\n";
+        }
+
+        int key = (i * 37) % (2 * choice / 5);
+        Rec rec = { key, i * 0.5 };
+        sprintf(rec.name, "record %i", i);
+        status = f.InsertRecord((char *)&rec, reclen, rids[i]);
+        keys.push_back(key);
+    }
+
+    if (tree != NULL)
+        cout << "  - " << tree->GetNumOfEntries() << " entries, height "
+             << tree->GetHeight() << "\n";
+
+    cout << "  - Reopen the tree\n";
+    f.DetachIndex(tree);
+    delete tree;
+    tree = NULL;
+    if (status == OK)
+        tree = new BTreeIndex("file_14.ival", offsetof(Rec, ival), attrInteger,
+                              sizeof(int), status);
+    if (status == OK && tree->GetNumOfEntries() != 2 * choice)
+    {
+        cerr << "*** The tree has " << tree->GetNumOfEntries() << " entries\n";
+        status = FAIL;
+    }
+    if (status != OK)
+        cerr << "*** Error building the tree\n";
+    else
+        f.AttachIndex(tree);
+
+    cout << "  - Check range scans\n";
+    int top = 2 * choice / 5;
+    AttrOperator ops[] = { aopEQ, aopLT, aopLE, aopGT, aopGE, opRANGE, aopNOP };
+    for (int o = 0; o < 7 && status == OK; o++)
+    {
+        for (int key = -1; key <= top && status == OK; key += 7)
+            status = CheckRange(*tree, ops[o], key, key + 9, keys);
+    }
+
+    cout << "  - Fetch the records of a range in page order\n";
+    if (status == OK)
+    {
+        int low = top / 4, high = top / 2;
+        BTreeScan *scan = tree->OpenScan(opRANGE, (char *)&low, (char *)&high, status);
+        IndexScan *records = NULL;
+        if (status == OK)
+            records = new IndexScan(scan, status);
+
+        RecordID rid, last = { INVALID_PAGE, INVALID_SLOT };
+        Rec rec;
+        int len, found = 0;
+        while (status == OK && (status = records->GetNext(rid, (char *)&rec, len)) == OK)
+        {
+            if (rid < last || rec.ival < low || rec.ival > high)
+            {
+                cerr << "*** Record " << rid << " with key " << rec.ival
+                     << " is out of order or range\n";
+                status = FAIL;
+            }
+            last = rid;
+            found++;
+        }
+        delete records;
+
+        if (status == DONE)
+            status = (found == (high - low + 1) * 5) ? OK : FAIL;
+        if (status != OK)
+            cerr << "*** Fetched " << found << " records\n";
+    }
+
+    cout << "  - Delete and update records, then look keys up\n";
+    for (int i = 0; i < 2 * choice && status == OK; i += 2)
+    {
+        status = f.DeleteRecord(rids[i]);
+        keys[i] = -1000;
+    }
+    for (int i = 1; i < 2 * choice && status == OK; i += 4)
+    {
+        Rec rec = { keys[i] + top, i * 0.5 };
+        sprintf(rec.name, "record %i", i);
+        status = f.UpdateRecord(rids[i], (char *)&rec, reclen);
+        keys[i] += top;
+    }
+    for (int key = 0; key < 2 * top && status == OK; key++)
+    {
+        vector<RecordID> found;
+        size_t expected = 0;
+        status = tree->Lookup((char *)&key, found);
+        for (size_t i = 0; i < keys.size(); i++)
+            if (keys[i] == key)
+                expected++;
+        if (status == OK && found.size() != expected)
+        {
+            cerr << "*** Key " << key << " maps to " << found.size()
+                 << " records instead of " << expected << endl;
+            status = FAIL;
+        }
+    }
+
+    cout << "  - Look up a double key\n";
+    if (status == OK)
+    {
+        BTreeIndex reals("file_14.fval", offsetof(Rec, fval), attrReal,
+                         sizeof(double), status);
+        if (status == OK)
+            status = reals.Build(f);
+
+        double key = 3 * 0.5;
+        vector<RecordID> found;
+        if (status == OK)
+            status = reals.Lookup((char *)&key, found);
+        if (status == OK && (found.size() != 1 || found[0] != rids[3]))
+        {
+            cerr << "*** Key " << key << " maps to " << found.size() << " records\n";
+            status = FAIL;
+        }
+        if (status == OK)
+            status = reals.DeleteFile();
+    }
+
+    f.DetachIndex(tree);
+    if (status == OK)
+        status = f.DeleteFile();
+    if (status == OK)
+        status = tree->DeleteFile();
+    delete tree;
+
+    if (status == OK)
+        cout << "  Test 14 completed successfully.\n";
+    return (status == OK);
+}
+
+
+static Status CheckSorted(HeapFile& f, int keyOffset, bool descending, int expected)
+{
+    Status status;
+    Scan *scan = f.OpenScan(status);
+    if (status != OK)
+        return status;
+
+    Rec rec, last;
+    RecordID rid;
+    int len, found = 0;
+    while ((status = scan->GetNext(rid, (char *)&rec, len)) == OK)
+    {
+        if (found > 0)
+        {
+            int c = (keyOffset == (int)offsetof(Rec, ival))
+                    ? (rec.ival > last.ival) - (rec.ival < last.ival)
+                    : strncmp(rec.name, last.name, sizeof(rec.name));
+            if (descending)
+                c = -c;
+            // Equal keys keep the order they were inserted in.
+            if (c < 0 || (c == 0 && rec.fval < last.fval))
+            {
+                cerr << "*** Record " << rec.name << " is out of order\n";
+                status = FAIL;
+                break;
+            }
+        }
+        last = rec;
+        found++;
+    }
+    delete scan;
+
+    if (status == DONE && found != expected)
+    {
+        cerr << "*** Sorted " << found << " records instead of " << expected << endl;
+        status = FAIL;
+    }
+    return (status == DONE) ? OK : status;
+}
+
+
+bool HeapDriver::Test15()
+{
+    cout << "\n  Test 15: External merge sort\n";
+    Status status = OK;
+    int numOfRecs = choice + choice / 10;
+    unsigned int unpinned = MINIBASE_BM->GetNumOfUnpinnedFrames();
+
+    // The file is closed once loaded so that it gives back the rest of its
+    // extent; the runs have to fit in what the output file leaves free.
+    {
+        HeapFile f("file_15", status);
+        if (status != OK)
+            cerr << "*** Could not create heap file\n";
+
+        for (int i = 0; i < numOfRecs && status == OK; i++)
+        {
+            RecordID rid;
+            Rec rec = { (i * 53) % 17, (double)i };
+            sprintf(rec.name, "record %05i", (i * 7919) % numOfRecs);
+            status = f.InsertRecord((char *)&rec, reclen, rid);
+        }
+    }
+
+    HeapFile f("file_15", status);
+
+    cout << "  - Sort on ival in 3 frames into a temporary file\n";
+    if (status == OK)
+    {
+        HeapFile out(NULL, status);
+        ExternalSort sort(offsetof(Rec, ival), attrInteger, sizeof(int), Ascending, 3);
+        if (status == OK)
+            status = sort.Run(f, out);
+        if (status == OK)
+        {
+            cout << "  - " << sort.GetNumOfRuns() << " runs, "
+                 << sort.GetNumOfPasses() << " passes\n";
+            if (sort.GetNumOfRuns() < 3 || sort.GetNumOfPasses() < 3)
+            {
+                cerr << "*** Expected several runs merged in several passes\n";
+                status = FAIL;
+            }
+        }
+        if (status == OK)
+            status = CheckSorted(out, offsetof(Rec, ival), false, numOfRecs);
+    }
+
+    cout << "  - Sort on name, descending, in 4 frames\n";
+    if (status == OK)
+    {
+        HeapFile out("file_15.sorted", status);
+        ExternalSort sort(offsetof(Rec, name), attrString, sizeof(((Rec *)0)->name),
+                          Descending, 4);
+        if (status == OK)
+            status = sort.Run(f, out);
+        if (status == OK && sort.GetNumOfPasses() != 2)
+        {
+            cerr << "*** Expected one merge pass, not " << sort.GetNumOfPasses() - 1 << endl;
+            status = FAIL;
+        }
+        if (status == OK)
+            status = CheckSorted(out, offsetof(Rec, name), true, numOfRecs);
+        if (status == OK)
+            status = out.DeleteFile();
+    }
+
+    cout << "  - Sort a file that fits in memory\n";
+    if (status == OK)
+    {
+        HeapFile out(NULL, status);
+        ExternalSort sort(offsetof(Rec, ival), attrInteger, sizeof(int), Descending, 50);
+        if (status == OK)
+            status = sort.Run(f, out);
+        if (status == OK && sort.GetNumOfRuns() != 0)
+        {
+            cerr << "*** Wrote " << sort.GetNumOfRuns() << " runs\n";
+            status = FAIL;
+        }
+        if (status == OK)
+            status = CheckSorted(out, offsetof(Rec, ival), true, numOfRecs);
+    }
+
+    if (status == OK && MINIBASE_BM->GetNumOfUnpinnedFrames() != unpinned)
+    {
+        cerr << "*** The sort did not give back its frames\n";
+        status = FAIL;
+    }
+
+    if (status == OK)
+        status = f.DeleteFile();
+
+    if (status == OK)
+        cout << "  Test 15 completed successfully.\n";
+    return (status == OK);
+}
+
+
+bool HeapDriver::Test16()
+{
+    cout << "\n  Test 16: Hash join and sort-merge join\n";
+    Status status = OK;
+
+    // The left file has keys 0 to 19 three times each, the right one keys
+    // 5 to 44 twice each, both in order: 15 keys match, in 6 pairs each.
+    // fval rises in the right file and falls in the left one.
+    int numOfLeft = 60, numOfRight = 80, numOfPairs = 15 * 3 * 2;
+
+    // The files are closed once loaded so that they give back the rest of
+    // their extents, which the partitions need.
+    {
+        HeapFile left("file_16.left", status);
+        for (int i = 0; i < numOfLeft && status == OK; i++)
+        {
+            RecordID rid;
+            Rec rec = { i / 3, (double)(numOfLeft - i) };
+            sprintf(rec.name, "left %i", i);
+            status = left.InsertRecord((char *)&rec, reclen, rid);
+        }
+    }
+    if (status == OK)
+    {
+        HeapFile right("file_16.right", status);
+        for (int i = 0; i < numOfRight && status == OK; i++)
+        {
+            RecordID rid;
+            Rec rec = { i / 2 + 5, (double)i };
+            sprintf(rec.name, "right %i", i);
+            status = right.InsertRecord((char *)&rec, reclen, rid);
+        }
+    }
+    if (status != OK)
+        cerr << "*** Could not create the heap files\n";
+
+    HeapFile left("file_16.left", status);
+    HeapFile right("file_16.right", status);
+
+    JoinKey key = { offsetof(Rec, ival), attrInteger, sizeof(int) };
+    int found = 0;
+    JoinCallback count = [&found](const char* leftRec, int leftLen,
+                                  const char* rightRec, int rightLen) -> Status
+    {
+        found++;
+        if (((Rec *)leftRec)->ival == ((Rec *)rightRec)->ival)
+            return OK;
+        cerr << "*** Joined " << ((Rec *)leftRec)->name << " with "
+             << ((Rec *)rightRec)->name << endl;
+        return FAIL;
+    };
+
+    cout << "  - Hash join with the build input in memory\n";
+    if (status == OK)
+    {
+        HashJoin join(key, key, 20);
+        status = join.Run(left, right, count);
+        if (status == OK && (found != numOfPairs || join.GetDepth() != 0))
+        {
+            cerr << "*** Found " << found << " pairs at depth " << join.GetDepth() << endl;
+            status = FAIL;
+        }
+    }
+
+    cout << "  - Grace hash join in 4 frames into a temporary file\n";
+    if (status == OK)
+    {
+        HeapFile result(NULL, status);
+        HashJoin join(key, key, 4);
+        if (status == OK)
+            status = join.Run(left, right, result);
+        if (status == OK)
+        {
+            cout << "  - " << join.GetNumOfPartitions() << " partitions, depth "
+                 << join.GetDepth() << "\n";
+            if (join.GetDepth() < 1)
+            {
+                cerr << "*** The build input was not partitioned\n";
+                status = FAIL;
+            }
+        }
+
+        Scan *scan = (status == OK) ? result.OpenScan(status) : NULL;
+        Rec pair[2];
+        RecordID rid;
+        int len;
+        found = 0;
+        while (status == OK && (status = scan->GetNext(rid, (char *)pair, len)) == OK)
+        {
+            found++;
+            if (len != 2 * reclen || pair[0].ival != pair[1].ival)
+            {
+                cerr << "*** Bad joined record " << rid << endl;
+                status = FAIL;
+            }
+        }
+        delete scan;
+        if (status == DONE)
+            status = (found == numOfPairs) ? OK : FAIL;
+        if (status != OK)
+            cerr << "*** Found " << found << " pairs\n";
+    }
+
+    cout << "  - Sort-merge join\n";
+    if (status == OK)
+    {
+        SortMergeJoin join(key, key);
+        found = 0;
+        status = join.Run(left, right, count);
+        if (status == OK && found != numOfPairs)
+        {
+            cerr << "*** Found " << found << " pairs\n";
+            status = FAIL;
+        }
+    }
+
+    cout << "  - Sort-merge join on fval, which the left file is not sorted on\n";
+    if (status == OK)
+    {
+        JoinKey fval = { offsetof(Rec, fval), attrReal, sizeof(double) };
+        SortMergeJoin join(fval, fval);
+        JoinCallback ignore = [](const char*, int, const char*, int) { return OK; };
+        if (join.Run(left, right, ignore) != FAIL)
+        {
+            cerr << "*** The unsorted input was not noticed\n";
+            status = FAIL;
+        }
+    }
+
+    if (status == OK)
+        status = left.DeleteFile();
+    if (status == OK)
+        status = right.DeleteFile();
+
+    if (status == OK)
+        cout << "  Test 16 completed successfully.\n";
+    return (status == OK);
+}
+
+
+// Computes the aggregates row at a time through GetNext, for Test17 to
+// check Aggregate against.
+static Status NaiveAggregate(HeapFile& f, int groupOffset, int groupLength,
+                             const vector<AggSpec>& aggs,
+                             map<string, vector<double> >& groups)
+{
+    Status status;
+    Scan *scan = f.OpenScan(status);
+    if (status != OK)
+        return status;
+
+    map<string, vector<double> > sums, counts;
+    Rec rec;
+    RecordID rid;
+    int len;
+    while ((status = scan->GetNext(rid, (char *)&rec, len)) == OK)
+    {
+        string key((char *)&rec + groupOffset, groupLength);
+        vector<double>& sum = sums[key];
+        vector<double>& count = counts[key];
+        vector<double>& value = groups[key];
+        if (value.empty())
+        {
+            sum.assign(aggs.size(), 0);
+            count.assign(aggs.size(), 0);
+            value.assign(aggs.size(), 0);
+        }
+
+        for (size_t a = 0; a < aggs.size(); a++)
+        {
+            double v = (aggs[a].type == attrInteger)
+                       ? *(int *)((char *)&rec + aggs[a].offset)
+                       : *(double *)((char *)&rec + aggs[a].offset);
+            if (count[a] == 0 || (aggs[a].func == aggMin && v < value[a])
+                || (aggs[a].func == aggMax && v > value[a]))
+                value[a] = v;
+            sum[a] += v;
+            count[a]++;
+
+            if (aggs[a].func == aggCount)
+                value[a] = count[a];
+            else if (aggs[a].func == aggSum)
+                value[a] = sum[a];
+            else if (aggs[a].func == aggAvg)
+                value[a] = sum[a] / count[a];
+        }
+    }
+    delete scan;
+    return (status == DONE) ? OK : status;
+}
+
+
+static bool SameGroups(map<string, vector<double> >& expected,
+                       map<string, vector<double> >& found)
+{
+    if (expected.size() != found.size())
+    {
+        cerr << "*** Found " << found.size() << " groups instead of "
+             << expected.size() << endl;
+        return false;
+    }
+
+    for (map<string, vector<double> >::iterator g = expected.begin();
+         g != expected.end(); ++g)
+    {
+        vector<double>& values = found[g->first];
+        for (size_t a = 0; a < g->second.size(); a++)
+        {
+            double e = g->second[a];
+            if (values.size() != g->second.size()
+                || fabs(values[a] - e) > 1e-9 * (1 + fabs(e)))
+            {
+                cerr << "*** Aggregate " << a << " of a group is wrong\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+bool HeapDriver::Test17()
+{
+    cout << "\n  Test 17: Aggregation\n";
+    Status status = OK;
+    int numOfRecs = 3 * choice;
+
+    {
+        HeapFile f("file_17", status);
+        for (int i = 0; i < numOfRecs && status == OK; i++)
+        {
+            RecordID rid;
+            Rec rec = { (i * 7) % 41, (i % 13) * 1.25 - 3 };
+            sprintf(rec.name, "group %i", i % 11);
+            status = f.InsertRecord((char *)&rec, reclen, rid);
+        }
+        if (status != OK)
+            cerr << "*** Could not create heap file\n";
+    }
+    HeapFile f("file_17", status);
+
+    AggSpec count = { aggCount, 0, attrInteger, 0 };
+    AggSpec sumInt = { aggSum, offsetof(Rec, ival), attrInteger, sizeof(int) };
+    AggSpec minReal = { aggMin, offsetof(Rec, fval), attrReal, sizeof(double) };
+    AggSpec maxReal = { aggMax, offsetof(Rec, fval), attrReal, sizeof(double) };
+    AggSpec avgReal = { aggAvg, offsetof(Rec, fval), attrReal, sizeof(double) };
+    AggSpec minInt = { aggMin, offsetof(Rec, ival), attrInteger, sizeof(int) };
+    vector<AggSpec> aggs;
+    aggs.push_back(count);
+    aggs.push_back(sumInt);
+    aggs.push_back(minReal);
+    aggs.push_back(maxReal);
+    aggs.push_back(avgReal);
+    aggs.push_back(minInt);
+
+    struct Case
+    {
+        const char *what;
+        int        groupOffset;
+        AttrType   groupType;
+        int        groupLength;
+        int        numOfFrames;
+    } cases[] = {
+        { "without grouping", 0, attrInteger, 0, 20 },
+        { "grouped by ival", offsetof(Rec, ival), attrInteger, sizeof(int), 20 },
+        { "grouped by ival in 3 frames", offsetof(Rec, ival), attrInteger, sizeof(int), 3 },
+        { "grouped by name in 4 frames", offsetof(Rec, name), attrString, sizeof(((Rec *)0)->name), 4 },
+    };
+
+    for (int c = 0; c < 4 && status == OK; c++)
+    {
+        cout << "  - Aggregate " << cases[c].what << "\n";
+
+        map<string, vector<double> > expected, found;
+        status = NaiveAggregate(f, cases[c].groupOffset, cases[c].groupLength, aggs, expected);
+
+        int groupLength = cases[c].groupLength;
+        Aggregate agg(cases[c].groupOffset, cases[c].groupType, groupLength,
+                      aggs, cases[c].numOfFrames);
+        if (status == OK)
+            status = agg.Run(f, [&](const char* key, const double* values) -> Status
+            {
+                string k = key ? string(key, groupLength) : string();
+                if (found.count(k))
+                {
+                    cerr << "*** A group was given out twice\n";
+                    return FAIL;
+                }
+                found[k].assign(values, values + aggs.size());
+                return OK;
+            });
+        if (status == OK && agg.GetNumOfSpilled() > 0)
+            cout << "  - " << agg.GetNumOfSpilled() << " records spilled, depth "
+                 << agg.GetDepth() << "\n";
+        if (status == OK && (c == 2) != (agg.GetNumOfSpilled() > 0))
+        {
+            cerr << "*** Spilled " << agg.GetNumOfSpilled() << " records\n";
+            status = FAIL;
+        }
+        if (status == OK && !SameGroups(expected, found))
+            status = FAIL;
+    }
+
+    cout << "  - Aggregate into a temporary file\n";
+    if (status == OK)
+    {
+        map<string, vector<double> > expected, found;
+        status = NaiveAggregate(f, offsetof(Rec, ival), sizeof(int), aggs, expected);
+
+        HeapFile result(NULL, status);
+        Aggregate agg(offsetof(Rec, ival), attrInteger, sizeof(int), aggs, 20);
+        if (status == OK)
+            status = agg.Run(f, result);
+
+        Scan *scan = (status == OK) ? result.OpenScan(status) : NULL;
+        char buf[sizeof(int) + 6 * sizeof(double)];
+        RecordID rid;
+        int len;
+        while (status == OK && (status = scan->GetNext(rid, buf, len)) == OK)
+        {
+            double *values = (double *)(buf + sizeof(int));
+            found[string(buf, sizeof(int))].assign(values, values + aggs.size());
+            if (len != (int)sizeof(buf))
+                status = FAIL;
+        }
+        delete scan;
+        if (status == DONE)
+            status = SameGroups(expected, found) ? OK : FAIL;
+        else
+            cerr << "*** Could not read back the result\n";
+    }
+
+    cout << "  - Aggregate an empty file\n";
+    if (status == OK)
+    {
+        HeapFile empty(NULL, status);
+        Aggregate agg(0, attrInteger, 0, aggs, 3);
+        int groups = 0;
+        if (status == OK)
+            status = agg.Run(empty, [&](const char*, const double* values) -> Status
+            {
+                groups++;
+                return (values[0] == 0 && values[1] == 0 && values[2] != values[2])
+                       ? OK : FAIL;
+            });
+        if (status == OK && groups != 1)
+            status = FAIL;
+        if (status != OK)
+            cerr << "*** Wrong aggregates of no records\n";
+    }
+
+    if (status == OK)
+        status = f.DeleteFile();
+
+    if (status == OK)
+        cout << "  Test 17 completed successfully.\n";
+    return (status == OK);
+}
+
+
+bool HeapDriver::Test18()
+{
+    cout << "\n  Test 18: Query operators\n";
+    Status status = OK;
+    unsigned int unpinned = MINIBASE_BM->GetNumOfUnpinnedFrames();
+
+    // The left file has ival 0 to 99 in order and fval cycling through
+    // 0 to 49.5; the right one ival 0, 3, ..., 87.
+    int numOfLeft = choice, numOfRight = 30;
+    {
+        HeapFile left("file_18.left", status);
+        for (int i = 0; i < numOfLeft && status == OK; i++)
+        {
+            RecordID rid;
+            Rec rec = { i, ((i * 37) % 100) * 0.5 };
+            sprintf(rec.name, "left %i", i);
+            status = left.InsertRecord((char *)&rec, reclen, rid);
+        }
+    }
+    if (status == OK)
+    {
+        HeapFile right("file_18.right", status);
+        for (int i = 0; i < numOfRight && status == OK; i++)
+        {
+            RecordID rid;
+            Rec rec = { 3 * i, (double)i };
+            sprintf(rec.name, "right %i", i);
+            status = right.InsertRecord((char *)&rec, reclen, rid);
+        }
+    }
+    if (status != OK)
+        cerr << "*** Could not create the heap files\n";
+
+    HeapFile left("file_18.left", status);
+    HeapFile right("file_18.right", status);
+
+    vector<Column> columns;
+    Column ival = { offsetof(Rec, ival), attrInteger, sizeof(int) };
+    Column fval = { offsetof(Rec, fval), attrReal, sizeof(double) };
+    Column name = { offsetof(Rec, name), attrString, sizeof(((Rec *)0)->name) };
+    columns.push_back(ival);
+    columns.push_back(fval);
+    columns.push_back(name);
+    Batch batch;
+
+    cout << "  - Scan, filter, project and limit\n";
+    if (status == OK)
+    {
+        int from = 10, limit = 25, next = from;
+        ScanOperator scan(left, columns);
+        FilterOperator filter(scan, 0, aopGE, (char *)&from);
+        vector<int> cols;
+        cols.push_back(2);
+        cols.push_back(0);
+        ProjectOperator project(filter, cols);
+        LimitOperator top(project, limit);
+
+        status = top.Open();
+        while (status == OK && (status = top.Next(batch)) == OK)
+        {
+            for (int row = 0; row < batch.GetNumOfRows(); row++, next++)
+            {
+                char expected[sizeof(((Rec *)0)->name)];
+                sprintf(expected, "left %i", next);
+                if (*(int *)batch.GetValue(1, row) != next
+                    || strcmp(batch.GetValue(0, row), expected) != 0)
+                {
+                    cerr << "*** Row " << row << " is wrong\n";
+                    status = FAIL;
+                }
+            }
+        }
+        if (status == DONE)
+            status = top.Close();
+        if (status == OK && (next != from + limit || top.GetNumOfRows() != limit
+                             || batch.GetNumOfColumns() != 2))
+        {
+            cerr << "*** Limit gave " << top.GetNumOfRows() << " rows\n";
+            status = FAIL;
+        }
+    }
+
+    cout << "  - Sort the rows of a filter\n";
+    if (status == OK)
+    {
+        double below = 25;
+        int expected = 0;
+        for (int i = 0; i < numOfLeft; i++)
+            expected += (((i * 37) % 100) * 0.5 < below) ? 1 : 0;
+
+        ScanOperator scan(left, columns);
+        FilterOperator filter(scan, 1, aopLT, (char *)&below);
+        SortOperator sort(filter, 1, Descending, 3);
+
+        double last = below;
+        status = sort.Open();
+        while (status == OK && (status = sort.Next(batch)) == OK)
+        {
+            for (int row = 0; row < batch.GetNumOfRows(); row++)
+            {
+                double value = *(double *)batch.GetValue(1, row);
+                if (value > last)
+                {
+                    cerr << "*** " << value << " is out of order\n";
+                    status = FAIL;
+                }
+                last = value;
+            }
+        }
+        if (status == DONE)
+            status = sort.Close();
+        if (status == OK && (scan.GetNumOfRows() != numOfLeft
+                             || filter.GetNumOfRows() != expected
+                             || sort.GetNumOfRows() != expected))
+        {
+            cerr << "*** Sorted " << sort.GetNumOfRows() << " rows of "
+                 << filter.GetNumOfRows() << " instead of " << expected << endl;
+            status = FAIL;
+        }
+    }
+
+    cout << "  - Join\n";
+    if (status == OK)
+    {
+        // Every right ival but those of 100 and up matches one left row.
+        int expected = 0;
+        for (int i = 0; i < numOfRight; i++)
+            expected += (3 * i < numOfLeft) ? 1 : 0;
+
+        vector<Column> rightColumns;
+        rightColumns.push_back(fval);
+        rightColumns.push_back(ival);
+        ScanOperator leftScan(left, columns);
+        ScanOperator rightScan(right, rightColumns);
+        JoinOperator join(leftScan, rightScan, 0, 1, 20);
+
+        int found = 0;
+        status = join.Open();
+        while (status == OK && (status = join.Next(batch)) == OK)
+        {
+            for (int row = 0; row < batch.GetNumOfRows(); row++, found++)
+            {
+                int key = *(int *)batch.GetValue(0, row);
+                if (key != *(int *)batch.GetValue(4, row)
+                    || *(double *)batch.GetValue(3, row) != key / 3)
+                {
+                    cerr << "*** Joined " << batch.GetValue(2, row) << " wrongly\n";
+                    status = FAIL;
+                }
+            }
+        }
+        if (status == DONE)
+            status = join.Close();
+        if (status == OK && found != expected)
+        {
+            cerr << "*** Found " << found << " rows instead of " << expected << endl;
+            status = FAIL;
+        }
+        if (status == OK)
+            join.Explain(cout, 2);
+    }
+
+    if (status == OK && MINIBASE_BM->GetNumOfUnpinnedFrames() != unpinned)
+    {
+        cerr << "*** The operators have not given back every frame\n";
+        status = FAIL;
+    }
+
+    if (status == OK)
+        status = left.DeleteFile();
+    if (status == OK)
+        status = right.DeleteFile();
+
+    if (status == OK)
+        cout << "  Test 18 completed successfully.\n";
+    return (status == OK);
+}
+
+
+// Reads every record txn sees through a scan of its snapshot, checking each
+// against GetRecord; ivals receives the ival of each by record ID.
+static Status ReadSnapshot(HeapFile& f, TxnID txn, map<RecordID, int>& ivals)
+{
+    const Snapshot *snapshot = MINIBASE_TXN->GetSnapshot(txn);
+    Status status;
+    Scan *scan = f.OpenScan(*snapshot, status);
+    if (status != OK)
+        return status;
+
+    Rec rec, again;
+    RecordID rid;
+    int len;
+    ivals.clear();
+    while ((status = scan->GetNext(rid, (char *)&rec, len)) == OK)
+    {
+        ivals[rid] = rec.ival;
+        if (len != reclen || f.GetRecord(*snapshot, rid, (char *)&again, len) != OK
+            || again.ival != rec.ival)
+        {
+            cerr << "*** GetRecord disagrees with the scan at " << rid << endl;
+            status = FAIL;
+            break;
+        }
+    }
+    delete scan;
+    return (status == DONE) ? OK : FAIL;
+}
+
+
+bool HeapDriver::Test19()
+{
+    cout << "\n  Test 19: Versioned records\n";
+    Status status = OK;
+    int numOfRecs = choice / 2;
+
+    HeapFile f("file_19", status);
+    vector<RecordID> rids(numOfRecs);
+    map<RecordID, int> seen;
+    TxnID loader, reader, writer, other;
+
+    cout << "  - Insert " << numOfRecs << " records and commit\n";
+    if (status == OK)
+        status = MINIBASE_TXN->Begin(loader);
+    for (int i = 0; i < numOfRecs && status == OK; i++)
+    {
+        Rec rec = { i, i * 2.5 };
+        sprintf(rec.name, "record %i", i);
+        status = f.InsertRecord(loader, (char *)&rec, reclen, rids[i]);
+    }
+    if (status == OK)
+        status = MINIBASE_TXN->Commit(loader);
+
+    cout << "  - Update and delete while a reader is scanning\n";
+    Scan *scan = NULL;
+    int numOfScanned = 0, sum = 0;
+    if (status == OK)
+        status = MINIBASE_TXN->Begin(reader);
+    if (status == OK)
+        scan = f.OpenScan(*MINIBASE_TXN->GetSnapshot(reader), status);
+    for (int i = 0; i < numOfRecs / 2 && status == OK; i++, numOfScanned++)
+    {
+        Rec rec;
+        RecordID rid;
+        int len;
+        status = scan->GetNext(rid, (char *)&rec, len);
+        sum += rec.ival;
+    }
+
+    // Every record is updated, one in five deleted and new ones inserted,
+    // all committed while the reader's scan is half way.
+    RecordID added;
+    if (status == OK)
+        status = MINIBASE_TXN->Begin(writer);
+    for (int i = 0; i < numOfRecs && status == OK; i++)
+    {
+        Rec rec = { i + 1000, i * 2.5 };
+        sprintf(rec.name, "record %i", i);
+        status = f.UpdateRecord(writer, rids[i], (char *)&rec, reclen);
+        if (status == OK && i % 5 == 0)
+            status = f.DeleteRecord(writer, rids[i]);
+    }
+    if (status == OK)
+    {
+        Rec rec = { 2000, 0 };
+        sprintf(rec.name, "added");
+        status = f.InsertRecord(writer, (char *)&rec, reclen, added);
+    }
+    if (status == OK)
+        status = MINIBASE_TXN->Commit(writer);
+
+    while (status == OK)
+    {
+        Rec rec;
+        RecordID rid;
+        int len;
+        if ((status = scan->GetNext(rid, (char *)&rec, len)) != OK)
+            break;
+        sum += rec.ival;
+        numOfScanned++;
+    }
+    delete scan;
+    if (status == DONE)
+        status = OK;
+    if (status == OK && (numOfScanned != numOfRecs || sum != numOfRecs * (numOfRecs - 1) / 2))
+    {
+        cerr << "*** The reader saw " << numOfScanned << " records, summing to " << sum << endl;
+        status = FAIL;
+    }
+
+    cout << "  - A new transaction sees the changes\n";
+    if (status == OK)
+        status = MINIBASE_TXN->Begin(other);
+    if (status == OK)
+        status = ReadSnapshot(f, other, seen);
+    if (status == OK)
+    {
+        int expected = numOfRecs - (numOfRecs + 4) / 5 + 1;
+        bool right = ((int)seen.size() == expected && seen[added] == 2000);
+        for (int i = 1; i < numOfRecs && right; i++)
+            right = (i % 5 == 0) ? !seen.count(rids[i]) : seen[rids[i]] == i + 1000;
+        if (!right)
+        {
+            cerr << "*** The new transaction saw " << seen.size() << " records\n";
+            status = FAIL;
+        }
+    }
+
+    cout << "  - Conflicting updates, and an abort\n";
+    if (status == OK)
+    {
+        TxnID late;
+        Rec rec = { -1, 0 };
+        status = MINIBASE_TXN->Begin(late);
+
+        // other changes a record and aborts; late fails to change it
+        // meanwhile, then succeeds.
+        if (status == OK)
+            status = f.UpdateRecord(other, rids[1], (char *)&rec, reclen);
+        if (status == OK && f.DeleteRecord(other, rids[2]) != OK)
+            status = FAIL;
+        if (status == OK && f.UpdateRecord(late, rids[1], (char *)&rec, reclen) != FAIL)
+        {
+            cerr << "*** Both transactions updated the record\n";
+            status = FAIL;
+        }
+        if (status == OK && f.DeleteRecord(other, rids[0]) != DONE)
+        {
+            cerr << "*** Deleted a deleted record\n";
+            status = FAIL;
+        }
+        if (status == OK)
+            status = MINIBASE_TXN->Abort(other);
+        if (status == OK)
+            status = ReadSnapshot(f, late, seen);
+        if (status == OK && (seen[rids[1]] != 1001 || seen[rids[2]] != 1002))
+        {
+            cerr << "*** The abort was not undone\n";
+            status = FAIL;
+        }
+        if (status == OK)
+            status = f.UpdateRecord(late, rids[1], (char *)&rec, reclen);
+        if (status == OK)
+            status = MINIBASE_TXN->Commit(late);
+    }
+
+    cout << "  - Vacuum\n";
+    int reclaimed = 0;
+    if (status == OK)
+        status = f.Vacuum(reclaimed);
+    if (status == OK && reclaimed != 0)
+    {
+        cerr << "*** Reclaimed " << reclaimed << " versions the reader still sees\n";
+        status = FAIL;
+    }
+    if (status == OK)
+        status = MINIBASE_TXN->Commit(reader);
+
+    // One old version of every record is left, and one more of the record
+    // updated twice; deleted records go with theirs.
+    int numOfLive = numOfRecs - (numOfRecs + 4) / 5 + 1;
+    if (status == OK)
+        status = f.Vacuum(reclaimed);
+    if (status == OK && (reclaimed != numOfRecs + 1 + (numOfRecs + 4) / 5
+                         || f.GetNumOfRecords() != numOfLive))
+    {
+        cerr << "*** Reclaimed " << reclaimed << " versions, leaving "
+             << f.GetNumOfRecords() << " records\n";
+        status = FAIL;
+    }
+    if (status == OK)
+        status = MINIBASE_TXN->Begin(other);
+    if (status == OK)
+        status = ReadSnapshot(f, other, seen);
+    if (status == OK && ((int)seen.size() != numOfLive || seen[rids[1]] != -1))
+    {
+        cerr << "*** Vacuum lost a version\n";
+        status = FAIL;
+    }
+    if (status == OK)
+        status = MINIBASE_TXN->Commit(other);
+
+    if (status == OK)
+        status = f.DeleteFile();
+
+    if (status == OK)
+        cout << "  Test 19 completed successfully.\n";
+    return (status == OK);
+}
+
+
+static Status CheckRecord(HeapFile& f, const RecordID& rid, int id, int len)
+{
+    char rec[MAX_SPACE], expected[MAX_SPACE];
+    int recLen;
+    FillRecord(expected, id, len);
+    if (f.GetRecord(rid, rec, recLen) != OK || recLen != len || memcmp(rec, expected, len) != 0)
+    {
+        cerr << "*** Record " << id << " at " << rid << " is not the " << len
+             << " bytes written\n";
+        return FAIL;
+    }
+    return OK;
+}
+
+
+// The SlotKind of a slot, and for a stub the slot it points to.
+static int KindOf(const RecordID& rid, RecordID& target)
+{
+    HeapPage *page;
+    if (MINIBASE_BM->PinPage(rid.pageNo, (Page *&)page) != OK)
+        return INVALID_SLOT;
+    int kind = page->GetSlotKind(rid);
+    int len;
+    if (kind == SLOT_FORWARD)
+        page->GetRecord(rid, (char *)&target, len);
+    MINIBASE_BM->UnpinPage(rid.pageNo, CLEAN);
+    return kind;
+}
+
+
+bool HeapDriver::Test20()
+{
+    cout << "\n  Test 20: Updates that change the length of records\n";
+    Status status = OK;
+    const int numOfRecs = 20, recLen = 100;
+
+    HeapFile f("file_20", status);
+    vector<RecordID> rids(numOfRecs);
+    vector<int> lens(numOfRecs, recLen);
+    char rec[MAX_SPACE];
+    RecordID target;
+
+    // Nine records fill a page, so the first two pages are full and the
+    // third is mostly free.
+    cout << "  - Insert " << numOfRecs << " records of " << recLen << " bytes\n";
+    for (int i = 0; i < numOfRecs && status == OK; i++)
+    {
+        FillRecord(rec, i, recLen);
+        status = f.InsertRecord(rec, recLen, rids[i]);
+    }
+
+    cout << "  - Grow records in their pages\n";
+    int grown[] = { numOfRecs - 1, 0 }, grownLen[] = { 300, 150 };
+    for (int i = 0; i < 2 && status == OK; i++)
+    {
+        int id = grown[i];
+        lens[id] = grownLen[i];
+        FillRecord(rec, id, lens[id]);
+        status = f.UpdateRecord(rids[id], rec, lens[id]);
+        if (status == OK && KindOf(rids[id], target) != SLOT_RECORD)
+        {
+            cerr << "*** Record " << id << " left its page\n";
+            status = FAIL;
+        }
+    }
+
+    cout << "  - Grow a record out of its page, twice\n";
+    RecordID first;
+    for (int i = 0; i < 2 && status == OK; i++)
+    {
+        lens[1] = (i == 0) ? 400 : 600;
+        FillRecord(rec, 1, lens[1]);
+        status = f.UpdateRecord(rids[1], rec, lens[1]);
+        if (status == OK && (KindOf(rids[1], target) != SLOT_FORWARD
+                             || KindOf(target, target) != SLOT_MOVED
+                             || (i == 1 && target == first)))
+        {
+            cerr << "*** Record 1 was not moved to a page of its own\n";
+            status = FAIL;
+        }
+        first = target;
+    }
+    if (status == OK)
+    {
+        lens[2] = 500;
+        FillRecord(rec, 2, lens[2]);
+        status = f.UpdateRecord(rids[2], rec, lens[2]);
+    }
+
+    cout << "  - Read the records through their record IDs and a scan\n";
+    for (int i = 0; i < numOfRecs && status == OK; i++)
+        status = CheckRecord(f, rids[i], i, lens[i]);
+
+    Scan *scan = NULL;
+    if (status == OK)
+        scan = f.OpenScan(status);
+    if (status == OK)
+    {
+        RecordID rid;
+        int len, numOfScanned = 0;
+        while ((status = scan->GetNext(rid, rec, len)) == OK)
+        {
+            int id;
+            memcpy(&id, rec, sizeof(int));
+            if (id < 0 || id >= numOfRecs || rid != rids[id] || len != lens[id])
+            {
+                cerr << "*** Scan returned record " << id << " at " << rid << endl;
+                status = FAIL;
+                break;
+            }
+            numOfScanned++;
+        }
+        if (status == DONE && numOfScanned == numOfRecs && f.GetNumOfRecords() == numOfRecs)
+            status = OK;
+        else if (status == DONE)
+        {
+            cerr << "*** Scanned " << numOfScanned << " records, file reports "
+                 << f.GetNumOfRecords() << endl;
+            status = FAIL;
+        }
+    }
+    delete scan;
+
+    cout << "  - Shrink a moved record back into its page\n";
+    if (status == OK)
+    {
+        lens[1] = 40;
+        FillRecord(rec, 1, lens[1]);
+        status = f.UpdateRecord(rids[1], rec, lens[1]);
+    }
+    if (status == OK && KindOf(rids[1], target) != SLOT_RECORD)
+    {
+        cerr << "*** Record 1 did not move back\n";
+        status = FAIL;
+    }
+    if (status == OK)
+        status = CheckRecord(f, rids[1], 1, lens[1]);
+
+    cout << "  - Delete a moved record\n";
+    if (status == OK && KindOf(rids[2], target) != SLOT_FORWARD)
+    {
+        cerr << "*** Record 2 was not moved\n";
+        status = FAIL;
+    }
+    if (status == OK)
+        status = f.DeleteRecord(rids[2]);
+    if (status == OK && (f.GetNumOfRecords() != numOfRecs - 1
+                         || KindOf(rids[2], target) != INVALID_SLOT))
+    {
+        cerr << "*** Record 2 was not deleted with its stub\n";
+        status = FAIL;
+    }
+
+    // The update fails before the record changes, and must leave the
+    // index as it was.
+    cout << "  - Fail to grow an indexed record past a page\n";
+    if (status == OK)
+    {
+        HashIndex hash("file_20.hash", 0, attrInteger, sizeof(int), status);
+        if (status == OK)
+            status = f.AttachIndex(&hash);
+        RecordID rid;
+        int oldKey = numOfRecs, key = numOfRecs + 1;
+        FillRecord(rec, oldKey, recLen);
+        if (status == OK)
+            status = f.InsertRecord(rec, recLen, rid);
+        if (status == OK)
+        {
+            FillRecord(rec, key, HeapPage::MaxRecordLength() + 1);
+            if (f.UpdateRecord(rid, rec, HeapPage::MaxRecordLength() + 1) == OK)
+            {
+                cerr << "*** Grew a record past a page\n";
+                status = FAIL;
+            }
+
+            vector<RecordID> oldRids, newRids;
+            if (status == OK)
+                status = hash.Lookup((char *)&oldKey, oldRids);
+            if (status == OK)
+                status = hash.Lookup((char *)&key, newRids);
+            if (status == OK && (oldRids.size() != 1 || oldRids[0] != rid
+                                 || !newRids.empty()))
+            {
+                cerr << "*** The failed update changed the index\n";
+                status = FAIL;
+            }
+        }
+        f.DetachIndex(&hash);
+        if (status == OK)
+            status = hash.DeleteFile();
+    }
+
+    if (status == OK)
+        status = f.DeleteFile();
+
+    if (status == OK)
+        cout << "  Test 20 completed successfully.\n";
+    return (status == OK);
+}
+
+
+// Reads a large record back a chunk at a time and compares it to blob.
+static Status CheckLargeRecord(HeapFile& f, const RecordID& rid, const vector<char>& blob,
+                               int chunk)
+{
+    LargeRecordReader reader;
+    if (f.OpenLargeRecord(rid, reader) != OK || reader.GetLength() != (int)blob.size())
+    {
+        cerr << "*** Could not open large record " << rid << endl;
+        return FAIL;
+    }
+
+    vector<char> buf(chunk);
+    int pos = 0, n;
+    Status status;
+    while ((status = reader.Read(&buf[0], chunk, n)) == OK)
+    {
+        if (n <= 0 || pos + n > (int)blob.size() || memcmp(&buf[0], &blob[pos], n) != 0)
+        {
+            cerr << "*** Large record " << rid << " differs at byte " << pos << endl;
+            return FAIL;
+        }
+        pos += n;
+    }
+    if (status != DONE || pos != (int)blob.size())
+    {
+        cerr << "*** Read " << pos << " bytes of large record " << rid << endl;
+        return FAIL;
+    }
+    return OK;
+}
+
+
+bool HeapDriver::Test21()
+{
+    cout << "\n  Test 21: Large records\n";
+    Status status = OK;
+    const int numOfBlobs = 3;
+    int blobLens[numOfBlobs] = { 5 * MINIBASE_PAGESIZE + 100, 300, 0 };
+
+    HeapFile f("file_21", status);
+    vector<vector<char> > blobs(numOfBlobs);
+    vector<RecordID> blobRids(numOfBlobs), recRids(numOfBlobs);
+
+    cout << "  - Insert large records between small ones\n";
+    for (int i = 0; i < numOfBlobs && status == OK; i++)
+    {
+        char rec[MAX_SPACE];
+        FillRecord(rec, i, 40);
+        status = f.InsertRecord(rec, 40, recRids[i]);
+
+        for (int j = 0; j < blobLens[i]; j++)
+            blobs[i].push_back((char)(j * 7 + i));
+        if (status == OK)
+            status = f.InsertLargeRecord(blobs[i].data(), blobLens[i], blobRids[i]);
+    }
+
+    cout << "  - Read them back in pieces\n";
+    int chunks[] = { 700, MINIBASE_PAGESIZE, 1 };
+    for (int i = 0; i < numOfBlobs && status == OK; i++)
+        status = CheckLargeRecord(f, blobRids[i], blobs[i], chunks[i]);
+
+    cout << "  - Scan the file\n";
+    Scan *scan = NULL;
+    if (status == OK)
+        scan = f.OpenScan(status);
+    if (status == OK)
+    {
+        char rec[MAX_SPACE];
+        RecordID rid;
+        int len, numOfScanned = 0, numOfHeaders = 0;
+        while ((status = scan->GetNext(rid, rec, len)) == OK)
+        {
+            numOfScanned++;
+            for (int i = 0; i < numOfBlobs; i++)
+            {
+                LargeRecordHeader *header = (LargeRecordHeader *)rec;
+                if (rid == blobRids[i] && len == (int)sizeof(LargeRecordHeader)
+                    && header->length == blobLens[i])
+                    numOfHeaders++;
+            }
+        }
+        if (status == DONE && (numOfScanned != 2 * numOfBlobs || numOfHeaders != numOfBlobs
+                               || f.GetNumOfRecords() != 2 * numOfBlobs))
+        {
+            cerr << "*** Scanned " << numOfScanned << " records, " << numOfHeaders
+                 << " of them large\n";
+            status = FAIL;
+        }
+        else if (status == DONE)
+            status = OK;
+    }
+    delete scan;
+
+    if (status == OK)
+    {
+        cout << "  - Try to update a large record\n";
+        Rec rec = { 0, 0 };
+        status = f.UpdateRecord(blobRids[0], (char *)&rec, reclen);
+        TestFailure(status, HEAPFILE, "Updating a large record");
+    }
+
+    // The pages of the first record go back to the database and are
+    // taken again by the next.
+    cout << "  - Delete a large record and insert another\n";
+    RecordID rid;
+    if (status == OK)
+        status = f.DeleteRecord(blobRids[0]);
+    if (status == OK)
+    {
+        LargeRecordReader reader;
+        if (f.OpenLargeRecord(blobRids[0], reader) == OK)
+        {
+            cerr << "*** Deleted large record " << blobRids[0] << " can still be read\n";
+            status = FAIL;
+        }
+    }
+    if (status == OK)
+    {
+        for (size_t j = 0; j < blobs[0].size(); j++)
+            blobs[0][j] = (char)(j * 13);
+        status = f.InsertLargeRecord(blobs[0].data(), blobs[0].size(), rid);
+    }
+    if (status == OK)
+        status = CheckLargeRecord(f, rid, blobs[0], 4000);
+    for (int i = 0; i < numOfBlobs && status == OK; i++)
+        status = CheckRecord(f, recRids[i], i, 40);
+
+    if (status == OK)
+        status = f.DeleteFile();
+
+    if (status == OK)
+        cout << "  Test 21 completed successfully.\n";
+    return (status == OK);
+}
+
+
+// The work of one thread of Test 22: inserts records, reads them back,
+// changes the length of some and deletes others.  live gets the records
+// left, by record ID, with their numbers and lengths.
+static Status InsertUpdateDelete(HeapFile& f, int t, int numOfRecords,
+                                 map<RecordID, pair<int, int> >& live)
+{
+    char rec[MAX_SPACE];
+    vector<RecordID> rids(numOfRecords);
+    vector<int> lens(numOfRecords);
+    Status status = OK;
+
+    for (int i = 0; i < numOfRecords && status == OK; i++)
+    {
+        int id = t * numOfRecords + i;
+        lens[i] = 16 + id % 24;
+        FillRecord(rec, id, lens[i]);
+        status = f.InsertRecord(rec, lens[i], rids[i]);
+        if (status == OK)
+            status = CheckRecord(f, rids[i], id, lens[i]);
+    }
+
+    for (int i = 0; i < numOfRecords && status == OK; i++)
+    {
+        int id = t * numOfRecords + i;
+        if (i % 4 == 1)
+        {
+            status = f.DeleteRecord(rids[i]);
+            continue;
+        }
+        if (i % 3 == 0)
+        {
+            lens[i] = (i % 2 == 0) ? 4 * lens[i] : lens[i] / 2;
+            FillRecord(rec, id, lens[i]);
+            status = f.UpdateRecord(rids[i], rec, lens[i]);
+        }
+        if (status == OK)
+            status = CheckRecord(f, rids[i], id, lens[i]);
+        live[rids[i]] = make_pair(id, lens[i]);
+    }
+    return status;
+}
+
+
+bool HeapDriver::Test22()
+{
+    cout << "\n  Test 22: Concurrent inserts, updates and deletes\n";
+    Status status = OK;
+    const int numOfThreads = 4;
+    const int recordsPerThread = 60;
+
+    HeapFile f("file_22", status);
+
+    cout << "  - Change the file from " << numOfThreads << " threads at once\n";
+    vector<std::thread> threads;
+    vector<Status> results(numOfThreads, OK);
+    vector<map<RecordID, pair<int, int> > > lives(numOfThreads);
+    for (int t = 0; t < numOfThreads && status == OK; t++)
+        threads.push_back(std::thread([t, &f, &results, &lives]() {
+            results[t] = InsertUpdateDelete(f, t, recordsPerThread, lives[t]);
+        }));
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+        if (results[t] != OK)
+            status = results[t];
+    }
+
+    cout << "  - Check every record left\n";
+    map<RecordID, pair<int, int> > live;
+    for (int t = 0; t < numOfThreads; t++)
+        live.insert(lives[t].begin(), lives[t].end());
+    for (map<RecordID, pair<int, int> >::iterator i = live.begin();
+         i != live.end() && status == OK; ++i)
+        status = CheckRecord(f, i->first, i->second.first, i->second.second);
+
+    if (status == OK && (live.size() != (size_t)(numOfThreads * recordsPerThread * 3 / 4)
+                         || f.GetNumOfRecords() != (int)live.size()))
+    {
+        cerr << "*** The file has " << f.GetNumOfRecords() << " records, "
+             << live.size() << " of them known\n";
+        status = FAIL;
+    }
+
+    Scan *scan = NULL;
+    if (status == OK)
+        scan = f.OpenScan(status);
+    if (status == OK)
+    {
+        char rec[MAX_SPACE];
+        RecordID rid;
+        int len;
+        size_t numOfScanned = 0;
+        while ((status = scan->GetNext(rid, rec, len)) == OK)
+        {
+            if (live.count(rid) == 0 || live[rid].second != len)
+            {
+                cerr << "*** The scan returned " << rid << ", which is not a record\n";
+                break;
+            }
+            numOfScanned++;
+        }
+        if (status == DONE && numOfScanned == live.size())
+            status = OK;
+        else
+        {
+            cerr << "*** The scan returned " << numOfScanned << " records\n";
+            status = FAIL;
+        }
+    }
+    delete scan;
+
+    // A reader waits while another thread has the record locked.
+
+    if (status == OK)
+    {
+        cout << "  - Read a record locked by another thread\n";
+        RecordID rid = live.begin()->first;
+        std::atomic<bool> read(false);
+
+        MINIBASE_LOCKS->Lock(rid, true);
+        std::thread reader([&f, &rid, &read]() {
+            char rec[MAX_SPACE];
+            int len;
+            f.GetRecord(rid, rec, len);
+            read = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        bool early = read;
+        MINIBASE_LOCKS->Unlock(rid);
+        reader.join();
+
+        if (early || !read)
+        {
+            cerr << "*** The record was read while it was locked\n";
+            status = FAIL;
+        }
+    }
+
+    if (status == OK)
+        status = f.DeleteFile();
+
+    if (status == OK)
+        cout << "  Test 22 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//------------------------------------------------------------------
+// HeapDriver::Test23
+//
+// Reads records and scans a file without waiting for the disk: with
+// the file's pages out of the pool, pages are read through the I/O
+// service and reads complete on its threads; with them in, reads
+// complete in the caller.
+//------------------------------------------------------------------
+
+bool HeapDriver::Test23()
+{
+    cout << "\n  Test 23: Asynchronous reads\n";
+    Status status = OK;
+    const int numOfRecords = 300;
+    const int len = 40;
+
+    HeapFile f("file_23", status);
+
+    vector<RecordID> rids(numOfRecords);
+    char rec[MAX_SPACE];
+    for (int i = 0; i < numOfRecords && status == OK; i++)
+    {
+        FillRecord(rec, i, len);
+        status = f.InsertRecord(rec, len, rids[i]);
+    }
+
+    // Emptying the pool leaves every page of the file to be read.  With
+    // a queue depth of one, the reads wait for one another in the queue.
+
+    int depth = MINIBASE_IO->GetQueueDepth();
+    for (int pass = 0; pass < 3 && status == OK; pass++)
+    {
+        bool cold = (pass < 2);
+        if (cold)
+        {
+            cout << "  - Read every record with the pool empty, "
+                 << (pass == 0 ? "one" : "many") << " at a time\n";
+            MINIBASE_IO->SetQueueDepth(pass == 0 ? 1 : depth);
+            status = MINIBASE_BM->FlushAllPages();
+        }
+        else
+            cout << "  - Read every record again, with its page in the pool\n";
+
+        vector<vector<char> > recs(numOfRecords, vector<char>(MAX_SPACE));
+        vector<Status> results(numOfRecords, FAIL);
+        vector<int> lens(numOfRecords, 0);
+        std::atomic<int> numOfElsewhere(0);
+        std::thread::id self = std::this_thread::get_id();
+
+        for (int i = 0; i < numOfRecords && status == OK; i++)
+            f.GetRecordAsync(rids[i], &recs[i][0],
+                             [i, self, &results, &lens, &numOfElsewhere](Status s, int l) {
+                results[i] = s;
+                lens[i] = l;
+                if (std::this_thread::get_id() != self)
+                    numOfElsewhere++;
+            });
+        MINIBASE_IO->Drain();
+
+        for (int i = 0; i < numOfRecords && status == OK; i++)
+        {
+            FillRecord(rec, i, len);
+            if (results[i] != OK || lens[i] != len || memcmp(&recs[i][0], rec, len) != 0)
+            {
+                cerr << "*** Record " << i << " at " << rids[i] << " was not read\n";
+                status = FAIL;
+            }
+        }
+        if (status == OK && (cold ? numOfElsewhere == 0 : numOfElsewhere != 0))
+        {
+            cerr << "*** " << numOfElsewhere << " reads went to the I/O threads\n";
+            status = FAIL;
+        }
+    }
+
+    // The callback of each call may run on another thread; Drain waits
+    // for it before the next call.
+
+    Scan *scan = NULL;
+    if (status == OK)
+    {
+        cout << "  - Scan the file with the pool empty\n";
+        status = MINIBASE_BM->FlushAllPages();
+    }
+    if (status == OK)
+        scan = f.OpenScan(status);
+    if (status == OK)
+    {
+        RecordID rid;
+        Status result;
+        int recLen, numOfScanned = 0;
+        for (;;)
+        {
+            scan->GetNextAsync(rid, rec, [&result, &recLen](Status s, int l) {
+                result = s;
+                recLen = l;
+            });
+            MINIBASE_IO->Drain();
+            if (result != OK)
+                break;
+
+            int id;
+            memcpy(&id, rec, sizeof(int));
+            if (id < 0 || id >= numOfRecords || !(rids[id] == rid) || recLen != len)
+            {
+                cerr << "*** The scan returned " << rid << ", which is not a record\n";
+                result = FAIL;
+                break;
+            }
+            numOfScanned++;
+        }
+        if (result != DONE || numOfScanned != numOfRecords)
+        {
+            cerr << "*** The scan returned " << numOfScanned << " records\n";
+            status = FAIL;
+        }
+    }
+    delete scan;
+
+    if (status == OK)
+        status = f.DeleteFile();
+
+    if (status == OK)
+        cout << "  Test 23 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//-------------------------------------------------------------
+// HeapDriver::Test24
+//
+// A file kept in a buffer pool of its own stays there however
+// much another file reads through the default pool, which work
+// frames shrink to a few frames for the test.
+//-------------------------------------------------------------
+
+bool HeapDriver::Test24()
+{
+    cout << "\n  Test 24: Buffer pools\n";
+    Status status = OK;
+    const int numOfHot = 100;
+    const int numOfCold = 60;
+    const int numOfFree = 6;
+    const int len = 40;
+    const int coldLen = 200;
+
+    cout << "  - Add a pool of 8 frames\n";
+    if (MINIBASE_BM->GetPoolNo("pool_24") == -1)
+        status = MINIBASE_BM->AddPool("pool_24", 8, "Clock");
+    if (status == OK && (MINIBASE_BM->AddPool("pool_24", 8, "Clock") == OK
+                         || MINIBASE_BM->AddPool("pool_24b", 8, "NoSuchPolicy") == OK))
+    {
+        cerr << "*** A pool was added twice, or with no such policy\n";
+        status = FAIL;
+    }
+
+    vector<RecordID> rids(numOfHot);
+    char rec[MAX_SPACE];
+    if (status == OK)
+    {
+        cout << "  - Insert records into a file in the default pool\n";
+        HeapFile f("file_24", status);
+        for (int i = 0; i < numOfHot && status == OK; i++)
+        {
+            FillRecord(rec, i, len);
+            status = f.InsertRecord(rec, len, rids[i]);
+        }
+    }
+
+    HeapFile *hot = NULL;
+    if (status == OK)
+    {
+        cout << "  - Reopen it in the new pool\n";
+        hot = new HeapFile("file_24", "pool_24", status);
+    }
+
+    vector<Page*> work;
+    if (status == OK)
+        status = MINIBASE_BM->GetWorkFrames(MINIBASE_BM->GetNumOfUnpinnedFrames() - 8 - numOfFree, work);
+
+    HeapFile cold("file_24_cold", status);
+    RecordID rid;
+    for (int i = 0; i < numOfCold && status == OK; i++)
+    {
+        FillRecord(rec, i, coldLen);
+        status = cold.InsertRecord(rec, coldLen, rid);
+    }
+
+    // The first pass may read the hot pages in; once they are, reading
+    // the cold file through the default pool must not push them out.
+
+    for (int pass = 0; pass < 2 && status == OK; pass++)
+    {
+        cout << "  - Read the file in the pool, then scan the other one\n";
+        MINIBASE_BM->ResetStat();
+
+        for (int i = 0; i < numOfHot && status == OK; i++)
+        {
+            int recLen;
+            char got[MAX_SPACE];
+            FillRecord(rec, i, len);
+            status = hot->GetRecord(rids[i], got, recLen);
+            if (status == OK && (recLen != len || memcmp(got, rec, len) != 0))
+            {
+                cerr << "*** Record " << i << " at " << rids[i] << " is wrong\n";
+                status = FAIL;
+            }
+        }
+
+        long pins, misses;
+        if (status == OK)
+            status = MINIBASE_BM->GetStat("pool_24", pins, misses);
+        if (status == OK && (pins < numOfHot || (pass == 1 && misses != 0)))
+        {
+            cerr << "*** The pool had " << pins << " pins and " << misses << " misses\n";
+            status = FAIL;
+        }
+
+        Scan *scan = NULL;
+        if (status == OK)
+            scan = cold.OpenScan(status);
+        int recLen, numOfScanned = 0;
+        while (status == OK && scan->GetNext(rid, rec, recLen) == OK)
+            numOfScanned++;
+        delete scan;
+
+        if (status == OK)
+            status = MINIBASE_BM->GetStat("default", pins, misses);
+        if (status == OK && (numOfScanned != numOfCold || misses == 0))
+        {
+            cerr << "*** The scan returned " << numOfScanned << " records with "
+                 << misses << " misses\n";
+            status = FAIL;
+        }
+    }
+
+    MINIBASE_BM->ReleaseWorkFrames(work);
+    if (status == OK)
+        status = cold.DeleteFile();
+    if (status == OK)
+        status = hot->DeleteFile();
+    delete hot;
+
+    if (status == OK)
+        cout << "  Test 24 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//-------------------------------------------------------------
+// HeapDriver::Test25
+//
+// The default pool grows and shrinks under a file's records,
+// changed or not, and while another thread reads them.
+//-------------------------------------------------------------
+
+bool HeapDriver::Test25()
+{
+    cout << "\n  Test 25: Resizing the buffer pool\n";
+    Status status = OK;
+    const int numOfRecords = 40;
+    const int len = 200;
+    const unsigned int size = MINIBASE_BM->GetNumOfFrames("default");
+    const unsigned int total = MINIBASE_BM->GetNumOfFrames();
+
+    HeapFile f("file_25", status);
+
+    vector<RecordID> rids(numOfRecords);
+    char rec[MAX_SPACE];
+    for (int i = 0; i < numOfRecords && status == OK; i++)
+    {
+        FillRecord(rec, i, len);
+        status = f.InsertRecord(rec, len, rids[i]);
+    }
+
+    // Reads every record back, expecting the one filled from i + offset.
+    auto check = [&](int offset) {
+        for (int i = 0; i < numOfRecords && status == OK; i++)
+        {
+            int recLen;
+            char got[MAX_SPACE];
+            FillRecord(rec, i + offset, len);
+            status = f.GetRecord(rids[i], got, recLen);
+            if (status == OK && (recLen != len || memcmp(got, rec, len) != 0))
+            {
+                cerr << "*** Record " << i << " at " << rids[i] << " is wrong\n";
+                status = FAIL;
+            }
+        }
+    };
+
+    if (status == OK)
+    {
+        cout << "  - Grow the pool by 50 frames\n";
+        status = MINIBASE_BM->Resize(size + 50);
+        if (status == OK && (MINIBASE_BM->GetNumOfFrames("default") != size + 50
+                             || MINIBASE_BM->GetNumOfFrames() != total + 50))
+        {
+            cerr << "*** The pool has " << MINIBASE_BM->GetNumOfFrames("default") << " frames\n";
+            status = FAIL;
+        }
+        check(0);
+    }
+
+    // The records are changed and left dirty, so shrinking has to write
+    // them back to give their frames up.
+
+    for (int i = 0; i < numOfRecords && status == OK; i++)
+    {
+        FillRecord(rec, i + 1, len);
+        status = f.UpdateRecord(rids[i], rec, len);
+    }
+    if (status == OK)
+    {
+        cout << "  - Shrink the pool to 10 frames\n";
+        status = MINIBASE_BM->Resize(10);
+        if (status == OK && MINIBASE_BM->GetNumOfFrames() != total - size + 10)
+        {
+            cerr << "*** The manager has " << MINIBASE_BM->GetNumOfFrames() << " frames\n";
+            status = FAIL;
+        }
+        check(1);
+    }
+
+    vector<Page*> work;
+    if (status == OK)
+    {
+        cout << "  - Shrink it below the frames pinned\n";
+        status = MINIBASE_BM->GetWorkFrames(8, work);
+    }
+    if (status == OK && (MINIBASE_BM->Resize(4) == OK || MINIBASE_BM->Resize(10, "no_pool") == OK
+                         || MINIBASE_BM->GetNumOfFrames("default") != 10))
+    {
+        cerr << "*** The pool gave up pinned frames\n";
+        status = FAIL;
+    }
+    MINIBASE_BM->ReleaseWorkFrames(work);
+
+    if (status == OK)
+    {
+        cout << "  - Resize it while another thread reads the file\n";
+        std::atomic<bool> done(false);
+        std::atomic<int> numOfErrors(0);
+        std::thread reader([&]() {
+            char buf[MAX_SPACE], expected[MAX_SPACE];
+            while (!done)
+            {
+                for (int i = 0; i < numOfRecords; i++)
+                {
+                    int recLen;
+                    FillRecord(expected, i + 1, len);
+                    if (f.GetRecord(rids[i], buf, recLen) != OK
+                        || recLen != len || memcmp(buf, expected, len) != 0)
+                        numOfErrors++;
+                }
+            }
+        });
+
+        for (int i = 0; i < 20 && status == OK; i++)
+            status = MINIBASE_BM->Resize((i % 2 == 0) ? size : 10);
+        done = true;
+        reader.join();
+
+        if (status == OK && numOfErrors != 0)
+        {
+            cerr << "*** " << numOfErrors << " reads failed\n";
+            status = FAIL;
+        }
+    }
+
+    // Shrinks racing each other must not take more frames between them
+    // than the one size asked for allows.
+
+    if (status == OK)
+    {
+        cout << "  - Shrink it to 10 frames from 4 threads at once\n";
+        status = MINIBASE_BM->Resize(size);
+    }
+    if (status == OK)
+    {
+        vector<std::thread> threads;
+        std::atomic<int> numOfFailed(0);
+        for (int t = 0; t < 4; t++)
+            threads.push_back(std::thread([&numOfFailed]() {
+                if (MINIBASE_BM->Resize(10) != OK)
+                    numOfFailed++;
+            }));
+        for (size_t t = 0; t < threads.size(); t++)
+            threads[t].join();
+
+        if (numOfFailed != 0 || MINIBASE_BM->GetNumOfFrames("default") != 10)
+        {
+            cerr << "*** The pool has " << MINIBASE_BM->GetNumOfFrames("default")
+                 << " frames, " << numOfFailed << " resizes failed\n";
+            status = FAIL;
+        }
+    }
+
+    if (status == OK)
+    {
+        status = MINIBASE_BM->Resize(size);
+        check(1);
+    }
+    if (status == OK && MINIBASE_BM->GetNumOfFrames() != total)
+    {
+        cerr << "*** The manager has " << MINIBASE_BM->GetNumOfFrames() << " frames\n";
+        status = FAIL;
+    }
+
+    if (status == OK)
+        status = f.DeleteFile();
+
+    if (status == OK)
+        cout << "  Test 25 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//-------------------------------------------------------------
+// HeapDriver::Test26
+//
+// After a restart the pool is warmed with the pages it held
+// when the database was flushed, so that reading them again
+// misses nothing.
+//-------------------------------------------------------------
+
+bool HeapDriver::Test26()
+{
+    cout << "\n  Test 26: Warming the pool after a restart\n";
+    Status status = OK;
+    const int numOfRecords = 40;
+    const int len = 200;
+
+    vector<RecordID> rids(numOfRecords);
+    char rec[MAX_SPACE];
+    {
+        HeapFile f("file_26", status);
+        for (int i = 0; i < numOfRecords && status == OK; i++)
+        {
+            FillRecord(rec, i, len);
+            status = f.InsertRecord(rec, len, rids[i]);
+        }
+    }
+
+    // Flushing saves the list of pages in the pool, then empties it,
+    // and the checkpoint after it leaves restart nothing to redo; what
+    // the pool holds after the restart it owes to the list.
+
+    if (status == OK)
+        status = MINIBASE_LOG->Commit();
+    if (status == OK)
+    {
+        cout << "  - Flush the pool and restart\n";
+        status = MINIBASE_BM->FlushAllPages();
+    }
+    if (status == OK)
+        status = MINIBASE_LOG->Checkpoint();
+    if (status == OK)
+    {
+        delete minibase_globals;
+        minibase_globals = NULL;
+        cout << "  - Read every record again in a new process\n";
+        status = Restart(26);
+        if (status != OK)
+            cerr << "*** The restarted pool was not warmed\n";
+    }
+
+    // Reopen even if the restart failed, for the tests that follow.
+
+    if (minibase_globals == NULL)
+    {
+        Status reopened;
+        minibase_globals = new SystemDefs(reopened, "MINIBASE.DB", "MINIBASE.LOG", 0, 500, 100, "Clock");
+        if (reopened != OK)
+        {
+            cerr << "*** Error reopening the database\n";
+            status = FAIL;
+        }
+    }
+    if (status == OK)
+    {
+        HeapFile f("file_26", status);
+        if (status == OK)
+            status = f.DeleteFile();
+    }
+    if (status == OK)
+        status = MINIBASE_LOG->Commit();
+
+    if (status == OK)
+        cout << "  Test 26 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//------------------------------------------------------------------
+// HeapDriver::Test27
+//
+// Inserts from several threads at once, each of which should fill
+// pages of its own; then checks that a thread that exits gives its
+// target back, and that freeing a page or deleting the file leaves
+// no thread inserting into a page that is gone.
+//------------------------------------------------------------------
+
+bool HeapDriver::Test27()
+{
+    cout << "\n  Test 27: Insert targets\n";
+    Status status = OK;
+    const int numOfThreads = 4;
+    const int recordsPerThread = 30;
+    const int len = 40;
+
+    HeapFile f("file_27", status);
+
+    // Every thread takes its slot before any inserts, and stays alive
+    // until all have inserted, so that no two share a slot.
+
+    cout << "  - Insert from " << numOfThreads << " threads at once\n";
+    vector<std::thread> threads;
+    vector<Status> results(numOfThreads, OK);
+    vector<vector<RecordID> > rids(numOfThreads);
+    vector<PageID> targets(numOfThreads, INVALID_PAGE);
+    std::atomic<int> started(0), inserted(0);
+    for (int t = 0; t < numOfThreads && status == OK; t++)
+        threads.push_back(std::thread([t, &f, &results, &rids, &targets, &started, &inserted]() {
+            char rec[MAX_SPACE];
+            if (f.GetInsertTarget() != INVALID_PAGE)
+                results[t] = FAIL;
+            for (started++; started < numOfThreads; )
+                std::this_thread::yield();
+            for (int i = 0; i < recordsPerThread && results[t] == OK; i++)
+            {
+                RecordID rid;
+                FillRecord(rec, t * recordsPerThread + i, len);
+                results[t] = f.InsertRecord(rec, len, rid);
+                rids[t].push_back(rid);
+            }
+            targets[t] = f.GetInsertTarget();
+            for (inserted++; inserted < numOfThreads; )
+                std::this_thread::yield();
+        }));
+    for (size_t t = 0; t < threads.size(); t++)
+    {
+        threads[t].join();
+        if (results[t] != OK)
+            status = results[t];
+    }
+
+    map<PageID, int> owners;
+    for (int t = 0; t < numOfThreads && status == OK; t++)
+    {
+        if (targets[t] == INVALID_PAGE || owners.count(targets[t]) != 0)
+        {
+            cerr << "*** Thread " << t << " inserted into page " << targets[t]
+                 << ", which is not a target of its own\n";
+            status = FAIL;
+        }
+        for (size_t i = 0; i < rids[t].size() && status == OK; i++)
+        {
+            PageID pid = rids[t][i].pageNo;
+            if (owners.count(pid) != 0 && owners[pid] != t)
+            {
+                cerr << "*** Threads " << owners[pid] << " and " << t
+                     << " both inserted into page " << pid << endl;
+                status = FAIL;
+            }
+            owners[pid] = t;
+            status = CheckRecord(f, rids[t][i], t * recordsPerThread + i, len);
+        }
+    }
+    if (status == OK && f.GetNumOfRecords() != numOfThreads * recordsPerThread)
+    {
+        cerr << "*** The file has " << f.GetNumOfRecords() << " records\n";
+        status = FAIL;
+    }
+
+    Scan *scan = NULL;
+    if (status == OK)
+        scan = f.OpenScan(status);
+    if (status == OK)
+    {
+        char rec[MAX_SPACE];
+        RecordID rid;
+        int recLen, numOfScanned = 0;
+        while ((status = scan->GetNext(rid, rec, recLen)) == OK)
+            numOfScanned++;
+        if (status != DONE || numOfScanned != numOfThreads * recordsPerThread)
+        {
+            cerr << "*** The scan returned " << numOfScanned << " records\n";
+            status = FAIL;
+        }
+        else
+            status = OK;
+    }
+    delete scan;
+
+    // The threads have exited, so a new thread gets a slot one of them
+    // held, and with it that thread's target.  Emptying the page frees
+    // it, and the target with it.
+
+    if (status == OK)
+    {
+        cout << "  - Insert from a new thread, then empty its page\n";
+        std::thread([&f, &status, &targets]() {
+            char rec[MAX_SPACE];
+            PageID pid = f.GetInsertTarget();
+            bool inherited = false;
+            for (int t = 0; t < numOfThreads; t++)
+                inherited = inherited || (pid == targets[t]);
+            if (!inherited)
+            {
+                cerr << "*** A new thread starts with page " << pid
+                     << ", not a target of a thread gone\n";
+                status = FAIL;
+                return;
+            }
+
+            RecordID rid;
+            FillRecord(rec, 0, len);
+            status = f.InsertRecord(rec, len, rid);
+            if (status == OK && rid.pageNo != pid)
+            {
+                cerr << "*** The insert went to page " << rid.pageNo << ", not " << pid << endl;
+                status = FAIL;
+            }
+
+            Scan *scan = NULL;
+            vector<RecordID> onPage;
+            if (status == OK)
+                scan = f.OpenScan(status);
+            int recLen;
+            RecordID next;
+            while (status == OK && (status = scan->GetNext(next, rec, recLen)) == OK)
+            {
+                if (next.pageNo == pid)
+                    onPage.push_back(next);
+            }
+            delete scan;
+            if (status == DONE)
+                status = OK;
+            for (size_t i = 0; i < onPage.size() && status == OK; i++)
+                status = f.DeleteRecord(onPage[i]);
+            if (status == OK && f.GetInsertTarget() != INVALID_PAGE)
+            {
+                cerr << "*** Page " << pid << " was freed but is still a target\n";
+                status = FAIL;
+            }
+
+            if (status == OK)
+            {
+                FillRecord(rec, 1, len);
+                status = f.InsertRecord(rec, len, rid);
+            }
+            if (status == OK && (rid.pageNo == pid || f.GetInsertTarget() != rid.pageNo))
+            {
+                cerr << "*** The insert went to page " << rid.pageNo << endl;
+                status = FAIL;
+            }
+            if (status == OK)
+                status = CheckRecord(f, rid, 1, len);
+            if (status == OK && f.GetNumOfRecords() != numOfThreads * recordsPerThread + 1 - (int)onPage.size() + 1)
+            {
+                cerr << "*** The file has " << f.GetNumOfRecords() << " records\n";
+                status = FAIL;
+            }
+        }).join();
+    }
+
+    if (status == OK)
+    {
+        cout << "  - Delete the file\n";
+        char rec[MAX_SPACE];
+        RecordID rid;
+        FillRecord(rec, 2, len);
+        status = f.InsertRecord(rec, len, rid);
+        if (status == OK)
+            status = f.DeleteFile();
+        if (status == OK && f.GetInsertTarget() != INVALID_PAGE)
+        {
+            cerr << "*** The file is deleted but page " << f.GetInsertTarget()
+                 << " is still a target\n";
+            status = FAIL;
+        }
+    }
+
+    if (status == OK)
+        cout << "  Test 27 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//------------------------------------------------------------------
+// HeapDriver::Test28
+//
+// Changes pages while a checkpoint is being taken, after the dirty
+// page table is taken but before the checkpoint is logged, then
+// crashes: restart must redo the changes, though the checkpoint's
+// table does not have their pages.
+//------------------------------------------------------------------
+
+bool HeapDriver::Test28()
+{
+    cout << "\n  Test 28: Changes during a checkpoint\n";
+    Status status = OK;
+    vector<RecordID> rids;
+
+    cout << "  - Insert " << CHECKPOINT_RECORDS << " records and write them out\n";
+    {
+        HeapFile f("file_28", status);
+        char rec[MAX_SPACE];
+        for (int i = 0; i < CHECKPOINT_RECORDS && status == OK; i++)
+        {
+            RecordID rid;
+            FillRecord(rec, i, CHECKPOINT_LEN);
+            status = f.InsertRecord(rec, CHECKPOINT_LEN, rid);
+            rids.push_back(rid);
+        }
+    }
+    if ( status == OK )
+        status = MINIBASE_LOG->Commit();
+    if ( status == OK )
+        status = MINIBASE_BM->FlushAllPages();
+    if ( status != OK )
+        return false;
+
+    // The child changes the clean pages from inside the checkpoint and
+    // commits, then dies with the changes only in the log.
+
+    cout << "  - Change the pages while a checkpoint is taken, and crash\n";
+    cout.flush();
+
+    pid_t child = fork();
+    if ( child == 0 )
+    {
+        HeapFile f("file_28", status);
+        if ( status == OK )
+            status = MINIBASE_LOG->Checkpoint([&f, &rids, &status]() {
+                char rec[MAX_SPACE];
+                for (size_t i = 0; i < rids.size() && status == OK; i += 2)
+                {
+                    FillRecord(rec, i + 1, CHECKPOINT_LEN);
+                    status = f.UpdateRecord(rids[i], rec, CHECKPOINT_LEN);
+                    if ( status == OK )
+                        status = f.DeleteRecord(rids[i + 1]);
+                }
+                if ( status == OK )
+                    status = MINIBASE_LOG->Commit();
+            });
+
+        LSN ckptLSN = MINIBASE_LOG->GetCheckpointLSN();
+        vector<DirtyPageEntry> dirtyPages;
+        MINIBASE_BM->GetDirtyPages(dirtyPages);
+        if ( status == OK && (dirtyPages.empty() || dirtyPages[0].recLSN >= ckptLSN) )
+        {
+            cerr << "*** The pages were not changed before the checkpoint was logged\n";
+            status = FAIL;
+        }
+        _exit(status == OK ? 0 : 1);
+    }
+
+    int childStatus;
+    if ( child < 0 || waitpid(child, &childStatus, 0) != child ||
+         !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0 )
+    {
+        cerr << "*** The crashing process failed before it crashed\n";
+        return false;
+    }
+
+    delete minibase_globals;
+    minibase_globals = NULL;
+
+    cout << "  - Restart and check the changes\n";
+    status = Restart(28);
+    if ( status != OK )
+        cerr << "*** The changes made during the checkpoint were lost\n";
+
+    // Reopen even if the restart failed, for the tests that follow.
+
+    Status reopened;
+    minibase_globals = new SystemDefs(reopened, "MINIBASE.DB", "MINIBASE.LOG", 0, 500, 100, "Clock");
+    if ( reopened != OK )
+    {
+        cerr << "*** Error reopening the database\n";
+        status = FAIL;
+    }
+    if ( status == OK )
+        status = CheckChangedInCheckpoint();
+    if ( status == OK )
+    {
+        HeapFile f("file_28", status);
+        if ( status == OK )
+            status = f.DeleteFile();
+        if ( status == OK )
+            status = MINIBASE_LOG->Commit();
+    }
+
+    if ( status == OK )
+        cout << "  Test 28 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//------------------------------------------------------------------
+// HeapDriver::Test29
+//
+// A dirty page the pool cannot write back when it is evicted stays in
+// the pool, and the pin that wanted its frame fails rather than lose
+// it.  A page beyond the end of the database cannot be written.
+//------------------------------------------------------------------
+
+bool HeapDriver::Test29()
+{
+    cout << "\n  Test 29: Evicting a page that cannot be written\n";
+    Status status = OK;
+    PageID pid, badPid = MINIBASE_DB->GetNumOfPages();
+    Page *page;
+
+    if (MINIBASE_BM->GetPoolNo("pool_29") == -1)
+        status = MINIBASE_BM->AddPool("pool_29", 1, "Clock");
+    int poolNo = MINIBASE_BM->GetPoolNo("pool_29");
+
+    if (status == OK)
+        status = MINIBASE_BM->NewPage(pid, page);
+    if (status == OK)
+        status = MINIBASE_BM->UnpinPage(pid, DIRTY);
+    if (status == OK)
+        status = MINIBASE_BM->BindPages(pid, 1, poolNo);
+    if (status == OK)
+        status = MINIBASE_BM->BindPages(badPid, 1, poolNo);
+
+    // The only frame of the pool holds a dirty page no write can take.
+
+    if (status == OK)
+    {
+        cout << "  - Dirty page " << badPid << ", past the end of the database\n";
+        status = MINIBASE_BM->PinPage(badPid, page, true);
+    }
+    if (status == OK)
+    {
+        memset((char *)page, 'x', MINIBASE_PAGESIZE);
+        status = MINIBASE_BM->UnpinPage(badPid, DIRTY);
+    }
+
+    if (status == OK)
+    {
+        cout << "  - Pin another page of its pool\n";
+        if (MINIBASE_BM->PinPage(pid, page) == OK)
+        {
+            cerr << "*** The page was evicted without being written\n";
+            MINIBASE_BM->UnpinPage(pid, CLEAN);
+            status = FAIL;
+        }
+        else if (!MINIBASE_BM->IsResident(badPid))
+        {
+            cerr << "*** The page that could not be written is gone\n";
+            status = FAIL;
+        }
+        minibase_errors.clear_errors();
+    }
+
+    // Freeing the page drops it without a write; the database cannot
+    // free a page it does not have, so that part fails.
+
+    if (status == OK)
+    {
+        cout << "  - Drop it, and pin the other page again\n";
+        MINIBASE_BM->FreePage(badPid);
+        minibase_errors.clear_errors();
+        status = MINIBASE_BM->PinPage(pid, page);
+    }
+    if (status == OK)
+        status = MINIBASE_BM->UnpinPage(pid, CLEAN);
+    if (status == OK)
+        status = MINIBASE_BM->FreePage(pid);
+
+    if (status == OK)
+        cout << "  Test 29 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//------------------------------------------------------------------
+// HeapDriver::Test30
+//
+// A thread unpinning a page it changed logs an image of it only if
+// no log record of its own covers the change: another thread pinning
+// the page meanwhile, and perhaps changing it, does not make it log
+// one.  Flushing the pool leaves the pages others hold unwritten.
+//------------------------------------------------------------------
+
+bool HeapDriver::Test30()
+{
+    cout << "\n  Test 30: Logging and flushing pages others hold\n";
+    Status status = OK;
+    PageID pid;
+    Page *page;
+    std::atomic<int> step(0);
+    Status otherStatus = OK;
+
+    status = MINIBASE_BM->NewPage(pid, page);
+    if (status == OK)
+        status = MINIBASE_BM->UnpinPage(pid, DIRTY);
+
+    // This thread changes the page and logs it; the other pins it
+    // before this one unpins, and unpins it after without logging.
+
+    if (status == OK)
+    {
+        cout << "  - Change page " << pid << " and log it, while another thread pins it\n";
+        status = MINIBASE_BM->PinPage(pid, page);
+    }
+    if (status == OK)
+        status = MINIBASE_BM->SetPageLSN(pid, MINIBASE_LOG->LogPageImage(pid, page));
+    if (status != OK)
+        return false;
+
+    std::thread other([&]() {
+        Page *otherPage;
+        otherStatus = MINIBASE_BM->PinPage(pid, otherPage);
+        step = 1;
+        while (step != 2)
+            std::this_thread::yield();
+        if (otherStatus == OK)
+            otherStatus = MINIBASE_BM->UnpinPage(pid, DIRTY);
+    });
+    while (step != 1)
+        std::this_thread::yield();
+
+    LSN endLSN = MINIBASE_LOG->GetEndLSN();
+    status = MINIBASE_BM->UnpinPage(pid, DIRTY);
+    if (status == OK && MINIBASE_LOG->GetEndLSN() != endLSN)
+    {
+        cerr << "*** An image was logged for a change already logged\n";
+        status = FAIL;
+    }
+
+    endLSN = MINIBASE_LOG->GetEndLSN();
+    step = 2;
+    other.join();
+    if (otherStatus != OK)
+        status = FAIL;
+    else if (MINIBASE_LOG->GetEndLSN() == endLSN)
+    {
+        cerr << "*** No image was logged for a change no record covers\n";
+        status = FAIL;
+    }
+
+    // A pinned page is being changed; its bytes are not written.
+
+    if (status == OK)
+    {
+        cout << "  - Flush the pool with the page pinned and changed\n";
+        status = MINIBASE_BM->PinPage(pid, page);
+    }
+    if (status == OK)
+    {
+        memset((char *)page, 'y', MINIBASE_PAGESIZE);
+        if (MINIBASE_BM->FlushAllPages() == OK)
+        {
+            cerr << "*** Flushing the pool ignored a pinned page\n";
+            status = FAIL;
+        }
+        else if (!MINIBASE_BM->IsResident(pid))
+        {
+            cerr << "*** The pinned page was dropped from the pool\n";
+            status = FAIL;
+        }
+        minibase_errors.clear_errors();
+
+        Page onDisk;
+        if (status == OK && MINIBASE_DB->ReadPage(pid, &onDisk) == OK
+            && memcmp(&onDisk, page, MINIBASE_PAGESIZE) == 0)
+        {
+            cerr << "*** The pinned page was written\n";
+            status = FAIL;
+        }
+        minibase_errors.clear_errors();
+
+        memset((char *)page, 0, MINIBASE_PAGESIZE);
+        if (MINIBASE_BM->UnpinPage(pid, CLEAN) != OK)
+            status = FAIL;
+    }
+    if (status == OK)
+        status = MINIBASE_BM->FreePage(pid);
+
+    if (status == OK)
+        cout << "  Test 30 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//------------------------------------------------------------------
+// HeapDriver::Test31
+//
+// A process inserts into and deletes from a heap file with a hash and
+// a B+-tree index attached, writes everything out and crashes without
+// committing.  Restart undoes the changes in the file; the indexes,
+// written out with the changes in them, are stale and rebuilt when
+// attached again.
+//------------------------------------------------------------------
+
+bool HeapDriver::Test31()
+{
+    cout << "\n  Test 31: Indexes after a crash\n";
+    Status status = OK;
+    vector<RecordID> rids(INDEXED_RECORDS);
+    char rec[MAX_SPACE];
+
+    // The indexes come first: the file takes what free pages there are
+    // for its extent.
+
+    cout << "  - Insert " << INDEXED_RECORDS << " indexed records and commit\n";
+    {
+        HashIndex hash("file_31.hash", 0, attrInteger, sizeof(int), status);
+        BTreeIndex tree("file_31.tree", 0, attrInteger, sizeof(int), status);
+        HeapFile f("file_31", status);
+        if ( status == OK )
+            status = f.AttachIndex(&hash);
+        if ( status == OK )
+            status = f.AttachIndex(&tree);
+        for (int i = 0; i < INDEXED_RECORDS && status == OK; i++)
+        {
+            FillRecord(rec, i, INDEXED_LEN);
+            status = f.InsertRecord(rec, INDEXED_LEN, rids[i]);
+        }
+    }
+    if ( status == OK )
+        status = MINIBASE_LOG->Commit();
+    if ( status != OK )
+        return false;
+
+    cout << "  - Delete some, insert more, write everything out, and crash\n";
+    cout.flush();
+
+    pid_t child = fork();
+    if ( child == 0 )
+    {
+        {
+            HashIndex hash("file_31.hash", 0, attrInteger, sizeof(int), status);
+            BTreeIndex tree("file_31.tree", 0, attrInteger, sizeof(int), status);
+            HeapFile f("file_31", status);
+            if ( status == OK )
+                status = f.AttachIndex(&hash);
+            if ( status == OK )
+                status = f.AttachIndex(&tree);
+            for (int i = 0; i < INDEXED_RECORDS && status == OK; i += 3)
+                status = f.DeleteRecord(rids[i]);
+            for (int i = INDEXED_RECORDS; i < INDEXED_RECORDS + INDEXED_RECORDS/4 && status == OK; i++)
+            {
+                RecordID rid;
+                FillRecord(rec, i, INDEXED_LEN);
+                status = f.InsertRecord(rec, INDEXED_LEN, rid);
+            }
+        }
+        if ( status == OK )
+            status = MINIBASE_BM->FlushAllPages();
+        _exit(status == OK ? 0 : 1);
+    }
+
+    int childStatus;
+    if ( child < 0 || waitpid(child, &childStatus, 0) != child ||
+         !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0 )
+    {
+        cerr << "*** The crashing process failed before it crashed\n";
+        return false;
+    }
+
+    delete minibase_globals;
+    minibase_globals = NULL;
+
+    cout << "  - Restart and look every key up\n";
+    status = Restart(31);
+    if ( status != OK )
+        cerr << "*** The indexes are not in step with the file\n";
+
+    // Reopen even if the restart failed, for the tests that follow.
+
+    Status reopened;
+    minibase_globals = new SystemDefs(reopened, "MINIBASE.DB", "MINIBASE.LOG", 0, 500, 100, "Clock");
+    if ( reopened != OK )
+    {
+        cerr << "*** Error reopening the database\n";
+        status = FAIL;
+    }
+    if ( status == OK )
+        status = CheckIndexesRecovered(false);
+    if ( status == OK )
+    {
+        HeapFile f("file_31", status);
+        HashIndex hash("file_31.hash", 0, attrInteger, sizeof(int), status);
+        BTreeIndex tree("file_31.tree", 0, attrInteger, sizeof(int), status);
+        if ( status == OK )
+            status = hash.DeleteFile();
+        if ( status == OK )
+            status = tree.DeleteFile();
+        if ( status == OK )
+            status = f.DeleteFile();
+        if ( status == OK )
+            status = MINIBASE_LOG->Commit();
+    }
+
+    if ( status == OK )
+        cout << "  Test 31 completed successfully.\n";
+    return (status == OK);
+}
+
+
+//------------------------------------------------------------------
+// HeapDriver::Test32
+//
+// A process updates, deletes and inserts versioned records in one
+// transaction, and crashes while it runs, after another transaction
+// has committed and so made its changes durable.  Restart takes the
+// transaction to have aborted: no snapshot sees its versions, and the
+// records it changed can be changed again.
+//------------------------------------------------------------------
+
+bool HeapDriver::Test32()
+{
+    cout << "\n  Test 32: Transactions running at a crash\n";
+    Status status = OK;
+    vector<RecordID> rids(CRASHED_RECORDS);
+    TxnID txn;
+
+    cout << "  - Insert " << CRASHED_RECORDS << " records and commit\n";
+    {
+        HeapFile f("file_32", status);
+        if ( status == OK )
+            status = MINIBASE_TXN->Begin(txn);
+        for (int i = 0; i < CRASHED_RECORDS && status == OK; i++)
+        {
+            Rec rec = { i, i * 2.5 };
+            sprintf(rec.name, "record %i", i);
+            status = f.InsertRecord(txn, (char *)&rec, reclen, rids[i]);
+        }
+        if ( status == OK )
+            status = MINIBASE_TXN->Commit(txn);
+    }
+    if ( status != OK )
+        return false;
+
+    cout << "  - Change records, let another transaction commit, and crash\n";
+    cout.flush();
+
+    pid_t child = fork();
+    if ( child == 0 )
+    {
+        {
+            HeapFile f("file_32", status);
+            TxnID crashed, committed;
+            RecordID rid;
+            if ( status == OK )
+                status = MINIBASE_TXN->Begin(crashed);
+            for (int i = 0; i < CRASHED_RECORDS / 4 && status == OK; i++)
+            {
+                Rec rec = { 100 + i, 0 };
+                sprintf(rec.name, "crashed %i", i);
+                status = f.UpdateRecord(crashed, rids[i], (char *)&rec, reclen);
+                if ( status == OK )
+                    status = f.DeleteRecord(crashed, rids[CRASHED_RECORDS / 4 + i]);
+                if ( status == OK )
+                    status = f.InsertRecord(crashed, (char *)&rec, reclen, rid);
+            }
+
+            Rec rec = { CRASHED_RECORDS, 0 };
+            sprintf(rec.name, "committed");
+            if ( status == OK )
+                status = MINIBASE_TXN->Begin(committed);
+            if ( status == OK )
+                status = f.InsertRecord(committed, (char *)&rec, reclen, rid);
+            if ( status == OK )
+                status = MINIBASE_TXN->Commit(committed);
+
+            // The checkpoint settles the run below the one still running,
+            // which began before the one that committed.
+            if ( status == OK )
+                status = MINIBASE_LOG->Checkpoint();
+        }
+        if ( status == OK )
+            status = MINIBASE_BM->FlushAllPages();
+        _exit(status == OK ? 0 : 1);
+    }
+
+    int childStatus;
+    if ( child < 0 || waitpid(child, &childStatus, 0) != child ||
+         !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0 )
+    {
+        cerr << "*** The crashing process failed before it crashed\n";
+        return false;
+    }
+
+    delete minibase_globals;
+    minibase_globals = NULL;
+
+    cout << "  - Restart and read the records\n";
+    status = Restart(32);
+    if ( status != OK )
+        cerr << "*** A transaction sees versions of the one that crashed\n";
+
+    // Reopen even if the restart failed, for the tests that follow.
+
+    Status reopened;
+    minibase_globals = new SystemDefs(reopened, "MINIBASE.DB", "MINIBASE.LOG", 0, 500, 100, "Clock");
+    if ( reopened != OK )
+    {
+        cerr << "*** Error reopening the database\n";
+        status = FAIL;
+    }
+    if ( status == OK )
+        status = CheckCrashedTxn();
+
+    cout << "  - Change the records the crashed transaction changed, and vacuum\n";
+    HeapFile *f = NULL;
+    if ( status == OK )
+        f = new HeapFile("file_32", status);
+    if ( status == OK )
+        status = MINIBASE_TXN->Begin(txn);
+    for (int i = 0; i < CRASHED_RECORDS / 4 && status == OK; i++)
+    {
+        Rec rec = { 100 + i, 0 };
+        sprintf(rec.name, "updated %i", i);
+        status = f->UpdateRecord(txn, rids[i], (char *)&rec, reclen);
+        if ( status == OK )
+            status = f->DeleteRecord(txn, rids[CRASHED_RECORDS / 4 + i]);
+        if ( status != OK )
+            cerr << "*** Cannot change what the crashed transaction changed\n";
+    }
+    if ( status == OK )
+        status = MINIBASE_TXN->Commit(txn);
+
+    int numOfReclaimed;
+    if ( status == OK )
+        status = f->Vacuum(numOfReclaimed);
+
+    // What is left is the records not deleted, in one version each.
+
+    int numOfLeft = CRASHED_RECORDS + 1 - CRASHED_RECORDS / 4;
+    if ( status == OK && f->GetNumOfRecords() != numOfLeft )
+    {
+        cerr << "*** " << f->GetNumOfRecords() << " versions left instead of "
+             << numOfLeft << endl;
+        status = FAIL;
+    }
+
+    map<RecordID, int> seen;
+    if ( status == OK )
+        status = MINIBASE_TXN->Begin(txn);
+    if ( status == OK )
+    {
+        status = ReadSnapshot(*f, txn, seen);
+        for (int i = 0; i < CRASHED_RECORDS && status == OK; i++)
+        {
+            bool deleted = (i >= CRASHED_RECORDS / 4 && i < CRASHED_RECORDS / 2);
+            int expected = (i < CRASHED_RECORDS / 4) ? 100 + i : i;
+            if ( deleted ? seen.count(rids[i]) != 0 : seen[rids[i]] != expected )
+            {
+                cerr << "*** Record " << rids[i] << " is not as last committed\n";
+                status = FAIL;
+            }
+        }
+        MINIBASE_TXN->Commit(txn);
+    }
+
+    if ( f != NULL )
+    {
+        if ( status == OK )
+            status = f->DeleteFile();
+        delete f;
+    }
+    if ( status == OK )
+        status = MINIBASE_LOG->Commit();
+
+    if ( status == OK )
+        cout << "  Test 32 completed successfully.\n";
+    return (status == OK);
+}
+
+
+// Inserts and deletes a record in f, committing every few times, until
+// the log has grown by at least growth bytes.
+static Status Churn(HeapFile& f, long growth)
+{
+    char rec[MAX_SPACE];
+    FillRecord(rec, KEPT_RECORDS, CHURN_LEN);
+    LSN end = MINIBASE_LOG->GetEndLSN() + growth;
+    Status status = OK;
+
+    for (int i = 0; MINIBASE_LOG->GetEndLSN() < end && status == OK; i++)
+    {
+        RecordID rid;
+        status = f.InsertRecord(rec, CHURN_LEN, rid);
+        if ( status == OK )
+            status = f.DeleteRecord(rid);
+        if ( status == OK && i % 8 == 0 )
+            status = MINIBASE_LOG->Commit();
+    }
+    if ( status == OK )
+        status = MINIBASE_LOG->Commit();
+    return status;
+}
+
+
+//------------------------------------------------------------------
+// HeapDriver::Test33
+//
+// The log grows to several times its size limit while records are
+// inserted and deleted.  A transaction left running holds on to the
+// log from where it began; once it commits, the checkpoints give back
+// the space before them, and the log takes up less than its limit.  A
+// process then commits a record and crashes, and restart finds it from
+// what the log kept.
+//------------------------------------------------------------------
+
+bool HeapDriver::Test33()
+{
+    cout << "\n  Test 33: Log space given back at checkpoints\n";
+    Status status = OK;
+    const long limit = (long)LOG_LIMIT * MINIBASE_PAGESIZE;
+
+    cout << "  - Insert and delete records while a transaction runs\n";
+    {
+        HeapFile f("file_33", status);
+        char rec[MAX_SPACE];
+        RecordID rid;
+        FillRecord(rec, 0, CHURN_LEN);
+        if ( status == OK )
+            status = f.InsertRecord(rec, CHURN_LEN, rid);
+
+        TxnID txn;
+        if ( status == OK )
+            status = MINIBASE_TXN->Begin(txn);
+        if ( status == OK )
+            status = Churn(f, 2 * limit);
+        if ( status == OK && LogSpace() < 2 * limit )
+        {
+            cerr << "*** The log takes up " << LogSpace() << " bytes, less than "
+                 << "the transaction running has written since it began\n";
+            status = FAIL;
+        }
+
+        cout << "  - Commit it and go on\n";
+        if ( status == OK )
+            status = MINIBASE_TXN->Commit(txn);
+        if ( status == OK )
+            status = Churn(f, 2 * limit);
+        if ( status == OK && LogSpace() > limit )
+        {
+            cerr << "*** The log takes up " << LogSpace() << " bytes, more than "
+                 << "its limit of " << limit << endl;
+            status = FAIL;
+        }
+    }
+    if ( status != OK )
+        return false;
+
+    cout << "  - Commit a record and crash\n";
+    cout.flush();
+
+    pid_t child = fork();
+    if ( child == 0 )
+    {
+        HeapFile f("file_33", status);
+        char rec[MAX_SPACE];
+        RecordID rid;
+        FillRecord(rec, 1, CHURN_LEN);
+        if ( status == OK )
+            status = f.InsertRecord(rec, CHURN_LEN, rid);
+        if ( status == OK )
+            status = MINIBASE_LOG->Commit();
+        _exit(status == OK ? 0 : 1);
+    }
+
+    int childStatus;
+    if ( child < 0 || waitpid(child, &childStatus, 0) != child ||
+         !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != 0 )
+    {
+        cerr << "*** The crashing process failed before it crashed\n";
+        return false;
+    }
+
+    delete minibase_globals;
+    minibase_globals = NULL;
+
+    cout << "  - Restart and read the records\n";
+    status = Restart(33);
+    if ( status != OK )
+        cerr << "*** Restart did not find what was committed\n";
+
+    // Reopen even if the restart failed, for the tests that follow.
+
+    Status reopened;
+    minibase_globals = new SystemDefs(reopened, "MINIBASE.DB", "MINIBASE.LOG", 0, LOG_LIMIT, 100,
+                                      "Clock");
+    if ( reopened != OK )
+    {
+        cerr << "*** Error reopening the database\n";
+        status = FAIL;
+    }
+    if ( status == OK )
+        status = CheckLogReclaimed();
+    if ( status == OK )
+    {
+        HeapFile f("file_33", status);
+        if ( status == OK )
+            status = f.DeleteFile();
+        if ( status == OK )
+            status = MINIBASE_LOG->Commit();
+    }
+
+    if ( status == OK )
+        cout << "  Test 33 completed successfully.\n";
+    return (status == OK);
+}
@@ -0,0 +1,289 @@
+#include <cstring>
+
+#include "index.h"
+#include "heapfile.h"
+#include "scan.h"
+#include "logmgr.h"
+
+
+//------------------------------------------------------------------
+// Constructor of Index
+//
+// Input    : keyOffset - offset of the key in a record,
+//            keyType - type of the key,
+//            keyLength - its length in bytes.
+// Output   : None.
+// Purpose  : Records where the key is; subclasses check it with
+//            KeyIsValid.  An index created now is built from now on;
+//            one opened gets when it was built from its header.
+//------------------------------------------------------------------
+
+Index::Index(int keyOffset, AttrType keyType, int keyLength)
+	: keyOffset(keyOffset), keyType(keyType), keyLength(keyLength)
+{
+	builtLSN = (MINIBASE_LOG != NULL) ? MINIBASE_LOG->GetEndLSN() : INVALID_LSN;
+}
+
+
+Index::~Index()
+{
+}
+
+
+//------------------------------------------------------------------
+// KeyIsValid
+//
+// Input    : keyOffset, keyType, keyLength - a key.
+// Output   : None.
+// Purpose  : Checks the key has a type that can be compared and a
+//            length that fits it.
+// Return   : true if it has.
+//------------------------------------------------------------------
+
+bool KeyIsValid(int keyOffset, AttrType keyType, int keyLength)
+{
+	switch (keyType)
+	{
+	case attrInteger :
+		return keyLength == sizeof(int) && keyOffset >= 0;
+	case attrReal :
+		return (keyLength == sizeof(float) || keyLength == sizeof(double))
+		       && keyOffset >= 0;
+	case attrString :
+		return keyLength > 0 && keyOffset >= 0;
+	default :
+		return false;
+	}
+}
+
+
+//------------------------------------------------------------------
+// CompareKeys
+//
+// Input    : keyType, keyLength - the type of the keys,
+//            a, b - two keys.
+// Output   : None.
+// Purpose  : Compares keys by value.  They may not be aligned.
+// Return   : Less than, equal to or greater than 0 as a is less than,
+//            equal to or greater than b.
+//------------------------------------------------------------------
+
+int CompareKeys(AttrType keyType, int keyLength, const char* a, const char* b)
+{
+	if (keyType == attrInteger)
+	{
+		int x, y;
+		memcpy(&x, a, sizeof(int));
+		memcpy(&y, b, sizeof(int));
+		return (x > y) - (x < y);
+	}
+	if (keyType == attrReal && keyLength == sizeof(double))
+	{
+		double x, y;
+		memcpy(&x, a, sizeof(double));
+		memcpy(&y, b, sizeof(double));
+		return (x > y) - (x < y);
+	}
+	if (keyType == attrReal)
+	{
+		float x, y;
+		memcpy(&x, a, sizeof(float));
+		memcpy(&y, b, sizeof(float));
+		return (x > y) - (x < y);
+	}
+	return strncmp(a, b, keyLength);
+}
+
+
+//------------------------------------------------------------------
+// HashKey
+//
+// Input    : keyType, keyLength - the type of the key,
+//            key - a key.
+// Output   : None.
+// Purpose  : Hashes a key so that keys that compare equal hash alike:
+//            a string up to its NUL, and 0 and -0 the same.  The bits
+//            are mixed with the MurmurHash3 finalizer, so that the low
+//            ones can be used on their own.
+// Return   : The hash value.
+//------------------------------------------------------------------
+
+unsigned HashKey(AttrType keyType, int keyLength, const char* key)
+{
+	unsigned h;
+
+	if (keyType == attrString)
+	{
+		h = 2166136261u;
+		for (int i = 0; i < keyLength && key[i] != '\0'; i++)
+		{
+			h ^= (unsigned char)key[i];
+			h *= 16777619u;
+		}
+	}
+	else if (keyType == attrReal && keyLength == sizeof(double))
+	{
+		double d;
+		unsigned long long bits;
+		memcpy(&d, key, sizeof(double));
+		if (d == 0)
+			d = 0;
+		memcpy(&bits, &d, sizeof(bits));
+		h = (unsigned)(bits ^ (bits >> 32));
+	}
+	else if (keyType == attrReal)
+	{
+		float f;
+		memcpy(&f, key, sizeof(float));
+		if (f == 0)
+			f = 0;
+		memcpy(&h, &f, sizeof(unsigned));
+	}
+	else
+	{
+		memcpy(&h, key, sizeof(unsigned));
+	}
+
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+	return h;
+}
+
+
+//------------------------------------------------------------------
+// Index::InsertRecord, Index::DeleteRecord
+//
+// Input    : recPtr - a record,
+//            recLen - its length,
+//            rid - its record ID.
+// Output   : None.
+// Purpose  : Adds or removes the entry of the record.
+// Return   : The status of Insert or Delete, FAIL if the record is too
+//            short to hold the key.
+//------------------------------------------------------------------
+
+Status Index::InsertRecord(const char* recPtr, int recLen, const RecordID& rid)
+{
+	if (keyOffset + keyLength > recLen)
+	{
+		cerr << "Index::InsertRecord - record " << rid << " has no key\n";
+		return FAIL;
+	}
+	return Insert(recPtr + keyOffset, rid);
+}
+
+
+Status Index::DeleteRecord(const char* recPtr, int recLen, const RecordID& rid)
+{
+	if (keyOffset + keyLength > recLen)
+	{
+		cerr << "Index::DeleteRecord - record " << rid << " has no key\n";
+		return FAIL;
+	}
+	return Delete(recPtr + keyOffset, rid);
+}
+
+
+//------------------------------------------------------------------
+// Index::UpdateRecord
+//
+// Input    : oldRecPtr, oldRecLen - the record before the update,
+//            newRecPtr, newRecLen - the record after it,
+//            rid - their record ID.
+// Output   : None.
+// Purpose  : Moves the entry of the record to its new key, if the key
+//            changed.  A missing old entry is not an error.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status Index::UpdateRecord(const char* oldRecPtr, int oldRecLen,
+                           const char* newRecPtr, int newRecLen, const RecordID& rid)
+{
+	if (keyOffset + keyLength > oldRecLen || keyOffset + keyLength > newRecLen)
+	{
+		cerr << "Index::UpdateRecord - record " << rid << " has no key\n";
+		return FAIL;
+	}
+	if (CompareKeys(oldRecPtr + keyOffset, newRecPtr + keyOffset) == 0)
+		return OK;
+
+	if (Delete(oldRecPtr + keyOffset, rid) == FAIL)
+		return FAIL;
+	return Insert(newRecPtr + keyOffset, rid);
+}
+
+
+//------------------------------------------------------------------
+// Index::Build
+//
+// Input    : file - the heap file to index.
+// Output   : None.
+// Purpose  : Scans the file and adds the entry of every record.  The
+//            index should be empty.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status Index::Build(HeapFile& file)
+{
+	Status status;
+	Scan *scan = file.OpenScan(status);
+	if (status != OK)
+		return status;
+
+	char rec[MAX_SPACE];
+	RecordID rid;
+	int len;
+
+	while ((status = scan->GetNext(rid, rec, len)) == OK)
+	{
+		status = InsertRecord(rec, len, rid);
+		if (status != OK)
+			break;
+	}
+	delete scan;
+
+	return (status == DONE) ? OK : status;
+}
+
+
+//------------------------------------------------------------------
+// Index::IsStale
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Tells whether restart has redone or undone changes since
+//            the index was created or last rebuilt.  Index changes are
+//            not logged record by record, so such an index may point to
+//            records that are gone and miss others (see RecoveryMgr).
+// Return   : True if the index must be rebuilt before it is used.
+//------------------------------------------------------------------
+
+bool Index::IsStale()
+{
+	return MINIBASE_LOG != NULL && builtLSN < MINIBASE_LOG->GetRecoveredLSN();
+}
+
+
+//------------------------------------------------------------------
+// Index::Rebuild
+//
+// Input    : file - the heap file the index is on.
+// Output   : None.
+// Purpose  : Empties the index and builds it again from the records of
+//            the file, which leaves it no longer stale.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status Index::Rebuild(HeapFile& file)
+{
+	if (MINIBASE_LOG != NULL)
+		builtLSN = MINIBASE_LOG->GetEndLSN();
+
+	Status status = Clear();
+	if (status == OK)
+		status = Build(file);
+	return status;
+}
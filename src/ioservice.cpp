@@ -0,0 +1,395 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+
+#include "ioservice.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define HAVE_IO_URING
+#endif
+#endif
+#endif
+
+using namespace std;
+
+
+IOService::IOService(int numOfThreads)
+	: numOfRunning(0), stopping(false), ringFd(-1), numOfReads(0),
+	  numOfInKernel(0), queueDepth(IO_QUEUE_DEPTH)
+{
+	for (int i = 0; i < numOfThreads; i++)
+		threads.push_back(std::thread(&IOService::Run, this));
+
+	if (SetUpRing())
+		reaper = std::thread(&IOService::Reap, this);
+}
+
+
+IOService::~IOService()
+{
+	Drain();
+
+#ifdef HAVE_IO_URING
+	if (ringFd >= 0)
+	{
+		// A no-op that carries no read tells the reaper to stop.
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			unsigned tail = *sqTail;
+			struct io_uring_sqe *sqe = &((struct io_uring_sqe *)sqes)[tail & *sqMask];
+			memset(sqe, 0, sizeof(*sqe));
+			sqe->opcode = IORING_OP_NOP;
+			sqArray[tail & *sqMask] = tail & *sqMask;
+			__atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+			syscall(__NR_io_uring_enter, ringFd, 1, 0, 0, NULL, 0);
+		}
+		reaper.join();
+
+		munmap(sqes, sqesSize);
+		if (cqRing != sqRing)
+			munmap(cqRing, cqRingSize);
+		munmap(sqRing, sqRingSize);
+		close(ringFd);
+	}
+#endif
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	ready.notify_all();
+
+	for (size_t i = 0; i < threads.size(); i++)
+		threads[i].join();
+}
+
+
+void IOService::Submit(const std::function<void ()>& work)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push_back(work);
+	}
+	ready.notify_one();
+}
+
+
+//------------------------------------------------------------------
+// IOService::Read
+//
+// Input    : fd, len, offset - what to read, as for pread,
+//            done - called with the outcome.
+// Output   : buf - the bytes read, once done is called.
+// Purpose  : Queues the read for the ring, which takes it as soon as
+//            fewer reads than the queue depth are under way, or hands
+//            it to the threads if there is no ring.
+// Return   : None.
+//------------------------------------------------------------------
+
+void IOService::Read(int fd, void* buf, size_t len, off_t offset, const IOCallback& done)
+{
+	if (ringFd < 0)
+	{
+		Submit([fd, buf, len, offset, done]() {
+			done(pread(fd, buf, len, offset));
+		});
+		return;
+	}
+
+	PendingRead *read = new PendingRead;
+	read->fd = fd;
+	read->iov.iov_base = buf;
+	read->iov.iov_len = len;
+	read->offset = offset;
+	read->done = done;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	numOfReads++;
+	waiting.push_back(read);
+	StartReads();
+}
+
+
+void IOService::SetQueueDepth(int depth)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (depth < 1)
+		depth = 1;
+	if (depth > IO_MAX_QUEUE_DEPTH)
+		depth = IO_MAX_QUEUE_DEPTH;
+	queueDepth = depth;
+
+	if (ringFd >= 0)
+		StartReads();
+}
+
+
+int IOService::GetQueueDepth()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return (ringFd >= 0) ? queueDepth : (int)threads.size();
+}
+
+
+void IOService::Drain()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!queue.empty() || numOfRunning > 0 || numOfReads > 0)
+		idle.wait(lock);
+}
+
+
+//------------------------------------------------------------------
+// IOService::Run
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Runs the work handed over, oldest first, until the
+//            service stops and none is left.
+// Return   : None.
+//------------------------------------------------------------------
+
+void IOService::Run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	for (;;)
+	{
+		while (queue.empty() && !stopping)
+			ready.wait(lock);
+		if (queue.empty())
+			return;
+
+		std::function<void ()> work = queue.front();
+		queue.pop_front();
+		numOfRunning++;
+
+		lock.unlock();
+		work();
+		lock.lock();
+
+		numOfRunning--;
+		if (queue.empty() && numOfRunning == 0 && numOfReads == 0)
+			idle.notify_all();
+	}
+}
+
+
+//------------------------------------------------------------------
+// IOService::SetUpRing
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Sets up an io_uring of IO_MAX_QUEUE_DEPTH entries and
+//            maps its queues.
+// Return   : True on success, false if the kernel offers none.
+//------------------------------------------------------------------
+
+bool IOService::SetUpRing()
+{
+#ifdef HAVE_IO_URING
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	int fd = syscall(__NR_io_uring_setup, IO_MAX_QUEUE_DEPTH, &params);
+	if (fd < 0)
+		return false;
+
+	sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	// Newer kernels map both queues at once.
+	bool single = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+	single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+	if (single && cqRingSize > sqRingSize)
+		sqRingSize = cqRingSize;
+
+	sqRing = mmap(NULL, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+	              fd, IORING_OFF_SQ_RING);
+	cqRing = single ? sqRing
+	                : mmap(NULL, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+	                       fd, IORING_OFF_CQ_RING);
+	sqes = mmap(NULL, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+	            fd, IORING_OFF_SQES);
+
+	if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqes == MAP_FAILED)
+	{
+		if (sqes != MAP_FAILED)
+			munmap(sqes, sqesSize);
+		if (cqRing != MAP_FAILED && cqRing != sqRing)
+			munmap(cqRing, cqRingSize);
+		if (sqRing != MAP_FAILED)
+			munmap(sqRing, sqRingSize);
+		close(fd);
+		return false;
+	}
+
+	char *sq = (char *)sqRing;
+	char *cq = (char *)cqRing;
+	sqHead = (unsigned *)(sq + params.sq_off.head);
+	sqTail = (unsigned *)(sq + params.sq_off.tail);
+	sqMask = (unsigned *)(sq + params.sq_off.ring_mask);
+	sqArray = (unsigned *)(sq + params.sq_off.array);
+	cqHead = (unsigned *)(cq + params.cq_off.head);
+	cqTail = (unsigned *)(cq + params.cq_off.tail);
+	cqMask = (unsigned *)(cq + params.cq_off.ring_mask);
+	cqes = cq + params.cq_off.cqes;
+	ringEntries = params.sq_entries;
+
+	ringFd = fd;
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+//------------------------------------------------------------------
+// IOService::StartReads
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Moves reads queued for the ring into it, as many as the
+//            queue depth leaves room for, and submits them in one
+//            call.  Reads the kernel does not take are handed to the
+//            threads.  The mutex is held.
+// Return   : None.
+//------------------------------------------------------------------
+
+void IOService::StartReads()
+{
+#ifdef HAVE_IO_URING
+	unsigned tail = *sqTail;
+	int numOfStarted = 0;
+
+	while (!waiting.empty() && numOfInKernel < queueDepth
+	       && numOfInKernel < (int)ringEntries)
+	{
+		PendingRead *read = waiting.front();
+		waiting.pop_front();
+
+		unsigned index = tail & *sqMask;
+		struct io_uring_sqe *sqe = &((struct io_uring_sqe *)sqes)[index];
+		memset(sqe, 0, sizeof(*sqe));
+		sqe->opcode = IORING_OP_READV;
+		sqe->fd = read->fd;
+		sqe->addr = (unsigned long)&read->iov;
+		sqe->len = 1;
+		sqe->off = read->offset;
+		sqe->user_data = (unsigned long)read;
+		sqArray[index] = index;
+
+		tail++;
+		numOfStarted++;
+		numOfInKernel++;
+	}
+	if (numOfStarted == 0)
+		return;
+
+	__atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+	unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+	long numOfSubmitted = syscall(__NR_io_uring_enter, ringFd, tail - head, 0, 0, NULL, 0);
+	if (numOfSubmitted == (long)(tail - head))
+		return;
+	if (numOfSubmitted < 0)
+		cerr << "IOService::StartReads - cannot submit reads: " << strerror(errno) << endl;
+
+	// The kernel takes entries only here, with the mutex held, so those
+	// from its head on are the ones it did not take.  Take them back out
+	// of the ring and make those reads with pread on the threads instead,
+	// so that each still completes.
+	head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+	for (unsigned i = head; i != tail; i++)
+	{
+		struct io_uring_sqe *sqe = &((struct io_uring_sqe *)sqes)[i & *sqMask];
+		PendingRead *read = (PendingRead *)sqe->user_data;
+		numOfInKernel--;
+
+		queue.push_back([this, read]() {
+			read->done(pread(read->fd, read->iov.iov_base, read->iov.iov_len, read->offset));
+			delete read;
+
+			// Run tells Drain once this is done.
+			std::lock_guard<std::mutex> lock(mutex);
+			numOfReads--;
+		});
+		ready.notify_one();
+	}
+	__atomic_store_n(sqTail, head, __ATOMIC_RELEASE);
+#endif
+}
+
+
+//------------------------------------------------------------------
+// IOService::Reap
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Waits for reads in the ring to complete, calls their
+//            callbacks and starts the reads queued behind them, until
+//            the no-op the destructor submits completes.
+// Return   : None.
+//------------------------------------------------------------------
+
+void IOService::Reap()
+{
+#ifdef HAVE_IO_URING
+	std::vector<std::pair<PendingRead*, ssize_t> > completed;
+	bool stop = false;
+
+	while (!stop)
+	{
+		if (syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0
+		    && errno != EINTR)
+			cerr << "IOService::Reap - cannot wait for reads: " << strerror(errno) << endl;
+
+		// The reads were queued with the mutex held; taking it here too
+		// orders what their callers wrote before what the callbacks read,
+		// where tools that do not see into the kernel can tell.
+
+		completed.clear();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			unsigned head = *cqHead;
+			unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+			for (; head != tail; head++)
+			{
+				struct io_uring_cqe *cqe = &((struct io_uring_cqe *)cqes)[head & *cqMask];
+				if (cqe->user_data == 0)
+					stop = true;
+				else
+					completed.push_back(std::make_pair((PendingRead *)cqe->user_data,
+					                                   (ssize_t)(cqe->res < 0 ? -1 : cqe->res)));
+			}
+			__atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+		}
+
+		// The callbacks run here, so that a read completes however busy
+		// the threads are; they hand anything that may wait to them.
+
+		for (size_t i = 0; i < completed.size(); i++)
+		{
+			completed[i].first->done(completed[i].second);
+			delete completed[i].first;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		numOfInKernel -= completed.size();
+		numOfReads -= completed.size();
+		StartReads();
+		if (queue.empty() && numOfRunning == 0 && numOfReads == 0)
+			idle.notify_all();
+	}
+#endif
+}
+
@@ -0,0 +1,548 @@
+#include <algorithm>
+#include <cstring>
+
+#include "join.h"
+#include "index.h"
+#include "heapfile.h"
+#include "scan.h"
+#include "bufmgr.h"
+
+
+//
+// Reads an input of a hash join: a heap file through a Scan, or a
+// partition through a frame, which keeps the partition for the caller to
+// free.
+//
+class JoinInput
+{
+public:
+
+	JoinInput(HeapFile* file, SpillRun* run, Page* frame)
+		: file(file), scan(NULL), reader(frame, run, false), started(false) {}
+	~JoinInput() { delete scan; }
+
+	// recPtr is valid until the next call; DONE after the last record.
+	Status Next(char*& recPtr, int& recLen);
+
+private:
+
+	HeapFile    *file;
+	Scan        *scan;
+	SpillReader reader;
+	bool        started;
+	char        rec[MAX_SPACE];
+};
+
+
+//
+// Reads an input of a sort-merge join, checking it is in order of key.
+//
+class MergeInput
+{
+public:
+
+	MergeInput(HeapFile& file, const JoinKey& key)
+		: recLen(0), file(file), key(key), scan(NULL), hasLast(false),
+		  lastKey(key.keyLength) {}
+	~MergeInput() { delete scan; }
+
+	// Reads the next record into rec; DONE after the last, FAIL if it has
+	// no key or its key is less than the one before.
+	Status Next();
+	const char *Key() { return rec + key.keyOffset; }
+
+	char rec[MAX_SPACE];
+	int  recLen;
+
+private:
+
+	HeapFile          &file;
+	JoinKey           key;
+	Scan              *scan;
+	bool              hasLast;
+	std::vector<char> lastKey;
+};
+
+
+static bool KeysAreValid(const JoinKey& a, const JoinKey& b, const char* join)
+{
+	if (KeyIsValid(a.keyOffset, a.keyType, a.keyLength)
+	    && KeyIsValid(b.keyOffset, b.keyType, b.keyLength)
+	    && a.keyType == b.keyType && a.keyLength == b.keyLength)
+		return true;
+
+	cerr << join << "::Run - cannot join on the keys\n";
+	return false;
+}
+
+
+static bool HasKey(const JoinKey& key, int recLen, const char* join)
+{
+	if (key.keyOffset + key.keyLength <= recLen)
+		return true;
+
+	cerr << join << "::Run - a record has no key\n";
+	return false;
+}
+
+
+//------------------------------------------------------------------
+// LevelHash
+//
+// Input    : key - the key of the record,
+//            recPtr - a record,
+//            seed - picks one of a family of hash functions.
+// Output   : None.
+// Purpose  : Hashes the key of the record with HashKey and mixes in the
+//            seed, so that each level of a hash join, and its table,
+//            splits keys independently of the level above.
+// Return   : The hash value.
+//------------------------------------------------------------------
+
+static unsigned LevelHash(const JoinKey& key, const char* recPtr, unsigned seed)
+{
+	unsigned h = HashKey(key.keyType, key.keyLength, recPtr + key.keyOffset);
+
+	h ^= seed * 0x9e3779b9u;
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+	return h;
+}
+
+
+//------------------------------------------------------------------
+// AppendTo
+//
+// Input    : result - a heap file.
+// Output   : None.
+// Purpose  : Makes a callback that appends each pair to result as one
+//            record, the left record followed by the right.
+// Return   : The callback.
+//------------------------------------------------------------------
+
+static JoinCallback AppendTo(HeapFile& result)
+{
+	return [&result](const char* leftRec, int leftLen,
+	                 const char* rightRec, int rightLen) -> Status
+	{
+		if (leftLen + rightLen > MAX_SPACE - 1)
+		{
+			cerr << "Join - a joined record is larger than a page\n";
+			return FAIL;
+		}
+
+		char rec[MAX_SPACE];
+		RecordID rid;
+		memcpy(rec, leftRec, leftLen);
+		memcpy(rec + leftLen, rightRec, rightLen);
+		return result.AppendRecord(rec, leftLen + rightLen, rid);
+	};
+}
+
+
+Status JoinInput::Next(char*& recPtr, int& recLen)
+{
+	Status status = OK;
+
+	if (file != NULL)
+	{
+		if (scan == NULL)
+		{
+			scan = file->OpenScan(status);
+			if (status != OK)
+				return status;
+		}
+
+		RecordID rid;
+		recPtr = rec;
+		return scan->GetNext(rid, rec, recLen);
+	}
+
+	status = started ? reader.Advance() : reader.Start();
+	started = true;
+	if (status != OK)
+		return status;
+	if (reader.done)
+		return DONE;
+
+	recPtr = reader.recPtr;
+	recLen = reader.recLen;
+	return OK;
+}
+
+
+Status MergeInput::Next()
+{
+	Status status = OK;
+
+	if (scan == NULL)
+	{
+		scan = file.OpenScan(status);
+		if (status != OK)
+			return status;
+	}
+	else
+	{
+		memcpy(&lastKey[0], Key(), key.keyLength);
+		hasLast = true;
+	}
+
+	RecordID rid;
+	status = scan->GetNext(rid, rec, recLen);
+	if (status != OK)
+		return status;
+
+	if (!HasKey(key, recLen, "SortMergeJoin"))
+		return FAIL;
+	if (hasLast && CompareKeys(key.keyType, key.keyLength, Key(), &lastKey[0]) < 0)
+	{
+		cerr << "SortMergeJoin::Run - record " << rid << " is out of order\n";
+		return FAIL;
+	}
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// Constructor of HashJoin
+//
+// Input    : buildKey - the key of the input loaded into memory,
+//            probeKey - the key of the input scanned against it,
+//            numOfFrames - frames of the buffer pool to join in.
+// Output   : None.
+// Purpose  : Records the keys; Run checks them.
+//------------------------------------------------------------------
+
+HashJoin::HashJoin(const JoinKey& buildKey, const JoinKey& probeKey, int numOfFrames)
+	: buildKey(buildKey), probeKey(probeKey), numOfFrames(numOfFrames),
+	  numOfPartitions(0), depth(0)
+{
+}
+
+
+//------------------------------------------------------------------
+// HashJoin::Run
+//
+// Input    : build, probe - the inputs.
+// Output   : emit - gets each pair, or
+//            result - gets each pair appended as one record.
+// Purpose  : Takes the frames of the join from the buffer pool, joins
+//            the inputs, and gives the frames back.
+// Return   : OK on success, FAIL if the keys or the memory are invalid,
+//            the pool has too few unpinned frames, a record has no key,
+//            or I/O fails; what emit returns if not OK.
+//------------------------------------------------------------------
+
+Status HashJoin::Run(HeapFile& build, HeapFile& probe, const JoinCallback& emit)
+{
+	numOfPartitions = depth = 0;
+
+	if (!KeysAreValid(buildKey, probeKey, "HashJoin"))
+		return FAIL;
+	if (numOfFrames < 3)
+	{
+		cerr << "HashJoin::Run - needs at least 3 frames\n";
+		return FAIL;
+	}
+	if (MINIBASE_BM->GetWorkFrames(numOfFrames, frames) != OK)
+	{
+		cerr << "HashJoin::Run - the pool has not " << numOfFrames
+		     << " unpinned frames\n";
+		return FAIL;
+	}
+
+	Status status = Join(&build, NULL, &probe, NULL, 0, emit);
+
+	space.Release();
+	MINIBASE_BM->ReleaseWorkFrames(frames);
+	return status;
+}
+
+
+Status HashJoin::Run(HeapFile& build, HeapFile& probe, HeapFile& result)
+{
+	return Run(build, probe, AppendTo(result));
+}
+
+
+//------------------------------------------------------------------
+// HashJoin::Join
+//
+// Input    : buildFile or buildRun - the build input, a file or a
+//            partition,
+//            probeFile or probeRun - the probe input likewise,
+//            level - levels of partitioning above the inputs,
+//            emit - gets each pair.
+// Output   : None.
+// Purpose  : Joins one pair of inputs.  The build input is loaded into
+//            all frames but the last two, which read the inputs, and put
+//            in a table chained by hash; each probe record looks its key
+//            up there.  A build input that overflows the frames is
+//            partitioned, with its probe input, and each pair of
+//            partitions joined a level down; below HASH_JOIN_MAX_DEPTH
+//            the probe input is scanned once per frameful instead.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status HashJoin::Join(HeapFile* buildFile, SpillRun* buildRun, HeapFile* probeFile,
+                      SpillRun* probeRun, int level, const JoinCallback& emit)
+{
+	depth = std::max(depth, level);
+
+	int arenaFrames = numOfFrames - 2;
+	bool spill = false;
+	Status status;
+	{
+		JoinInput build(buildFile, buildRun, frames[numOfFrames - 2]);
+		std::vector<JoinRecord> recs;
+		std::vector<int> buckets;
+		char *recPtr;
+		int recLen;
+
+		status = build.Next(recPtr, recLen);
+		while (status == OK)
+		{
+			// Load as much of the build input as the frames hold; a record
+			// that does not fit is left in the reader for the next frameful.
+
+			int frame = 0, used = 0;
+			recs.clear();
+			while (status == OK)
+			{
+				if (!HasKey(buildKey, recLen, "HashJoin"))
+					return FAIL;
+				if (used + recLen > (int)sizeof(Page))
+				{
+					frame++;
+					used = 0;
+				}
+				if (frame == arenaFrames)
+					break;
+
+				JoinRecord rec = { (char*)frames[frame] + used, recLen, -1 };
+				memcpy(rec.recPtr, recPtr, recLen);
+				recs.push_back(rec);
+				used += recLen;
+
+				status = build.Next(recPtr, recLen);
+			}
+			if (status != OK && status != DONE)
+				return status;
+
+			if (status == OK && level < HASH_JOIN_MAX_DEPTH)
+			{
+				spill = true;
+				break;
+			}
+
+			size_t numOfBuckets = 1;
+			while (numOfBuckets < recs.size())
+				numOfBuckets *= 2;
+			buckets.assign(numOfBuckets, -1);
+
+			for (size_t i = 0; i < recs.size(); i++)
+			{
+				unsigned b = LevelHash(buildKey, recs[i].recPtr, 2 * level + 1)
+				             & (numOfBuckets - 1);
+				recs[i].next = buckets[b];
+				buckets[b] = i;
+			}
+
+			JoinInput probe(probeFile, probeRun, frames[numOfFrames - 1]);
+			char *probePtr;
+			int probeLen;
+			Status probeStatus;
+
+			while ((probeStatus = probe.Next(probePtr, probeLen)) == OK)
+			{
+				if (!HasKey(probeKey, probeLen, "HashJoin"))
+					return FAIL;
+
+				const char *key = probePtr + probeKey.keyOffset;
+				unsigned b = LevelHash(probeKey, probePtr, 2 * level + 1)
+				             & (numOfBuckets - 1);
+
+				for (int i = buckets[b]; i != -1; i = recs[i].next)
+				{
+					if (CompareKeys(buildKey.keyType, buildKey.keyLength,
+					                recs[i].recPtr + buildKey.keyOffset, key) != 0)
+						continue;
+
+					probeStatus = emit(recs[i].recPtr, recs[i].recLen, probePtr, probeLen);
+					if (probeStatus != OK)
+						return probeStatus;
+				}
+			}
+			if (probeStatus != DONE)
+				return probeStatus;
+		}
+	}
+
+	if (!spill)
+		return (status == DONE) ? OK : status;
+
+	// The build input does not fit: split both inputs alike and join the
+	// pairs of partitions one at a time.
+
+	int numOfParts = numOfFrames - 1;
+	std::vector<SpillRun> buildParts(numOfParts);
+	std::vector<SpillRun> probeParts(numOfParts);
+
+	status = Partition(buildFile, buildRun, buildKey, level, buildParts);
+	if (status == OK)
+		status = Partition(probeFile, probeRun, probeKey, level, probeParts);
+	numOfPartitions += numOfParts;
+
+	for (int i = 0; i < numOfParts; i++)
+	{
+		if (status == OK && !buildParts[i].pages.empty() && !probeParts[i].pages.empty())
+			status = Join(NULL, &buildParts[i], NULL, &probeParts[i], level + 1, emit);
+		buildParts[i].Free();
+		probeParts[i].Free();
+	}
+
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// HashJoin::Partition
+//
+// Input    : file or run - an input, a file or a partition,
+//            key - its key,
+//            level - levels of partitioning above it.
+// Output   : parts - the partitions, as many as there are.
+// Purpose  : Spills each record to the partition its key hashes to,
+//            writing each partition through a frame of its own.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status HashJoin::Partition(HeapFile* file, SpillRun* run, const JoinKey& key,
+                           int level, std::vector<SpillRun>& parts)
+{
+	Status status = OK;
+	int numOfParts = parts.size();
+
+	std::vector<SpillWriter> writers;
+	for (int i = 0; i < numOfParts; i++)
+	{
+		writers.push_back(SpillWriter(space, frames[i]));
+		if (status == OK)
+			status = writers[i].Begin(&parts[i]);
+	}
+
+	JoinInput in(file, run, frames[numOfFrames - 1]);
+	char *recPtr;
+	int recLen;
+
+	while (status == OK && (status = in.Next(recPtr, recLen)) == OK)
+	{
+		if (!HasKey(key, recLen, "HashJoin"))
+		{
+			status = FAIL;
+			break;
+		}
+		status = writers[LevelHash(key, recPtr, 2 * level) % numOfParts].Append(recPtr, recLen);
+	}
+	if (status == DONE)
+		status = OK;
+
+	for (int i = 0; i < numOfParts; i++)
+	{
+		Status endStatus = writers[i].End();
+		if (status == OK)
+			status = endStatus;
+	}
+	return status;
+}
+
+
+SortMergeJoin::SortMergeJoin(const JoinKey& leftKey, const JoinKey& rightKey)
+	: leftKey(leftKey), rightKey(rightKey)
+{
+}
+
+
+//------------------------------------------------------------------
+// SortMergeJoin::Run
+//
+// Input    : left, right - the inputs, in ascending order of key.
+// Output   : emit - gets each pair, or
+//            result - gets each pair appended as one record.
+// Purpose  : Scans both inputs in step.  When the keys meet, holds the
+//            right records with that key and joins each left record
+//            with that key with all of them.
+// Return   : OK on success, FAIL if the keys are invalid, a record has
+//            no key, an input is out of order, or I/O fails; what emit
+//            returns if not OK.
+//------------------------------------------------------------------
+
+Status SortMergeJoin::Run(HeapFile& left, HeapFile& right, const JoinCallback& emit)
+{
+	if (!KeysAreValid(leftKey, rightKey, "SortMergeJoin"))
+		return FAIL;
+
+	MergeInput l(left, leftKey), r(right, rightKey);
+	AttrType keyType = leftKey.keyType;
+	int keyLength = leftKey.keyLength;
+
+	std::vector<char> key(keyLength);
+	std::vector<char> group;
+	std::vector<int>  groupLens;
+
+	Status leftStatus = l.Next();
+	Status rightStatus = r.Next();
+
+	while (leftStatus == OK && rightStatus == OK)
+	{
+		int c = CompareKeys(keyType, keyLength, l.Key(), r.Key());
+		if (c < 0)
+		{
+			leftStatus = l.Next();
+			continue;
+		}
+		if (c > 0)
+		{
+			rightStatus = r.Next();
+			continue;
+		}
+
+		memcpy(&key[0], r.Key(), keyLength);
+		group.clear();
+		groupLens.clear();
+		while (rightStatus == OK && CompareKeys(keyType, keyLength, r.Key(), &key[0]) == 0)
+		{
+			group.insert(group.end(), r.rec, r.rec + r.recLen);
+			groupLens.push_back(r.recLen);
+			rightStatus = r.Next();
+		}
+
+		while (leftStatus == OK && CompareKeys(keyType, keyLength, l.Key(), &key[0]) == 0)
+		{
+			size_t offset = 0;
+			for (size_t i = 0; i < groupLens.size(); i++)
+			{
+				Status status = emit(l.rec, l.recLen, &group[offset], groupLens[i]);
+				if (status != OK)
+					return status;
+				offset += groupLens[i];
+			}
+			leftStatus = l.Next();
+		}
+	}
+
+	if (leftStatus != OK && leftStatus != DONE)
+		return leftStatus;
+	if (rightStatus != OK && rightStatus != DONE)
+		return rightStatus;
+	return OK;
+}
+
+
+Status SortMergeJoin::Run(HeapFile& left, HeapFile& right, HeapFile& result)
+{
+	return Run(left, right, AppendTo(result));
+}
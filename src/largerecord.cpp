@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cstring>
+
+#include "largerecord.h"
+#include "heappage.h"
+#include "bufmgr.h"
+#include "db.h"
+#include "logmgr.h"
+
+
+// Logs an overflow page, now complete, as an image and unpins it.
+static Status FinishPage(PageID pid, OverflowPage* page)
+{
+	MINIBASE_BM->SetPageLSN(pid, MINIBASE_LOG->LogPageImage(pid, (Page *)page));
+	UNPIN(pid, DIRTY);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// WriteOverflow
+//
+// Input    : recPtr, recLen - a record.
+// Output   : header - where the record was written.
+// Purpose  : Copies the record to overflow pages, allocated in runs
+//            of as many of the pages still needed as the database has
+//            free in a row, each run following the last if it can.
+// Return   : OK on success, FAIL otherwise; the pages taken are then
+//            given back.
+//------------------------------------------------------------------
+
+Status WriteOverflow(const char* recPtr, int recLen, LargeRecordHeader& header)
+{
+	header.length = recLen;
+	header.firstPage = INVALID_PAGE;
+	header.numOfPages = 0;
+
+	int numOfPages = (recLen + OVERFLOW_DATA_SIZE - 1) / OVERFLOW_DATA_SIZE;
+	PageID prevPid = INVALID_PAGE;
+	OverflowPage *prev = NULL;
+	int written = 0;
+
+	while (header.numOfPages < numOfPages)
+	{
+		PageID start;
+		int runSize = numOfPages - header.numOfPages;
+		PageID near = (prev == NULL) ? 0 : prevPid + 1;
+		if (MINIBASE_DB->AllocateExtent(start, runSize, near) != OK)
+		{
+			cerr << "WriteOverflow - no space for a record of " << recLen << " bytes\n";
+			break;
+		}
+
+		int i;
+		for (i = 0; i < runSize; i++)
+		{
+			PageID pid = start + i;
+			OverflowPage *page;
+			if (MINIBASE_BM->PinPage(pid, (Page *&)page, true) != OK)
+				break;
+
+			if (prev == NULL)
+				header.firstPage = pid;
+			else
+			{
+				prev->next = pid;
+				if (FinishPage(prevPid, prev) != OK)
+					return FAIL;
+			}
+			header.numOfPages++;
+
+			int n = std::min(recLen - written, OVERFLOW_DATA_SIZE);
+			page->next = INVALID_PAGE;
+			memcpy(page->data, recPtr + written, n);
+			written += n;
+			prev = page;
+			prevPid = pid;
+		}
+
+		if (i < runSize)
+		{
+			MINIBASE_DB->DeallocatePage(start + i, runSize - i);
+			break;
+		}
+	}
+
+	if (prev != NULL && FinishPage(prevPid, prev) != OK)
+		return FAIL;
+
+	if (header.numOfPages < numOfPages)
+	{
+		FreeOverflow(header);
+		return FAIL;
+	}
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// FreeOverflow
+//
+// Input    : header - a large record.
+// Output   : None.
+// Purpose  : Frees the overflow pages of the record, following the
+//            chain.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status FreeOverflow(const LargeRecordHeader& header)
+{
+	PageID pid = header.firstPage;
+
+	for (int i = 0; i < header.numOfPages && pid != INVALID_PAGE; i++)
+	{
+		OverflowPage *page;
+		PIN(pid, page);
+		PageID next = page->next;
+		UNPIN(pid, CLEAN);
+		FREEPAGE(pid);
+		pid = next;
+	}
+
+	return OK;
+}
+
+
+void LargeRecordReader::Open(const LargeRecordHeader& header)
+{
+	Close();
+	this->header = header;
+	pos = 0;
+	offset = 0;
+}
+
+
+//------------------------------------------------------------------
+// LargeRecordReader::Read
+//
+// Input    : buf, max - where to copy to, and how much at most.
+// Output   : numOfBytes - bytes copied.
+// Purpose  : Copies the record on from where the last read stopped,
+//            pinning each overflow page in turn.
+// Return   : OK if bytes were copied, DONE if the record has all been
+//            read, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status LargeRecordReader::Read(char* buf, int max, int& numOfBytes)
+{
+	numOfBytes = 0;
+	if (pos == header.length)
+		return DONE;
+
+	while (numOfBytes < max && pos < header.length)
+	{
+		if (page == NULL || offset == OVERFLOW_DATA_SIZE)
+		{
+			PageID next = (page == NULL) ? header.firstPage : page->next;
+			Close();
+			PIN(next, page);
+			pid = next;
+			offset = 0;
+		}
+
+		int n = std::min(std::min(max - numOfBytes, header.length - pos),
+		                 OVERFLOW_DATA_SIZE - offset);
+		memcpy(buf + numOfBytes, page->data + offset, n);
+		numOfBytes += n;
+		pos += n;
+		offset += n;
+	}
+
+	return OK;
+}
+
+
+void LargeRecordReader::Close()
+{
+	if (page != NULL)
+	{
+		MINIBASE_BM->UnpinPage(pid, CLEAN);
+		page = NULL;
+	}
+}
@@ -0,0 +1,97 @@
+#include "locktable.h"
+
+
+LockTable::Shard& LockTable::ShardOf(const RecordID& rid)
+{
+	unsigned h = (unsigned)rid.pageNo * 31 + (unsigned)rid.slotNo;
+	return shards[h % LOCK_TABLE_SHARDS];
+}
+
+
+//------------------------------------------------------------------
+// LockTable::Lock
+//
+// Input    : rid - a record,
+//            exclusive - true to lock it exclusively, false shared.
+// Output   : None.
+// Purpose  : Locks the record, waiting while another thread holds it
+//            exclusively or, for an exclusive lock, at all.
+// Return   : None.
+//------------------------------------------------------------------
+
+void LockTable::Lock(const RecordID& rid, bool exclusive)
+{
+	Shard& shard = ShardOf(rid);
+	std::thread::id self = std::this_thread::get_id();
+	std::unique_lock<std::mutex> lock(shard.mutex);
+
+	for (;;)
+	{
+		std::map<RecordID, LockState>::iterator i = shard.locks.find(rid);
+		if (i == shard.locks.end())
+		{
+			LockState state = { 0, 0, std::thread::id() };
+			i = shard.locks.insert(std::make_pair(rid, state)).first;
+		}
+		LockState& state = i->second;
+
+		if (state.exclusive > 0 && state.owner == self)
+		{
+			state.exclusive++;
+			return;
+		}
+		if (state.exclusive == 0 && (!exclusive || state.shared == 0))
+		{
+			if (exclusive)
+			{
+				state.exclusive = 1;
+				state.owner = self;
+			}
+			else
+				state.shared++;
+			return;
+		}
+
+		shard.released.wait(lock);
+	}
+}
+
+
+void LockTable::Unlock(const RecordID& rid)
+{
+	Shard& shard = ShardOf(rid);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+
+	std::map<RecordID, LockState>::iterator i = shard.locks.find(rid);
+	if (i == shard.locks.end())
+	{
+		cerr << "LockTable::Unlock - " << rid << " is not locked\n";
+		return;
+	}
+
+	LockState& state = i->second;
+	if (state.exclusive > 0 && state.owner == std::this_thread::get_id())
+		state.exclusive--;
+	else if (state.shared > 0)
+		state.shared--;
+
+	if (state.exclusive == 0 && state.shared == 0)
+	{
+		shard.locks.erase(i);
+		shard.released.notify_all();
+	}
+}
+
+
+RecordLock::RecordLock(const RecordID& r, bool exclusive) : rid(r)
+{
+	if (MINIBASE_LOCKS != NULL)
+		MINIBASE_LOCKS->Lock(rid, exclusive);
+}
+
+
+RecordLock::~RecordLock()
+{
+	if (MINIBASE_LOCKS != NULL)
+		MINIBASE_LOCKS->Unlock(rid);
+}
@@ -0,0 +1,895 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+#include "logmgr.h"
+#include "heappage.h"
+#include "bufmgr.h"
+#include "db.h"
+#include "crc32c.h"
+
+//
+// The first page of the log file holds a header; records start after it.
+//
+struct LogHeader
+{
+	unsigned magic;
+	unsigned maxSize;
+	LSN      checkpointLSN;     // the master record: where restart begins.
+	TxnID    txnLimit;          // transaction IDs below have been handed out.
+	LSN      recoveredLSN;      // end of the log after the last restart that
+	                            // had changes to redo or undo.
+	LSN      abortedLSN;        // newest LOG_ABORTED_TXNS record.
+	TxnID    runTxn;            // first transaction ID of the present run.
+	LSN      runLSN;            // first record of the present run.
+};
+
+static const unsigned LOG_MAGIC = 0x4c4f474d;          // "LOGM"
+static const unsigned LOG_BUFFER_SIZE = 64 * 1024;     // write out when reached
+
+
+static unsigned RecordChecksum(const LogRecord* rec, const char* data)
+{
+	LogRecord header = *rec;
+	header.checksum = 0;
+
+	unsigned crc = Crc32c(&header, sizeof(LogRecord));
+	crc ^= Crc32c(data, rec->dataLen);
+	return crc;
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::LogMgr
+//
+// Input    : name - name of the log file,
+//            maxlogsize - size limit of the log, in pages,
+//            create - true to start a new log.
+// Output   : status - OK if the log was opened.
+// Purpose  : Opens the log.  An existing log is read to its last
+//            intact record; a torn record left by a crash in the
+//            middle of a write is cut off.
+//------------------------------------------------------------------
+
+LogMgr::LogMgr(const char* name, unsigned maxlogsize, bool create, Status& status)
+{
+	maxSize = maxlogsize * MINIBASE_PAGESIZE;
+	checkpointLSN = INVALID_LSN;
+	autoCheckpoint = true;
+	lastCommitLSN = INVALID_LSN;
+	txnLimit = INVALID_TXN + 1;
+	recoveredLSN = INVALID_LSN;
+	abortedLSN = INVALID_LSN;
+	runTxn = txnLimit;
+	runLSN = LOG_START;
+	endLSN = LOG_START;
+	flushing = false;
+	runKnown = create;
+	lastBeginLSN.store(INVALID_LSN);
+	reclaimedLSN = LOG_START;
+	numOfCommits = 0;
+	numOfSyncs = 0;
+
+	fd = ::open(name, create ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR, 0666);
+	if (fd < 0)
+	{
+		status = MINIBASE_FIRST_ERROR(DBMGR, LOG_IO_ERROR);
+		return;
+	}
+
+	char page[MINIBASE_PAGESIZE];
+	LogHeader *header = (LogHeader *)page;
+
+	if (create)
+	{
+		memset(page, 0, sizeof(page));
+		header->magic = LOG_MAGIC;
+		header->maxSize = maxSize;
+		header->checkpointLSN = INVALID_LSN;
+		header->txnLimit = txnLimit;
+		header->recoveredLSN = INVALID_LSN;
+		header->abortedLSN = INVALID_LSN;
+		header->runTxn = runTxn;
+		header->runLSN = runLSN;
+		if (pwrite(fd, page, sizeof(page), 0) != (ssize_t)sizeof(page) ||
+		    fdatasync(fd) != 0)
+		{
+			status = MINIBASE_FIRST_ERROR(DBMGR, LOG_IO_ERROR);
+			return;
+		}
+	}
+	else
+	{
+		struct stat st;
+		if (pread(fd, page, sizeof(page), 0) != (ssize_t)sizeof(page) ||
+		    header->magic != LOG_MAGIC || fstat(fd, &st) != 0)
+		{
+			status = MINIBASE_FIRST_ERROR(DBMGR, BAD_LOG_FILE);
+			return;
+		}
+		maxSize = header->maxSize;
+		checkpointLSN = header->checkpointLSN;
+		if (header->txnLimit != INVALID_TXN)
+			txnLimit = header->txnLimit;
+		recoveredLSN = header->recoveredLSN;
+		abortedLSN = header->abortedLSN;
+		if (header->runTxn != INVALID_TXN)
+			runTxn = header->runTxn;
+		if (header->runLSN != INVALID_LSN)
+			runLSN = header->runLSN;
+
+		// Find the end of the log.  Everything before the checkpoint was
+		// durable when it was taken, so the search starts there.
+
+		if (checkpointLSN != INVALID_LSN)
+			endLSN = checkpointLSN;
+
+		LogRecord rec;
+		std::vector<char> data;
+
+		while (pread(fd, &rec, sizeof(LogRecord), endLSN) == (ssize_t)sizeof(LogRecord))
+		{
+			if (rec.lsn != endLSN || rec.dataLen < 0 ||
+			    rec.length != (int)sizeof(LogRecord) + rec.dataLen ||
+			    endLSN + rec.length > st.st_size)
+				break;
+			data.resize(rec.dataLen);
+			if (pread(fd, data.data(), rec.dataLen, endLSN + sizeof(LogRecord)) != rec.dataLen)
+				break;
+			if (RecordChecksum(&rec, data.data()) != rec.checksum)
+				break;
+			if (rec.type == LOG_COMMIT)
+				lastCommitLSN = endLSN;
+			endLSN += rec.length;
+		}
+
+		if (ftruncate(fd, endLSN) != 0)
+		{
+			status = MINIBASE_FIRST_ERROR(DBMGR, LOG_IO_ERROR);
+			return;
+		}
+
+		// No commit since the checkpoint; it names the one before.
+
+		if (lastCommitLSN == INVALID_LSN && checkpointLSN != INVALID_LSN)
+		{
+			if (ReadRecord(checkpointLSN, rec, &data) != OK)
+			{
+				status = MINIBASE_FIRST_ERROR(DBMGR, BAD_LOG_FILE);
+				return;
+			}
+			lastCommitLSN = ((CheckpointData *)data.data())->lastCommitLSN;
+		}
+	}
+
+	bufferLSN = endLSN;
+	durableLSN = endLSN;
+	status = OK;
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::~LogMgr
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Writes out any buffered records and closes the log.
+//------------------------------------------------------------------
+
+LogMgr::~LogMgr()
+{
+	if (fd >= 0)
+	{
+		if (GetEndLSN() > LOG_START)
+			Flush(GetEndLSN() - 1);
+		::close(fd);
+	}
+}
+
+
+LSN LogMgr::LogPageInit(PageID pid, PageID dirPid)
+{
+	return Append(LOG_PAGE_INIT, pid, dirPid, INVALID_SLOT, NULL, 0);
+}
+
+
+LSN LogMgr::LogInsert(const RecordID& rid, PageID dirPid, const char* recPtr, int recLen,
+                      short kind)
+{
+	return Append(LOG_INSERT, rid.pageNo, dirPid, rid.slotNo, recPtr, recLen,
+	              INVALID_LSN, kind);
+}
+
+
+LSN LogMgr::LogDelete(const RecordID& rid, PageID dirPid, const char* oldRecPtr, int recLen,
+                      short kind)
+{
+	return Append(LOG_DELETE, rid.pageNo, dirPid, rid.slotNo, oldRecPtr, recLen,
+	              INVALID_LSN, kind);
+}
+
+
+LSN LogMgr::LogUpdate(const RecordID& rid, PageID dirPid, const char* recPtr,
+                      const char* oldRecPtr, int recLen)
+{
+	char data[2 * MAX_SPACE];
+	memcpy(data, recPtr, recLen);
+	memcpy(data + recLen, oldRecPtr, recLen);
+
+	return Append(LOG_UPDATE, rid.pageNo, dirPid, rid.slotNo, data, 2 * recLen);
+}
+
+
+LSN LogMgr::LogPageImage(PageID pid, const Page* page)
+{
+	return Append(LOG_PAGE_IMAGE, pid, INVALID_PAGE, INVALID_SLOT,
+	              (const char *)page, MINIBASE_PAGESIZE);
+}
+
+
+LSN LogMgr::LogPageFree(PageID pid)
+{
+	return Append(LOG_PAGE_FREE, pid, INVALID_PAGE, INVALID_SLOT, NULL, 0);
+}
+
+
+LSN LogMgr::LogCompensation(short type, const RecordID& rid, PageID dirPid,
+                            const char* data, int dataLen, LSN undone, short kind)
+{
+	return Append(type, rid.pageNo, dirPid, rid.slotNo, data, dataLen, undone, kind);
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::Commit
+//
+// Input    : txn - the transaction committing, or INVALID_TXN.
+// Output   : None.
+// Purpose  : Appends a commit record, naming txn if given, and waits
+//            until it is durable.  Concurrent callers share the same
+//            write and sync.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status LogMgr::Commit(TxnID txn)
+{
+	LSN lsn = Append(LOG_COMMIT, INVALID_PAGE, INVALID_PAGE, INVALID_SLOT, (const char *)&txn,
+	                 (txn == INVALID_TXN) ? 0 : sizeof(txn));
+	if (txn != INVALID_TXN)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		runCommits.push_back(txn);
+	}
+
+	Status status = Flush(lsn);
+	if (status == OK)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		numOfCommits++;
+	}
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::Flush
+//
+// Input    : lsn - LSN of a record that must be made durable.
+// Output   : None.
+// Purpose  : Makes the log durable up to and including the record
+//            at lsn.  The first thread to find the log short becomes
+//            the leader: it takes every buffered record, writes them
+//            with one write and one sync, and wakes the others.
+//            Threads arriving meanwhile wait, and their records go
+//            out together in the next batch.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status LogMgr::Flush(LSN lsn)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (lsn >= endLSN)
+		lsn = endLSN - 1;
+
+	while (durableLSN <= lsn)
+	{
+		if (flushing)
+		{
+			flushed.wait(lock);
+			continue;
+		}
+
+		std::vector<char> batch;
+		batch.swap(buffer);
+		LSN start = bufferLSN;
+		bufferLSN = endLSN;
+		flushing = true;
+
+		lock.unlock();
+		Status status = WriteBatch(start, batch);
+		lock.lock();
+
+		flushing = false;
+		if (status == OK)
+		{
+			durableLSN = start + batch.size();
+			numOfSyncs++;
+		}
+		else
+		{
+			// Put the records back so that a later flush retries them.
+			batch.insert(batch.end(), buffer.begin(), buffer.end());
+			batch.swap(buffer);
+			bufferLSN = start;
+		}
+		flushed.notify_all();
+
+		if (status != OK)
+			return status;
+	}
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::Checkpoint
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Logs the newest commit and the dirty page table of the
+//            buffer manager, then points the log header at the new
+//            record.  Pages are not written; the database file is
+//            synced first so that pages already written out, and so
+//            left out of the table, are on disk.  The end of the log
+//            is noted before the table is taken: other threads may
+//            change pages meanwhile, and restart takes the pages they
+//            change from there on as dirty, as the table does not.
+//            So that restart need not go back further than the last
+//            checkpoint, pages first changed before it began are
+//            written back first, and the run is settled up to the
+//            oldest transaction running (see SettleRun).  Once the
+//            header names the new record, the log before the oldest
+//            record restart would read is given back.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status LogMgr::Checkpoint()
+{
+	return Checkpoint(std::function<void()>());
+}
+
+
+Status LogMgr::Checkpoint(const std::function<void()>& taken)
+{
+	LSN lastLSN = lastBeginLSN.load();
+	if (lastLSN != INVALID_LSN)
+	{
+		Status status = MINIBASE_BM->WriteOldPages(lastLSN);
+		if (status != OK)
+			return status;
+	}
+
+	TxnID txn = INVALID_TXN;
+	LSN begun = INVALID_LSN;
+	if (MINIBASE_TXN != NULL)
+		MINIBASE_TXN->GetOldestRunning(txn, begun);
+
+	CheckpointData ckpt;
+	ckpt.beginLSN = GetEndLSN();
+
+	std::vector<DirtyPageEntry> dirtyPages;
+	MINIBASE_BM->GetDirtyPages(dirtyPages);
+	if (taken)
+		taken();
+
+	Status status = MINIBASE_DB->Sync();
+	if (status != OK)
+		return status;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		ckpt.lastCommitLSN = lastCommitLSN;
+	}
+	ckpt.numOfPages = dirtyPages.size();
+
+	std::vector<char> data((char *)&ckpt, (char *)(&ckpt + 1));
+	if (!dirtyPages.empty())
+		data.insert(data.end(), (char *)&dirtyPages[0],
+		            (char *)(&dirtyPages[0] + dirtyPages.size()));
+
+	LSN lsn = Append(LOG_CHECKPOINT, INVALID_PAGE, INVALID_PAGE, INVALID_SLOT,
+	                 data.data(), data.size());
+
+	status = Flush(lsn);
+	if (status != OK)
+		return status;
+
+	// Where restart from this checkpoint begins (see RecoveryMgr::Analysis).
+	LSN keepLSN = LOG_START;
+	if (ckpt.lastCommitLSN != INVALID_LSN)
+		keepLSN = std::min(ckpt.lastCommitLSN, ckpt.beginLSN);
+	for (size_t i = 0; i < dirtyPages.size(); i++)
+		keepLSN = std::min(keepLSN, dirtyPages[i].recLSN);
+
+	std::lock_guard<std::mutex> settled(settling);
+	status = SettleRun(txn, begun, keepLSN);
+	if (status != OK)
+		return status;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (lsn <= checkpointLSN)
+			return OK;
+		checkpointLSN = lsn;
+		status = WriteHeader();
+		keepLSN = std::min(keepLSN, runLSN);
+		if (abortedLSN != INVALID_LSN)
+			keepLSN = std::min(keepLSN, abortedLSN);
+	}
+
+	if (status == OK)
+	{
+		lastBeginLSN.store(ckpt.beginLSN);
+		Reclaim(keepLSN);
+	}
+	return status;
+}
+
+
+bool LogMgr::CheckpointDue()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	LSN last = (checkpointLSN == INVALID_LSN) ? LOG_START : checkpointLSN;
+	return autoCheckpoint && endLSN - last >= (LSN)maxSize / 4;
+}
+
+
+void LogMgr::SetAutoCheckpoint(bool on)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	autoCheckpoint = on;
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::ReadRecord
+//
+// Input    : lsn - LSN of a durable record.
+// Output   : rec - the record header,
+//            data - the record data, if not NULL.
+// Purpose  : Reads a record back from the log file.
+// Return   : OK on success, BAD_LOG_FILE if there is no intact record
+//            at lsn.
+//------------------------------------------------------------------
+
+Status LogMgr::ReadRecord(LSN lsn, LogRecord& rec, std::vector<char>* data)
+{
+	if (pread(fd, &rec, sizeof(LogRecord), lsn) != (ssize_t)sizeof(LogRecord) ||
+	    rec.lsn != lsn || rec.dataLen < 0 ||
+	    rec.length != (int)sizeof(LogRecord) + rec.dataLen)
+		return MINIBASE_FIRST_ERROR(DBMGR, BAD_LOG_FILE);
+
+	if (data != NULL)
+	{
+		data->resize(rec.dataLen);
+		if (pread(fd, data->data(), rec.dataLen, lsn + sizeof(LogRecord)) != rec.dataLen ||
+		    RecordChecksum(&rec, data->data()) != rec.checksum)
+			return MINIBASE_FIRST_ERROR(DBMGR, BAD_LOG_FILE);
+	}
+
+	return OK;
+}
+
+
+LSN LogMgr::GetEndLSN()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return endLSN;
+}
+
+
+LSN LogMgr::GetDurableLSN()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return durableLSN;
+}
+
+
+LSN LogMgr::GetCheckpointLSN()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return checkpointLSN;
+}
+
+
+LSN LogMgr::GetRecoveredLSN()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return recoveredLSN;
+}
+
+
+void LogMgr::GetStat(long& commitNo, long& syncNo)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	commitNo = numOfCommits;
+	syncNo = numOfSyncs;
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::Append
+//
+// Input    : type - kind of record,
+//            pid, dirPid, slotNo - where the change was made,
+//            data, dataLen - data to log with it,
+//            undone - for a compensation record, the record undone,
+//            kind - for an insert or delete, the SlotKind of the slot.
+// Output   : None.
+// Purpose  : Appends a record to the log buffer.  A buffer that has
+//            grown large is written out.
+// Return   : The LSN of the record.
+//------------------------------------------------------------------
+
+LSN LogMgr::Append(short type, PageID pid, PageID dirPid, int slotNo,
+                   const char* data, int dataLen, LSN undone, short kind)
+{
+	LogRecord rec;
+
+	memset(&rec, 0, sizeof(LogRecord));
+	rec.undone = undone;
+	rec.length = sizeof(LogRecord) + dataLen;
+	rec.dataLen = dataLen;
+	rec.type = type;
+	rec.kind = kind;
+	rec.pid = pid;
+	rec.dirPid = dirPid;
+	rec.slotNo = slotNo;
+
+	unsigned dataCrc = Crc32c(data, dataLen);
+
+	// The pages change before their LSNs are set; they join the dirty
+	// page table now, so that a checkpoint begun after this record's
+	// LSN is handed out cannot leave them out (see Checkpoint).
+	if (type != LOG_PAGE_FREE && pid != INVALID_PAGE && MINIBASE_BM != NULL)
+	{
+		LSN end = GetEndLSN();
+		MINIBASE_BM->SetRecLSN(pid, end);
+		if (dirPid != INVALID_PAGE)
+			MINIBASE_BM->SetRecLSN(dirPid, end);
+	}
+
+	LSN lsn;
+	size_t buffered;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		lsn = endLSN;
+		rec.lsn = lsn;
+		rec.checksum = Crc32c(&rec, sizeof(LogRecord)) ^ dataCrc;
+		buffer.insert(buffer.end(), (char *)&rec, (char *)(&rec + 1));
+		if (dataLen > 0)
+			buffer.insert(buffer.end(), data, data + dataLen);
+		endLSN += rec.length;
+		if (type == LOG_COMMIT)
+			lastCommitLSN = lsn;
+		buffered = buffer.size();
+	}
+
+	if (buffered >= LOG_BUFFER_SIZE)
+		Flush(lsn);
+
+	return lsn;
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::WriteBatch
+//
+// Input    : start - LSN of the first byte of batch,
+//            batch - records to write.
+// Output   : None.
+// Purpose  : Writes records to the log file and syncs it.
+// Return   : OK on success, LOG_IO_ERROR otherwise.
+//------------------------------------------------------------------
+
+Status LogMgr::WriteBatch(LSN start, const std::vector<char>& batch)
+{
+	if (!batch.empty() &&
+	    pwrite(fd, &batch[0], batch.size(), start) != (ssize_t)batch.size())
+		return MINIBASE_FIRST_ERROR(DBMGR, LOG_IO_ERROR);
+
+	if (fdatasync(fd) != 0)
+		return MINIBASE_FIRST_ERROR(DBMGR, LOG_IO_ERROR);
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::ReserveTxnIDs
+//
+// Input    : count - how many transaction IDs to reserve.
+// Output   : first - the first of them.
+// Purpose  : Hands out IDs that were never handed out before, in this
+//            run or any other: the header records the new limit before
+//            they are given.
+// Return   : OK on success, LOG_IO_ERROR otherwise.
+//------------------------------------------------------------------
+
+Status LogMgr::ReserveTxnIDs(TxnID& first, int count)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	first = txnLimit;
+	txnLimit += count;
+	Status status = WriteHeader();
+	if (status != OK)
+		txnLimit = first;
+	return status;
+}
+
+
+void LogMgr::GetLastRun(TxnID& first, LSN& start, TxnID& limit)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	first = runTxn;
+	start = runLSN;
+	limit = txnLimit;
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::StartRun
+//
+// Input    : aborted - transactions of the last run that aborted,
+//            sorted.
+// Output   : None.
+// Purpose  : Logs them together with those of the runs before, in
+//            one record the header points to, and begins a new run at
+//            the end of the log.  A crash before the header is written
+//            leaves the last run where it was, so the next restart
+//            finds the same transactions again.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status LogMgr::StartRun(const std::vector<TxnRange>& aborted)
+{
+	std::lock_guard<std::mutex> settled(settling);
+
+	LSN lsn = INVALID_LSN;
+	if (!aborted.empty())
+	{
+		Status status = LogAborted(aborted, lsn);
+		if (status != OK)
+			return status;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (lsn != INVALID_LSN)
+		abortedLSN = lsn;
+	runTxn = txnLimit;
+	runLSN = endLSN;
+	runKnown = true;
+	runCommits.clear();
+	return WriteHeader();
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::LogAborted
+//
+// Input    : aborted - transactions that aborted, sorted, and above
+//            those logged as aborted before.
+// Output   : lsn - the new LOG_ABORTED_TXNS record.
+// Purpose  : Logs them together with those logged before, in one
+//            record, and makes it durable.  The header is left to the
+//            caller.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status LogMgr::LogAborted(const std::vector<TxnRange>& aborted, LSN& lsn)
+{
+	std::vector<TxnRange> all;
+	Status status = GetAbortedTxns(all);
+	if (status != OK)
+		return status;
+
+	for (size_t i = 0; i < aborted.size(); i++)
+	{
+		if (!all.empty() && all.back().limit == aborted[i].first)
+			all.back().limit = aborted[i].limit;
+		else
+			all.push_back(aborted[i]);
+	}
+
+	lsn = INVALID_LSN;
+	if (all.empty())
+		return OK;
+	lsn = Append(LOG_ABORTED_TXNS, INVALID_PAGE, INVALID_PAGE, INVALID_SLOT,
+	             (const char *)&all[0], all.size() * sizeof(TxnRange));
+	return Flush(lsn);
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::SettleRun
+//
+// Input    : txn, begun - the oldest transaction running and the end
+//            of the log when it began (see TxnMgr::GetOldestRunning),
+//            keepLSN - where restart from the checkpoint being taken
+//            begins.
+// Output   : None.
+// Purpose  : Moves the start of the run up to txn and begun, as if
+//            the run had begun there, so that restart need not read
+//            the commits before.  The transactions of the run below
+//            txn have finished, and those that did not commit are
+//            logged as aborted, as restart would have.  The aborted
+//            record is logged again, too, if it is older than
+//            keepLSN.  The header is left to the caller, who holds
+//            settling.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status LogMgr::SettleRun(TxnID txn, LSN begun, LSN keepLSN)
+{
+	std::vector<TxnRange> aborted;
+	LSN oldLSN;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// A log opened but not restarted yet does not know the commits of
+		// the run before.
+		if (!runKnown)
+			return OK;
+		if (txn == INVALID_TXN || txn < runTxn)
+			txn = runTxn;
+
+		std::sort(runCommits.begin(), runCommits.end());
+		TxnID first = runTxn;
+		for (size_t i = 0; i < runCommits.size() && runCommits[i] < txn; i++)
+		{
+			if (runCommits[i] > first)
+			{
+				TxnRange range = { first, runCommits[i] };
+				aborted.push_back(range);
+			}
+			first = runCommits[i] + 1;
+		}
+		if (first < txn)
+		{
+			TxnRange range = { first, txn };
+			aborted.push_back(range);
+		}
+		oldLSN = abortedLSN;
+	}
+
+	LSN lsn = INVALID_LSN;
+	if (!aborted.empty() || (oldLSN != INVALID_LSN && oldLSN < keepLSN))
+	{
+		Status status = LogAborted(aborted, lsn);
+		if (status != OK)
+			return status;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (lsn != INVALID_LSN)
+		abortedLSN = lsn;
+	runCommits.erase(std::remove_if(runCommits.begin(), runCommits.end(),
+	                                [txn](TxnID id) { return id < txn; }),
+	                 runCommits.end());
+	runTxn = txn;
+	if (begun > runLSN)
+		runLSN = begun;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::Reclaim
+//
+// Input    : keepLSN - the oldest record restart may read.
+// Output   : None.
+// Purpose  : Gives the space of the log before keepLSN, in whole
+//            pages, back to the file system by punching a hole in the
+//            file, which keeps its length.  Where the file system
+//            cannot, the space stays in use.  The caller holds
+//            settling.
+// Return   : None.
+//------------------------------------------------------------------
+
+void LogMgr::Reclaim(LSN keepLSN)
+{
+#ifdef FALLOC_FL_PUNCH_HOLE
+	LSN upto = keepLSN / MINIBASE_PAGESIZE * MINIBASE_PAGESIZE;
+	if (upto > reclaimedLSN &&
+	    fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, reclaimedLSN,
+	              upto - reclaimedLSN) == 0)
+		reclaimedLSN = upto;
+#endif
+}
+
+
+Status LogMgr::GetAbortedTxns(std::vector<TxnRange>& aborted)
+{
+	LSN lsn;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		lsn = abortedLSN;
+	}
+
+	aborted.clear();
+	if (lsn == INVALID_LSN)
+		return OK;
+
+	LogRecord rec;
+	std::vector<char> data;
+	Status status = ReadRecord(lsn, rec, &data);
+	if (status != OK || rec.type != LOG_ABORTED_TXNS || data.size() % sizeof(TxnRange) != 0)
+		return MINIBASE_FIRST_ERROR(DBMGR, BAD_LOG_FILE);
+
+	aborted.resize(data.size() / sizeof(TxnRange));
+	if (!aborted.empty())
+		memcpy(&aborted[0], data.data(), data.size());
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::SetRecovered
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Records in the header that a restart redid or undid
+//            changes up to the present end of the log.  What was not
+//            logged record by record may be out of step with the heap
+//            files from here on (see Index::IsStale).
+// Return   : OK on success, LOG_IO_ERROR otherwise.
+//------------------------------------------------------------------
+
+Status LogMgr::SetRecovered()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	LSN before = recoveredLSN;
+	recoveredLSN = endLSN;
+	Status status = WriteHeader();
+	if (status != OK)
+		recoveredLSN = before;
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// LogMgr::WriteHeader
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Writes the log header and syncs it.  The caller holds
+//            the mutex.
+// Return   : OK on success, LOG_IO_ERROR otherwise.
+//------------------------------------------------------------------
+
+Status LogMgr::WriteHeader()
+{
+	LogHeader header;
+
+	memset(&header, 0, sizeof(header));
+	header.magic = LOG_MAGIC;
+	header.maxSize = maxSize;
+	header.checkpointLSN = checkpointLSN;
+	header.txnLimit = txnLimit;
+	header.recoveredLSN = recoveredLSN;
+	header.abortedLSN = abortedLSN;
+	header.runTxn = runTxn;
+	header.runLSN = runLSN;
+
+	if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+	    fdatasync(fd) != 0)
+		return MINIBASE_FIRST_ERROR(DBMGR, LOG_IO_ERROR);
+
+	return OK;
+}
@@ -1,24 +1,31 @@
-#include <iostream>
-
-#include "heaptest.h"
-
-using namespace std;
-
-int MINIBASE_RESTART_FLAG = 0;
-
-int main(int argc, char **argv)
-{
-   HeapDriver hd;
-   Status dbstatus = hd.RunTests();
-
-   // Check if the create database has succeeded
-   if (dbstatus != OK) {       
-      cout << "Error encountered during hfpage tests: " << endl;
-      minibase_errors.show_errors();      
-      return 1;
-   }
-   
-   return 0;
-}
-
-
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+#include "heaptest.h"
+
+using namespace std;
+
+int MINIBASE_RESTART_FLAG = 0;
+
+int main(int argc, char **argv)
+{
+   HeapDriver hd;
+
+   // A test restarting the database runs it again in a new process.
+   if (argc == 3 && strcmp(argv[1], "-restart") == 0)
+      return (hd.RunRestart(atoi(argv[2])) == OK) ? 0 : 1;
+
+   Status dbstatus = hd.RunTests();
+
+   // Check if the create database has succeeded
+   if (dbstatus != OK) {       
+      cout << "Error encountered during hfpage tests: " << endl;
+      minibase_errors.show_errors();      
+      return 1;
+   }
+   
+   return 0;
+}
+
+
@@ -0,0 +1,363 @@
+#include "metrics.h"
+
+MetricsRegistry minibase_metrics;
+
+
+//------------------------------------------------------------------
+// Constructor of Counter
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Starts the counter at zero.
+//------------------------------------------------------------------
+
+Counter::Counter()
+{
+	Reset();
+}
+
+
+//------------------------------------------------------------------
+// Counter::Get
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Adds up the shards.  Updates made meanwhile may or may
+//            not be counted.
+// Return   : The value of the counter.
+//------------------------------------------------------------------
+
+long Counter::Get() const
+{
+	long total = 0;
+	for (int i = 0; i < METRICS_SHARDS; i++)
+		total += shards[i].value.load(std::memory_order_relaxed);
+	return total;
+}
+
+
+void Counter::Reset()
+{
+	for (int i = 0; i < METRICS_SHARDS; i++)
+		shards[i].value.store(0, std::memory_order_relaxed);
+}
+
+
+//------------------------------------------------------------------
+// Counter::ThreadShard
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Gives each thread, on its first update of any metric,
+//            the next shard in turn.
+// Return   : The shard of the calling thread.
+//------------------------------------------------------------------
+
+int Counter::ThreadShard()
+{
+	static std::atomic<unsigned> nextShard(0);
+	thread_local int shard = nextShard.fetch_add(1) % METRICS_SHARDS;
+	return shard;
+}
+
+
+//------------------------------------------------------------------
+// Constructor of Histogram
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Starts the histogram empty.
+//------------------------------------------------------------------
+
+Histogram::Histogram()
+{
+	Reset();
+}
+
+
+void Histogram::Reset()
+{
+	for (int i = 0; i < METRICS_SHARDS; i++)
+	{
+		for (int b = 0; b < HISTOGRAM_BUCKETS; b++)
+			shards[i].buckets[b].store(0, std::memory_order_relaxed);
+		shards[i].sum.store(0, std::memory_order_relaxed);
+	}
+}
+
+
+//------------------------------------------------------------------
+// Histogram::Bucket
+//
+// Input    : value - a value to record.
+// Output   : None.
+// Purpose  : Finds the bucket of a value: the position of its top bit
+//            picks the power of two, the next HISTOGRAM_SUB_BITS bits
+//            the bucket within it.  Negative values count as 0.
+// Return   : The bucket.
+//------------------------------------------------------------------
+
+int Histogram::Bucket(long value)
+{
+	const long subBuckets = 1L << HISTOGRAM_SUB_BITS;
+
+	if (value < subBuckets)
+		return value < 0 ? 0 : (int)value;
+
+	int top = 63 - __builtin_clzl((unsigned long)value);
+	int shift = top - HISTOGRAM_SUB_BITS;
+	return ((shift + 1) << HISTOGRAM_SUB_BITS) + (int)((value >> shift) - subBuckets);
+}
+
+
+//------------------------------------------------------------------
+// Histogram::BucketLow, Histogram::BucketHigh
+//
+// Input    : bucket - a bucket.
+// Output   : None.
+// Purpose  : Inverts Bucket.
+// Return   : The smallest and the largest value of the bucket.
+//------------------------------------------------------------------
+
+long Histogram::BucketLow(int bucket)
+{
+	const int subBuckets = 1 << HISTOGRAM_SUB_BITS;
+
+	if (bucket < subBuckets)
+		return bucket;
+
+	int shift = (bucket >> HISTOGRAM_SUB_BITS) - 1;
+	return (long)((unsigned long)(subBuckets + (bucket & (subBuckets - 1))) << shift);
+}
+
+
+long Histogram::BucketHigh(int bucket)
+{
+	if (bucket < (1 << HISTOGRAM_SUB_BITS))
+		return bucket;
+
+	int shift = (bucket >> HISTOGRAM_SUB_BITS) - 1;
+	return (long)((unsigned long)BucketLow(bucket) + ((1UL << shift) - 1));
+}
+
+
+//------------------------------------------------------------------
+// Histogram::Snapshot
+//
+// Input    : None.
+// Output   : snapshot - the counts of every bucket, their total and
+//            the sum of the values.
+// Purpose  : Adds up the shards.
+// Return   : None.
+//------------------------------------------------------------------
+
+void Histogram::Snapshot(HistogramSnapshot& snapshot) const
+{
+	snapshot.count = 0;
+	snapshot.sum = 0;
+	snapshot.buckets.assign(HISTOGRAM_BUCKETS, 0);
+
+	for (int i = 0; i < METRICS_SHARDS; i++)
+	{
+		for (int b = 0; b < HISTOGRAM_BUCKETS; b++)
+		{
+			long n = shards[i].buckets[b].load(std::memory_order_relaxed);
+			snapshot.buckets[b] += n;
+			snapshot.count += n;
+		}
+		snapshot.sum += shards[i].sum.load(std::memory_order_relaxed);
+	}
+}
+
+
+//------------------------------------------------------------------
+// HistogramSnapshot::GetPercentile
+//
+// Input    : p - a fraction between 0 and 1.
+// Output   : None.
+// Purpose  : Finds the bucket holding the nearest-rank percentile.
+// Return   : The largest value of that bucket, 0 if there are no
+//            values.
+//------------------------------------------------------------------
+
+long HistogramSnapshot::GetPercentile(double p) const
+{
+	long rank = (long)(p * count + 0.999999);
+	if (rank < 1)
+		rank = 1;
+
+	long seen = 0;
+	for (size_t b = 0; b < buckets.size(); b++)
+	{
+		seen += buckets[b];
+		if (seen >= rank)
+			return Histogram::BucketHigh((int)b);
+	}
+	return 0;
+}
+
+
+long HistogramSnapshot::GetMax() const
+{
+	for (size_t b = buckets.size(); b > 0; b--)
+		if (buckets[b - 1] != 0)
+			return Histogram::BucketHigh((int)b - 1);
+	return 0;
+}
+
+
+//------------------------------------------------------------------
+// MetricsSnapshot::WriteText
+//
+// Input    : out - where to write.
+// Output   : None.
+// Purpose  : Writes one line per metric; a histogram is summed up by
+//            its count, mean and percentiles.
+// Return   : None.
+//------------------------------------------------------------------
+
+void MetricsSnapshot::WriteText(std::ostream& out) const
+{
+	for (std::map<std::string, long>::const_iterator i = counters.begin();
+	     i != counters.end(); ++i)
+		out << i->first << " " << i->second << "\n";
+
+	for (std::map<std::string, HistogramSnapshot>::const_iterator i = histograms.begin();
+	     i != histograms.end(); ++i)
+	{
+		const HistogramSnapshot& h = i->second;
+		out << i->first << " count=" << h.count
+		    << " mean=" << (h.count ? h.sum / h.count : 0)
+		    << " p50=" << h.GetPercentile(0.50)
+		    << " p99=" << h.GetPercentile(0.99)
+		    << " p999=" << h.GetPercentile(0.999)
+		    << " max=" << h.GetMax() << "\n";
+	}
+}
+
+
+//------------------------------------------------------------------
+// MetricsSnapshot::WriteJson
+//
+// Input    : out - where to write.
+// Output   : None.
+// Purpose  : Writes the metrics as one JSON object.  Histograms list
+//            their non-empty buckets as [low, high, count].
+// Return   : None.
+//------------------------------------------------------------------
+
+void MetricsSnapshot::WriteJson(std::ostream& out) const
+{
+	out << "{\n  \"counters\": {";
+	for (std::map<std::string, long>::const_iterator i = counters.begin();
+	     i != counters.end(); ++i)
+		out << (i == counters.begin() ? "\n" : ",\n")
+		    << "    \"" << i->first << "\": " << i->second;
+	out << "\n  },\n  \"histograms\": {";
+
+	for (std::map<std::string, HistogramSnapshot>::const_iterator i = histograms.begin();
+	     i != histograms.end(); ++i)
+	{
+		const HistogramSnapshot& h = i->second;
+		out << (i == histograms.begin() ? "\n" : ",\n")
+		    << "    \"" << i->first << "\": {\"count\": " << h.count
+		    << ", \"sum\": " << h.sum
+		    << ", \"p50\": " << h.GetPercentile(0.50)
+		    << ", \"p99\": " << h.GetPercentile(0.99)
+		    << ", \"max\": " << h.GetMax()
+		    << ", \"buckets\": [";
+
+		bool first = true;
+		for (size_t b = 0; b < h.buckets.size(); b++)
+		{
+			if (h.buckets[b] == 0)
+				continue;
+			out << (first ? "" : ", ") << "[" << Histogram::BucketLow((int)b)
+			    << ", " << Histogram::BucketHigh((int)b) << ", " << h.buckets[b] << "]";
+			first = false;
+		}
+		out << "]}";
+	}
+	out << "\n  }\n}\n";
+}
+
+
+MetricsRegistry::~MetricsRegistry()
+{
+	for (std::map<std::string, Counter*>::iterator i = counters.begin();
+	     i != counters.end(); ++i)
+		delete i->second;
+	for (std::map<std::string, Histogram*>::iterator i = histograms.begin();
+	     i != histograms.end(); ++i)
+		delete i->second;
+}
+
+
+//------------------------------------------------------------------
+// MetricsRegistry::GetCounter, MetricsRegistry::GetHistogram
+//
+// Input    : name - name of the metric.
+// Output   : None.
+// Purpose  : Looks a metric up, creating it if it does not exist.
+// Return   : The metric.
+//------------------------------------------------------------------
+
+Counter& MetricsRegistry::GetCounter(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	Counter*& counter = counters[name];
+	if (counter == NULL)
+		counter = new Counter();
+	return *counter;
+}
+
+
+Histogram& MetricsRegistry::GetHistogram(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	Histogram*& histogram = histograms[name];
+	if (histogram == NULL)
+		histogram = new Histogram();
+	return *histogram;
+}
+
+
+//------------------------------------------------------------------
+// MetricsRegistry::Snapshot
+//
+// Input    : None.
+// Output   : snapshot - the value of every metric.
+// Purpose  : Reads every metric.  Each one is read consistently with
+//            itself, but not with the others.
+// Return   : None.
+//------------------------------------------------------------------
+
+void MetricsRegistry::Snapshot(MetricsSnapshot& snapshot)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	snapshot.counters.clear();
+	snapshot.histograms.clear();
+
+	for (std::map<std::string, Counter*>::iterator i = counters.begin();
+	     i != counters.end(); ++i)
+		snapshot.counters[i->first] = i->second->Get();
+	for (std::map<std::string, Histogram*>::iterator i = histograms.begin();
+	     i != histograms.end(); ++i)
+		i->second->Snapshot(snapshot.histograms[i->first]);
+}
+
+
+void MetricsRegistry::Reset()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (std::map<std::string, Counter*>::iterator i = counters.begin();
+	     i != counters.end(); ++i)
+		i->second->Reset();
+	for (std::map<std::string, Histogram*>::iterator i = histograms.begin();
+	     i != histograms.end(); ++i)
+		i->second->Reset();
+}
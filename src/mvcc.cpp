@@ -0,0 +1,201 @@
+#include <algorithm>
+
+#include "mvcc.h"
+#include "heapfile.h"
+#include "logmgr.h"
+
+
+static bool InRanges(const std::vector<TxnRange>& ranges, TxnID id)
+{
+	size_t low = 0, high = ranges.size();
+	while (low < high)
+	{
+		size_t mid = (low + high) / 2;
+		if (ranges[mid].limit <= id)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low < ranges.size() && ranges[low].first <= id;
+}
+
+
+bool Snapshot::Sees(TxnID id) const
+{
+	if (id == txn)
+		return true;
+	if (id < xmin)
+		return aborted == NULL || !InRanges(*aborted, id);
+	if (id >= xmax)
+		return false;
+	return !std::binary_search(active.begin(), active.end(), id);
+}
+
+
+//------------------------------------------------------------------
+// TxnMgr::Begin
+//
+// Input    : None.
+// Output   : txn - the new transaction.
+// Purpose  : Starts a transaction and takes its snapshot.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status TxnMgr::Begin(TxnID& txn)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	Status status = Reserve();
+	if (status != OK)
+		return status;
+	txn = next++;
+
+	TxnState& state = running[txn];
+	state.begun = log->GetEndLSN();
+	Snapshot& snapshot = state.snapshot;
+	snapshot.txn = txn;
+	snapshot.xmax = txn;
+	snapshot.xmin = txn;
+	snapshot.aborted = &aborted;
+	for (std::map<TxnID, TxnState>::iterator i = running.begin(); i->first != txn; ++i)
+		snapshot.active.push_back(i->first);
+	if (!snapshot.active.empty())
+		snapshot.xmin = snapshot.active.front();
+	return OK;
+}
+
+
+Status TxnMgr::Commit(TxnID txn)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (running.find(txn) == running.end())
+		{
+			cerr << "TxnMgr::Commit - transaction " << txn << " is not running\n";
+			return FAIL;
+		}
+	}
+
+	Status status = log->Commit(txn);
+	if (status != OK)
+		return status;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	running.erase(txn);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// TxnMgr::Abort
+//
+// Input    : txn - a running transaction.
+// Output   : None.
+// Purpose  : Undoes the changes of the transaction, newest first, and
+//            ends it.  Until it has ended, no other transaction sees
+//            what it is undoing.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status TxnMgr::Abort(TxnID txn)
+{
+	std::vector<TxnUndo> undo;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::map<TxnID, TxnState>::iterator i = running.find(txn);
+		if (i == running.end())
+		{
+			cerr << "TxnMgr::Abort - transaction " << txn << " is not running\n";
+			return FAIL;
+		}
+		undo.swap(i->second.undo);
+	}
+
+	Status status = OK;
+	for (size_t i = undo.size(); i-- > 0 && status == OK; )
+		status = undo[i].file->UndoVersion(txn, undo[i]);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	running.erase(txn);
+	return status;
+}
+
+
+const Snapshot *TxnMgr::GetSnapshot(TxnID txn)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::map<TxnID, TxnState>::iterator i = running.find(txn);
+	return (i == running.end()) ? NULL : &i->second.snapshot;
+}
+
+
+TxnID TxnMgr::GetHorizon()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// Before the first transaction of a run, every ID handed out before
+	// is below the next batch.
+	if (Reserve() != OK)
+		return INVALID_TXN;
+
+	TxnID horizon = next;
+	for (std::map<TxnID, TxnState>::iterator i = running.begin(); i != running.end(); ++i)
+		horizon = std::min(horizon, i->second.snapshot.xmin);
+	return horizon;
+}
+
+
+void TxnMgr::AddUndo(TxnID txn, const TxnUndo& undo)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::map<TxnID, TxnState>::iterator i = running.find(txn);
+	if (i != running.end())
+		i->second.undo.push_back(undo);
+}
+
+
+bool TxnMgr::IsAborted(TxnID id) const
+{
+	return InRanges(aborted, id);
+}
+
+
+void TxnMgr::GetOldestRunning(TxnID& txn, LSN& begun)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (running.empty())
+	{
+		txn = next;
+		begun = log->GetEndLSN();
+	}
+	else
+	{
+		txn = running.begin()->first;
+		begun = running.begin()->second.begun;
+	}
+}
+
+
+// Reserves a new batch of IDs in the log if they are used up.  The caller
+// holds the mutex.  Restart has settled which IDs of the runs before
+// aborted by the first batch of a run.
+Status TxnMgr::Reserve()
+{
+	if (next != limit)
+		return OK;
+
+	Status status;
+	if (limit == INVALID_TXN)
+	{
+		status = log->GetAbortedTxns(aborted);
+		if (status != OK)
+			return status;
+	}
+
+	status = log->ReserveTxnIDs(next, TXN_ID_BATCH);
+	if (status == OK)
+		limit = next + TXN_ID_BATCH;
+	else
+		next = limit;
+	return status;
+}
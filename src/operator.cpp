@@ -0,0 +1,676 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "operator.h"
+#include "index.h"
+#include "heapfile.h"
+#include "scan.h"
+#include "sort.h"
+#include "join.h"
+#include "metrics.h"
+
+
+static long Nanoseconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+
+static bool ColumnIsValid(const std::vector<Column>& schema, int col, const char* op)
+{
+	if (col >= 0 && col < (int)schema.size()
+	    && KeyIsValid(0, schema[col].type, schema[col].length))
+		return true;
+
+	cerr << op << "::Open - cannot work on column " << col << "\n";
+	return false;
+}
+
+
+//------------------------------------------------------------------
+// Drain
+//
+// Input    : op - an open operator,
+//            file - a heap file.
+// Output   : None.
+// Purpose  : Appends every row op returns to the file, as a record of
+//            its columns back to back, and gives back the pages of its
+//            extent left over.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+static Status Drain(Operator& op, HeapFile& file)
+{
+	Batch batch;
+	std::vector<char> rec(op.GetRowLength());
+	RecordID rid;
+	Status status;
+
+	while ((status = op.Next(batch)) == OK)
+	{
+		for (int row = 0; row < batch.GetNumOfRows(); row++)
+		{
+			batch.GetRecord(row, &rec[0]);
+			if (file.AppendRecord(&rec[0], rec.size(), rid) != OK)
+				return FAIL;
+		}
+	}
+	if (status != DONE)
+		return status;
+
+	// The rest of the extent is better left to the files that follow.
+	return file.ReleaseExtent();
+}
+
+
+void Batch::Reset(const std::vector<Column>& schema)
+{
+	numOfRows = 0;
+	bool same = (schema.size() == columns.size());
+	for (size_t c = 0; same && c < schema.size(); c++)
+		same = (schema[c].length == columns[c].length);
+	columns = schema;
+	if (same)
+		return;
+
+	data.resize(schema.size());
+	for (size_t c = 0; c < schema.size(); c++)
+		data[c].resize(BATCH_ROWS * schema[c].length);
+}
+
+
+//------------------------------------------------------------------
+// Batch::AppendRecords
+//
+// Input    : fields - where each column is in a record,
+//            recPtrs - records,
+//            n - how many, no more than the batch has room for.
+// Output   : None.
+// Purpose  : Adds a row for each record.  The records are gone through
+//            once a column, so that each loop writes one array in order.
+//------------------------------------------------------------------
+
+void Batch::AppendRecords(const std::vector<Column>& fields, char* const* recPtrs, int n)
+{
+	for (size_t c = 0; c < columns.size(); c++)
+	{
+		int offset = fields[c].offset;
+		int length = columns[c].length;
+		char *value = GetValue(c, numOfRows);
+		for (int i = 0; i < n; i++, value += length)
+			memcpy(value, recPtrs[i] + offset, length);
+	}
+	numOfRows += n;
+}
+
+
+void Batch::GetRecord(int row, char* recPtr) const
+{
+	for (size_t c = 0; c < columns.size(); c++)
+	{
+		memcpy(recPtr, GetValue(c, row), columns[c].length);
+		recPtr += columns[c].length;
+	}
+}
+
+
+void Batch::Select(const std::vector<char>& keep)
+{
+	for (size_t c = 0; c < columns.size(); c++)
+	{
+		int length = columns[c].length;
+		char *to = GetValue(c, 0);
+		for (int row = 0; row < numOfRows; row++)
+		{
+			if (keep[row])
+			{
+				memmove(to, GetValue(c, row), length);
+				to += length;
+			}
+		}
+	}
+
+	int n = 0;
+	for (int row = 0; row < numOfRows; row++)
+		n += keep[row] ? 1 : 0;
+	numOfRows = n;
+}
+
+
+void Batch::CopyColumn(int to, const Batch& in, int from)
+{
+	memcpy(GetValue(to, 0), in.GetValue(from, 0),
+	       in.numOfRows * columns[to].length);
+	numOfRows = in.numOfRows;
+}
+
+
+//------------------------------------------------------------------
+// Constructor of Operator
+//
+// Input    : name - what the operator is, for Explain and its metrics.
+// Output   : None.
+// Purpose  : Starts the counts at zero and finds the metrics.
+//------------------------------------------------------------------
+
+Operator::Operator(const char* name)
+	: name(name), numOfRows(0), numOfBatches(0), nanoseconds(0)
+{
+	rows = &minibase_metrics.GetCounter(std::string("operator.") + name + ".rows");
+	nextTimes = &minibase_metrics.GetHistogram(std::string("operator.") + name + ".next");
+}
+
+
+Status Operator::Open()
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	numOfRows = numOfBatches = nanoseconds = 0;
+	Status status = DoOpen();
+	nanoseconds += Nanoseconds(start);
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// Operator::Next
+//
+// Input    : None.
+// Output   : batch - the next rows.
+// Purpose  : Empties the batch, gives it the schema of the operator and
+//            has the operator fill it, counting what it returns.
+// Return   : OK if there are rows, DONE after the last, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status Operator::Next(Batch& batch)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	batch.Reset(schema);
+	Status status = DoNext(batch);
+
+	long ns = Nanoseconds(start);
+	nanoseconds += ns;
+	nextTimes->Record(ns);
+	if (status == OK)
+	{
+		numOfRows += batch.GetNumOfRows();
+		numOfBatches++;
+		rows->Add(batch.GetNumOfRows());
+	}
+	return status;
+}
+
+
+Status Operator::Close()
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	Status status = DoClose();
+	nanoseconds += Nanoseconds(start);
+	return status;
+}
+
+
+int Operator::GetRowLength() const
+{
+	int length = 0;
+	for (size_t c = 0; c < schema.size(); c++)
+		length += schema[c].length;
+	return length;
+}
+
+
+void Operator::SetSchema(const std::vector<Column>& columns)
+{
+	schema = columns;
+	int offset = 0;
+	for (size_t c = 0; c < schema.size(); c++)
+	{
+		schema[c].offset = offset;
+		offset += schema[c].length;
+	}
+}
+
+
+//------------------------------------------------------------------
+// Operator::Explain
+//
+// Input    : out - where to write,
+//            indent - levels to indent the operator by.
+// Output   : None.
+// Purpose  : Writes the operator and the counts of its last run, then
+//            its children indented one level more.  The time of the
+//            operator without its children is given first.
+//------------------------------------------------------------------
+
+void Operator::Explain(std::ostream& out, int indent) const
+{
+	long own = nanoseconds;
+	for (size_t i = 0; i < children.size(); i++)
+		own -= children[i]->nanoseconds;
+
+	out << std::string(2 * indent, ' ') << name << ": " << numOfRows
+	    << " rows in " << numOfBatches << " batches, " << own / 1000
+	    << " us (" << nanoseconds / 1000 << " us in all)\n";
+	for (size_t i = 0; i < children.size(); i++)
+		children[i]->Explain(out, indent + 1);
+}
+
+
+//------------------------------------------------------------------
+// BatchReader::Open
+//
+// Input    : file - a heap file,
+//            columns - where each column is in a record.
+// Output   : None.
+// Purpose  : Opens a scan of the file.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status BatchReader::Open(HeapFile& file, const std::vector<Column>& columns)
+{
+	Close();
+	this->columns = columns;
+	recLen = 0;
+	for (size_t c = 0; c < columns.size(); c++)
+		recLen = std::max(recLen, columns[c].offset + columns[c].length);
+
+	Status status;
+	scan = file.OpenScan(status);
+	if (status != OK)
+	{
+		delete scan;
+		scan = NULL;
+		return FAIL;
+	}
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// BatchReader::Read
+//
+// Input    : None.
+// Output   : batch - rows of the next records.
+// Purpose  : Fills the batch from the records of the current page of
+//            the scan, and the pages after it until the batch is full.
+// Return   : OK if there are rows, DONE after the last record, FAIL if
+//            a record is too short to hold the columns.
+//------------------------------------------------------------------
+
+Status BatchReader::Read(Batch& batch)
+{
+	while (!batch.IsFull())
+	{
+		if (next == recPtrs.size())
+		{
+			// The rows already in the batch are copies, so the page
+			// they came from may be unpinned.
+			next = 0;
+			Status status = scan->GetNextBatch(recPtrs, recLens);
+			if (status == DONE)
+				break;
+			if (status != OK)
+				return FAIL;
+		}
+
+		int n = std::min(recPtrs.size() - next, (size_t)(BATCH_ROWS - batch.GetNumOfRows()));
+		for (int i = 0; i < n; i++)
+		{
+			if (recLens[next + i] < recLen)
+			{
+				cerr << "BatchReader::Read - a record has no room for the columns\n";
+				return FAIL;
+			}
+		}
+		batch.AppendRecords(columns, &recPtrs[next], n);
+		next += n;
+	}
+	return (batch.GetNumOfRows() > 0) ? OK : DONE;
+}
+
+
+void BatchReader::Close()
+{
+	delete scan;
+	scan = NULL;
+	recPtrs.clear();
+	recLens.clear();
+	next = 0;
+}
+
+
+ScanOperator::ScanOperator(HeapFile& file, const std::vector<Column>& columns)
+	: Operator("scan"), file(&file), columns(columns)
+{
+	SetSchema(columns);
+}
+
+
+Status ScanOperator::DoOpen()
+{
+	return reader.Open(*file, columns);
+}
+
+
+Status ScanOperator::DoNext(Batch& batch)
+{
+	return reader.Read(batch);
+}
+
+
+Status ScanOperator::DoClose()
+{
+	reader.Close();
+	return OK;
+}
+
+
+FilterOperator::FilterOperator(Operator& child, int col, AttrOperator op,
+                               const char* value)
+	: Operator("filter"), child(&child), col(col), op(op), keep(BATCH_ROWS)
+{
+	schema = child.GetSchema();
+	children.push_back(&child);
+	if (col >= 0 && col < (int)schema.size())
+		this->value.assign(value, value + schema[col].length);
+}
+
+
+Status FilterOperator::DoOpen()
+{
+	if (!ColumnIsValid(schema, col, "FilterOperator"))
+		return FAIL;
+	if (op != aopEQ && op != aopLT && op != aopGT && op != aopNE
+	    && op != aopLE && op != aopGE)
+	{
+		cerr << "FilterOperator::Open - cannot filter by the operator\n";
+		return FAIL;
+	}
+	return child->Open();
+}
+
+
+//------------------------------------------------------------------
+// FilterOperator::DoNext
+//
+// Input    : None.
+// Output   : batch - the next rows that pass.
+// Purpose  : Compares the column of a batch of the child's rows with the
+//            value in one loop, then keeps the rows that pass, pulling
+//            batches until one has any.
+// Return   : OK if there are rows, DONE after the last, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status FilterOperator::DoNext(Batch& batch)
+{
+	const Column& column = schema[col];
+	Status status;
+
+	while ((status = child->Next(batch)) == OK)
+	{
+		int n = batch.GetNumOfRows();
+		for (int row = 0; row < n; row++)
+		{
+			int c = CompareKeys(column.type, column.length,
+			                    batch.GetValue(col, row), &value[0]);
+			switch (op)
+			{
+			case aopEQ: keep[row] = (c == 0); break;
+			case aopLT: keep[row] = (c < 0);  break;
+			case aopGT: keep[row] = (c > 0);  break;
+			case aopNE: keep[row] = (c != 0); break;
+			case aopLE: keep[row] = (c <= 0); break;
+			default:    keep[row] = (c >= 0); break;
+			}
+		}
+
+		batch.Select(keep);
+		if (batch.GetNumOfRows() > 0)
+			return OK;
+	}
+	return status;
+}
+
+
+Status FilterOperator::DoClose()
+{
+	return child->Close();
+}
+
+
+ProjectOperator::ProjectOperator(Operator& child, const std::vector<int>& cols)
+	: Operator("project"), child(&child), cols(cols)
+{
+	std::vector<Column> columns;
+	for (size_t i = 0; i < cols.size(); i++)
+	{
+		if (cols[i] >= 0 && cols[i] < (int)child.GetSchema().size())
+			columns.push_back(child.GetSchema()[cols[i]]);
+	}
+	SetSchema(columns);
+	children.push_back(&child);
+}
+
+
+Status ProjectOperator::DoOpen()
+{
+	if (schema.size() != cols.size())
+	{
+		cerr << "ProjectOperator::Open - no such column\n";
+		return FAIL;
+	}
+	return child->Open();
+}
+
+
+Status ProjectOperator::DoNext(Batch& batch)
+{
+	Status status = child->Next(in);
+	if (status != OK)
+		return status;
+
+	for (size_t i = 0; i < cols.size(); i++)
+		batch.CopyColumn(i, in, cols[i]);
+	return OK;
+}
+
+
+Status ProjectOperator::DoClose()
+{
+	return child->Close();
+}
+
+
+LimitOperator::LimitOperator(Operator& child, long limit)
+	: Operator("limit"), child(&child), limit(limit), passed(0)
+{
+	schema = child.GetSchema();
+	children.push_back(&child);
+}
+
+
+Status LimitOperator::DoOpen()
+{
+	passed = 0;
+	return child->Open();
+}
+
+
+Status LimitOperator::DoNext(Batch& batch)
+{
+	if (passed >= limit)
+		return DONE;
+
+	Status status = child->Next(batch);
+	if (status != OK)
+		return status;
+
+	if (batch.GetNumOfRows() > limit - passed)
+		batch.Truncate(limit - passed);
+	passed += batch.GetNumOfRows();
+	return OK;
+}
+
+
+Status LimitOperator::DoClose()
+{
+	return child->Close();
+}
+
+
+SortOperator::SortOperator(Operator& child, int col, TupleOrder order, int numOfFrames)
+	: Operator("sort"), child(&child), col(col), order(order),
+	  numOfFrames(numOfFrames), sorted(NULL)
+{
+	schema = child.GetSchema();
+	children.push_back(&child);
+}
+
+
+SortOperator::~SortOperator()
+{
+	reader.Close();
+	delete sorted;
+}
+
+
+//------------------------------------------------------------------
+// SortOperator::DoOpen
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Writes every row of the child to a temporary file and sorts
+//            it into another, freeing the first.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status SortOperator::DoOpen()
+{
+	if (!ColumnIsValid(schema, col, "SortOperator") || child->Open() != OK)
+		return FAIL;
+
+	reader.Close();
+	delete sorted;
+	sorted = NULL;
+
+	Status status;
+	HeapFile rows(NULL, status);
+	if (status != OK || Drain(*child, rows) != OK)
+		return FAIL;
+
+	sorted = new HeapFile(NULL, status);
+	if (status == OK)
+	{
+		ExternalSort sort(schema[col].offset, schema[col].type, schema[col].length,
+		                  order, numOfFrames);
+		status = sort.Run(rows, *sorted);
+	}
+	if (status == OK)
+		status = reader.Open(*sorted, schema);
+	return status;
+}
+
+
+Status SortOperator::DoNext(Batch& batch)
+{
+	return reader.Read(batch);
+}
+
+
+Status SortOperator::DoClose()
+{
+	reader.Close();
+	delete sorted;
+	sorted = NULL;
+	return child->Close();
+}
+
+
+JoinOperator::JoinOperator(Operator& left, Operator& right, int leftCol,
+                           int rightCol, int numOfFrames)
+	: Operator("join"), left(&left), right(&right), leftCol(leftCol),
+	  rightCol(rightCol), numOfFrames(numOfFrames), joined(NULL)
+{
+	std::vector<Column> columns(left.GetSchema());
+	columns.insert(columns.end(), right.GetSchema().begin(), right.GetSchema().end());
+	SetSchema(columns);
+	children.push_back(&left);
+	children.push_back(&right);
+}
+
+
+JoinOperator::~JoinOperator()
+{
+	reader.Close();
+	delete joined;
+}
+
+
+//------------------------------------------------------------------
+// JoinOperator::DoOpen
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Writes the rows of both children to temporary files and
+//            joins them into a third, freeing the first two.  The rows
+//            of the children are written back to back, so that a pair
+//            HashJoin appends is a row of the join.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status JoinOperator::DoOpen()
+{
+	const std::vector<Column>& leftSchema = left->GetSchema();
+	const std::vector<Column>& rightSchema = right->GetSchema();
+	if (!ColumnIsValid(leftSchema, leftCol, "JoinOperator")
+	    || !ColumnIsValid(rightSchema, rightCol, "JoinOperator"))
+		return FAIL;
+	if (left->Open() != OK || right->Open() != OK)
+		return FAIL;
+
+	reader.Close();
+	delete joined;
+	joined = NULL;
+
+	Status status;
+	HeapFile leftRows(NULL, status);
+	if (status != OK || Drain(*left, leftRows) != OK)
+		return FAIL;
+	HeapFile rightRows(NULL, status);
+	if (status != OK || Drain(*right, rightRows) != OK)
+		return FAIL;
+
+	joined = new HeapFile(NULL, status);
+	if (status == OK)
+	{
+		const Column& l = leftSchema[leftCol];
+		const Column& r = rightSchema[rightCol];
+		JoinKey buildKey = { l.offset, l.type, l.length };
+		JoinKey probeKey = { r.offset, r.type, r.length };
+		HashJoin join(buildKey, probeKey, numOfFrames);
+		status = join.Run(leftRows, rightRows, *joined);
+	}
+	if (status == OK)
+		status = reader.Open(*joined, schema);
+	return status;
+}
+
+
+Status JoinOperator::DoNext(Batch& batch)
+{
+	return reader.Read(batch);
+}
+
+
+Status JoinOperator::DoClose()
+{
+	reader.Close();
+	delete joined;
+	joined = NULL;
+
+	Status status = left->Close();
+	if (right->Close() != OK)
+		status = FAIL;
+	return status;
+}
@@ -0,0 +1,565 @@
+#include <string.h>
+#include <algorithm>
+
+#include "recovery.h"
+#include "heappage.h"
+#include "dirpage.h"
+#include "bufmgr.h"
+#include "db.h"
+#include "largerecord.h"
+
+
+static bool IsHeapChange(short type)
+{
+	return type == LOG_INSERT || type == LOG_DELETE || type == LOG_UPDATE;
+}
+
+
+//------------------------------------------------------------------
+// ApplyChange
+//
+// Input    : page - a pinned heap page,
+//            type - kind of change,
+//            rid - record it applies to,
+//            data, dataLen - data of the log record,
+//            kind - SlotKind of the slot, for an insert.
+// Output   : None.
+// Purpose  : Makes the change a heap log record describes.
+// Return   : OK on success, FAIL if the page cannot take it.
+//------------------------------------------------------------------
+
+static Status ApplyChange(HeapPage* page, short type, const RecordID& rid,
+                          const char* data, int dataLen, short kind)
+{
+	char *recPtr;
+	int recLen;
+
+	switch (type)
+	{
+	case LOG_INSERT:
+		return (page->InsertRecordAt(rid, data, dataLen, kind) == OK) ? OK : FAIL;
+
+	case LOG_DELETE:
+		return page->DeleteRecord(rid);
+
+	case LOG_UPDATE:
+		if (page->ReturnRecord(rid, recPtr, recLen) != OK || 2 * recLen != dataLen)
+			return FAIL;
+		memcpy(recPtr, data, recLen);
+		return OK;
+	}
+
+	return FAIL;
+}
+
+
+RecoveryMgr::RecoveryMgr(LogMgr* log)
+{
+	this->log = log;
+	lastCommitLSN = INVALID_LSN;
+	numOfRedos = 0;
+	numOfUndos = 0;
+}
+
+
+//------------------------------------------------------------------
+// RecoveryMgr::Recover
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Runs analysis, redo and undo, and settles which
+//            transactions of the last run aborted, then takes a
+//            checkpoint so that the next restart starts from here.  If
+//            anything was redone or undone, the log notes it, which makes
+//            every index stale.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status RecoveryMgr::Recover()
+{
+	// A checkpoint taken halfway would leave out pages not redone yet.
+
+	log->SetAutoCheckpoint(false);
+
+	Status status = Analysis();
+	if (status == OK)
+		status = Redo();
+	if (status == OK)
+		status = Undo();
+	if (status == OK)
+		status = EndRun();
+
+	// Indexes are not logged record by record, and may now hold entries
+	// of changes undone, or miss some of changes redone.
+
+	if (status == OK && numOfRedos + numOfUndos > 0)
+		status = log->SetRecovered();
+	if (status == OK)
+		status = log->Checkpoint();
+
+	log->SetAutoCheckpoint(true);
+	return status;
+}
+
+
+void RecoveryMgr::GetStat(long& redoNo, long& undoNo)
+{
+	redoNo = numOfRedos;
+	undoNo = numOfUndos;
+}
+
+
+//------------------------------------------------------------------
+// RecoveryMgr::EndRun
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Reads the commit records of the last run, from its first
+//            record on, and logs every transaction ID it reserved that
+//            none names as aborted: it was running at the crash, or
+//            never handed out.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status RecoveryMgr::EndRun()
+{
+	TxnID first, limit;
+	LSN lsn;
+	log->GetLastRun(first, lsn, limit);
+
+	std::vector<TxnID> committed;
+	LSN end = log->GetEndLSN();
+	LogRecord rec;
+	std::vector<char> data;
+
+	for (; lsn < end; lsn += rec.length)
+	{
+		Status status = log->ReadRecord(lsn, rec, NULL);
+		if (status != OK)
+			return status;
+		if (rec.type != LOG_COMMIT || rec.dataLen != (int)sizeof(TxnID))
+			continue;
+
+		status = log->ReadRecord(lsn, rec, &data);
+		if (status != OK)
+			return status;
+		committed.push_back(*(TxnID *)data.data());
+	}
+	std::sort(committed.begin(), committed.end());
+
+	std::vector<TxnRange> aborted;
+	for (size_t i = 0; i < committed.size(); i++)
+	{
+		if (committed[i] < first || committed[i] >= limit)
+			continue;
+		if (committed[i] > first)
+		{
+			TxnRange range = { first, committed[i] };
+			aborted.push_back(range);
+		}
+		first = committed[i] + 1;
+	}
+	if (first < limit)
+	{
+		TxnRange range = { first, limit };
+		aborted.push_back(range);
+	}
+
+	return log->StartRun(aborted);
+}
+
+
+//------------------------------------------------------------------
+// RecoveryMgr::Analysis
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Reads the log from where the last checkpoint began, or
+//            from further back if the last commit or the oldest lost
+//            change is older.  Pages changed since the checkpoint
+//            began, while its dirty page table was being taken or
+//            after, join the table, each with the first such change.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status RecoveryMgr::Analysis()
+{
+	LogRecord rec;
+	std::vector<char> data;
+	Status status;
+
+	LSN ckptLSN = log->GetCheckpointLSN();
+	LSN beginLSN = LOG_START;
+	LSN start = LOG_START;
+
+	if (ckptLSN != INVALID_LSN)
+	{
+		status = log->ReadRecord(ckptLSN, rec, &data);
+		if (status != OK)
+			return status;
+
+		CheckpointData *ckpt = (CheckpointData *)data.data();
+		DirtyPageEntry *entries = (DirtyPageEntry *)(ckpt + 1);
+
+		beginLSN = ckpt->beginLSN;
+		lastCommitLSN = ckpt->lastCommitLSN;
+		if (lastCommitLSN != INVALID_LSN)
+			start = (lastCommitLSN < beginLSN) ? lastCommitLSN : beginLSN;
+
+		for (int i = 0; i < ckpt->numOfPages; i++)
+		{
+			dirtyPages[entries[i].pid] = entries[i].recLSN;
+			if (entries[i].recLSN < start)
+				start = entries[i].recLSN;
+		}
+	}
+
+	LSN endLSN = log->GetEndLSN();
+
+	for (LSN lsn = start; lsn < endLSN; lsn += rec.length)
+	{
+		status = log->ReadRecord(lsn, rec, NULL);
+		if (status != OK)
+			return status;
+
+		RecordInfo info = { lsn, rec.undone, rec.type };
+		records.push_back(info);
+
+		if (rec.type == LOG_COMMIT)
+			lastCommitLSN = lsn;
+		else if (rec.type == LOG_PAGE_INIT || rec.type == LOG_PAGE_IMAGE ||
+		         rec.type == LOG_PAGE_FREE)
+			lastReset[rec.pid] = lsn;
+
+		if (lsn >= beginLSN && rec.type != LOG_PAGE_FREE && rec.pid != INVALID_PAGE)
+		{
+			dirtyPages.insert(std::make_pair(rec.pid, lsn));
+			if (IsHeapChange(rec.type))
+				dirtyPages.insert(std::make_pair(rec.dirPid, lsn));
+		}
+	}
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// RecoveryMgr::Redo
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Repeats every change from the oldest one a dirty page may
+//            have lost, losers' changes included.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status RecoveryMgr::Redo()
+{
+	if (dirtyPages.empty())
+		return OK;
+
+	LSN redoLSN = dirtyPages.begin()->second;
+	std::map<PageID, LSN>::iterator it;
+	for (it = dirtyPages.begin(); it != dirtyPages.end(); it++)
+	{
+		if (it->second < redoLSN)
+			redoLSN = it->second;
+	}
+
+	LogRecord rec;
+	std::vector<char> data;
+
+	for (unsigned int i = 0; i < records.size(); i++)
+	{
+		short type = records[i].type;
+		if (records[i].lsn < redoLSN ||
+		    !(IsHeapChange(type) || type == LOG_PAGE_INIT || type == LOG_PAGE_IMAGE))
+			continue;
+
+		Status status = log->ReadRecord(records[i].lsn, rec, &data);
+		if (status == OK)
+			status = RedoRecord(rec, data.data());
+		if (status != OK)
+			return status;
+	}
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// RecoveryMgr::Undo
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Undoes the heap changes logged after the last commit,
+//            newest first.  A compensation record shows that the
+//            record it names, and everything after it, is already
+//            undone.  A commit record ends the rollback.
+// Return   : OK on success, the failing status otherwise.
+//------------------------------------------------------------------
+
+Status RecoveryMgr::Undo()
+{
+	LogRecord rec;
+	std::vector<char> data;
+	LSN limit = log->GetEndLSN();
+	bool rolledBack = false;
+
+	for (int i = (int)records.size() - 1; i >= 0 && records[i].lsn > lastCommitLSN; i--)
+	{
+		RecordInfo& info = records[i];
+		if (!IsHeapChange(info.type))
+			continue;
+
+		rolledBack = true;
+		if (info.undone != INVALID_LSN)
+		{
+			if (info.undone < limit)
+				limit = info.undone;
+			continue;
+		}
+		if (info.lsn >= limit)
+			continue;
+
+		Status status = log->ReadRecord(info.lsn, rec, &data);
+		if (status != OK)
+			return status;
+
+		if (GoneAfter(rec, data.data()))
+			continue;
+
+		status = UndoRecord(rec, data.data());
+		if (status != OK)
+			return status;
+	}
+
+	if (rolledBack)
+		return log->Commit();
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// RecoveryMgr::RedoRecord
+//
+// Input    : rec, data - a log record.
+// Output   : None.
+// Purpose  : Repeats one change if the page may have lost it.  A heap
+//            change also brings the page's directory entry up to date.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status RecoveryMgr::RedoRecord(const LogRecord& rec, const char* data)
+{
+	// Whatever was logged for a page before it was reset is gone with it.
+
+	if (ResetAfter(rec.pid, rec.lsn))
+		return OK;
+
+	bool redoPage = InDirtyPages(rec.pid, rec.lsn);
+	HeapPage *page;
+
+	if (rec.type == LOG_PAGE_INIT || rec.type == LOG_PAGE_IMAGE)
+	{
+		if (!redoPage)
+			return OK;
+
+		if (MINIBASE_BM->PinPage(rec.pid, (Page *&)page, true) != OK)
+			return FAIL;
+
+		if (rec.type == LOG_PAGE_INIT)
+		{
+			page->Init(rec.pid);
+			page->SetLSN(rec.lsn);
+		}
+		else
+		{
+			memcpy(page, data, MINIBASE_PAGESIZE);
+		}
+
+		MINIBASE_BM->SetPageLSN(rec.pid, rec.lsn);
+		numOfRedos++;
+		return MINIBASE_BM->UnpinPage(rec.pid, DIRTY);
+	}
+
+	bool redoDir = InDirtyPages(rec.dirPid, rec.lsn);
+	if (!redoPage && !redoDir)
+		return OK;
+
+	RecordID rid;
+	rid.pageNo = rec.pid;
+	rid.slotNo = rec.slotNo;
+	bool dirty = false;
+
+	PIN(rec.pid, page);
+
+	if (redoPage && page->GetLSN() < rec.lsn)
+	{
+		if (ApplyChange(page, rec.type, rid, data, rec.dataLen, rec.kind) != OK)
+		{
+			cerr << "Unable to redo log record " << rec.lsn << " on page " << rec.pid << endl;
+			MINIBASE_BM->UnpinPage(rec.pid, CLEAN);
+			return FAIL;
+		}
+		page->SetLSN(rec.lsn);
+		MINIBASE_BM->SetPageLSN(rec.pid, rec.lsn);
+		dirty = true;
+		numOfRedos++;
+	}
+
+	Status status = OK;
+	if (redoDir)
+		status = FixDirEntry(rec.dirPid, rec.pid, page, rec.lsn);
+
+	UNPIN(rec.pid, dirty);
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// RecoveryMgr::UndoRecord
+//
+// Input    : rec, data - a heap log record after the last commit.
+// Output   : None.
+// Purpose  : Makes the inverse change and logs it as a compensation
+//            record naming rec.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status RecoveryMgr::UndoRecord(const LogRecord& rec, const char* data)
+{
+	RecordID rid;
+	rid.pageNo = rec.pid;
+	rid.slotNo = rec.slotNo;
+
+	short type = rec.type;
+	const char *undoData = data;
+	char swapped[2 * MAX_SPACE];
+	int recLen = rec.dataLen / 2;
+
+	switch (rec.type)
+	{
+	case LOG_INSERT:
+		type = LOG_DELETE;
+		break;
+
+	case LOG_DELETE:
+		type = LOG_INSERT;
+		break;
+
+	case LOG_UPDATE:
+		memcpy(swapped, data + recLen, recLen);
+		memcpy(swapped + recLen, data, recLen);
+		undoData = swapped;
+		break;
+	}
+
+	HeapPage *page;
+	PIN(rec.pid, page);
+
+	if (ApplyChange(page, type, rid, undoData, rec.dataLen, rec.kind) != OK)
+	{
+		cerr << "Unable to undo log record " << rec.lsn << " on page " << rec.pid << endl;
+		MINIBASE_BM->UnpinPage(rec.pid, CLEAN);
+		return FAIL;
+	}
+
+	LSN lsn = log->LogCompensation(type, rid, rec.dirPid, undoData, rec.dataLen, rec.lsn,
+	                               rec.kind);
+	page->SetLSN(lsn);
+	MINIBASE_BM->SetPageLSN(rec.pid, lsn);
+	numOfUndos++;
+
+	Status status = FixDirEntry(rec.dirPid, rec.pid, page, lsn);
+
+	UNPIN(rec.pid, DIRTY);
+
+	// A large record that is no more takes its overflow pages with it.
+
+	if (status == OK && rec.type == LOG_INSERT && rec.kind == SLOT_LARGE)
+		status = FreeOverflow(*(const LargeRecordHeader *)data);
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// RecoveryMgr::FixDirEntry
+//
+// Input    : dirPid - directory page listing pid,
+//            pid, page - a pinned heap page,
+//            lsn - the record the directory change belongs to.
+// Output   : None.
+// Purpose  : Sets the record count and free space in the directory
+//            entry of the page from the page itself.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status RecoveryMgr::FixDirEntry(PageID dirPid, PageID pid, HeapPage* page, LSN lsn)
+{
+	DirPage *dirPage;
+	PIN(dirPid, dirPage);
+
+	PageInfo *info = dirPage->FindPageInfo(pid);
+	if (info == NULL)
+	{
+		UNPIN(dirPid, CLEAN);
+		return OK;
+	}
+
+	info->spaceAvailable = page->AvailableSpace();
+	info->numOfRecords = page->GetNumOfRecords();
+	MINIBASE_BM->SetPageLSN(dirPid, lsn);
+
+	UNPIN(dirPid, DIRTY);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// RecoveryMgr::InDirtyPages
+//
+// Input    : pid - a page,
+//            lsn - a change to it.
+// Output   : None.
+// Purpose  : Tells whether the page may have lost the change: it is
+//            in the dirty page table, and the change is no older than
+//            the first one the page has not written out.
+// Return   : true if the change may need redoing.
+//------------------------------------------------------------------
+
+bool RecoveryMgr::InDirtyPages(PageID pid, LSN lsn)
+{
+	std::map<PageID, LSN>::iterator it = dirtyPages.find(pid);
+	return it != dirtyPages.end() && it->second <= lsn;
+}
+
+
+bool RecoveryMgr::ResetAfter(PageID pid, LSN lsn)
+{
+	std::map<PageID, LSN>::iterator it = lastReset.find(pid);
+	return it != lastReset.end() && it->second > lsn;
+}
+
+
+//------------------------------------------------------------------
+// RecoveryMgr::GoneAfter
+//
+// Input    : rec, data - a heap log record.
+// Output   : None.
+// Purpose  : Tells whether what the record changed was freed later:
+//            its page, or for a large record its overflow pages.  The
+//            record is gone with them and the change is not undone.
+// Return   : true if the change is gone.
+//------------------------------------------------------------------
+
+bool RecoveryMgr::GoneAfter(const LogRecord& rec, const char* data)
+{
+	if (ResetAfter(rec.pid, rec.lsn))
+		return true;
+	if (rec.kind != SLOT_LARGE || rec.dataLen != (int)sizeof(LargeRecordHeader))
+		return false;
+
+	const LargeRecordHeader *header = (const LargeRecordHeader *)data;
+	return header->numOfPages > 0 && ResetAfter(header->firstPage, rec.lsn);
+}
@@ -0,0 +1,66 @@
+#include "replacer.h"
+#include "metrics.h"
+
+Replacer::Replacer()
+{
+}
+
+
+Replacer::~Replacer()
+{
+}
+
+
+Clock::Clock(int bufSize, Frame **frames)
+{
+	this->current = 0;
+	this->numOfFrames = bufSize;
+	this->frames = frames;
+}
+
+
+Clock::~Clock()
+{
+}
+
+
+//------------------------------------------------------------------
+// Clock::PickVictim
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Sweeps the clock hand over the frames, clearing the
+//            referenced bit of each frame it passes, until it finds
+//            an unpinned frame whose bit is already clear.  The page
+//            the victim may still hold is left to the caller (see
+//            BufMgr::EvictFrame).  The number of frames looked at goes
+//            to the bufmgr.evict.scan histogram.
+// Return   : The victim's frame number, or INVALID_FRAME if every
+//            frame is pinned.
+//------------------------------------------------------------------
+
+int Clock::PickVictim()
+{
+	static Histogram& scanLength = minibase_metrics.GetHistogram("bufmgr.evict.scan");
+
+	for (int i = 0; i < 2 * numOfFrames; i++)
+	{
+		Frame *frame = frames[current];
+
+		if (frame->IsVictim())
+		{
+			scanLength.Record(i + 1);
+			return current;
+		}
+
+		if (frame->IsReferenced())
+			frame->UnsetReferenced();
+
+		current++;
+		if (current == numOfFrames)
+			current = 0;
+	}
+
+	scanLength.Record(2 * numOfFrames);
+	return INVALID_FRAME;
+}
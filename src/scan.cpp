@@ -0,0 +1,420 @@
+#include <cstring>
+
+#include "scan.h"
+#include "heapfile.h"
+#include "bufmgr.h"
+#include "metrics.h"
+#include "ioservice.h"
+
+//------------------------------------------------------------------
+// Constructor of Scan
+//
+// Input    : hf - the file to scan.
+// Output   : status - OK if the scan was opened.
+// Purpose  : Positions the scan on the first record of the file.
+//            The current directory page and data page stay pinned
+//            while the scan is on them.
+//------------------------------------------------------------------
+
+Scan::Scan(HeapFile *hf, Status& status)
+{
+	Open(hf, status);
+}
+
+
+//------------------------------------------------------------------
+// Constructor of Scan
+//
+// Input    : hf - a versioned file to scan,
+//            snapshot - what the scan is to see.
+// Output   : status - OK if the scan was opened.
+// Purpose  : Positions the scan on the first record of the file; it
+//            returns, under its own record ID, the version of each
+//            record the snapshot sees, and none of records it does not.
+//------------------------------------------------------------------
+
+Scan::Scan(HeapFile *hf, const Snapshot& snapshot, Status& status)
+	: snapshot(snapshot), version(MAX_SPACE)
+{
+	Open(hf, status);
+	versioned = true;
+}
+
+
+void Scan::Open(HeapFile *hf, Status& status)
+{
+	file = hf;
+	versioned = false;
+	currDirPid = hf->GetFirstDirPage();
+	firstDirPid = currDirPid;
+	currEntry = 0;
+	page = NULL;
+	noMore = false;
+	pageUsedUp = false;
+	records = hf->scanRecords;
+
+	MINIBASE_BM->PinPage(currDirPid, (Page *&)dirPage);
+
+	status = NextPage();
+}
+
+
+//------------------------------------------------------------------
+// Destructor of Scan
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Unpins whatever pages the scan still holds.
+//------------------------------------------------------------------
+
+Scan::~Scan()
+{
+	if (page != NULL)
+		MINIBASE_BM->UnpinPage(currPid, CLEAN);
+	if (dirPage != NULL)
+		MINIBASE_BM->UnpinPage(currDirPid, CLEAN);
+}
+
+
+//------------------------------------------------------------------
+// Scan::GetNext
+//
+// Input    : None.
+// Output   : rid - record ID of the next record,
+//            recPtr - a copy of the record,
+//            recLen - its length.
+// Purpose  : Returns the record under the scan and moves the scan
+//            on to the next one, crossing to the next data page and
+//            directory page as needed.
+// Return   : OK if a record was returned, DONE if the scan is over,
+//            FAIL otherwise.
+//------------------------------------------------------------------
+
+Status Scan::GetNext(RecordID& rid, char *recPtr, int& recLen)
+{
+	if (!versioned)
+		return NextRecord(rid, recPtr, recLen);
+
+	Status status;
+	int versionLen;
+	VersionInfo info;
+	while ((status = NextRecord(rid, &version[0], versionLen)) == OK)
+	{
+		if (versionLen < (int)sizeof(VersionInfo))
+		{
+			cerr << "Scan::GetNext - record " << rid << " has no version\n";
+			return FAIL;
+		}
+
+		// Old versions are reached from their records.
+		memcpy(&info, &version[versionLen - sizeof(VersionInfo)], sizeof(VersionInfo));
+		if (info.copy)
+			continue;
+
+		status = file->FindVisible(snapshot, &version[0], versionLen, recPtr, recLen);
+		if (status != DONE)
+			return status;
+	}
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// Scan::GetNextAsync
+//
+// Input    : done - called with the outcome of GetNext.
+// Output   : rid, recPtr - as for GetNext, once done is called.
+// Purpose  : Calls GetNext in the calling thread if it stays on the
+//            data page the scan holds, and on one of MINIBASE_IO's
+//            threads if it may have to read another page.  The next
+//            data page, if the directory page the scan holds lists it,
+//            is fetched first (see BufMgr::FetchPage), so that no
+//            thread waits for it; the page a moved record went to, the
+//            next directory page, and the older versions a scan of a
+//            snapshot reads are read by GetNext itself.
+// Return   : None.
+//------------------------------------------------------------------
+
+void Scan::GetNextAsync(RecordID& rid, char *recPtr, ReadCallback done)
+{
+	if (NextIsOnPage())
+	{
+		int recLen;
+		Status status = GetNext(rid, recPtr, recLen);
+		done(status, recLen);
+		return;
+	}
+
+	Scan *scan = this;
+	RecordID *ridPtr = &rid;
+	std::function<void ()> next = [scan, ridPtr, recPtr, done]() {
+		int recLen;
+		Status status = scan->GetNext(*ridPtr, recPtr, recLen);
+		done(status, recLen);
+	};
+
+	PageID pid = NextListedPage();
+	if (pid == INVALID_PAGE || MINIBASE_BM->IsResident(pid))
+		MINIBASE_IO->Submit(next);
+	else
+		MINIBASE_BM->FetchPage(pid, [next, done](Status status) {
+			if (status != OK)
+				done(status, 0);
+			else
+				next();
+		});
+}
+
+
+// The data page after the one the scan holds, if GetNext moves on to it
+// and the directory page the scan holds lists it; INVALID_PAGE otherwise.
+PageID Scan::NextListedPage()
+{
+	RecordID next;
+
+	if (versioned || noMore || dirPage == NULL)
+		return INVALID_PAGE;
+	if (!pageUsedUp && page->NextRecord(currRid, next) == OK)
+		return INVALID_PAGE;
+
+	PageInfo *info = dirPage->GetPageInfo(currEntry);
+	return (info == NULL) ? INVALID_PAGE : info->pid;
+}
+
+
+// True if the next GetNext reads nothing but the data page the scan
+// holds, and does not move on from it.
+bool Scan::NextIsOnPage()
+{
+	RecordID next;
+
+	if (noMore && !pageUsedUp)
+		return true;
+	return !versioned && !pageUsedUp && page->GetSlotKind(currRid) != SLOT_FORWARD
+	       && page->NextRecord(currRid, next) == OK;
+}
+
+
+Status Scan::NextRecord(RecordID& rid, char *recPtr, int& recLen)
+{
+	if (pageUsedUp)
+	{
+		pageUsedUp = false;
+		if (NextPage() != OK)
+			return FAIL;
+	}
+
+	if (noMore)
+		return DONE;
+
+	// A stub is followed to its record, which takes the stub's place.
+
+	rid = currRid;
+	Status status = (page->GetSlotKind(rid) == SLOT_FORWARD)
+	                ? file->GetRecord(rid, recPtr, recLen)
+	                : page->GetRecord(rid, recPtr, recLen);
+	if (status != OK)
+		return FAIL;
+	records->Add();
+
+	status = page->NextRecord(currRid, currRid);
+	if (status != DONE)
+		return OK;
+
+	// This page is used up; move on to the next one.  If there is none,
+	// the record just returned was the last one.
+
+	if (NextPage() != OK)
+		return FAIL;
+
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// Scan::GetNextBatch
+//
+// Input    : None.
+// Output   : recPtrs - the records left on the current data page,
+//            recLens - their lengths.
+// Purpose  : Returns the rest of the page in place.  The page is left
+//            pinned for the caller to read the records from; the next
+//            call moves on to the next page.  Records moved to other
+//            pages are copied out instead, and kept until then.
+// Return   : OK if records were returned, DONE if the scan is over,
+//            FAIL otherwise.
+//------------------------------------------------------------------
+
+Status Scan::GetNextBatch(std::vector<char*>& recPtrs, std::vector<int>& recLens)
+{
+	recPtrs.clear();
+	recLens.clear();
+
+	if (versioned)
+	{
+		cerr << "Scan::GetNextBatch - cannot read versions in place\n";
+		return FAIL;
+	}
+
+	if (pageUsedUp)
+	{
+		pageUsedUp = false;
+		if (NextPage() != OK)
+			return FAIL;
+	}
+
+	if (noMore)
+		return DONE;
+
+	Status status;
+	size_t numOfMoved = 0;
+	do
+	{
+		char *recPtr;
+		int recLen;
+		if (page->GetSlotKind(currRid) == SLOT_FORWARD)
+		{
+			if (numOfMoved == moved.size())
+				moved.push_back(std::vector<char>(MAX_SPACE));
+			recPtr = &moved[numOfMoved++][0];
+			if (file->GetRecord(currRid, recPtr, recLen) != OK)
+				return FAIL;
+		}
+		else if (page->ReturnRecord(currRid, recPtr, recLen) != OK)
+			return FAIL;
+		recPtrs.push_back(recPtr);
+		recLens.push_back(recLen);
+	} while ((status = page->NextRecord(currRid, currRid)) == OK);
+
+	if (status != DONE)
+		return FAIL;
+
+	records->Add(recPtrs.size());
+	pageUsedUp = true;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// Scan::NextPage
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Moves the scan on to the first record of the next data
+//            page, crossing to the next directory page as needed.
+//            Empty pages, which recovery leaves behind when it undoes
+//            the inserts that filled them, are passed over.  If no
+//            page is left, noMore is set.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status Scan::NextPage()
+{
+	Status status;
+
+	do
+	{
+		if (page != NULL)
+		{
+			UNPIN(currPid, CLEAN);
+			page = NULL;
+		}
+
+		PageInfo *info = dirPage->GetPageInfo(currEntry);
+		currEntry++;
+
+		while (info == NULL)
+		{
+			PageID nextDirPid = dirPage->GetNextPage();
+			UNPIN(currDirPid, CLEAN);
+			dirPage = NULL;
+
+			if (nextDirPid == INVALID_PAGE)
+			{
+				noMore = true;
+				return OK;
+			}
+
+			PIN(nextDirPid, dirPage);
+			currDirPid = nextDirPid;
+			currEntry = 0;
+			info = dirPage->GetPageInfo(currEntry);
+			currEntry++;
+		}
+
+		currPid = info->pid;
+		PIN(currPid, page);
+		status = page->FirstRecord(currRid);
+	} while (status == DONE);
+
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// Scan::MoveTo
+//
+// Input    : rid - record ID to move the scan to.
+// Output   : None.
+// Purpose  : Positions the scan so that the next call to GetNext
+//            returns the given record.
+// Return   : OK on success, FAIL if no page of the file holds the
+//            record.
+//------------------------------------------------------------------
+
+Status Scan::MoveTo(RecordID rid)
+{
+	currRid = rid;
+	pageUsedUp = false;
+
+	if (currPid == rid.pageNo && !noMore)
+	{
+		noMore = false;
+		return OK;
+	}
+
+	if (page != NULL)
+	{
+		UNPIN(currPid, CLEAN);
+		page = NULL;
+	}
+
+	if (dirPage != NULL)
+	{
+		UNPIN(currDirPid, CLEAN);
+		dirPage = NULL;
+	}
+
+	currPid = rid.pageNo;
+
+	DirPageIterator dirIter(firstDirPid);
+	PageInfo *info = NULL;
+
+	while ((currDirPid = dirIter()) != INVALID_PAGE)
+	{
+		PIN(currDirPid, dirPage);
+
+		PageInfoIterator infoIter(dirPage);
+		currEntry = 0;
+		while ((info = infoIter()) != NULL)
+		{
+			currEntry++;
+			if (info->pid == currPid)
+				break;
+		}
+
+		if (info != NULL)
+			break;
+
+		UNPIN(currDirPid, CLEAN);
+		dirPage = NULL;
+	}
+
+	if (info == NULL)
+		return FAIL;
+
+	PIN(currPid, page);
+	noMore = false;
+
+	return OK;
+}
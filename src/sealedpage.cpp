@@ -0,0 +1,403 @@
+#include <iostream>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "sealedpage.h"
+
+using namespace std;
+
+
+//------------------------------------------------------------------
+// Bit packing helpers.  Values are packed least significant bit
+// first; a value is at most 32 bits wide.
+//------------------------------------------------------------------
+
+static void PutBits(char *buf, int bitPos, int width, unsigned int value)
+{
+	for (int i = 0; i < width; i++, bitPos++){
+		unsigned char mask = (unsigned char)(1 << (bitPos & 7));
+		if (value & (1u << i))
+			buf[bitPos >> 3] |= mask;
+		else
+			buf[bitPos >> 3] &= ~mask;
+	}
+}
+
+static unsigned int GetBits(const char *buf, int bitPos, int width)
+{
+	if (width == 0)
+		return 0;
+	int first = bitPos >> 3;
+	int shift = bitPos & 7;
+	int nbytes = (shift + width + 7) >> 3;
+	unsigned long long acc = 0;
+	for (int i = 0; i < nbytes; i++)
+		acc |= (unsigned long long)(unsigned char)buf[first + i] << (8 * i);
+	return (unsigned int)((acc >> shift) & ((1ull << width) - 1));
+}
+
+static int BitsNeeded(unsigned long long range)
+{
+	int width = 0;
+	while (range > 0){
+		width++;
+		range >>= 1;
+	}
+	return width;
+}
+
+static int PackedBytes(int count, int width)
+{
+	return (count * width + 7) / 8;
+}
+
+
+//------------------------------------------------------------------
+// SealedPage::Seal
+//
+// Input     : The heap page to seal and the layout of its records
+// Output    : None
+// Purpose   : Build a compressed image of the page.  Integer columns
+//             are stored as offsets from the column minimum, string
+//             columns through a per-page dictionary; either falls back
+//             to the raw bytes when encoding does not pay off.
+// Return    : OK if the page was sealed, DONE if it cannot be sealed
+//             (records of different lengths, stubs of records moved
+//             to other pages, or no space saved),
+//             FAIL if the column layout is invalid
+//------------------------------------------------------------------
+
+Status SealedPage::Seal(HeapPage* page, const ColumnDesc* cols, int numCols)
+{
+	if (numCols < 0 || numCols > MAX_SEALED_COLUMNS)
+		return FAIL;
+
+	this->lsn = page->lsn;
+	this->pid = page->pid;
+	this->nextPage = page->nextPage;
+	this->prevPage = page->prevPage;
+	this->numOfSlots = page->numOfSlots;
+	this->numOfRecords = 0;
+	this->recLen = 0;
+	this->numOfCols = numCols;
+
+	// Every record has to share one length for the column layout to apply,
+	// and stubs and moved records have none.
+	for (int i = 0; i < page->numOfSlots; i++){
+		if (SLOT_IS_EMPTY(page->Slots()[i]))
+			continue;
+		if (SLOT_KIND(page->Slots()[i]) != SLOT_RECORD)
+			return DONE;
+		if (numOfRecords > 0 && page->Slots()[i].length != recLen)
+			return DONE;
+		recLen = page->Slots()[i].length;
+		numOfRecords++;
+	}
+
+	int covered = 0;
+	int end = 0;
+	for (int c = 0; c < numCols; c++){
+		if (cols[c].offset < end || cols[c].length <= 0)
+			return FAIL;
+		end = cols[c].offset + cols[c].length;
+		covered += cols[c].length;
+	}
+	if (numOfRecords > 0 && end > recLen)
+		return FAIL;
+
+	// Records in slot order; index i of recs is the rank of the record.
+	const char **recs = new const char*[numOfRecords > 0 ? numOfRecords : 1];
+	int bitmapLen = (numOfSlots + 7) / 8;
+	if (bitmapLen > SEALEDPAGE_DATA_SIZE){
+		delete [] recs;
+		return DONE;
+	}
+	memset(data, 0, bitmapLen);
+	for (int i = 0, n = 0; i < numOfSlots; i++){
+		if (SLOT_IS_EMPTY(page->Slots()[i]))
+			continue;
+		data[i >> 3] |= (char)(1 << (i & 7));
+		recs[n++] = &page->data[SLOT_OFFSET(page->Slots()[i])];
+	}
+
+	int pos = bitmapLen;
+	Status status = OK;
+	for (int c = 0; c < numCols && status == OK; c++){
+		Block &b = blocks[c];
+		int len = cols[c].length;
+		b.colOffset = cols[c].offset;
+		b.colLength = len;
+		b.dataOffset = pos;
+		b.encoding = SEAL_RAW;
+		b.width = 0;
+		b.base = 0;
+
+		int rawBytes = numOfRecords * len;
+		int bytes = rawBytes;
+
+		if (cols[c].type == attrInteger && len == sizeof(int) && numOfRecords > 0){
+			int lo, hi, v;
+			memcpy(&lo, recs[0] + b.colOffset, sizeof(int));
+			hi = lo;
+			for (int r = 1; r < numOfRecords; r++){
+				memcpy(&v, recs[r] + b.colOffset, sizeof(int));
+				if (v < lo) lo = v;
+				if (v > hi) hi = v;
+			}
+			int width = BitsNeeded((unsigned long long)((long long)hi - lo));
+			if (PackedBytes(numOfRecords, width) < rawBytes){
+				b.encoding = SEAL_FOR;
+				b.width = (char)width;
+				b.base = lo;
+				bytes = PackedBytes(numOfRecords, width);
+			}
+		}
+		else if (cols[c].type == attrString && numOfRecords > 0){
+			// Entries live in the data area itself, at the start of the block.
+			int entries = 0;
+			int *codes = new int[numOfRecords];
+			for (int r = 0; r < numOfRecords; r++){
+				int e = 0;
+				while (e < entries && memcmp(&data[pos + e * len], recs[r] + b.colOffset, len) != 0)
+					e++;
+				if (e == entries){
+					if (entries == 256 || pos + (entries + 1) * len > SEALEDPAGE_DATA_SIZE){
+						entries = -1;
+						break;
+					}
+					memcpy(&data[pos + e * len], recs[r] + b.colOffset, len);
+					entries++;
+				}
+				codes[r] = e;
+			}
+			if (entries > 0){
+				int width = BitsNeeded((unsigned long long)(entries - 1));
+				int dictBytes = entries * len + PackedBytes(numOfRecords, width);
+				if (dictBytes < rawBytes && pos + dictBytes <= SEALEDPAGE_DATA_SIZE){
+					b.encoding = SEAL_DICT;
+					b.width = (char)width;
+					b.base = entries;
+					bytes = dictBytes;
+					char *packed = &data[pos + entries * len];
+					memset(packed, 0, PackedBytes(numOfRecords, width));
+					for (int r = 0; r < numOfRecords; r++)
+						PutBits(packed, r * width, width, (unsigned int)codes[r]);
+				}
+			}
+			delete [] codes;
+		}
+
+		if (pos + bytes > SEALEDPAGE_DATA_SIZE){
+			status = DONE;
+			break;
+		}
+
+		if (b.encoding == SEAL_FOR){
+			char *packed = &data[pos];
+			memset(packed, 0, bytes);
+			for (int r = 0; r < numOfRecords; r++){
+				int v;
+				memcpy(&v, recs[r] + b.colOffset, sizeof(int));
+				PutBits(packed, r * b.width, b.width, (unsigned int)((long long)v - b.base));
+			}
+		}
+		else if (b.encoding == SEAL_RAW){
+			for (int r = 0; r < numOfRecords; r++)
+				memcpy(&data[pos + r * len], recs[r] + b.colOffset, len);
+		}
+		pos += bytes;
+	}
+
+	// Whatever the columns leave uncovered is kept verbatim.
+	int residualLen = (numOfRecords > 0) ? recLen - covered : 0;
+	residualOffset = pos;
+	if (status == OK && pos + numOfRecords * residualLen > SEALEDPAGE_DATA_SIZE)
+		status = DONE;
+	for (int r = 0; r < numOfRecords && status == OK; r++){
+		int from = 0;
+		for (int c = 0; c <= numCols; c++){
+			int to = (c < numCols) ? blocks[c].colOffset : recLen;
+			memcpy(&data[pos], recs[r] + from, to - from);
+			pos += to - from;
+			if (c < numCols)
+				from = blocks[c].colOffset + blocks[c].colLength;
+		}
+	}
+	dataLen = pos;
+
+	delete [] recs;
+
+	if (status == OK && SealedSize() >= MAX_SPACE - page->freeSpace)
+		status = DONE;
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// SealedPage::Unseal
+//
+// Input     : Page to restore into
+// Output    : None
+// Purpose   : Decompress the whole sealed page back into a heap page.
+//             Slot numbers, and therefore record IDs, are preserved.
+// Return    : OK
+//------------------------------------------------------------------
+
+Status SealedPage::Unseal(HeapPage* page)
+{
+	page->Init(pid);
+	page->SetNextPage(nextPage);
+	page->SetPrevPage(prevPage);
+	page->SetLSN(lsn);
+
+	int rank = 0;
+	for (int i = 0; i < numOfSlots; i++){
+		if (!(data[i >> 3] & (1 << (i & 7)))){
+			SLOT_SET_EMPTY(page->Slots()[i]);
+			continue;
+		}
+		page->fillPtr -= recLen;
+		DecodeRecord(rank++, &page->data[page->fillPtr]);
+		SLOT_FILL(page->Slots()[i], page->fillPtr, recLen);
+	}
+	page->numOfSlots = numOfSlots;
+	page->freeSpace = HEAPPAGE_DATA_SIZE - numOfSlots * sizeof(HeapPage::Slot) - numOfRecords * recLen;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// SealedPage::FirstRecord
+//
+// Input    : None
+// Output   : record id of the first record on a page
+// Purpose  : To find the first record on a page
+// Return   : OK if successful, DONE otherwise
+//------------------------------------------------------------------
+
+Status SealedPage::FirstRecord(RecordID& rid)
+{
+	RecordID before;
+	before.pageNo = pid;
+	before.slotNo = -1;
+	return NextRecord(before, rid);
+}
+
+
+//------------------------------------------------------------------
+// SealedPage::NextRecord
+//
+// Input    : ID of the current record
+// Output   : ID of the next record
+// Return   : Return DONE if no more records exist on the page;
+//            otherwise OK.
+//------------------------------------------------------------------
+
+Status SealedPage::NextRecord(RecordID curRid, RecordID& nextRid)
+{
+	for (int i = curRid.slotNo + 1; i < numOfSlots; i++){
+		if (data[i >> 3] & (1 << (i & 7))){
+			nextRid.pageNo = pid;
+			nextRid.slotNo = i;
+			return OK;
+		}
+	}
+	return DONE;
+}
+
+
+//------------------------------------------------------------------
+// SealedPage::GetRecord
+//
+// Input    : Record ID
+// Output   : Records length and a copy of the record itself
+// Purpose  : To decode a single record without unsealing the page
+// Return   : OK if successful, FAIL otherwise
+//------------------------------------------------------------------
+
+Status SealedPage::GetRecord(RecordID rid, char *recPtr, int& length)
+{
+	if (rid.slotNo < 0 || rid.slotNo >= numOfSlots)
+		return FAIL;
+	if (!(data[rid.slotNo >> 3] & (1 << (rid.slotNo & 7))))
+		return FAIL;
+	DecodeRecord(Rank(rid.slotNo), recPtr);
+	length = recLen;
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// SealedPage::SealedSize
+//
+// Input    : None
+// Output   : None
+// Purpose  : To report how many bytes of the page the image uses.
+// Return   : Size of the header plus the data in use.
+//------------------------------------------------------------------
+
+int SealedPage::SealedSize()
+{
+	return (MAX_SPACE - SEALEDPAGE_DATA_SIZE) + dataLen;
+}
+
+
+//------------------------------------------------------------------
+// SealedPage::Rank
+//
+// Input    : Slot number of a filled slot
+// Output   : None
+// Purpose  : Count the filled slots in front of the given one.
+// Return   : Position of the record in the column blocks.
+//------------------------------------------------------------------
+
+int SealedPage::Rank(int slotNo)
+{
+	int rank = 0;
+	for (int i = 0; i < (slotNo >> 3); i++)
+		rank += __builtin_popcount((unsigned char)data[i]);
+	unsigned char tail = (unsigned char)data[slotNo >> 3] & ((1 << (slotNo & 7)) - 1);
+	return rank + __builtin_popcount(tail);
+}
+
+
+//------------------------------------------------------------------
+// SealedPage::DecodeRecord
+//
+// Input    : Rank of the record, buffer of at least recLen bytes
+// Output   : The decoded record
+// Purpose  : Reassemble one record from its columns and residual bytes.
+// Return   : None
+//------------------------------------------------------------------
+
+void SealedPage::DecodeRecord(int rank, char* recPtr)
+{
+	int residualLen = recLen;
+	for (int c = 0; c < numOfCols; c++)
+		residualLen -= blocks[c].colLength;
+
+	const char *residual = &data[residualOffset + rank * residualLen];
+	int from = 0;
+	for (int c = 0; c <= numOfCols; c++){
+		int to = (c < numOfCols) ? blocks[c].colOffset : recLen;
+		memcpy(recPtr + from, residual, to - from);
+		residual += to - from;
+		if (c == numOfCols)
+			break;
+
+		Block &b = blocks[c];
+		const char *block = &data[b.dataOffset];
+		if (b.encoding == SEAL_FOR){
+			int v = (int)((long long)b.base + GetBits(block, rank * b.width, b.width));
+			memcpy(recPtr + b.colOffset, &v, sizeof(int));
+		}
+		else if (b.encoding == SEAL_DICT){
+			unsigned int code = GetBits(block + b.base * b.colLength, rank * b.width, b.width);
+			memcpy(recPtr + b.colOffset, block + code * b.colLength, b.colLength);
+		}
+		else{
+			memcpy(recPtr + b.colOffset, block + rank * b.colLength, b.colLength);
+		}
+		from = b.colOffset + b.colLength;
+	}
+}
@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <cstring>
+
+#include "sort.h"
+#include "index.h"
+#include "heapfile.h"
+#include "scan.h"
+#include "bufmgr.h"
+#include "db.h"
+
+
+//------------------------------------------------------------------
+// Constructor of ExternalSort
+//
+// Input    : keyOffset, keyType, keyLength - the key to sort on,
+//            order - Ascending or Descending,
+//            numOfFrames - frames of the buffer pool to sort in.
+// Output   : None.
+// Purpose  : Records the key; Run checks it.
+//------------------------------------------------------------------
+
+ExternalSort::ExternalSort(int keyOffset, AttrType keyType, int keyLength,
+                           TupleOrder order, int numOfFrames)
+	: keyOffset(keyOffset), keyType(keyType), keyLength(keyLength),
+	  order(order), numOfFrames(numOfFrames), numOfRuns(0), numOfPasses(0)
+{
+}
+
+
+bool ExternalSort::Less(const char* a, const char* b) const
+{
+	int c = CompareKeys(keyType, keyLength, a + keyOffset, b + keyOffset);
+	return (order == Descending) ? c > 0 : c < 0;
+}
+
+
+void ExternalSort::SortRecords(std::vector<SortRecord>& recs)
+{
+	std::stable_sort(recs.begin(), recs.end(),
+		[this](const SortRecord& a, const SortRecord& b)
+		{
+			return Less(a.recPtr, b.recPtr);
+		});
+}
+
+
+//------------------------------------------------------------------
+// ExternalSort::Run
+//
+// Input    : in - the file to sort.
+// Output   : out - gets the records of in, in order.
+// Purpose  : Takes the frames of the sort from the buffer pool,
+//            generates runs, merges them until few enough are left to
+//            merge into out, and gives the frames back.
+// Return   : OK on success, FAIL if the key or the memory is invalid, the
+//            pool has too few unpinned frames, a record is too short to
+//            hold the key, or I/O fails.
+//------------------------------------------------------------------
+
+Status ExternalSort::Run(HeapFile& in, HeapFile& out)
+{
+	numOfRuns = numOfPasses = 0;
+
+	if (!KeyIsValid(keyOffset, keyType, keyLength) || order == Random)
+	{
+		cerr << "ExternalSort::Run - cannot sort on the key\n";
+		return FAIL;
+	}
+	if (numOfFrames < 3)
+	{
+		cerr << "ExternalSort::Run - needs at least 3 frames\n";
+		return FAIL;
+	}
+	if (MINIBASE_BM->GetWorkFrames(numOfFrames, frames) != OK)
+	{
+		cerr << "ExternalSort::Run - the pool has not " << numOfFrames
+		     << " unpinned frames\n";
+		return FAIL;
+	}
+
+	std::vector<SpillRun> runs;
+	Status status = MakeRuns(in, out, runs);
+	numOfPasses = 1;
+	numOfRuns = runs.size();
+
+	size_t fanIn = numOfFrames - 1;
+
+	while (status == OK && runs.size() > fanIn)
+	{
+		std::vector<SpillRun> merged;
+
+		for (size_t first = 0; first < runs.size() && status == OK; first += fanIn)
+		{
+			size_t n = std::min(fanIn, runs.size() - first);
+			merged.push_back(SpillRun());
+
+			SpillWriter writer(space, frames[numOfFrames - 1]);
+			status = writer.Begin(&merged.back());
+			if (status == OK)
+				status = Merge(runs, first, n, &writer, NULL);
+			Status endStatus = writer.End();
+			if (status == OK)
+				status = endStatus;
+
+			for (size_t i = first; i < first + n; i++)
+				runs[i].Free();
+		}
+
+		for (size_t i = 0; i < runs.size(); i++)
+			runs[i].Free();
+		runs.swap(merged);
+		numOfPasses++;
+	}
+
+	// No more runs are written; out may need the pages.
+	space.Release();
+
+	if (status == OK && !runs.empty())
+	{
+		status = Merge(runs, 0, runs.size(), NULL, &out);
+		numOfPasses++;
+	}
+
+	for (size_t i = 0; i < runs.size(); i++)
+		runs[i].Free();
+	MINIBASE_BM->ReleaseWorkFrames(frames);
+
+	return status;
+}
+
+
+//------------------------------------------------------------------
+// ExternalSort::MakeRuns
+//
+// Input    : in - the file to sort.
+// Output   : out - gets the records if they all fit in memory,
+//            runs - the sorted runs otherwise.
+// Purpose  : Packs the records of a scan into every frame but the last,
+//            writing them as a run, sorted, each time the frames are full.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status ExternalSort::MakeRuns(HeapFile& in, HeapFile& out, std::vector<SpillRun>& runs)
+{
+	Status status;
+	Scan *scan = in.OpenScan(status);
+	if (status != OK)
+		return status;
+
+	std::vector<SortRecord> recs;
+	int frame = 0;
+	int used = 0;
+
+	char rec[MAX_SPACE];
+	RecordID rid;
+	int len;
+
+	while ((status = scan->GetNext(rid, rec, len)) == OK)
+	{
+		if (keyOffset + keyLength > len)
+		{
+			cerr << "ExternalSort::Run - record " << rid << " has no key\n";
+			status = FAIL;
+			break;
+		}
+
+		if (used + len > (int)sizeof(Page))
+		{
+			frame++;
+			used = 0;
+		}
+		if (frame == numOfFrames - 1)
+		{
+			status = WriteRun(recs, runs);
+			if (status != OK)
+				break;
+			frame = 0;
+		}
+
+		SortRecord sortRec = { (char*)frames[frame] + used, len };
+		memcpy(sortRec.recPtr, rec, len);
+		recs.push_back(sortRec);
+		used += len;
+	}
+	delete scan;
+
+	if (status != DONE)
+		return status;
+
+	if (!runs.empty())
+		return recs.empty() ? OK : WriteRun(recs, runs);
+
+	SortRecords(recs);
+	for (size_t i = 0; i < recs.size(); i++)
+	{
+		if (out.AppendRecord(recs[i].recPtr, recs[i].recLen, rid) != OK)
+			return FAIL;
+	}
+	return OK;
+}
+
+
+Status ExternalSort::WriteRun(std::vector<SortRecord>& recs, std::vector<SpillRun>& runs)
+{
+	SortRecords(recs);
+
+	runs.push_back(SpillRun());
+	SpillWriter writer(space, frames[numOfFrames - 1]);
+
+	Status status = writer.Begin(&runs.back());
+	for (size_t i = 0; i < recs.size() && status == OK; i++)
+		status = writer.Append(recs[i].recPtr, recs[i].recLen);
+
+	Status endStatus = writer.End();
+	recs.clear();
+	return (status == OK) ? endStatus : status;
+}
+
+
+//------------------------------------------------------------------
+// ExternalSort::Merge
+//
+// Input    : runs - the runs,
+//            first, n - the n runs to merge, from first.
+// Output   : writer - the run to merge into, or
+//            out - the file to merge into if writer is NULL.
+// Purpose  : Merges the runs with a loser tree.  Node 0 holds the run
+//            whose record is next, nodes 1 to n-1 the loser of the match
+//            played there; run i plays from node (i + n) / 2 up.  Run n
+//            stands for a record before every other while the tree is
+//            built, and a run that is done for one after every other.
+//            Ties go to the earlier run, keeping the merge stable.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status ExternalSort::Merge(std::vector<SpillRun>& runs, size_t first, size_t n,
+                           SpillWriter* writer, HeapFile* out)
+{
+	Status status = OK;
+	int k = n;
+
+	std::vector<SpillReader> readers;
+	for (int i = 0; i < k; i++)
+	{
+		readers.push_back(SpillReader(frames[i], &runs[first + i]));
+		if (status == OK)
+			status = readers.back().Start();
+	}
+	if (status != OK)
+		return status;
+
+	std::vector<int> tree(k, k);
+
+	auto beats = [&](int a, int b) -> bool
+	{
+		if (a == k || b == k)
+			return a == k && b != k;
+		if (readers[a].done || readers[b].done)
+			return !readers[a].done || (readers[b].done && a < b);
+		if (Less(readers[a].recPtr, readers[b].recPtr))
+			return true;
+		if (Less(readers[b].recPtr, readers[a].recPtr))
+			return false;
+		return a < b;
+	};
+
+	auto play = [&](int s)
+	{
+		for (int p = (s + k) / 2; p > 0; p /= 2)
+		{
+			if (beats(tree[p], s))
+				std::swap(s, tree[p]);
+		}
+		tree[0] = s;
+	};
+
+	for (int i = k - 1; i >= 0; i--)
+		play(i);
+
+	RecordID rid;
+	while (!readers[tree[0]].done)
+	{
+		SpillReader& winner = readers[tree[0]];
+
+		if (writer != NULL)
+			status = writer->Append(winner.recPtr, winner.recLen);
+		else
+			status = out->AppendRecord(winner.recPtr, winner.recLen, rid);
+		if (status == OK)
+			status = winner.Advance();
+		if (status != OK)
+			return FAIL;
+
+		play(tree[0]);
+	}
+
+	return OK;
+}
+
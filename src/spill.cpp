@@ -0,0 +1,226 @@
+#include "spill.h"
+#include "heappage.h"
+#include "db.h"
+
+
+//------------------------------------------------------------------
+// SpillRun::Free
+//
+// Input    : None.
+// Output   : None.
+// Purpose  : Gives the pages of the run back to the database, a run of
+//            contiguous pages at a time.
+//------------------------------------------------------------------
+
+void SpillRun::Free()
+{
+	size_t i = 0;
+	while (i < pages.size())
+	{
+		if (pages[i] == INVALID_PAGE)
+		{
+			i++;
+			continue;
+		}
+
+		size_t j = i + 1;
+		while (j < pages.size() && pages[j] == pages[j - 1] + 1)
+			j++;
+		MINIBASE_DB->DeallocatePage(pages[i], j - i);
+		i = j;
+	}
+	pages.clear();
+}
+
+
+//------------------------------------------------------------------
+// SpillSpace::NewPage
+//
+// Input    : None.
+// Output   : pid - a free page.
+// Purpose  : Hands out the next page of the extent, allocating a new
+//            extent after the old one, if it can, once it is used up.
+// Return   : OK on success, FAIL if the database is full.
+//------------------------------------------------------------------
+
+Status SpillSpace::NewPage(PageID& pid)
+{
+	if (extentNext == extentEnd)
+	{
+		int runSize = SPILL_EXTENT_SIZE;
+		PageID near = (extentEnd == INVALID_PAGE) ? 0 : extentEnd;
+		if (MINIBASE_DB->AllocateExtent(extentNext, runSize, near) != OK)
+		{
+			cerr << "SpillSpace::NewPage - no space to spill to\n";
+			extentNext = extentEnd = INVALID_PAGE;
+			return FAIL;
+		}
+		extentEnd = extentNext + runSize;
+	}
+
+	pid = extentNext++;
+	return OK;
+}
+
+
+void SpillSpace::FreePage(PageID pid)
+{
+	if (pid == extentNext - 1)
+		extentNext--;
+	else
+		MINIBASE_DB->DeallocatePage(pid);
+}
+
+
+void SpillSpace::Release()
+{
+	if (extentNext != extentEnd)
+		MINIBASE_DB->DeallocatePage(extentNext, extentEnd - extentNext);
+	extentNext = extentEnd = INVALID_PAGE;
+}
+
+
+SpillWriter::SpillWriter(SpillSpace& space, Page* frame)
+	: space(&space), page((HeapPage*)frame), run(NULL), pid(INVALID_PAGE)
+{
+}
+
+
+Status SpillWriter::Begin(SpillRun* r)
+{
+	run = r;
+	return StartPage();
+}
+
+
+Status SpillWriter::StartPage()
+{
+	if (space->NewPage(pid) != OK)
+	{
+		pid = INVALID_PAGE;
+		return FAIL;
+	}
+	page->Init(pid);
+	return OK;
+}
+
+
+//------------------------------------------------------------------
+// SpillWriter::Append
+//
+// Input    : recPtr - a record,
+//            recLen - its length.
+// Output   : None.
+// Purpose  : Adds the record to the page in the frame, writing the page
+//            and starting the next one if it is full.
+// Return   : OK on success, FAIL otherwise.
+//------------------------------------------------------------------
+
+Status SpillWriter::Append(const char* recPtr, int recLen)
+{
+	RecordID rid;
+	if (page->InsertRecord((char*)recPtr, recLen, rid) == OK)
+		return OK;
+
+	// A scratch page: restart never reads a run.
+	if (MINIBASE_DB->WritePage(pid, (Page*)page, true) != OK)
+		return FAIL;
+	run->pages.push_back(pid);
+
+	if (StartPage() != OK)
+		return FAIL;
+	return page->InsertRecord((char*)recPtr, recLen, rid);
+}
+
+
+Status SpillWriter::End()
+{
+	if (pid == INVALID_PAGE)
+		return OK;
+
+	Status status = OK;
+	if (page->GetNumOfRecords() > 0)
+		status = MINIBASE_DB->WritePage(pid, (Page*)page, true);
+	if (status == OK && page->GetNumOfRecords() > 0)
+		run->pages.push_back(pid);
+	else
+		space->FreePage(pid);
+
+	pid = INVALID_PAGE;
+	return status;
+}
+
+
+SpillReader::SpillReader(Page* frame, SpillRun* run, bool freeRun)
+	: done(false), recPtr(NULL), recLen(0), page((HeapPage*)frame),
+	  run(run), freeRun(freeRun), nextPage(0)
+{
+}
+
+
+Status SpillReader::Start()
+{
+	done = false;
+	nextPage = 0;
+	return ReadPage();
+}
+
+
+Status SpillReader::ReadPage()
+{
+	while (nextPage < run->pages.size())
+	{
+		PageID& pid = run->pages[nextPage++];
+		if (MINIBASE_DB->ReadPage(pid, (Page*)page) != OK)
+			return FAIL;
+		if (freeRun)
+		{
+			MINIBASE_DB->DeallocatePage(pid);
+			pid = INVALID_PAGE;
+		}
+
+		if (page->FirstRecord(rid) == OK)
+			return page->ReturnRecord(rid, recPtr, recLen);
+	}
+
+	done = true;
+	return OK;
+}
+
+
+Status SpillReader::Advance()
+{
+	RecordID next;
+	if (page->NextRecord(rid, next) == OK)
+	{
+		rid = next;
+		return page->ReturnRecord(rid, recPtr, recLen);
+	}
+	return ReadPage();
+}
+
+
+Status SpillReader::GetNextBatch(std::vector<char*>& recPtrs, std::vector<int>& recLens)
+{
+	recPtrs.clear();
+	recLens.clear();
+
+	if (ReadPage() != OK)
+		return FAIL;
+	if (done)
+		return DONE;
+
+	recPtrs.push_back(recPtr);
+	recLens.push_back(recLen);
+
+	RecordID next;
+	while (page->NextRecord(rid, next) == OK)
+	{
+		rid = next;
+		if (page->ReturnRecord(rid, recPtr, recLen) != OK)
+			return FAIL;
+		recPtrs.push_back(recPtr);
+		recLens.push_back(recLen);
+	}
+	return OK;
+}
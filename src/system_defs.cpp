@@ -0,0 +1,161 @@
+/////////////////////////////////////////////////////////////////
+//
+// filename : system_defs.cpp
+//
+// System startup: creates the global buffer manager and opens or
+// creates the database.
+//
+/////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <new>
+#include <string>
+
+#include "minirel.h"
+#include "bufmgr.h"
+#include "db.h"
+#include "logmgr.h"
+#include "recovery.h"
+#include "mvcc.h"
+#include "locktable.h"
+#include "ioservice.h"
+
+extern int MINIBASE_RESTART_FLAG;
+
+SystemDefs* minibase_globals = 0;
+
+
+ostream& operator<<(ostream& out, const RecordID rid)
+{
+	out << "[" << rid.pageNo << "/" << rid.slotNo << "]";
+	return out;
+}
+
+
+SystemDefs::SystemDefs( Status& status, const char* dbname, const char* logname,
+                        unsigned dbpages, unsigned maxlogsize,
+                        unsigned bufpoolsize, const char* replacement_policy )
+{
+	if (replacement_policy == 0)
+		replacement_policy = "Clock";
+
+	init(status, dbname, logname, dbpages, maxlogsize, bufpoolsize,
+	     replacement_policy);
+}
+
+
+SystemDefs::SystemDefs( Status& status, const char* dbname, unsigned dbpages,
+                        unsigned bufpoolsize, const char* replacement_policy )
+{
+	char logname[MINIBASE_MAXARRSIZE + 8];
+	sprintf(logname, "%s-log", dbname);
+
+	if (bufpoolsize == 0)
+		bufpoolsize = NUMBUF;
+
+	unsigned maxlogsize = dbpages ? 3 * dbpages : 500;
+
+	init(status, dbname, logname, dbpages, maxlogsize, bufpoolsize,
+	     replacement_policy);
+}
+
+
+void SystemDefs::init( Status& status, const char* dbname, const char* logname,
+                       unsigned dbpages, unsigned maxlogsize,
+                       unsigned bufpoolsize, const char* replacement_policy )
+{
+	status = OK;
+	GlobalBufMgr = 0;
+	GlobalDB = 0;
+	GlobalCatalogPtr = 0;
+	GlobalDBName = 0;
+	GlobalLogName = 0;
+	GlobalLogMgr = 0;
+	GlobalTxnMgr = 0;
+	GlobalLockTable = 0;
+	GlobalIOService = 0;
+
+	minibase_globals = this;
+
+	void* bufspace = malloc(sizeof(BufMgr));
+	GlobalBufMgr = new(bufspace) BufMgr(bufpoolsize, replacement_policy);
+
+	GlobalDBName = strcpy(malloc(strlen(dbname) + 1), dbname);
+	GlobalLogName = strcpy(malloc(strlen(logname) + 1), logname);
+
+	bool opening = MINIBASE_RESTART_FLAG || dbpages == 0;
+	std::string pagelist = std::string(dbname) + ".prewarm";
+
+	GlobalLogMgr = new LogMgr(logname, maxlogsize, !opening, status);
+	if (status != OK) {
+		cerr << "Error opening log " << logname << endl;
+		minibase_errors.show_errors();
+		return;
+	}
+	GlobalTxnMgr = new TxnMgr(GlobalLogMgr);
+	GlobalLockTable = new LockTable();
+	GlobalIOService = new IOService(IO_THREADS);
+
+	if (opening) {
+		GlobalDB = new DB(dbname, status);
+		if (status != OK) {
+			cerr << "Error opening Database " << dbname << endl;
+			minibase_errors.show_errors();
+			return;
+		}
+
+		RecoveryMgr recovery(GlobalLogMgr);
+		status = recovery.Recover();
+		if (status != OK) {
+			cerr << "Error recovering Database " << dbname << endl;
+			minibase_errors.show_errors();
+			return;
+		}
+
+		// Bring back, in the background, the pages the pool held when
+		// the database was last closed.
+		GlobalBufMgr->SetPageListFile(pagelist.c_str());
+		GlobalBufMgr->Prewarm();
+	}
+	else {
+		GlobalDB = new DB(dbname, dbpages, status);
+		if (status != OK) {
+			cerr << "Error creating Database " << dbname << endl;
+			minibase_errors.show_errors();
+			return;
+		}
+
+		// A list left by a database of the same name is of no use.
+		unlink(pagelist.c_str());
+		GlobalBufMgr->SetPageListFile(pagelist.c_str());
+
+		status = GlobalBufMgr->FlushAllPages();
+		if (status != OK) {
+			cerr << "Error flushing buffer pool pages" << endl;
+			minibase_errors.show_errors();
+		}
+	}
+}
+
+
+SystemDefs::~SystemDefs()
+{
+	// Reads still handed over use the pool; let them finish first.
+	delete GlobalIOService;
+
+	if (GlobalBufMgr) {
+		GlobalBufMgr->SavePageList();
+		GlobalBufMgr->~BufMgr();
+		delete [] (char*)GlobalBufMgr;
+	}
+	delete [] GlobalDBName;
+	delete [] GlobalLogName;
+	delete GlobalDB;
+	delete GlobalTxnMgr;
+	delete GlobalLockTable;
+	delete GlobalLogMgr;
+	minibase_globals = 0;
+}
@@ -1,279 +1,753 @@
-#include <stdlib.h>
-#include <stdio.h>
-#include <sys/types.h>
-#include <string.h>
-#include <errno.h>
-#include <iostream>
-#include <assert.h>
-#include <unistd.h>
-
-using namespace std;
-
-#include "new_error.h"
-#include "test.h"
-
-TestDriver::TestDriver( const char* nameRoot )
-{
-    unsigned len = (unsigned int)strlen(nameRoot);
-    char basename[200];
-    char dbfname[300];
-    char logfname[300];
-
-    sprintf( basename, "%s%d", nameRoot, getpid() );
-    sprintf( dbfname, "%s.minibase-db", basename );
-    sprintf( logfname, "%s.minibase-log", basename );
-
-    dbpath = strdup(dbfname);
-    logpath = strdup(logfname);
-}
-
-
-TestDriver::~TestDriver()
-{
-    ::free(dbpath);
-    ::free(logpath);
-}
-
-
-bool TestDriver::Test1()
-{
-    return true;
-}
-
-bool TestDriver::Test2()
-{
-    return true;
-}
-
-bool TestDriver::Test3()
-{
-    return true;
-}
-
-bool TestDriver::Test4()
-{
-    return true;
-}
-
-bool TestDriver::Test5()
-{
-    return true;
-}
-
-bool TestDriver::Test6()
-{
-    return true;
-}
-
-
-const char* TestDriver::TestName()
-{
-    return "*** unknown ***";   // A little reminder to subclassers.
-}
-
-
-void TestDriver::TestFailure( Status& status, Status expectedStatus,
-                              const char* activity, int postedErrExpected )
-{
-    if ( status == OK )
-    {
-        status = FAIL;
-        cerr << "*** " << activity << " did not return a failure status.\n";
-    }
-	/*
-    else if ( status != expectedStatus )
-        cerr << "*** " << activity << " correctly returned a failure status,\n"
-             << "    but not the expected one.\n";
-    else if ( postedErrExpected && !minibase_errors.error() )
-        cerr << "*** " << activity << " correctly returned a failure status,\n"
-             << "    but did not log the error.\n";
-    else if ( !postedErrExpected && minibase_errors.error() )
-        cerr << "*** " << activity << " correctly returned a failure status,\n"
-             << "    but unexpectedly logged the error.\n";
-	*/
-    else
-    {
-        status = OK;
-        cout << "    --> Failed as expected\n";
-    }
-
-    if ( status != OK )
-        minibase_errors.show_errors();
-
-    minibase_errors.clear_errors();
-}
-
-
-
-void TestDriver::RunTest( Status& status, TestDriver::testFunction test )
-{
-    /*
-	minibase_errors.clear_errors();
-    int result = test();
-    if ( !result || minibase_errors.error() )
-    {
-        status = FAIL;
-        if ( minibase_errors.error() )
-            cerr << (result? "*** Unexpected error(s) logged, test failed:\n"
-                     : "Errors logged:\n");
-        minibase_errors.show_errors(cerr);
-    }
-	*/
-}
-
-
-Status TestDriver::RunTests()
-{
-    cout << "\nRunning " << TestName() << " tests...\n" << endl;
-
-
-    // Kill anything that might be hanging around.
-
-    char* newdbpath;
-    char* newlogpath;
-   
-	//char remove_logcmd[50];
-	//char remove_dbcmd[50];
-
-    newdbpath = new char[ strlen(dbpath) + 20];
-    newlogpath = new char[ strlen(logpath) + 20];
-    strcpy(newdbpath,dbpath); 
-    strcpy(newlogpath, logpath);
-
-/*	sprintf(remove_logcmd, "del %s", logpath);
-	sprintf(remove_dbcmd, "del %s", dbpath);
-	
-	system(remove_logcmd);
-	system(remove_dbcmd);
-*/
-	sprintf(newdbpath, "%s", dbpath);
-	sprintf(newlogpath, "%s", logpath);
-
-
-    unlink( newdbpath );
-    unlink( newlogpath );
-
-    minibase_errors.clear_errors();
-
-
-      // Run the tests.
-    Status answer = RunAllTests();
-
-
-      // Clean up.
-	/*
-    unlink( newdbpath );
-    unlink( newlogpath );
-	*/
-
-    minibase_errors.clear_errors();
-
-    cout << "\n..." << TestName() << " tests "
-         << (answer == OK ? "completed successfully" : "failed")
-         << ".\n\n";
-
-    delete newdbpath; delete newlogpath;
-
-    return answer;
-}
-
-
-Status TestDriver::RunAllTests()
-{
-    std::string inputTxt;
-
-	//there are really 6 tests but the last one doesn't do anything so I'll only mention 1-5
-	cout << "Input a space separated test sequence (ie. a list of numbers " 
-         << endl 
-         << " in the range 1-5: 1 2 3 4 5) or hit ENTER to run all tests: ";
-    std::getline(cin, inputTxt);
-
-	if ( inputTxt.size() == 0 )
-	{
-		inputTxt = "12345";
-	}
-
-    Status status = OK;
-    int result;
-	for ( size_t i = 0; i < inputTxt.size(); i++)
-	{
-		switch ( inputTxt[i] )
-		{
-		case '1' : 
-			minibase_errors.clear_errors();
-			result = Test1();
-			if ( !result || minibase_errors.error() )
-			{
-				status = FAIL;
-				if ( minibase_errors.error() )
-					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
-					                : "Errors logged:\n");
-				minibase_errors.show_errors(cerr);
-			}
-			break;
-		case '2' :
-			minibase_errors.clear_errors();
-			result = Test2();
-			if ( !result || minibase_errors.error() )
-			{
-				status = FAIL;
-				if ( minibase_errors.error() )
-					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
-					                : "Errors logged:\n");
-				minibase_errors.show_errors(cerr);
-			}
-			break;
-		case '3' :
-			minibase_errors.clear_errors();
-			result = Test3();
-			if ( !result || minibase_errors.error() )
-			{
-				status = FAIL;
-				if ( minibase_errors.error() )
-					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
-					                : "Errors logged:\n");
-				minibase_errors.show_errors(cerr);
-			}    
-			break;
-		case '4' :
-			minibase_errors.clear_errors();
-			result = Test4();
-			if ( !result || minibase_errors.error() )
-			{
-				status = FAIL;
-				if ( minibase_errors.error() )
-					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
-					                : "Errors logged:\n");
-				minibase_errors.show_errors(cerr);
-			}
-			break;
-		case '5' :
-			minibase_errors.clear_errors();
-			result = Test5();
-			if ( !result || minibase_errors.error() )
-			{
-				status = FAIL;
-				if ( minibase_errors.error() )
-					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
-					                : "Errors logged:\n");
-				minibase_errors.show_errors(cerr);
-			}
-			break;
-		case '6' :
-			minibase_errors.clear_errors();
-			result = Test6();
-			if ( !result || minibase_errors.error() )
-			{
-				status = FAIL;
-				if ( minibase_errors.error() )
-					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
-					                : "Errors logged:\n");
-				minibase_errors.show_errors(cerr);
-			}
-
-			minibase_errors.clear_errors();
-			break;
-		}
-	}
-    return status;
-}
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <string.h>
+#include <errno.h>
+#include <iostream>
+#include <assert.h>
+#include <unistd.h>
+
+using namespace std;
+
+#include "new_error.h"
+#include "test.h"
+
+TestDriver::TestDriver( const char* nameRoot )
+{
+    unsigned len = (unsigned int)strlen(nameRoot);
+    char basename[200];
+    char dbfname[300];
+    char logfname[300];
+
+    sprintf( basename, "%s%d", nameRoot, getpid() );
+    sprintf( dbfname, "%s.minibase-db", basename );
+    sprintf( logfname, "%s.minibase-log", basename );
+
+    dbpath = strdup(dbfname);
+    logpath = strdup(logfname);
+}
+
+
+TestDriver::~TestDriver()
+{
+    ::free(dbpath);
+    ::free(logpath);
+}
+
+
+bool TestDriver::Test1()
+{
+    return true;
+}
+
+bool TestDriver::Test2()
+{
+    return true;
+}
+
+bool TestDriver::Test3()
+{
+    return true;
+}
+
+bool TestDriver::Test4()
+{
+    return true;
+}
+
+bool TestDriver::Test5()
+{
+    return true;
+}
+
+bool TestDriver::Test6()
+{
+    return true;
+}
+
+bool TestDriver::Test7()
+{
+    return true;
+}
+
+bool TestDriver::Test8()
+{
+    return true;
+}
+
+bool TestDriver::Test9()
+{
+    return true;
+}
+
+bool TestDriver::Test10()
+{
+    return true;
+}
+
+bool TestDriver::Test11()
+{
+    return true;
+}
+
+bool TestDriver::Test12()
+{
+    return true;
+}
+
+bool TestDriver::Test13()
+{
+    return true;
+}
+
+bool TestDriver::Test14()
+{
+    return true;
+}
+
+bool TestDriver::Test15()
+{
+    return true;
+}
+
+bool TestDriver::Test16()
+{
+    return true;
+}
+
+bool TestDriver::Test17()
+{
+    return true;
+}
+
+bool TestDriver::Test18()
+{
+    return true;
+}
+
+bool TestDriver::Test19()
+{
+    return true;
+}
+
+bool TestDriver::Test20()
+{
+    return true;
+}
+
+bool TestDriver::Test21()
+{
+    return true;
+}
+
+bool TestDriver::Test22()
+{
+    return true;
+}
+
+bool TestDriver::Test23()
+{
+    return true;
+}
+
+bool TestDriver::Test24()
+{
+    return true;
+}
+
+bool TestDriver::Test25()
+{
+    return true;
+}
+
+bool TestDriver::Test26()
+{
+    return true;
+}
+
+bool TestDriver::Test27()
+{
+    return true;
+}
+
+bool TestDriver::Test28()
+{
+    return true;
+}
+
+bool TestDriver::Test29()
+{
+    return true;
+}
+
+bool TestDriver::Test30()
+{
+    return true;
+}
+
+bool TestDriver::Test31()
+{
+    return true;
+}
+
+bool TestDriver::Test32()
+{
+    return true;
+}
+
+bool TestDriver::Test33()
+{
+    return true;
+}
+
+
+const char* TestDriver::TestName()
+{
+    return "*** unknown ***";   // A little reminder to subclassers.
+}
+
+
+void TestDriver::TestFailure( Status& status, Status expectedStatus,
+                              const char* activity, int postedErrExpected )
+{
+    if ( status == OK )
+    {
+        status = FAIL;
+        cerr << "*** " << activity << " did not return a failure status.\n";
+    }
+	/*
+    else if ( status != expectedStatus )
+        cerr << "*** " << activity << " correctly returned a failure status,\n"
+             << "    but not the expected one.\n";
+    else if ( postedErrExpected && !minibase_errors.error() )
+        cerr << "*** " << activity << " correctly returned a failure status,\n"
+             << "    but did not log the error.\n";
+    else if ( !postedErrExpected && minibase_errors.error() )
+        cerr << "*** " << activity << " correctly returned a failure status,\n"
+             << "    but unexpectedly logged the error.\n";
+	*/
+    else
+    {
+        status = OK;
+        cout << "    --> Failed as expected\n";
+    }
+
+    if ( status != OK )
+        minibase_errors.show_errors();
+
+    minibase_errors.clear_errors();
+}
+
+
+
+void TestDriver::RunTest( Status& status, TestDriver::testFunction test )
+{
+    /*
+	minibase_errors.clear_errors();
+    int result = test();
+    if ( !result || minibase_errors.error() )
+    {
+        status = FAIL;
+        if ( minibase_errors.error() )
+            cerr << (result? "*** Unexpected error(s) logged, test failed:\n"
+                     : "Errors logged:\n");
+        minibase_errors.show_errors(cerr);
+    }
+	*/
+}
+
+
+Status TestDriver::RunTests()
+{
+    cout << "\nRunning " << TestName() << " tests...\n" << endl;
+
+
+    // Kill anything that might be hanging around.
+
+    char* newdbpath;
+    char* newlogpath;
+   
+	//char remove_logcmd[50];
+	//char remove_dbcmd[50];
+
+    newdbpath = new char[ strlen(dbpath) + 20];
+    newlogpath = new char[ strlen(logpath) + 20];
+    strcpy(newdbpath,dbpath); 
+    strcpy(newlogpath, logpath);
+
+/*	sprintf(remove_logcmd, "del %s", logpath);
+	sprintf(remove_dbcmd, "del %s", dbpath);
+	
+	system(remove_logcmd);
+	system(remove_dbcmd);
+*/
+	sprintf(newdbpath, "%s", dbpath);
+	sprintf(newlogpath, "%s", logpath);
+
+
+    unlink( newdbpath );
+    unlink( newlogpath );
+
+    minibase_errors.clear_errors();
+
+
+      // Run the tests.
+    Status answer = RunAllTests();
+
+
+      // Clean up.
+	/*
+    unlink( newdbpath );
+    unlink( newlogpath );
+	*/
+
+    minibase_errors.clear_errors();
+
+    cout << "\n..." << TestName() << " tests "
+         << (answer == OK ? "completed successfully" : "failed")
+         << ".\n\n";
+
+    delete [] newdbpath; delete [] newlogpath;
+
+    return answer;
+}
+
+
+Status TestDriver::RunAllTests()
+{
+    std::string inputTxt;
+
+	cout << "Input a space separated test sequence (ie. a list of numbers " 
+         << endl 
+         << " in the range 1-9, a-x: 1 2 3 4 5 6 7 8 9 a b c d e f g h i j k l m n o p q r s t u v w x) or hit ENTER to run all tests: ";
+    std::getline(cin, inputTxt);
+
+	if ( inputTxt.size() == 0 )
+	{
+		inputTxt = "123456789abcdefghijklmnopqrstuvwx";
+	}
+
+    Status status = OK;
+    int result;
+	for ( size_t i = 0; i < inputTxt.size(); i++)
+	{
+		switch ( inputTxt[i] )
+		{
+		case '1' : 
+			minibase_errors.clear_errors();
+			result = Test1();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case '2' :
+			minibase_errors.clear_errors();
+			result = Test2();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case '3' :
+			minibase_errors.clear_errors();
+			result = Test3();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}    
+			break;
+		case '4' :
+			minibase_errors.clear_errors();
+			result = Test4();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case '5' :
+			minibase_errors.clear_errors();
+			result = Test5();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case '6' :
+			minibase_errors.clear_errors();
+			result = Test6();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case '7' :
+			minibase_errors.clear_errors();
+			result = Test7();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case '8' :
+			minibase_errors.clear_errors();
+			result = Test8();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case '9' :
+			minibase_errors.clear_errors();
+			result = Test9();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case 'a' :
+			minibase_errors.clear_errors();
+			result = Test10();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case 'b' :
+			minibase_errors.clear_errors();
+			result = Test11();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case 'c' :
+			minibase_errors.clear_errors();
+			result = Test12();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case 'd' :
+			minibase_errors.clear_errors();
+			result = Test13();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case 'e' :
+			minibase_errors.clear_errors();
+			result = Test14();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case 'f' :
+			minibase_errors.clear_errors();
+			result = Test15();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case 'g' :
+			minibase_errors.clear_errors();
+			result = Test16();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+			break;
+		case 'h' :
+			minibase_errors.clear_errors();
+			result = Test17();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'i' :
+			minibase_errors.clear_errors();
+			result = Test18();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'j' :
+			minibase_errors.clear_errors();
+			result = Test19();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'k' :
+			minibase_errors.clear_errors();
+			result = Test20();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'l' :
+			minibase_errors.clear_errors();
+			result = Test21();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'm' :
+			minibase_errors.clear_errors();
+			result = Test22();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'n' :
+			minibase_errors.clear_errors();
+			result = Test23();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'o' :
+			minibase_errors.clear_errors();
+			result = Test24();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'p' :
+			minibase_errors.clear_errors();
+			result = Test25();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'q' :
+			minibase_errors.clear_errors();
+			result = Test26();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'r' :
+			minibase_errors.clear_errors();
+			result = Test27();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 's' :
+			minibase_errors.clear_errors();
+			result = Test28();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 't' :
+			minibase_errors.clear_errors();
+			result = Test29();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'u' :
+			minibase_errors.clear_errors();
+			result = Test30();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'v' :
+			minibase_errors.clear_errors();
+			result = Test31();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'w' :
+			minibase_errors.clear_errors();
+			result = Test32();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			break;
+		case 'x' :
+			minibase_errors.clear_errors();
+			result = Test33();
+			if ( !result || minibase_errors.error() )
+			{
+				status = FAIL;
+				if ( minibase_errors.error() )
+					cerr << (result ? "*** Unexpected error(s) logged, test failed:\n"
+					                : "Errors logged:\n");
+				minibase_errors.show_errors(cerr);
+			}
+
+			minibase_errors.clear_errors();
+			break;
+		}
+	}
+    return status;
+}